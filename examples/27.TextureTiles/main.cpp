@@ -0,0 +1,90 @@
+/** Example 027 TextureTiles
+
+This example measures the fill rate of the Burning's Video software
+renderer for a textured floor seen at a grazing angle. Such a floor is the
+worst case for a texture stored row by row: the pixels of a scanline walk
+diagonally through the texture, and with a rolled camera nearly every texel
+is in another row, so in another cache line.
+
+When the engine is compiled with SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+(see SoftwareDriver2_compile_config.h), Burning's Video samples a copy of
+each texture which is stored in small square tiles, so texels which are
+near on the screen are also near in memory. Build the engine once as it is
+and once with NO_SOFTWARE_DRIVER_2_TEXTURE_TILES defined and compare the
+times printed by this example.
+*/
+
+#ifdef _MSC_VER
+// We'll also define this to stop MSVC complaining about sprintf().
+#define _CRT_SECURE_NO_WARNINGS
+#pragma comment(lib, "Irrlicht.lib")
+#endif
+
+#include <irrlicht.h>
+#include <stdio.h>
+
+using namespace irr;
+
+/*
+The floor is drawn with point sampling and with bilinear filtering, each
+with an upright and a rolled camera. The frames of a run are rendered as
+fast as possible and the average time of a frame is printed.
+*/
+int main()
+{
+	IrrlichtDevice* device = createDevice(video::EDT_BURNINGSVIDEO,
+			core::dimension2d<u32>(640, 480));
+	if (device == 0)
+		return 1; // could not create selected driver.
+
+	video::IVideoDriver* driver = device->getVideoDriver();
+	scene::ISceneManager* smgr = device->getSceneManager();
+	ITimer* timer = device->getTimer();
+
+	/*
+	A large floor, repeating a large texture. It is split into many
+	triangles, so each of them gets a fitting mip map level.
+	*/
+	scene::IMesh* floor = smgr->addHillPlaneMesh("floor",
+			core::dimension2d<f32>(20, 20), core::dimension2d<u32>(40, 40), 0, 0,
+			core::dimension2d<f32>(0, 0), core::dimension2d<f32>(20, 20));
+	scene::IMeshSceneNode* node = smgr->addMeshSceneNode(floor);
+	node->setMaterialFlag(video::EMF_LIGHTING, false);
+	node->setMaterialTexture(0, driver->getTexture("../../media/terrain-texture.jpg"));
+
+	scene::ICameraSceneNode* camera = smgr->addCameraSceneNode(0,
+			core::vector3df(0, 6, 0), core::vector3df(100, 0, 100));
+	camera->setFarValue(2000.f);
+
+	const u32 frames = 200;
+	for (u32 run = 0; run < 4 && device->run(); ++run)
+	{
+		const bool bilinear = run >= 2;
+		const bool roll = run & 1;
+
+		node->setMaterialFlag(video::EMF_BILINEAR_FILTER, bilinear);
+		camera->setUpVector(roll ? core::vector3df(0.5f, 1, -0.5f) : core::vector3df(0, 1, 0));
+
+		const u32 start = timer->getRealTime();
+		for (u32 i = 0; i < frames && device->run(); ++i)
+		{
+			driver->beginScene(true, true, video::SColor(255, 100, 101, 140));
+			smgr->drawAll();
+			driver->endScene();
+		}
+		const u32 time = timer->getRealTime() - start;
+
+		printf("%s, %s camera: %.2f ms per frame\n",
+			bilinear ? "bilinear" : "point sampled",
+			roll ? "rolled" : "upright",
+			(f32) time / frames);
+	}
+
+	device->drop();
+
+	return 0;
+}
+
+/*
+That's it. Compile the engine both ways and compare the times.
+**/
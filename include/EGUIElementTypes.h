@@ -85,6 +85,9 @@ enum EGUI_ELEMENT_TYPE
 	//! A window
 	EGUIET_WINDOW,
 
+	//! A profiler display (IGUIProfiler)
+	EGUIET_PROFILER,
+
 	//! Unknown type.
 	EGUIET_ELEMENT,
 
@@ -125,6 +128,7 @@ const c8* const GUIElementTypeNames[] =
 	"toolBar",
 	"treeview",
 	"window",
+	"profiler",
 	"element",
 	"root",
 	0
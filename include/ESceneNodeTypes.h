@@ -51,6 +51,12 @@ namespace scene
 		//! Mesh Scene Node
 		ESNT_MESH           = MAKE_IRR_ID('m','e','s','h'),
 
+		//! Instanced Mesh Scene Node
+		ESNT_INSTANCED_MESH = MAKE_IRR_ID('i','m','s','h'),
+
+		//! Level of Detail Mesh Scene Node
+		ESNT_LOD_MESH       = MAKE_IRR_ID('l','o','d','m'),
+
 		//! Light Scene Node
 		ESNT_LIGHT          = MAKE_IRR_ID('l','g','h','t'),
 
@@ -47,6 +47,7 @@ class IGUIImageList;
 class IGUIFileOpenDialog;
 class IGUIColorSelectDialog;
 class IGUIInOutFader;
+class IGUIProfiler;
 class IGUIStaticText;
 class IGUIEditBox;
 class IGUISpinBox;
@@ -451,6 +452,15 @@ public:
 	IReferenceCounted::drop() for more information. */
 	virtual IGUIInOutFader* addInOutFader(const core::rect<s32>* rectangle=0, IGUIElement* parent=0, s32 id=-1) = 0;
 
+	//! Adds an element displaying the statistics of the engine's profiler.
+	/** \param rectangle Rectangle specifying the borders of the element.
+	\param parent Parent item of the element, e.g. a window.
+	\param id An identifier for the element.
+	\return Pointer to the created profiler display. Returns 0 if an
+	error occurred. This pointer should not be dropped. See
+	IReferenceCounted::drop() for more information. */
+	virtual IGUIProfiler* addProfilerDisplay(const core::rect<s32>& rectangle, IGUIElement* parent=0, s32 id=-1) = 0;
+
 	//! Adds a tab control to the environment.
 	/** \param rectangle Rectangle specifying the borders of the tab control.
 	\param parent Parent item of the element, e.g. a window.
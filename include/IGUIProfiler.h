@@ -0,0 +1,53 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_GUI_PROFILER_H_INCLUDED__
+#define __I_GUI_PROFILER_H_INCLUDED__
+
+#include "IGUIElement.h"
+
+namespace irr
+{
+namespace gui
+{
+
+	//! Element displaying the statistics of the IProfiler
+	/** It shows average, minimum, maximum and last time per frame of
+	each scope which was called since the last reset. Children are
+	indented below the scope they run in. Create it with
+	IGUIEnvironment::addProfilerDisplay(). */
+	class IGUIProfiler : public IGUIElement
+	{
+	public:
+
+		//! constructor
+		IGUIProfiler(IGUIEnvironment* environment, IGUIElement* parent, s32 id, core::rect<s32> rectangle)
+			: IGUIElement(EGUIET_PROFILER, environment, parent, id, rectangle) {}
+
+		//! Sets how often the displayed values are updated
+		/** \param ms Time between two updates in milliseconds. */
+		virtual void setUpdateInterval(u32 ms) = 0;
+
+		//! Gets the time between two updates in milliseconds
+		virtual u32 getUpdateInterval() const = 0;
+
+		//! Stops or continues updating the displayed values
+		virtual void setFrozen(bool freeze) = 0;
+
+		//! Checks if the displayed values are frozen
+		virtual bool isFrozen() const = 0;
+
+		//! Sets whether to draw a background behind the values
+		virtual void setDrawBackground(bool draw) = 0;
+
+		//! Checks if a background is drawn
+		virtual bool isDrawBackgroundEnabled() const = 0;
+	};
+
+
+} // end namespace gui
+} // end namespace irr
+
+#endif
+
@@ -95,6 +95,18 @@ public:
 	//! copies this surface into another, scaling it to fit, appyling a box filter
 	virtual void copyToScalingBoxFilter(IImage* target, s32 bias = 0, bool blend = false) = 0;
 
+	//! Writes the mip map levels of the image into a buffer
+	/** Each level has half the width and height of the previous one, down
+	to 1x1, and each pixel is the average of 2x2 pixels of the previous
+	level. The levels follow each other without padding, in the color
+	format of the image. This is the layout of the mipmapData of
+	IVideoDriver::addTexture() and ITexture::regenerateMipMapLevels().
+	\param target Buffer of getMipMapsDataSize() bytes.
+	\param gammaCorrect Average the colors in linear space, for images
+	which store sRGB colors. Alpha and floating point formats are always
+	averaged as they are stored. */
+	virtual void copyToMipMaps(void* target, bool gammaCorrect = false) = 0;
+
 	//! fills the surface with given color
 	virtual void fill(const SColor &color) =0;
 
@@ -128,6 +140,23 @@ public:
 		}
 	}
 
+	//! get the size in bytes of the mip map levels written by copyToMipMaps()
+	static u32 getMipMapsDataSize(const ECOLOR_FORMAT format, const core::dimension2d<u32>& size)
+	{
+		u32 width = size.Width;
+		u32 height = size.Height;
+		u32 pixels = 0;
+		while (width > 1 || height > 1)
+		{
+			if (width > 1)
+				width >>= 1;
+			if (height > 1)
+				height >>= 1;
+			pixels += width * height;
+		}
+		return pixels * (getBitsPerPixelFromFormat(format) / 8);
+	}
+
 	//! test if the color format is only viable for RenderTarget textures
 	/** Since we don't have support for e.g. floating point IImage formats
 	one should test if the color format can be used for arbitrary usage, or
@@ -0,0 +1,142 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class IMesh;
+
+
+//! A scene node displaying many instances of one static mesh
+/** Each instance has its own transformation relative to the node and
+a color. Instances are culled against the view frustum together and
+all visible instances of a mesh buffer are drawn with one call of
+IVideoDriver::drawMeshBufferInstanced(). This is much faster than one
+IMeshSceneNode per instance for things like trees, rocks or grass.
+Instances are identified by their index, which is between 0 and
+getInstanceCount()-1. */
+class IInstancedMeshSceneNode : public ISceneNode
+{
+public:
+
+	//! Constructor
+	/** Use setMesh() to set the mesh to display.
+	*/
+	IInstancedMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: ISceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Sets a new mesh to display
+	/** \param mesh Mesh to display. */
+	virtual void setMesh(IMesh* mesh) = 0;
+
+	//! Get the currently defined mesh for display.
+	/** \return Pointer to mesh which is displayed by this node. */
+	virtual IMesh* getMesh(void) = 0;
+
+	//! Adds an instance of the mesh
+	/** \param transform Transformation of the instance relative to
+	the node.
+	\param color Color of the instance. If it is not white, it
+	replaces the vertex colors of the mesh for this instance.
+	\return Index of the new instance. */
+	virtual u32 addInstance(const core::matrix4& transform,
+		video::SColor color=video::SColor(255,255,255,255)) = 0;
+
+	//! Removes an instance
+	/** The last instance is moved to the index of the removed one,
+	so indices of other instances stay valid except for the last.
+	\param index Index of the instance to remove. */
+	virtual void removeInstance(u32 index) = 0;
+
+	//! Removes all instances
+	virtual void removeAllInstances() = 0;
+
+	//! Reserves memory for instances
+	/** Adding instances up to this amount does not allocate memory.
+	\param count Amount of instances to reserve memory for. */
+	virtual void reserveInstances(u32 count) = 0;
+
+	//! Get amount of instances
+	virtual u32 getInstanceCount() const = 0;
+
+	//! Get amount of instances which were visible in the last frame
+	/** Includes the instances drawn as impostors. */
+	virtual u32 getVisibleInstanceCount() const = 0;
+
+	//! Sets the transformation of an instance relative to the node
+	virtual void setInstanceTransform(u32 index, const core::matrix4& transform) = 0;
+
+	//! Get the transformation of an instance relative to the node
+	virtual const core::matrix4& getInstanceTransform(u32 index) const = 0;
+
+	//! Sets the color of an instance
+	virtual void setInstanceColor(u32 index, video::SColor color) = 0;
+
+	//! Get the color of an instance
+	virtual video::SColor getInstanceColor(u32 index) const = 0;
+
+	//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+	/** \param readonly Flag if the materials shall be read-only. */
+	virtual void setReadOnlyMaterials(bool readonly) = 0;
+
+	//! Check if the scene node should not copy the materials of the mesh but use them in a read only style
+	/** \return Whether the materials are read-only. */
+	virtual bool isReadOnlyMaterials() const = 0;
+
+	//! Draws instances far away from the camera as textured quads
+	/** The mesh is rendered from several directions around its
+	vertical axis into a texture created with
+	IVideoDriver::addRenderTargetTexture(). The views are rendered at
+	the start of the next ISceneManager::drawAll(), before any node is
+	drawn. setMesh() and setReadOnlyMaterials() render them again. With
+	read only materials, the texture is named after the name of the
+	mesh in the mesh cache and the settings, so all nodes with the same
+	mesh share it. Otherwise each node renders its own copied
+	materials, and this method has to be called again after they were
+	changed. Instances farther away from the camera than the distance
+	are drawn as quads which turn around the vertical axis to face the
+	camera, showing the view which is closest to the direction of the
+	camera. So the instances should only be rotated around the Y axis.
+	The quads of the node are drawn with one call for up to 16384
+	instances. Impostors need the EVDF_RENDER_TO_TARGET feature of the
+	driver.
+	\param distance Distance from the camera beyond which the
+	instances are drawn as quads. 0 draws all instances as meshes.
+	\param viewCount Amount of directions the mesh is rendered from.
+	\param viewSize Width and height of each view in pixels. */
+	virtual void setImpostors(f32 distance, u32 viewCount=8, u32 viewSize=128) = 0;
+
+	//! Renders the views of the mesh for the impostors
+	/** Called by ISceneManager::drawAll() after setImpostors(),
+	setMesh() or setReadOnlyMaterials(). Does nothing if the views
+	are up to date. */
+	virtual void updateImpostorViews() = 0;
+
+	//! Get the distance beyond which instances are drawn as quads
+	virtual f32 getImpostorDistance() const = 0;
+
+	//! Get amount of instances which were drawn as quads in the last frame
+	virtual u32 getVisibleImpostorCount() const = 0;
+
+	//! Get the texture with the views of the mesh
+	/** \return The texture, or 0 if it was not rendered yet. */
+	virtual video::ITexture* getImpostorTexture() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
+
@@ -0,0 +1,82 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_LOD_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_LOD_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IMeshSceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! A mesh scene node which switches to less detailed meshes when it gets small on the screen
+/** The mesh set with setMesh() is level 0, the most detailed one.
+Less detailed levels are added with addLevel(), for example meshes
+created by IMeshManipulator::createLODMeshes(). Each frame the height
+of the bounding sphere of the node projected by the active camera is
+compared to the screen sizes of the levels, and the last level whose
+screen size is larger than the projected height is drawn. To avoid
+flickering at the limits, a level is only changed when the limit is
+passed by the hysteresis. All levels use the materials of the node,
+so they must have the same mesh buffers in the same order as the
+mesh of level 0. */
+class ILODMeshSceneNode : public IMeshSceneNode
+{
+public:
+
+	//! Constructor
+	/** Use setMesh() to set the mesh to display.
+	*/
+	ILODMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: IMeshSceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Adds a less detailed level
+	/** \param mesh Mesh of the level.
+	\param screenSize The level is used when the projected height of
+	the node is below this fraction of the screen height. Must be
+	smaller than the screen size of the previous level. */
+	virtual void addLevel(IMesh* mesh, f32 screenSize) = 0;
+
+	//! Removes all levels except level 0
+	/** This is also done by setMesh(). */
+	virtual void removeLevels() = 0;
+
+	//! Get the amount of levels, including level 0
+	virtual u32 getLevelCount() const = 0;
+
+	//! Get the mesh of a level
+	virtual IMesh* getLevelMesh(u32 level) = 0;
+
+	//! Sets the screen size below which a level is used
+	/** \param level Level, larger than 0.
+	\param screenSize Fraction of the screen height. */
+	virtual void setLevelScreenSize(u32 level, f32 screenSize) = 0;
+
+	//! Get the screen size below which a level is used
+	virtual f32 getLevelScreenSize(u32 level) const = 0;
+
+	//! Sets how far the limit of a level must be passed to change it
+	/** \param hysteresis Fraction of the screen size of the level.
+	The default is 0.1, so a node switches to a level with screen
+	size 0.5 below 0.45 and back above 0.55. */
+	virtual void setHysteresis(f32 hysteresis) = 0;
+
+	//! Get how far the limit of a level must be passed to change it
+	virtual f32 getHysteresis() const = 0;
+
+	//! Get the level which was chosen in the last frame
+	virtual u32 getCurrentLevel() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
+
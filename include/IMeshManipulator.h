@@ -295,6 +295,59 @@ namespace scene
 		\return A new mesh optimized for the vertex cache. */
 		virtual IMesh* createForsythOptimizedMesh(const IMesh *mesh) const = 0;
 
+		//! Merges the mesh buffers of several meshes which have equal materials
+		/** All vertices are transformed into the space of the new mesh.
+		Buffers with the same material and vertex type are merged into
+		one buffer, which is split when it would exceed the range of 16
+		bit indices, unless 32 bit indices are allowed. This way static
+		geometry can be drawn with only a few draw calls.
+		\param meshes Array of meshes to merge.
+		\param transforms Transformation of each mesh into the space of
+		the new mesh.
+		\param materials Optional array with a pointer to the materials
+		of each mesh, one per mesh buffer. If this or the pointer of a
+		mesh is 0, the materials of the mesh buffers are used.
+		\param count Amount of meshes.
+		\param allow32BitIndices Allow buffers with 32 bit indices,
+		which aren't supported by all drivers.
+		\return Mesh with the merged and transformed buffers. If you no
+		longer need the mesh, you should call IMesh::drop(). See
+		IReferenceCounted::drop() for more information. */
+		virtual IMesh* createBatchedMesh(const IMesh* const* meshes, const core::matrix4* transforms,
+			const video::SMaterial* const* materials, u32 count, bool allow32BitIndices=false) const = 0;
+
+		//! Creates a copy of a mesh with less triangles
+		/** Edges are collapsed in the order of the smallest quadric
+		error, so flat areas lose triangles first. Each mesh buffer is
+		simplified on its own and vertices are only removed, never
+		moved or created. Vertices on open edges, which includes UV and
+		normal seams where vertices are split and the borders between
+		mesh buffers of different materials, are kept, so the result
+		has no cracks and no stretched textures. Because of this the
+		requested amount of triangles can't always be reached.
+		\param mesh Mesh with triangle lists.
+		\param triangleRatio Amount of triangles to keep, between 0
+		and 1.
+		\return New mesh with the same amount of mesh buffers and
+		materials as the source. If you no longer need the mesh, you
+		should call IMesh::drop(). See IReferenceCounted::drop() for
+		more information. */
+		virtual IMesh* createSimplifiedMesh(const IMesh* mesh, f32 triangleRatio) const = 0;
+
+		//! Creates several simplified copies of a mesh as levels of detail
+		/** Same as calling createSimplifiedMesh() with triangleRatio,
+		triangleRatio^2 and so on, but faster because each level
+		continues the simplification of the previous one.
+		\param mesh Mesh with triangle lists.
+		\param levels The new meshes are appended to this array, the
+		most detailed one first. Drop them when they are no longer
+		needed.
+		\param levelCount Amount of meshes to create.
+		\param triangleRatio Amount of triangles each level keeps of
+		the previous one, between 0 and 1. */
+		virtual void createLODMeshes(const IMesh* mesh, core::array<IMesh*>& levels,
+			u32 levelCount, f32 triangleRatio=0.5f) const = 0;
+
 		//! Apply a manipulator on the Meshbuffer
 		/** \param func A functor defining the mesh manipulation.
 		\param buffer The Meshbuffer to apply the manipulator to.
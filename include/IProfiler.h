@@ -0,0 +1,193 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_PROFILER_H_INCLUDED__
+#define __I_PROFILER_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IReferenceCounted.h"
+#include "irrString.h"
+
+namespace irr
+{
+namespace io
+{
+	class IWriteFile;
+} // end namespace io
+
+//! Timings of one scope measured by the profiler
+/** All times are in microseconds. The times of all calls of a scope
+within one frame are added up, minimum, maximum and average are taken
+over the frames in which the scope was called. The time of a scope
+includes the times of its children. */
+struct SProfileData
+{
+	SProfileData() : Id(0), ParentId(0), Depth(0), CallCount(0), FrameCount(0),
+		TimeSum(0), MinFrameTime(0), MaxFrameTime(0), LastFrameTime(0)
+	{
+	}
+
+	//! Average time per frame in which the scope was called
+	u32 getAverageFrameTime() const
+	{
+		return FrameCount ? (u32)(TimeSum / FrameCount) : 0;
+	}
+
+	//! Id used to start and stop the scope
+	s32 Id;
+
+	//! Id of the scope which was running when this scope was started the first time
+	/** Equal to Id if no other scope was running. resetAll() lets
+	the scope find its parent again. */
+	s32 ParentId;
+
+	//! Amount of parents of the scope, 0 for a scope without parent
+	u32 Depth;
+
+	//! Name of the scope
+	core::stringw Name;
+
+	//! Name of the group of the scope, like "scene" or "video"
+	core::stringw GroupName;
+
+	//! Amount of calls since the last reset
+	u32 CallCount;
+
+	//! Amount of frames in which the scope was called
+	u32 FrameCount;
+
+	//! Time of all calls since the last reset
+	u64 TimeSum;
+
+	//! Shortest time of a frame
+	u32 MinFrameTime;
+
+	//! Longest time of a frame
+	u32 MaxFrameTime;
+
+	//! Time of the last frame in which the scope was called
+	u32 LastFrameTime;
+};
+
+
+//! Measures the time spent in scopes of the engine and the application
+/** The engine measures scopes like ISceneManager::drawAll(), its render
+passes, IVideoDriver::beginScene() and endScene(), loading textures and
+meshes and collision queries. Those have negative ids, applications can
+add their own scopes with positive ids. Scopes are usually measured with
+a CProfileScope object. The profiler is shared by all devices, it can be
+accessed with irr::getProfiler() or IrrlichtDevice::getProfiler(). Only
+the thread which renders the scene should use it.
+Measuring is only done when the engine is compiled with
+_IRR_COMPILE_WITH_PROFILING_. */
+class IProfiler : public virtual IReferenceCounted
+{
+public:
+
+	//! Adds a scope to measure
+	/** \param id Id of the scope, positive for scopes of the
+	application. If a scope with this id already exists, it is renamed.
+	\param name Name of the scope.
+	\param groupName Name of the group the scope belongs to. */
+	virtual void add(s32 id, const core::stringw& name, const core::stringw& groupName) = 0;
+
+	//! Removes a scope
+	virtual void remove(s32 id) = 0;
+
+	//! Starts the time measurement of a scope
+	/** Calls can be nested, only the outermost start() and stop() of
+	a scope are measured. A scope started while other scopes are
+	running becomes a child of the one started last, so "render solid"
+	is shown under "drawAll". */
+	virtual void start(s32 id) = 0;
+
+	//! Stops the time measurement of a scope
+	virtual void stop(s32 id) = 0;
+
+	//! Finishes the current frame
+	/** The times of all scopes called since the last call are added to
+	their statistics. This is called in IVideoDriver::beginScene(). */
+	virtual void nextFrame() = 0;
+
+	//! Enables or disables measuring
+	/** Disabled scopes cost only a function call. Enabled by default. */
+	virtual void setEnabled(bool enable) = 0;
+
+	//! Check if measuring is enabled
+	virtual bool isEnabled() const = 0;
+
+	//! Get the amount of scopes
+	virtual u32 getProfileDataCount() const = 0;
+
+	//! Get the data of a scope by index
+	/** \param index Index between 0 and getProfileDataCount()-1.
+	Scopes are sorted by their id.
+	\return Data of the scope. */
+	virtual const SProfileData& getProfileDataByIndex(u32 index) const = 0;
+
+	//! Get the data of a scope by id
+	/** \return Data of the scope, 0 if there is no scope with this id. */
+	virtual const SProfileData* getProfileData(s32 id) const = 0;
+
+	//! Resets the statistics of all scopes
+	virtual void resetAll() = 0;
+
+	//! Writes the statistics of all scopes as table into a string
+	/** Children are listed indented below their parent.
+	\param result String the table is added to.
+	\param suppressUncalled If true, scopes which were never called
+	since the last reset are left out. */
+	virtual void printAll(core::stringw& result, bool suppressUncalled=true) const = 0;
+
+	//! Writes the statistics of all scopes as table into a file
+	/** \param file File to write to.
+	\param suppressUncalled If true, scopes which were never called
+	since the last reset are left out.
+	\return True if successful. */
+	virtual bool writeToFile(io::IWriteFile* file, bool suppressUncalled=true) const = 0;
+};
+
+
+//! Get the profiler which is shared by the whole engine
+IRRLICHT_API IProfiler& IRRCALLCONV getProfiler();
+
+
+//! Measures the time until it goes out of scope
+/** Use it together with IRR_PROFILE to compile it out when the engine
+is built without _IRR_COMPILE_WITH_PROFILING_:
+\code
+{
+	IRR_PROFILE(CProfileScope p(MY_SCOPE_ID);)
+	doSomething();
+}
+\endcode */
+class CProfileScope
+{
+public:
+	CProfileScope(s32 id) : Id(id), Profiler(getProfiler())
+	{
+		Profiler.start(Id);
+	}
+
+	~CProfileScope()
+	{
+		Profiler.stop(Id);
+	}
+
+private:
+	s32 Id;
+	IProfiler& Profiler;
+};
+
+
+#ifdef _IRR_COMPILE_WITH_PROFILING_
+#define IRR_PROFILE(X) X
+#else
+#define IRR_PROFILE(X)
+#endif
+
+} // end namespace irr
+
+#endif
+
@@ -12,6 +12,8 @@ namespace irr
 {
 namespace scene
 {
+	struct SViewFrustum;
+
 	//! Interface for a Mesh which can be loaded directly from a Quake3 .bsp-file.
 	/** The Mesh tries to load all textures of the map.*/
 	class IQ3LevelMesh : public IAnimatedMesh
@@ -37,6 +39,42 @@ namespace scene
 
 		//! returns the requested brush entity
 		virtual IMesh* getBrushEntityMesh(quake3::IEntity &ent) const = 0;
+
+		//! Get the visibility cluster of a position
+		/** \param position Position in the coordinate system of the mesh.
+		\return Index of the cluster, or -1 if the position is inside
+		solid geometry or the level has no visibility data. */
+		virtual s32 getClusterFromPosition(const core::vector3df& position) const = 0;
+
+		//! Checks if a cluster is in the potentially visible set of another one
+		/** \param fromCluster Cluster of the viewer. If it is -1 or the
+		level has no visibility data, all clusters are visible.
+		\param testCluster Cluster to test.
+		\return True if testCluster might be visible from fromCluster. */
+		virtual bool isClusterVisible(s32 fromCluster, s32 testCluster) const = 0;
+
+		//! Restricts the potentially visible mesh to what can be seen from a position
+		/** Faces of leafs whose cluster is not in the potentially visible
+		set of the cluster of the position are left out. If a frustum is
+		given, faces of leafs outside of it are left out, too. Call this
+		once per frame with the position of the camera.
+		\param position Position of the viewer in the coordinate system
+		of the mesh.
+		\param frustum Optional view frustum in the coordinate system of
+		the mesh.
+		\return Amount of triangles in the potentially visible mesh. */
+		virtual u32 updatePotentiallyVisibleSet(const core::vector3df& position,
+				const SViewFrustum* frustum=0) = 0;
+
+		//! Get the level geometry restricted to the potentially visible set
+		/** The mesh has the same mesh buffers as
+		getMesh(quake3::E_Q3_MESH_GEOMETRY), sharing their vertices, but
+		only contains the faces found by the last call of
+		updatePotentiallyVisibleSet(). Before the first call all faces
+		are contained. Add it to a mesh scene node instead of the
+		geometry mesh to draw only the visible part of the level.
+		\return The mesh, never 0 for a loaded level. */
+		virtual IMesh* getPotentiallyVisibleMesh() const = 0;
 	};
 
 } // end namespace scene
@@ -11,6 +11,7 @@
 #include "path.h"
 #include "vector3d.h"
 #include "dimension2d.h"
+#include "aabbox3d.h"
 #include "SColor.h"
 #include "ETerrainElements.h"
 #include "ESceneNodeTypes.h"
@@ -108,6 +109,8 @@ namespace scene
 	class IMeshLoader;
 	class IMeshManipulator;
 	class IMeshSceneNode;
+	class IInstancedMeshSceneNode;
+	class ILODMeshSceneNode;
 	class IMeshWriter;
 	class IMetaTriangleSelector;
 	class IParticleSystemSceneNode;
@@ -522,6 +525,78 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) = 0;
 
+		//! Adds a scene node for rendering many instances of a static mesh.
+		/** Add the instances with IInstancedMeshSceneNode::addInstance().
+		\param mesh: Pointer to the loaded static mesh to be displayed.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initital rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) = 0;
+
+		//! Adds a scene node which draws less detailed versions of a static mesh when it gets small.
+		/** The less detailed meshes are created with
+		IMeshManipulator::createLODMeshes(). The first of them is used
+		when the node is smaller than half of the screen height, each
+		further one when the size went down by the square root of
+		triangleRatio, so the triangles keep about the same size on the
+		screen. Use ILODMeshSceneNode::setLevelScreenSize() to change
+		this.
+		\param mesh: Pointer to the loaded static mesh to be displayed.
+		\param levelCount: Amount of less detailed levels to create.
+		\param triangleRatio: Amount of triangles each level keeps of
+		the previous one.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initital rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual ILODMeshSceneNode* addLODMeshSceneNode(IMesh* mesh, u32 levelCount=3,
+			f32 triangleRatio=0.5f, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) = 0;
+
+		//! Merges static mesh scene nodes into a few batched nodes.
+		/** The meshes of the nodes are transformed into world space and
+		all mesh buffers with equal materials are merged with
+		IMeshManipulator::createBatchedMesh(), so the whole set is drawn
+		with a few draw calls. Only visible mesh scene nodes with a mesh,
+		without children and without transparent materials are batched,
+		all other nodes are ignored. The batched nodes are removed from
+		the scene, but kept alive by the scene manager so they can be
+		restored with unbatchStaticMeshes().
+		\param nodes: Nodes to batch.
+		\param cellSize: If larger than 0, the nodes are sorted into a
+		grid of cubes with this edge length by the center of their box,
+		and each cell gets its own batched node, so it can still be
+		culled. Otherwise all nodes go into one batch.
+		\param allow32BitIndices: Allow mesh buffers with 32 bit indices,
+		which results in fewer buffers but isn't supported by all drivers.
+		\return Pointer to an empty scene node which holds the batched
+		nodes as children, or 0 if no node could be batched. This
+		pointer should not be dropped. See IReferenceCounted::drop() for
+		more information. */
+		virtual ISceneNode* batchStaticMeshes(const core::array<ISceneNode*>& nodes,
+			f32 cellSize=0.f, bool allow32BitIndices=false) = 0;
+
+		//! Restores the nodes of a batch created with batchStaticMeshes().
+		/** The original nodes are added to their old parents again and
+		the batched nodes are removed.
+		\param batch: Node returned by batchStaticMeshes().
+		\return True if the node was a batch and has been removed. */
+		virtual bool unbatchStaticMeshes(ISceneNode* batch) = 0;
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		/** Looks really good when the Material type EMT_TRANSPARENT_REFLECTION
 		is used.
@@ -1080,7 +1155,15 @@ namespace scene
 		virtual ISceneNode* getRootSceneNode() = 0;
 
 		//! Get the first scene node with the specified id.
-		/** \param id: The id to search for
+		/** The scene manager keeps an index of ids, names and types of
+		the nodes in the scene. After nodes were added or removed, the next
+		search walks the whole scene graph and sorts the index again, which
+		is O(n log n) in the amount of nodes. After nodes were only renamed
+		or got a new id, the next search moves just their entries, which is
+		O(n) for a few changes. Searching repeatedly in an unchanged scene
+		is a binary search. So scenes which add or remove nodes every frame
+		should keep pointers to the nodes instead of searching them.
+		\param id: The id to search for
 		\param start: Scene node to start from. All children of this scene
 		node are searched. If null is specified, the root scene node is
 		taken.
@@ -1148,6 +1231,25 @@ namespace scene
 		virtual u32 registerNodeForRendering(ISceneNode* node,
 			E_SCENE_NODE_RENDER_PASS pass = ESNRP_AUTOMATIC) = 0;
 
+		//! Registers the mesh buffers of a node for rendering.
+		/** Scene nodes which draw nothing but the buffers of a mesh
+		with their absolute transformation can use this instead of
+		registerNodeForRendering() in ISceneNode::OnRegisterSceneNode().
+		The node is culled like with registerNodeForRendering(). Then
+		each buffer goes into the solid or transparent pass depending on
+		its material and is sorted with everything else registered in
+		this frame by material, textures and distance, so the video
+		driver has to change its states less often. ISceneNode::render()
+		is not called for those buffers.
+		\param node: Node the mesh belongs to.
+		\param mesh: Mesh to draw.
+		\param materials: Array with one material for each mesh buffer,
+		or 0 to use the materials of the mesh buffers. Has to stay valid
+		until drawAll() is finished.
+		\return Amount of mesh buffers registered, 0 if the node was culled. */
+		virtual u32 registerMeshForRendering(ISceneNode* node, IMesh* mesh,
+			const video::SMaterial* materials = 0) = 0;
+
 		//! Draws all the scene nodes.
 		/** This can only be invoked between
 		IVideoDriver::beginScene() and IVideoDriver::endScene(). Please note that
@@ -1155,6 +1257,124 @@ namespace scene
 		by existing scene node animators, culling of scene nodes is done, etc. */
 		virtual void drawAll() = 0;
 
+		//! Sets the number of threads used to animate the scene in drawAll().
+		/** By default the whole scene graph is animated on the thread
+		calling drawAll(). With more threads, each direct child of the
+		root scene node is a separate job which is animated by a pool of
+		worker threads, as long as all nodes in its subtree return true
+		for ISceneNode::isAnimationThreadSafe(). Most of the engine's
+		scene nodes do, custom scene nodes have to opt in. All other
+		subtrees are animated on the calling thread after the parallel
+		jobs. All animation has finished before the nodes are registered
+		for rendering. So to profit from this, put independent objects into
+		separate subtrees directly below the root and only use animators
+		which are thread safe (see ISceneNodeAnimator::isThreadSafe()).
+		If Irrlicht is compiled without _IRR_COMPILE_WITH_THREADS_ this
+		setting has no effect.
+		\param threadCount Number of threads to use, including the
+		calling thread. 1 disables parallel animation, 0 uses one thread
+		per processor. */
+		virtual void setAnimationThreadCount(u32 threadCount) = 0;
+
+		//! Get the number of threads used to animate the scene.
+		/** \return Number of threads including the thread calling
+		drawAll(), 1 if parallel animation is disabled. */
+		virtual u32 getAnimationThreadCount() const = 0;
+
+		//! Enables or disables the spatial index used for culling.
+		/** By default each scene node which registers itself for
+		rendering is tested against the view frustum by isCulled(),
+		so culling costs the same for nodes behind the camera as for
+		visible ones. With the spatial index, drawAll() sorts all
+		visible nodes with automatic culling into a loose octree and
+		classifies whole regions of it against the view frustum at once.
+		Nodes in regions outside of the frustum are culled without
+		further tests, nodes in regions completely inside skip the
+		bounding box and frustum tests of their culling flags. Occlusion
+		queries (EAC_OCC_QUERY) are still evaluated for them. Nodes with
+		EAC_OFF or only EAC_OCC_QUERY are not part of the index.
+		The index is kept up to date each frame, so moving nodes only
+		update their own entry.
+		\param enable True to use the spatial index.
+		\param worldBox Area covered by the index. Nodes outside of it
+		still work, but are always tested by themselves. Ignored when
+		disabling.
+		\param maxDepth Number of subdivisions of the world box. Cells
+		at maximum depth have the size of the world box divided by
+		2^maxDepth. Ignored when disabling. */
+		virtual void setSpatialIndex(bool enable, const core::aabbox3df& worldBox=core::aabbox3df(-10000.f,-10000.f,-10000.f,10000.f,10000.f,10000.f), u32 maxDepth=8) = 0;
+
+		//! Checks if the spatial index is used for culling.
+		/** \return True if the spatial index is enabled. */
+		virtual bool isSpatialIndexEnabled() const = 0;
+
+		//! Adds an occluder for software occlusion culling.
+		/** Before the nodes register themselves for rendering,
+		drawAll() rasterizes the meshes of all occluders into a small
+		depth buffer on the cpu. Nodes with EAC_OCC_SOFTWARE culling
+		whose bounding box is completely behind the occluders are culled.
+		Unlike occlusion queries this needs no round trip to the graphics
+		card and works in the frame it is drawn. Good occluders are big
+		and simple meshes inside of the visible geometry, like a box in a
+		building or the walls of a level, as the rasterizer only works in
+		the resolution of the depth buffer. Occluders are drawn only
+		while their node is visible and part of the scene.
+		\param node Node which places the occluder. Its absolute
+		transformation is used for the mesh. The node is grabbed.
+		\param mesh Triangles of the occluder in the coordinate system
+		of the node. If 0, the mesh of a mesh, octree, cube or sphere
+		scene node is used. The mesh is grabbed. */
+		virtual void addOccluder(ISceneNode* node, IMesh* mesh=0) = 0;
+
+		//! Removes all occluders of a node.
+		/** \return True if the node had occluders. */
+		virtual bool removeOccluder(ISceneNode* node) = 0;
+
+		//! Removes all occluders.
+		virtual void removeAllOccluders() = 0;
+
+		//! Sets the resolution of the depth buffer for software occlusion culling.
+		/** Higher resolutions cull more small objects behind edges of
+		occluders, but each pixel costs time for each occluder and each
+		tested node. The default is 256x128. */
+		virtual void setOcclusionBufferSize(const core::dimension2du& size) = 0;
+
+		//! Gets the resolution of the depth buffer for software occlusion culling.
+		virtual const core::dimension2du& getOcclusionBufferSize() const = 0;
+
+		//! Enables automatic hardware occlusion queries.
+		/** drawAll() then manages the occlusion queries of all nodes with
+		EAC_OCC_QUERY culling, so the application doesn't have to add,
+		run and update them with the IVideoDriver methods. After the
+		solid objects are drawn, the bounding boxes of those nodes which
+		are inside of the view frustum are drawn invisibly as queries.
+		The results are not waited for, the driver retrieves them in one
+		of the next frames and they are used from then on. Invisible
+		nodes are tested again as soon as the previous result arrived,
+		visible ones only every few frames, as they usually stay visible.
+		Nodes which were outside of the view frustum, or which contain
+		the camera, are assumed to be visible until a new result arrives.
+		This needs a driver which supports EVDF_OCCLUSION_QUERY.
+		\param enable True to manage the queries.
+		\param visibleTestInterval Visible nodes are tested again every
+		this many frames. The frames are spread over the nodes.
+		\param maxLatency Number of frames after which drawAll() waits
+		for a result which did not arrive yet. */
+		virtual void setAutomaticOcclusionQueries(bool enable, u32 visibleTestInterval=8, u32 maxLatency=3) = 0;
+
+		//! Checks if drawAll() manages the occlusion queries.
+		virtual bool isAutomaticOcclusionQueryEnabled() const = 0;
+
+		//! Renders the impostor views of a node in the next drawAll().
+		/** IInstancedMeshSceneNode calls this when its views have to be
+		rendered again. drawAll() renders them before any node is
+		registered for rendering, while the driver is between
+		IVideoDriver::beginScene() and IVideoDriver::endScene(), which
+		some drivers need for drawing into render targets.
+		\param node Node whose views are rendered. It is grabbed until
+		then. */
+		virtual void addImpostorUpdate(IInstancedMeshSceneNode* node) = 0;
+
 		//! Creates a rotation animator, which rotates the attached scene node around itself.
 		/** \param rotationSpeed Specifies the speed of the animation in degree per 10 milliseconds.
 		\return The animator. Attach it to a scene node with ISceneNode::addAnimator()
@@ -1638,6 +1858,31 @@ namespace scene
 			current callbacks manager and restore the default behavior. */
 		virtual void setLightManager(ILightManager* lightManager) = 0;
 
+		//! Creates a light manager for scenes with many dynamic lights
+		/** Without a light manager only the lights closest to the camera
+		are used, up to IVideoDriver::getMaximalDynamicLightAmount(). This
+		light manager uses all lights, but turns on only the lights close
+		to each node before it is rendered. For that the lights are sorted
+		into a grid of clusters in the view frustum of the active camera,
+		made of screen tiles and depth slices, so the effort does not grow
+		with lights times nodes. Directional lights are used for all nodes.
+		The lights are turned on again after drawAll().
+		Example:
+		\code
+		scene::ILightManager* lm = smgr->createClusteredLightManager();
+		smgr->setLightManager(lm);
+		lm->drop();
+		\endcode
+		\param maxLightsPerNode Maximal amount of lights for a node, the
+		nearest ones relative to their radius are used. It is also limited
+		by IVideoDriver::getMaximalDynamicLightAmount().
+		\param clusterCount Amount of tiles in x and y direction on the
+		screen and of depth slices.
+		\return The light manager. You need to drop() it after use, see
+		IReferenceCounted::drop() for details. */
+		virtual ILightManager* createClusteredLightManager(u32 maxLightsPerNode=8,
+			const core::vector3di& clusterCount=core::vector3di(16,8,24)) = 0;
+
 		//! Get an instance of a geometry creator.
 		/** The geometry creator provides some helper methods to create various types of
 		basic geometry. This can be useful for custom scene nodes. */
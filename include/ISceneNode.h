@@ -49,7 +49,10 @@ namespace scene
 			: RelativeTranslation(position), RelativeRotation(rotation), RelativeScale(scale),
 				Parent(0), SceneManager(mgr), TriangleSelector(0), ID(id),
 				AutomaticCullingState(EAC_BOX), DebugDataVisible(EDS_OFF),
-				IsVisible(true), IsDebugObject(false)
+				IsVisible(true), IsDebugObject(false), TransformationDirty(true),
+				BoundingSphereRadius(0.f),
+				BoundingSphereDirty(true), SpatialIndexHandle(0xffffffff), SpatialIndexMoved(true),
+				NodeIndexBegin(0), NodeIndexEnd(0), NodeIndexDirty(ENIC_STRUCTURE)
 		{
 			if (parent)
 				parent->addChild(this);
@@ -61,8 +64,14 @@ namespace scene
 		//! Destructor
 		virtual ~ISceneNode()
 		{
-			// delete all children
-			removeAll();
+			// delete all children, the node is not part of a scene
+			// anymore, so the node index needs no update
+			ISceneNodeList::Iterator it = Children.begin();
+			for (; it != Children.end(); ++it)
+			{
+				(*it)->Parent = 0;
+				(*it)->drop();
+			}
 
 			// delete all animators
 			ISceneNodeAnimatorList::Iterator ait = Animators.begin();
@@ -122,8 +131,10 @@ namespace scene
 					anim->animateNode(this, timeMs);
 				}
 
-				// update absolute position
-				updateAbsolutePosition();
+				// update absolute position, only if this node or its
+				// parent moved since the last update
+				if (TransformationDirty)
+					updateAbsolutePosition();
 
 				// perform the post render process on all children
 
@@ -134,6 +145,23 @@ namespace scene
 		}
 
 
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		/** When the scene manager animates with more than one thread,
+		a subtree below the root scene node is only animated on a
+		worker thread when this returns true for all nodes in it.
+		The default implementation returns false, so nodes which were
+		not written with this in mind stay on the thread calling
+		drawAll(). Overwrite this and return areAnimatorsThreadSafe() if
+		your OnAnimate() accesses nothing besides this node, its
+		animators and its own data.
+		\return True if OnAnimate() of this node can be called
+		concurrently with the OnAnimate() of nodes in other subtrees. */
+		virtual bool isAnimationThreadSafe() const
+		{
+			return false;
+		}
+
+
 		//! Renders the node.
 		virtual void render() = 0;
 
@@ -151,6 +179,7 @@ namespace scene
 		virtual void setName(const c8* name)
 		{
 			Name = name;
+			invalidateNodeIndex(ENIC_NAMES);
 		}
 
 
@@ -159,6 +188,7 @@ namespace scene
 		virtual void setName(const core::stringc& name)
 		{
 			Name = name;
+			invalidateNodeIndex(ENIC_NAMES);
 		}
 
 
@@ -183,11 +213,43 @@ namespace scene
 		}
 
 
-		//! Get the absolute transformation of the node. Is recalculated every OnAnimate()-call.
+		//! Get a sphere around the transformed bounding box of this node.
+		/** The sphere is cached and only recalculated when the
+		absolute transformation or the bounding box changed, so this is
+		cheap to call each frame. It is used for EAC_FRUSTUM_SPHERE
+		culling.
+		\param center Receives the center of the sphere in world space.
+		\param radius Receives the radius of the sphere. */
+		void getTransformedBoundingSphere(core::vector3df& center, f32& radius) const
+		{
+			const core::aabbox3d<f32>& box = getBoundingBox();
+			if (BoundingSphereDirty || box.MinEdge != BoundingSphereBox.MinEdge ||
+				box.MaxEdge != BoundingSphereBox.MaxEdge)
+			{
+				BoundingSphereBox = box;
+
+				const core::vector3df boxCenter = box.getCenter();
+				AbsoluteTransformation.transformVect(BoundingSphereCenter, boxCenter);
+
+				// a sphere around the box, scaled by the largest axis of the transformation
+				const core::vector3df scale = AbsoluteTransformation.getScale();
+				BoundingSphereRadius = (box.MaxEdge - boxCenter).getLength() *
+					core::max_(core::abs_(scale.X), core::abs_(scale.Y), core::abs_(scale.Z));
+
+				BoundingSphereDirty = false;
+			}
+
+			center = BoundingSphereCenter;
+			radius = BoundingSphereRadius;
+		}
+
+
+		//! Get the absolute transformation of the node. Is recalculated in OnAnimate() when the node or a parent moved.
 		/** NOTE: For speed reasons the absolute transformation is not 
 		automatically recalculated on each change of the relative 
 		transformation or by a transformation change of an parent. Instead the
-		update usually happens once per frame in OnAnimate. You can enforce 
+		update usually happens once per frame in OnAnimate, and only for
+		nodes marked with setTransformationDirty(). You can enforce 
 		an update with updateAbsolutePosition().
 		\return The absolute transformation matrix. */
 		virtual const core::matrix4& getAbsoluteTransformation() const
@@ -270,6 +332,7 @@ namespace scene
 		virtual void setID(s32 id)
 		{
 			ID = id;
+			invalidateNodeIndex(ENIC_IDS);
 		}
 
 
@@ -289,6 +352,8 @@ namespace scene
 				child->remove(); // remove from old parent
 				Children.push_back(child);
 				child->Parent = this;
+				child->TransformationDirty = true;
+				invalidateNodeIndex();
 			}
 		}
 
@@ -306,8 +371,10 @@ namespace scene
 				if ((*it) == child)
 				{
 					(*it)->Parent = 0;
+					(*it)->TransformationDirty = true;
 					(*it)->drop();
 					Children.erase(it);
+					invalidateNodeIndex();
 					return true;
 				}
 
@@ -326,10 +393,12 @@ namespace scene
 			for (; it != Children.end(); ++it)
 			{
 				(*it)->Parent = 0;
+				(*it)->TransformationDirty = true;
 				(*it)->drop();
 			}
 
 			Children.clear();
+			invalidateNodeIndex();
 		}
 
 
@@ -468,6 +537,7 @@ namespace scene
 		virtual void setScale(const core::vector3df& scale)
 		{
 			RelativeScale = scale;
+			TransformationDirty = true;
 		}
 
 
@@ -488,6 +558,7 @@ namespace scene
 		virtual void setRotation(const core::vector3df& rotation)
 		{
 			RelativeRotation = rotation;
+			TransformationDirty = true;
 		}
 
 
@@ -507,6 +578,7 @@ namespace scene
 		virtual void setPosition(const core::vector3df& newpos)
 		{
 			RelativeTranslation = newpos;
+			TransformationDirty = true;
 		}
 
 
@@ -599,6 +671,7 @@ namespace scene
 			remove();
 
 			Parent = newParent;
+			TransformationDirty = true;
 
 			if (Parent)
 				Parent->addChild(this);
@@ -607,6 +680,27 @@ namespace scene
 		}
 
 
+		//! Marks the absolute transformation of the node as outdated
+		/** OnAnimate() only recalculates the absolute transformation of
+		nodes which are marked. The setters of the relative transformation,
+		setParent() and a moving parent mark a node automatically. Nodes
+		which compute getRelativeTransformation() from other values have to
+		call this when these change. */
+		void setTransformationDirty()
+		{
+			TransformationDirty = true;
+		}
+
+
+		//! Checks if the absolute transformation has to be recalculated
+		/** \return True if the node or its parent moved since the
+		last call of updateAbsolutePosition(). */
+		bool isTransformationDirty() const
+		{
+			return TransformationDirty;
+		}
+
+
 		//! Returns the triangle selector attached to this scene node.
 		/** The Selector can be used by the engine for doing collision
 		detection. You can create a TriangleSelector with
@@ -648,16 +742,32 @@ namespace scene
 
 		//! Updates the absolute position based on the relative and the parents position
 		/** Note: This does not recursively update the parents absolute positions, so if you have a deeper
-			hierarchy you might want to update the parents first.*/
+			hierarchy you might want to update the parents first. The update is always done,
+			even if the node is not marked dirty. When the absolute transformation changes,
+			the children are marked dirty. */
 		virtual void updateAbsolutePosition()
 		{
+			TransformationDirty = false;
+
+			core::matrix4 absolute;
 			if (Parent)
 			{
-				AbsoluteTransformation =
+				absolute =
 					Parent->getAbsoluteTransformation() * getRelativeTransformation();
 			}
 			else
-				AbsoluteTransformation = getRelativeTransformation();
+				absolute = getRelativeTransformation();
+
+			if (absolute != AbsoluteTransformation)
+			{
+				AbsoluteTransformation = absolute;
+				BoundingSphereDirty = true;
+				SpatialIndexMoved = true;
+
+				ISceneNodeList::Iterator it = Children.begin();
+				for (; it != Children.end(); ++it)
+					(*it)->TransformationDirty = true;
+			}
 		}
 
 
@@ -749,6 +859,21 @@ namespace scene
 
 	protected:
 
+		//! Returns if all animators of this node are thread safe.
+		/** See ISceneNodeAnimator::isThreadSafe(). Nodes which allow
+		to be animated on a worker thread return this in
+		isAnimationThreadSafe(). */
+		bool areAnimatorsThreadSafe() const
+		{
+			ISceneNodeAnimatorList::ConstIterator ait = Animators.begin();
+			for (; ait != Animators.end(); ++ait)
+			{
+				if (!(*ait)->isThreadSafe())
+					return false;
+			}
+			return true;
+		}
+
 		//! A clone function for the ISceneNode members.
 		/** This method can be used by clone() implementations of
 		derived classes
@@ -758,6 +883,8 @@ namespace scene
 		{
 			Name = toCopyFrom->Name;
 			AbsoluteTransformation = toCopyFrom->AbsoluteTransformation;
+			TransformationDirty = true;
+			BoundingSphereDirty = true;
 			RelativeTranslation = toCopyFrom->RelativeTranslation;
 			RelativeRotation = toCopyFrom->RelativeRotation;
 			RelativeScale = toCopyFrom->RelativeScale;
@@ -848,6 +975,56 @@ namespace scene
 
 		//! Is debug object?
 		bool IsDebugObject;
+
+		//! Has the absolute transformation to be recalculated?
+		bool TransformationDirty;
+
+	private:
+
+		//! Cached result of getTransformedBoundingSphere()
+		mutable core::aabbox3d<f32> BoundingSphereBox;
+		mutable core::vector3df BoundingSphereCenter;
+		mutable f32 BoundingSphereRadius;
+		mutable bool BoundingSphereDirty;
+
+		//! Slot of this node in the spatial index of the scene manager, not cloned
+		u32 SpatialIndexHandle;
+
+		//! Set when the absolute transformation changed since the last update of the spatial index
+		bool SpatialIndexMoved;
+
+		//! Parts of the node index of the scene manager which are outdated
+		enum E_NODE_INDEX_CHANGE
+		{
+			//! ids changed, only their keys are updated
+			ENIC_IDS = 1,
+			//! names changed, only their keys are updated
+			ENIC_NAMES = 2,
+			//! nodes were added or removed, the index is rebuilt
+			ENIC_STRUCTURE = 4
+		};
+
+		//! Marks the node index of the scene manager at the top of the graph as outdated
+		/** The scene manager is the root of its graph, so the flag is found
+		without a pointer to the manager. */
+		void invalidateNodeIndex(u32 change=ENIC_STRUCTURE)
+		{
+			ISceneNode* top = this;
+			while (top->Parent)
+				top = top->Parent;
+			top->NodeIndexDirty |= change;
+		}
+
+		//! Preorder position of this node and the end of its subtree in the
+		//! node index of the scene manager, not cloned
+		u32 NodeIndexBegin;
+		u32 NodeIndexEnd;
+
+		//! Only used by the root scene node, E_NODE_INDEX_CHANGE flags set
+		//! when a node below was added, removed, renamed or got a new id
+		u32 NodeIndexDirty;
+
+		friend class CSceneManager;
 	};
 
 
@@ -68,6 +68,26 @@ namespace scene
 		{
 			return false;
 		}
+
+		//! Returns if animateNode() may be called from a worker thread.
+		/** When the scene manager animates with more than one thread
+		(see ISceneManager::setAnimationThreadCount()), subtrees of the
+		scene graph are animated in parallel, but only if all their
+		animators return true here. An animator which returns true
+		promises that animateNode() only reads and modifies the node it
+		was called with and the animator itself. It must not add, remove
+		or delete scene nodes or animators, access other scene nodes
+		(including the camera), the video driver, the GUI or the mesh
+		cache, and must not call into user callbacks. Note that an
+		animator attached to several nodes can be called from several
+		threads at once.
+		\return True if the animator keeps the contract above. The
+		default is false, so custom animators are always called from
+		the thread calling ISceneManager::drawAll(). */
+		virtual bool isThreadSafe() const
+		{
+			return false;
+		}
 	};
 
 
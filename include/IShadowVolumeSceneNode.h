@@ -28,7 +28,24 @@ namespace scene
 		virtual void setShadowMesh(const IMesh* mesh) = 0;
 
 		//! Updates the shadow volumes for current light positions.
+		/** A shadow volume is only built again when the light moved
+		relative to the node or the mesh changed. Changes of the mesh are
+		noticed by IMeshBuffer::getChangedID_Vertex() and
+		getChangedID_Index(), so call IMeshBuffer::setDirty() after
+		changing the vertices of the shadow mesh. */
 		virtual void updateShadowVolumes() = 0;
+
+		//! Sets the memory the node may use to keep shadow volumes
+		/** Shadow volumes of lights which are not used anymore are kept
+		until this size is exceeded, so they do not need to be built again
+		when the light comes back. Volumes of lights used in the last
+		update are always kept.
+		\param bytes Size of all shadow volumes of this node in bytes,
+		1 MB by default. */
+		virtual void setCacheSize(u32 bytes) = 0;
+
+		//! Gets the memory the node may use to keep shadow volumes
+		virtual u32 getCacheSize() const = 0;
 	};
 
 } // end namespace scene
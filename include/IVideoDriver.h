@@ -494,7 +494,9 @@ namespace video
 
 		//! Update all occlusion queries. Retrieves results from GPU.
 		/** If the query shall not block, set the flag to false.
-		Update might not occur in this case, though */
+		Update might not occur in this case, though. endScene() updates
+		all queries without blocking, so results arrive a frame or more
+		after the queries were run. */
 		virtual void updateAllOcclusionQueries(bool block=true) =0;
 
 		//! Return query result.
@@ -503,6 +505,12 @@ namespace video
 		actual value of pixels. */
 		virtual u32 getOcclusionQueryResult(scene::ISceneNode* node) const =0;
 
+		//! Check if an occlusion query still waits for its result.
+		/** \return True if the query was run on the GPU, but its result
+		was not retrieved by an update yet. getOcclusionQueryResult()
+		returns the result of the previous run meanwhile. */
+		virtual bool isOcclusionQueryPending(scene::ISceneNode* node) const =0;
+
 		//! Sets a boolean alpha channel on the texture based on a color key.
 		/** This makes the texture fully transparent at the texels where
 		this color key can be found when using for example draw2DImage
@@ -1018,6 +1026,23 @@ namespace video
 		/** \param mb Buffer to draw */
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) =0;
 
+		//! Draws a mesh buffer several times with different transformations
+		/** If the active material uses a GLSL shader with an attribute
+		named inInstanceWorld (mat4) and the OpenGL driver supports
+		ARB_draw_instanced and ARB_instanced_arrays, all instances are
+		drawn with one call. The world transformation is then set to
+		identity and the shader has to apply inInstanceWorld itself. It
+		also receives the color of the instance in the optional vec4
+		attribute inInstanceColor. All other drivers and materials draw
+		the buffer once per instance.
+		\param mb Buffer to draw.
+		\param transforms World transformation of each instance.
+		\param colors If not 0, the color of each instance, which
+		replaces the vertex colors of the buffer.
+		\param instanceCount Amount of instances. */
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+				const core::matrix4* transforms, const SColor* colors, u32 instanceCount) =0;
+
 		//! Draws normals of a mesh buffer
 		/** \param mb Buffer to draw the normals of
 		\param length length scale factor of the normals
@@ -1082,6 +1107,13 @@ namespace video
 		\return Amount of primitives drawn in the last frame. */
 		virtual u32 getPrimitiveCountDrawn( u32 mode =0 ) const =0;
 
+		//! Returns how often the material was changed in the last frame.
+		/** Only calls of setMaterial() with a material different from
+		the active one are counted, so this shows how well the
+		rendered geometry is sorted by material.
+		\return Amount of material changes in the last frame. */
+		virtual u32 getMaterialChangeCount() const =0;
+
 		//! Deletes all dynamic lights which were previously added with addDynamicLight().
 		virtual void deleteAllDynamicLights() =0;
 
@@ -113,6 +113,39 @@
 #endif
 
 
+//! Define _IRR_COMPILE_WITH_THREADS_ if the engine may spread work over several threads.
+/** This is used for example by ISceneManager::setAnimationThreadCount. Without
+it all such work is done on the calling thread. On Linux you have to link your
+application against pthread. */
+#if (defined(_IRR_WINDOWS_API_) && !defined(_WIN32_WCE) && !defined(_IRR_XBOX_PLATFORM_)) || defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_)
+#define _IRR_COMPILE_WITH_THREADS_
+#endif
+#ifdef NO_IRR_COMPILE_WITH_THREADS_
+#undef _IRR_COMPILE_WITH_THREADS_
+#endif
+
+
+//! Define _IRR_COMPILE_WITH_SSE2_ to use SSE2 instructions in a few speed critical places.
+/** This is enabled automatically when the compiler targets a cpu with SSE2,
+for example with gcc -msse2 and on all x86_64 compilers. All code using it has a
+plain C++ version as well, which is used otherwise. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define _IRR_COMPILE_WITH_SSE2_
+#endif
+#ifdef NO_IRR_COMPILE_WITH_SSE2_
+#undef _IRR_COMPILE_WITH_SSE2_
+#endif
+
+
+//! Define _IRR_COMPILE_WITH_PROFILING_ to measure the time spent in parts of the engine.
+/** The results can be read from the IProfiler returned by irr::getProfiler(). Each
+measured scope costs two calls of the profiler, which are cheap but not free. */
+#define _IRR_COMPILE_WITH_PROFILING_
+#ifdef NO_IRR_COMPILE_WITH_PROFILING_
+#undef _IRR_COMPILE_WITH_PROFILING_
+#endif
+
+
 //! Maximum number of texture an SMaterial can have, up to 8 are supported by Irrlicht.
 #define _IRR_MATERIAL_MAX_TEXTURES_ 4
 
@@ -794,6 +827,8 @@ precision will be lower but speed higher. currently X86 only
 	#define _IRR_COMPILE_WITH_BURNINGSVIDEO_
 	#define BURNINGVIDEO_RENDERER_BEAUTIFUL
 
+	#undef _IRR_COMPILE_WITH_THREADS_
+
 #endif
 
 
@@ -21,6 +21,7 @@ namespace irr
 	class ILogger;
 	class IEventReceiver;
 	class IRandomizer;
+	class IProfiler;
 
 	namespace io {
 		class IFileSystem;
@@ -132,6 +133,13 @@ namespace irr
 		\return Pointer to the ITimer object. */
 		virtual ITimer* getTimer() = 0;
 
+		//! Provides access to the engine's profiler.
+		/** It measures the time spent in parts of the engine and
+		can display the results with IGUIEnvironment::addProfilerDisplay().
+		It is the same object as returned by irr::getProfiler().
+		\return Pointer to the IProfiler object. */
+		virtual IProfiler* getProfiler() = 0;
+
 		//! Provides access to the engine's currently set randomizer.
 		/** \return Pointer to the IRandomizer object. */
 		virtual IRandomizer* getRandomizer() const =0;
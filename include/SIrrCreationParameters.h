@@ -46,6 +46,7 @@ namespace irr
 			DisplayAdapter(0),
 			DriverMultithreaded(false),
 			UsePerformanceTimer(true),
+			RasterizerThreads(1),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION)
 		{
 		}
@@ -78,6 +79,7 @@ namespace irr
 			DriverMultithreaded = other.DriverMultithreaded;
 			DisplayAdapter = other.DisplayAdapter;
 			UsePerformanceTimer = other.UsePerformanceTimer;
+			RasterizerThreads = other.RasterizerThreads;
 			return *this;
 		}
 
@@ -290,6 +292,20 @@ namespace irr
 		*/
 		bool UsePerformanceTimer;
 
+		//! Number of threads Burning's Video rasterizes triangles with.
+		/** With more than one thread, triangles are transformed and
+		clipped by the thread calling drawVertexPrimitiveList() and
+		binned to interleaved bands of scanlines, each band is
+		rasterized by one thread. The result is the same as with one
+		thread. Binned triangles are drawn before 2d drawing, render
+		target changes, screenshots and at endScene(). Locking a
+		texture for writing with ITexture::lock() and
+		ITexture::regenerateMipMapLevels() also draw them first, so
+		the triangles still see the old texels. Read only locks don't
+		wait for the threads. 0 uses one thread per processor.
+		Only supported by Burning's Video. Default: 1 */
+		u32 RasterizerThreads;
+
 		//! Don't use or change this parameter.
 		/** Always set it to IRRLICHT_SDK_VERSION, which is done by default.
 		This is needed for sdk version checks. */
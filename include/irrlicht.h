@@ -87,6 +87,7 @@
 #include "IGUIInOutFader.h"
 #include "IGUIListBox.h"
 #include "IGUIMeshViewer.h"
+#include "IGUIProfiler.h"
 #include "IGUIScrollBar.h"
 #include "IGUISkin.h"
 #include "IGUISpinBox.h"
@@ -111,11 +112,14 @@
 #include "IMeshLoader.h"
 #include "IMeshManipulator.h"
 #include "IMeshSceneNode.h"
+#include "IInstancedMeshSceneNode.h"
+#include "ILODMeshSceneNode.h"
 #include "IMeshWriter.h"
 #include "IColladaMeshWriter.h"
 #include "IMetaTriangleSelector.h"
 #include "IOSOperator.h"
 #include "IParticleSystemSceneNode.h" // also includes all emitters and attractors
+#include "IProfiler.h"
 #include "IQ3LevelMesh.h"
 #include "IQ3Shader.h"
 #include "IReadFile.h"
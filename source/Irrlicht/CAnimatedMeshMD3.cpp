@@ -199,6 +199,7 @@ IMesh* CAnimatedMeshMD3::getMesh(s32 frame, s32 detailLevel, s32 startFrameLoop,
 					Mesh->Buffer[i],
 					(SMeshBufferLightMap*) MeshIPol->getMeshBuffer(i));
 	}
+	MeshIPol->setDirty(EBT_VERTEX);
 	MeshIPol->recalculateBoundingBox();
 
 	// build current tags
@@ -254,6 +254,10 @@ void CAnimatedMeshSceneNode::OnAnimate(u32 timeMs)
 
 		if (mesh)
 			Box = mesh->getBoundingBox();
+
+		// the tag transformation of md3 models changes with the frame
+		if (Mesh->getMeshType() == EAMT_MD3)
+			TransformationDirty = true;
 	}
 	LastTimeMs = timeMs;
 
@@ -39,6 +39,9 @@ namespace scene
 		//! OnAnimate() is called just before rendering the whole scene.
 		virtual void OnAnimate(u32 timeMs);
 
+		//! Animating updates the mesh, which is shared with other nodes
+		virtual bool isAnimationThreadSafe() const { return false; }
+
 		//! renders the node.
 		virtual void render();
 
@@ -41,6 +41,9 @@ namespace scene
 
 		virtual void OnAnimate(u32 timeMs);
 
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
 		virtual void updateAbsolutePositionOfAllChildren();
 
 		//! Writes attributes of the scene node.
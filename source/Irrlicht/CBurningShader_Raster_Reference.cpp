@@ -978,7 +978,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			}
 
 			// render a scanline
-			scanline ();
+			if ( ownsScanLine ( line.y ) )
+				scanline ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -1093,7 +1094,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			}
 
 			// render a scanline
-			scanline ();
+			if ( ownsScanLine ( line.y ) )
+				scanline ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -110,6 +110,9 @@ namespace scene
 		//! PreRender event
 		virtual void OnRegisterSceneNode();
 
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
 		//! Render
 		virtual void render();
 
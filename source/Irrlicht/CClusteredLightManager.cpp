@@ -0,0 +1,370 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CClusteredLightManager.h"
+#include "ICameraSceneNode.h"
+#include "IVideoDriver.h"
+#include "SLight.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+CClusteredLightManager::CClusteredLightManager(ISceneManager* sceneManager,
+		u32 maxLightsPerNode, const core::vector3di& clusterCount)
+: SceneManager(sceneManager), ClusterCount(clusterCount),
+	MaxLightsPerNode(maxLightsPerNode), MaxLights(0), Near(1.f), Far(1.f),
+	SliceScale(0.f), Orthogonal(false), Stamp(0), LastNode(0),
+	RenderPass(ESNRP_NONE), Active(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CClusteredLightManager");
+	#endif
+
+	ClusterCount.X = core::max_(ClusterCount.X, 1);
+	ClusterCount.Y = core::max_(ClusterCount.Y, 1);
+	ClusterCount.Z = core::max_(ClusterCount.Z, 1);
+}
+
+
+//! Called after the scene nodes were registered
+void CClusteredLightManager::OnPreRender(core::array<ISceneNode*>& lightList)
+{
+	Active = false;
+	LastNode = 0;
+}
+
+
+//! Called after the last scene node was rendered
+void CClusteredLightManager::OnPostRender()
+{
+	restoreLights();
+	Active = false;
+}
+
+
+//! Called before a render pass
+void CClusteredLightManager::OnRenderPassPreRender(E_SCENE_NODE_RENDER_PASS renderPass)
+{
+	RenderPass = renderPass;
+}
+
+
+//! Called after a render pass, bins the lights after the light pass
+void CClusteredLightManager::OnRenderPassPostRender(E_SCENE_NODE_RENDER_PASS renderPass)
+{
+	if (renderPass != ESNRP_LIGHT)
+		return;
+
+	buildClusters();
+	if (!Active)
+		return;
+
+	// the nodes turn on what they need
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	for (u32 i=0; i<LightOn.size(); ++i)
+	{
+		driver->turnLightOn((s32)i, false);
+		LightOn[i] = false;
+	}
+	OnLights.set_used(0);
+}
+
+
+//! Turns on the lights of the node
+void CClusteredLightManager::OnNodePreRender(ISceneNode* node)
+{
+	if (!Active || node == LastNode)
+		return;
+
+	if (RenderPass != ESNRP_SOLID && RenderPass != ESNRP_TRANSPARENT &&
+		RenderPass != ESNRP_TRANSPARENT_EFFECT)
+		return;
+
+	// the render queue calls this once per mesh buffer
+	LastNode = node;
+
+	Candidates.set_used(0);
+	++Stamp;
+
+	u32 i;
+	for (i=0; i<DirectionalLights.size(); ++i)
+	{
+		SCandidate c;
+		c.Score = -1.f;
+		c.Light = DirectionalLights[i];
+		Candidates.push_back(c);
+	}
+
+	const core::aabbox3df box = node->getTransformedBoundingBox();
+	core::aabbox3df viewBox(box);
+	View.transformBoxEx(viewBox);
+
+	SClusterRange r;
+	if (getClusterRange(viewBox, r))
+	{
+		for (u32 z=r.Z0; z<=r.Z1; ++z)
+		for (u32 y=r.Y0; y<=r.Y1; ++y)
+		for (u32 x=r.X0; x<=r.X1; ++x)
+		{
+			const u32 cluster = (z*ClusterCount.Y + y)*ClusterCount.X + x;
+			for (i=ClusterStart[cluster]; i<ClusterStart[cluster+1]; ++i)
+			{
+				const u32 l = ClusterLights[i];
+				if (LightStamp[l] == Stamp)
+					continue;
+				LightStamp[l] = Stamp;
+
+				// distance from the light to the nearest point of the box
+				const core::vector3df& p = LightPositions[l];
+				const core::vector3df d(
+					p.X - core::clamp(p.X, box.MinEdge.X, box.MaxEdge.X),
+					p.Y - core::clamp(p.Y, box.MinEdge.Y, box.MaxEdge.Y),
+					p.Z - core::clamp(p.Z, box.MinEdge.Z, box.MaxEdge.Z));
+				const f32 radiusSQ = LightRadii[l] * LightRadii[l];
+				const f32 distanceSQ = d.getLengthSQ();
+				if (distanceSQ > radiusSQ)
+					continue;
+
+				SCandidate c;
+				c.Score = distanceSQ / radiusSQ;
+				c.Light = l;
+				Candidates.push_back(c);
+			}
+		}
+	}
+
+	if (Candidates.size() > MaxLights)
+	{
+		Candidates.sort();
+		Candidates.set_used(MaxLights);
+	}
+
+	applyLights();
+}
+
+
+//! Called after a node was rendered
+void CClusteredLightManager::OnNodePostRender(ISceneNode* node)
+{
+}
+
+
+//! bins the lights of the driver into the clusters
+void CClusteredLightManager::buildClusters()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	const u32 lightCount = driver ? driver->getDynamicLightCount() : 0;
+
+	Active = camera && lightCount;
+	if (!Active)
+		return;
+
+	MaxLights = core::min_(MaxLightsPerNode, driver->getMaximalDynamicLightAmount());
+
+	View = camera->getViewMatrix();
+	Projection = camera->getProjectionMatrix();
+	Near = camera->getNearValue();
+	Far = core::max_(camera->getFarValue(), Near + core::ROUNDING_ERROR_f32);
+	Orthogonal = camera->isOrthogonal();
+	if (Orthogonal)
+		SliceScale = ClusterCount.Z / (Far - Near);
+	else
+	{
+		Near = core::max_(Near, core::ROUNDING_ERROR_f32);
+		SliceScale = ClusterCount.Z / logf(Far / Near);
+	}
+
+	LightPositions.set_used(lightCount);
+	LightRadii.set_used(lightCount);
+	LightRanges.set_used(lightCount);
+	LightOn.set_used(lightCount);
+	LightStamp.set_used(lightCount);
+	DirectionalLights.set_used(0);
+	Stamp = 0;
+
+	const u32 clusters = ClusterCount.X * ClusterCount.Y * ClusterCount.Z;
+	ClusterStart.set_used(clusters + 1);
+	u32 c;
+	for (c=0; c<=clusters; ++c)
+		ClusterStart[c] = 0;
+
+	// count the lights per cluster
+	u32 i;
+	u32 total = 0;
+	for (i=0; i<lightCount; ++i)
+	{
+		const video::SLight& light = driver->getDynamicLight(i);
+		LightPositions[i] = light.Position;
+		LightRadii[i] = light.Radius;
+		LightOn[i] = true;
+		LightStamp[i] = 0;
+
+		SClusterRange& r = LightRanges[i];
+		r.X0 = 1;
+		r.X1 = 0;
+
+		// lights without a radius reach everything
+		if (light.Type == video::ELT_DIRECTIONAL || light.Radius <= 0.f)
+		{
+			DirectionalLights.push_back(i);
+			continue;
+		}
+
+		core::vector3df center(light.Position);
+		View.transformVect(center);
+		const core::vector3df extent(light.Radius);
+		if (!getClusterRange(core::aabbox3df(center - extent, center + extent), r))
+		{
+			r.X0 = 1;
+			r.X1 = 0;
+			continue;
+		}
+
+		for (u32 z=r.Z0; z<=r.Z1; ++z)
+		for (u32 y=r.Y0; y<=r.Y1; ++y)
+		for (u32 x=r.X0; x<=r.X1; ++x)
+			++ClusterStart[(z*ClusterCount.Y + y)*ClusterCount.X + x];
+		total += (r.X1-r.X0+1) * (r.Y1-r.Y0+1) * (r.Z1-r.Z0+1);
+	}
+
+	// end of each cluster, moved to its start while filling
+	for (c=1; c<clusters; ++c)
+		ClusterStart[c] += ClusterStart[c-1];
+	ClusterStart[clusters] = total;
+
+	ClusterLights.set_used(total);
+	for (i=0; i<lightCount; ++i)
+	{
+		const SClusterRange& r = LightRanges[i];
+		if (r.X0 > r.X1)
+			continue;
+
+		for (u32 z=r.Z0; z<=r.Z1; ++z)
+		for (u32 y=r.Y0; y<=r.Y1; ++y)
+		for (u32 x=r.X0; x<=r.X1; ++x)
+			ClusterLights[--ClusterStart[(z*ClusterCount.Y + y)*ClusterCount.X + x]] = i;
+	}
+}
+
+
+//! finds the clusters touched by a box in view space
+bool CClusteredLightManager::getClusterRange(const core::aabbox3df& viewBox, SClusterRange& range) const
+{
+	const f32 z0 = core::max_(viewBox.MinEdge.Z, Near);
+	const f32 z1 = core::min_(viewBox.MaxEdge.Z, Far);
+	if (z0 > z1)
+		return false;
+
+	// the projection of x/y is monotonic in x, y and z, so the corners
+	// of the box give the extent on the screen
+	const f32* m = Projection.pointer();
+	f32 minX = FLT_MAX, maxX = -FLT_MAX, minY = FLT_MAX, maxY = -FLT_MAX;
+	for (u32 i=0; i<2; ++i)
+	{
+		const f32 z = i ? z1 : z0;
+		const f32 w = z*m[11] + m[15];
+		if (w <= 0.f)
+			return false;
+		const f32 invW = 1.f / w;
+
+		for (u32 j=0; j<2; ++j)
+		{
+			const f32 x = j ? viewBox.MaxEdge.X : viewBox.MinEdge.X;
+			const f32 y = j ? viewBox.MaxEdge.Y : viewBox.MinEdge.Y;
+			const f32 sx = (x*m[0] + z*m[8] + m[12]) * invW;
+			const f32 sy = (y*m[5] + z*m[9] + m[13]) * invW;
+			minX = core::min_(minX, sx);
+			maxX = core::max_(maxX, sx);
+			minY = core::min_(minY, sy);
+			maxY = core::max_(maxY, sy);
+		}
+	}
+
+	if (minX > 1.f || maxX < -1.f || minY > 1.f || maxY < -1.f)
+		return false;
+
+	const s32 lastX = ClusterCount.X - 1;
+	const s32 lastY = ClusterCount.Y - 1;
+	range.X0 = core::clamp(core::floor32((minX + 1.f) * 0.5f * ClusterCount.X), 0, lastX);
+	range.X1 = core::clamp(core::floor32((maxX + 1.f) * 0.5f * ClusterCount.X), 0, lastX);
+	range.Y0 = core::clamp(core::floor32((minY + 1.f) * 0.5f * ClusterCount.Y), 0, lastY);
+	range.Y1 = core::clamp(core::floor32((maxY + 1.f) * 0.5f * ClusterCount.Y), 0, lastY);
+	range.Z0 = getSlice(z0);
+	range.Z1 = getSlice(z1);
+	return true;
+}
+
+
+//! converts a view depth into a slice
+u32 CClusteredLightManager::getSlice(f32 z) const
+{
+	const f32 s = Orthogonal ? (z - Near) * SliceScale : logf(z / Near) * SliceScale;
+	return (u32)core::clamp(core::floor32(s), 0, ClusterCount.Z - 1);
+}
+
+
+//! turns on exactly the lights in Candidates
+void CClusteredLightManager::applyLights()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	++Stamp;
+	u32 i;
+	for (i=0; i<Candidates.size(); ++i)
+		LightStamp[Candidates[i].Light] = Stamp;
+
+	// turn off first, drivers with few hardware lights need them free
+	u32 kept = 0;
+	for (i=0; i<OnLights.size(); ++i)
+	{
+		const u32 l = OnLights[i];
+		if (LightStamp[l] == Stamp)
+			OnLights[kept++] = l;
+		else
+		{
+			driver->turnLightOn((s32)l, false);
+			LightOn[l] = false;
+		}
+	}
+	OnLights.set_used(kept);
+
+	for (i=0; i<Candidates.size(); ++i)
+	{
+		const u32 l = Candidates[i].Light;
+		if (!LightOn[l])
+		{
+			driver->turnLightOn((s32)l, true);
+			LightOn[l] = true;
+			OnLights.push_back(l);
+		}
+	}
+}
+
+
+//! turns all lights on again
+void CClusteredLightManager::restoreLights()
+{
+	if (!Active)
+		return;
+
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	for (u32 i=0; i<LightOn.size(); ++i)
+	{
+		if (!LightOn[i])
+		{
+			driver->turnLightOn((s32)i, true);
+			LightOn[i] = true;
+		}
+	}
+	OnLights.set_used(0);
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
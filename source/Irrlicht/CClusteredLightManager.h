@@ -0,0 +1,129 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+#define __C_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+
+#include "ISceneManager.h"
+#include "ILightManager.h"
+#include "matrix4.h"
+#include "aabbox3d.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Light manager which turns on only the lights near each rendered node
+	/** After the light pass the view frustum of the active camera is
+	divided into a grid of clusters, screen tiles times depth slices which
+	get exponentially thicker with the distance. Each point and spot light
+	is added to the clusters touched by the box around its radius. Before a
+	node is rendered, the lights of the clusters touched by its bounding
+	box are tested against the box and the nearest ones, relative to their
+	radius, are turned on. Directional lights are always preferred. So the
+	work per frame grows with the lights times the clusters they touch and
+	per node with the lights close to it, not with all lights. */
+	class CClusteredLightManager : public ILightManager
+	{
+	public:
+
+		//! constructor
+		CClusteredLightManager(ISceneManager* sceneManager, u32 maxLightsPerNode,
+			const core::vector3di& clusterCount);
+
+		//! Called after the scene nodes were registered
+		virtual void OnPreRender(core::array<ISceneNode*>& lightList);
+
+		//! Called after the last scene node was rendered
+		virtual void OnPostRender(void);
+
+		//! Called before a render pass
+		virtual void OnRenderPassPreRender(E_SCENE_NODE_RENDER_PASS renderPass);
+
+		//! Called after a render pass, bins the lights after the light pass
+		virtual void OnRenderPassPostRender(E_SCENE_NODE_RENDER_PASS renderPass);
+
+		//! Turns on the lights of the node
+		virtual void OnNodePreRender(ISceneNode* node);
+
+		//! Called after a node was rendered
+		virtual void OnNodePostRender(ISceneNode* node);
+
+	private:
+
+		//! clusters touched by a box
+		struct SClusterRange
+		{
+			u32 X0, X1, Y0, Y1, Z0, Z1;
+		};
+
+		//! light which may be turned on for a node
+		struct SCandidate
+		{
+			//! squared distance to the node relative to the radius,
+			//! negative for directional lights
+			f32 Score;
+			u32 Light;
+
+			bool operator<(const SCandidate& other) const
+			{
+				return Score < other.Score || (Score == other.Score && Light < other.Light);
+			}
+		};
+
+		//! bins the lights of the driver into the clusters
+		void buildClusters();
+
+		//! finds the clusters touched by a box in view space
+		bool getClusterRange(const core::aabbox3df& viewBox, SClusterRange& range) const;
+
+		//! converts a view depth into a slice
+		u32 getSlice(f32 z) const;
+
+		//! turns on exactly the lights in Candidates
+		void applyLights();
+
+		//! turns all lights on again
+		void restoreLights();
+
+		ISceneManager* SceneManager;
+		core::vector3di ClusterCount;
+		u32 MaxLightsPerNode;
+		u32 MaxLights;
+
+		core::matrix4 View;
+		core::matrix4 Projection;
+		f32 Near;
+		f32 Far;
+		f32 SliceScale;
+		bool Orthogonal;
+
+		//! index of the first light of each cluster in ClusterLights,
+		//! one more entry than clusters
+		core::array<u32> ClusterStart;
+		core::array<u32> ClusterLights;
+		core::array<SClusterRange> LightRanges;
+		core::array<u32> DirectionalLights;
+
+		//! per light of the driver
+		core::array<core::vector3df> LightPositions;
+		core::array<f32> LightRadii;
+		core::array<bool> LightOn;
+		core::array<u32> LightStamp;
+		core::array<SCandidate> Candidates;
+		core::array<u32> OnLights;
+		u32 Stamp;
+
+		ISceneNode* LastNode;
+		E_SCENE_NODE_RENDER_PASS RenderPass;
+		bool Active;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // __C_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+
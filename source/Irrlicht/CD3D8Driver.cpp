@@ -17,6 +17,8 @@
 #include "CD3D8NormalMapRenderer.h"
 #include "CD3D8ParallaxMapRenderer.h"
 #include "SIrrCreationParameters.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 namespace irr
 {
@@ -416,6 +418,8 @@ bool CD3D8Driver::initDriver(HWND hwnd, bool pureSoftware)
 bool CD3D8Driver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 		const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_BEGIN_SCENE);)
+
 	CNullDriver::beginScene(backBuffer, zBuffer, color, videoData, sourceRect);
 	WindowId = (HWND)videoData.D3D8.HWnd;
 	SceneSourceRect = sourceRect;
@@ -475,6 +479,8 @@ bool CD3D8Driver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 //! applications must call this method after performing any rendering. returns false if failed.
 bool CD3D8Driver::endScene()
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_END_SCENE);)
+
 	CNullDriver::endScene();
 	DriverWasReset=false;
 
@@ -1358,6 +1364,8 @@ bool CD3D8Driver::setRenderStates3DMode()
 
 	if (ResetRenderStates || LastMaterial != Material)
 	{
+		++MaterialChanges;
+
 		// unset old material
 
 		if (CurrentRenderMode == ERM_3D &&
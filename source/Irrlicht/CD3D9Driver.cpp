@@ -17,6 +17,8 @@
 #include "CD3D9HLSLMaterialRenderer.h"
 #include "CD3D9CgMaterialRenderer.h"
 #include "SIrrCreationParameters.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 namespace irr
 {
@@ -512,6 +514,8 @@ bool CD3D9Driver::initDriver(HWND hwnd, bool pureSoftware)
 bool CD3D9Driver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 		const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_BEGIN_SCENE);)
+
 	CNullDriver::beginScene(backBuffer, zBuffer, color, videoData, sourceRect);
 	WindowId = (HWND)videoData.D3D9.HWnd;
 	SceneSourceRect = sourceRect;
@@ -569,6 +573,8 @@ bool CD3D9Driver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 //! applications must call this method after performing any rendering. returns false if failed.
 bool CD3D9Driver::endScene()
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_END_SCENE);)
+
 	CNullDriver::endScene();
 	DriverWasReset=false;
 
@@ -1309,7 +1315,7 @@ void CD3D9Driver::addOcclusionQuery(scene::ISceneNode* node,
 	if (!queryFeature(EVDF_OCCLUSION_QUERY))
 		return;
 	CNullDriver::addOcclusionQuery(node, mesh);
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if ((index != -1) && (OcclusionQueries[index].PID == 0))
 		pID3DDevice->CreateQuery(D3DQUERYTYPE_OCCLUSION, reinterpret_cast<IDirect3DQuery9**>(&OcclusionQueries[index].PID));
 }
@@ -1318,7 +1324,7 @@ void CD3D9Driver::addOcclusionQuery(scene::ISceneNode* node,
 //! Remove occlusion query.
 void CD3D9Driver::removeOcclusionQuery(scene::ISceneNode* node)
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 	{
 		if (OcclusionQueries[index].PID != 0)
@@ -1336,14 +1342,17 @@ void CD3D9Driver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
 	if (!node)
 		return;
 
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 	{
 		if (OcclusionQueries[index].PID)
 			reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->Issue(D3DISSUE_BEGIN);
 		CNullDriver::runOcclusionQuery(node,visible);
 		if (OcclusionQueries[index].PID)
+		{
 			reinterpret_cast<IDirect3DQuery9*>(OcclusionQueries[index].PID)->Issue(D3DISSUE_END);
+			OcclusionQueries[index].Pending = true;
+		}
 	}
 }
 
@@ -1353,11 +1362,11 @@ void CD3D9Driver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
 Update might not occur in this case, though */
 void CD3D9Driver::updateOcclusionQuery(scene::ISceneNode* node, bool block)
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 	{
-		// not yet started
-		if (OcclusionQueries[index].Run==u32(~0))
+		// not yet started or result already retrieved
+		if (OcclusionQueries[index].Run==u32(~0) || !OcclusionQueries[index].Pending)
 			return;
 		bool available = block?true:false;
 		int tmp=0;
@@ -1374,7 +1383,10 @@ void CD3D9Driver::updateOcclusionQuery(scene::ISceneNode* node, bool block)
 			} while (!available);
 		}
 		if (available)
+		{
 			OcclusionQueries[index].Result = tmp;
+			OcclusionQueries[index].Pending = false;
+		}
 	}
 }
 
@@ -1385,7 +1397,7 @@ The value is a safe approximation, i.e. can be larger than the
 actual value of pixels. */
 u32 CD3D9Driver::getOcclusionQueryResult(scene::ISceneNode* node) const
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 		return OcclusionQueries[index].Result;
 	else
@@ -2065,6 +2077,8 @@ bool CD3D9Driver::setRenderStates3DMode()
 
 	if (ResetRenderStates || LastMaterial != Material)
 	{
+		++MaterialChanges;
+
 		// unset old material
 
 		if (CurrentRenderMode == ERM_3D &&
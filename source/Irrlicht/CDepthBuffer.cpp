@@ -17,6 +17,9 @@ namespace video
 //! constructor
 CDepthBuffer::CDepthBuffer(const core::dimension2d<u32>& size)
 : Buffer(0), Size(0,0)
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+	, TileCountX(0), TileCountY(0)
+#endif
 {
 	#ifdef _DEBUG
 	setDebugName("CDepthBuffer");
@@ -50,6 +53,11 @@ void CDepthBuffer::clear()
 	zMaxValue = IR(zMax);
 
 	memset32 ( Buffer, zMaxValue, TotalSize );
+
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+	if ( TileMin.size() )
+		memset32 ( TileMin.pointer(), zMaxValue, TileMin.size() * sizeof ( f32 ) );
+#endif
 }
 
 
@@ -68,6 +76,14 @@ void CDepthBuffer::setSize(const core::dimension2d<u32>& size)
 	Pitch = size.Width * sizeof ( fp24 );
 	TotalSize = Pitch * size.Height;
 	Buffer = new u8[TotalSize];
+
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+	const u32 tileSize = 1 << SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2;
+	TileCountX = ( size.Width + tileSize - 1 ) >> SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2;
+	TileCountY = ( size.Height + tileSize - 1 ) >> SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2;
+	TileMin.set_used ( TileCountX * TileCountY );
+#endif
+
 	clear ();
 }
 
@@ -79,6 +95,95 @@ const core::dimension2d<u32>& CDepthBuffer::getSize() const
 	return Size;
 }
 
+
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+
+//! clips the area to the buffer and converts it to tiles, false if it is outside
+bool CDepthBuffer::getTiles ( AbsRectangle& tiles, const AbsRectangle& area ) const
+{
+	const s32 x0 = core::s32_max ( area.x0, 0 );
+	const s32 y0 = core::s32_max ( area.y0, 0 );
+	const s32 x1 = core::s32_min ( area.x1, (s32) Size.Width - 1 );
+	const s32 y1 = core::s32_min ( area.y1, (s32) Size.Height - 1 );
+
+	if ( x0 > x1 || y0 > y1 )
+		return false;
+
+	tiles.x0 = x0 >> SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2;
+	tiles.y0 = y0 >> SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2;
+	tiles.x1 = x1 >> SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2;
+	tiles.y1 = y1 >> SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2;
+	return true;
+}
+
+
+//! farthest w in the pixels of a tile
+f32 CDepthBuffer::getTileMin ( s32 x, s32 y ) const
+{
+	const u32 x0 = x << SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2;
+	const u32 y0 = y << SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2;
+	const u32 x1 = core::min_ ( x0 + ( 1 << SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2 ), Size.Width );
+	const u32 y1 = core::min_ ( y0 + ( 1 << SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2 ), Size.Height );
+
+	f32 w = FLT_MAX;
+	for ( u32 py = y0; py != y1; ++py )
+	{
+		const fp24 *z = (fp24*) ( Buffer + py * Pitch );
+		for ( u32 px = x0; px != x1; ++px )
+			w = core::min_ ( w, z[px] );
+	}
+	return w;
+}
+
+
+//! returns true if no pixel of the area passes the depth test for any w <= wMax
+bool CDepthBuffer::isOccluded ( const AbsRectangle& area, f32 wMax, u32 band, u32 bandCount )
+{
+	AbsRectangle tiles;
+	if ( !getTiles ( tiles, area ) )
+		return true;
+
+	for ( s32 y = tiles.y0; y <= tiles.y1; ++y )
+	{
+		if ( !ownsTileRow ( y, band, bandCount ) )
+			continue;
+
+		f32 *tile = TileMin.pointer() + y * TileCountX;
+		for ( s32 x = tiles.x0; x <= tiles.x1; ++x )
+		{
+			if ( tile[x] < 0.f )
+				tile[x] = getTileMin ( x, y );
+
+			// also visible if wMax is not a number
+			if ( !( wMax < tile[x] ) )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+//! tells that pixels of the area in the raster band may have been written
+void CDepthBuffer::invalidate ( const AbsRectangle& area, u32 band, u32 bandCount )
+{
+	AbsRectangle tiles;
+	if ( !getTiles ( tiles, area ) )
+		return;
+
+	for ( s32 y = tiles.y0; y <= tiles.y1; ++y )
+	{
+		if ( !ownsTileRow ( y, band, bandCount ) )
+			continue;
+
+		f32 *tile = TileMin.pointer() + y * TileCountX;
+		for ( s32 x = tiles.x0; x <= tiles.x1; ++x )
+			tile[x] = -1.f;
+	}
+}
+
+#endif // SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+
 // -----------------------------------------------------------------
 
 //! constructor
@@ -40,13 +40,43 @@ namespace video
 		//! returns pitch of depthbuffer (in bytes)
 		virtual u32 getPitch() const { return Pitch; }
 
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+		//! returns true if no pixel of the area passes the depth test for any w <= wMax
+		virtual bool isOccluded ( const AbsRectangle& area, f32 wMax, u32 band, u32 bandCount );
+
+		//! tells that pixels of the area in the raster band may have been written
+		virtual void invalidate ( const AbsRectangle& area, u32 band, u32 bandCount );
+#endif
+
 
 	private:
 
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+		//! clips the area to the buffer and converts it to tiles, false if it is outside
+		bool getTiles ( AbsRectangle& tiles, const AbsRectangle& area ) const;
+
+		//! true if the tile row belongs to the raster band
+		bool ownsTileRow ( s32 row, u32 band, u32 bandCount ) const
+		{
+			return bandCount == 1 ||
+				( (u32) row >> ( SOFTWARE_DRIVER_2_RASTER_BAND_HEIGHT_LOG2 - SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2 ) ) % bandCount == band;
+		}
+
+		//! farthest w in the pixels of a tile
+		f32 getTileMin ( s32 x, s32 y ) const;
+#endif
+
 		u8* Buffer;
 		core::dimension2d<u32> Size;
 		u32 TotalSize;
 		u32 Pitch;
+
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+		// farthest w of each tile, negative if its pixels changed since
+		core::array<f32> TileMin;
+		u32 TileCountX;
+		u32 TileCountY;
+#endif
 	};
 
 
@@ -30,6 +30,9 @@ namespace scene
 		//! Returns the relative transformation of the scene node.
 		virtual core::matrix4 getRelativeTransformation() const;
 
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
 		//! does nothing.
 		virtual void render() {}
 
@@ -25,6 +25,9 @@ namespace scene
 		//! This method is called just before the rendering process of the whole scene.
 		virtual void OnRegisterSceneNode();
 
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
 		//! does nothing.
 		virtual void render();
 
@@ -0,0 +1,235 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CFrustumCuller.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+//! Sets the frustum to test against
+void CFrustumCuller::setFrustum(const SViewFrustum& frustum)
+{
+	for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+	{
+		const core::plane3df& plane = frustum.planes[i];
+		NX[i] = plane.Normal.X;
+		NY[i] = plane.Normal.Y;
+		NZ[i] = plane.Normal.Z;
+		D[i] = plane.D;
+		AbsNX[i] = core::abs_(plane.Normal.X);
+		AbsNY[i] = core::abs_(plane.Normal.Y);
+		AbsNZ[i] = core::abs_(plane.Normal.Z);
+	}
+}
+
+
+//! Classifies a world space axis aligned box
+CFrustumCuller::E_CULL_RESULT CFrustumCuller::classifyBox(const core::aabbox3df& box, u32& planeMask, u8& hint) const
+{
+	const core::vector3df center = box.getCenter();
+	const core::vector3df extent = box.MaxEdge - center;
+
+	if (hint >= SViewFrustum::VF_PLANE_COUNT)
+		hint = 0;
+
+	u32 intersects = 0;
+	for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+	{
+		// start with the plane which rejected the box the last time
+		u32 p = hint + i;
+		if (p >= SViewFrustum::VF_PLANE_COUNT)
+			p -= SViewFrustum::VF_PLANE_COUNT;
+
+		if (!(planeMask & (1 << p)))
+			continue;
+
+		// signed distance of the center and distance of the p-vertex to the center
+		const f32 dist = NX[p]*center.X + NY[p]*center.Y + NZ[p]*center.Z + D[p];
+		const f32 radius = AbsNX[p]*extent.X + AbsNY[p]*extent.Y + AbsNZ[p]*extent.Z;
+
+		if (dist - radius > 0.f)
+		{
+			hint = (u8)p;
+			return ECR_OUTSIDE;
+		}
+		if (dist + radius > 0.f)
+			intersects |= 1 << p;
+	}
+
+	planeMask = intersects;
+	return intersects ? ECR_INTERSECTS : ECR_INSIDE;
+}
+
+
+//! Classifies many world space axis aligned boxes
+void CFrustumCuller::classifyBoxes(const core::aabbox3df* boxes, u32 count, u32 planeMask,
+		u8* results, u8* hints) const
+{
+	u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i+4 <= count; i+=4)
+	{
+		// four boxes as center and half extent, one box per lane
+		const core::aabbox3df* b = boxes + i;
+		const __m128 minX = _mm_setr_ps(b[0].MinEdge.X, b[1].MinEdge.X, b[2].MinEdge.X, b[3].MinEdge.X);
+		const __m128 minY = _mm_setr_ps(b[0].MinEdge.Y, b[1].MinEdge.Y, b[2].MinEdge.Y, b[3].MinEdge.Y);
+		const __m128 minZ = _mm_setr_ps(b[0].MinEdge.Z, b[1].MinEdge.Z, b[2].MinEdge.Z, b[3].MinEdge.Z);
+		const __m128 maxX = _mm_setr_ps(b[0].MaxEdge.X, b[1].MaxEdge.X, b[2].MaxEdge.X, b[3].MaxEdge.X);
+		const __m128 maxY = _mm_setr_ps(b[0].MaxEdge.Y, b[1].MaxEdge.Y, b[2].MaxEdge.Y, b[3].MaxEdge.Y);
+		const __m128 maxZ = _mm_setr_ps(b[0].MaxEdge.Z, b[1].MaxEdge.Z, b[2].MaxEdge.Z, b[3].MaxEdge.Z);
+
+		const __m128 cx = _mm_mul_ps(_mm_add_ps(maxX, minX), half);
+		const __m128 cy = _mm_mul_ps(_mm_add_ps(maxY, minY), half);
+		const __m128 cz = _mm_mul_ps(_mm_add_ps(maxZ, minZ), half);
+		const __m128 ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+		const __m128 ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+		const __m128 ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+		__m128 outside = zero;
+		__m128 intersects = zero;
+
+		for (u32 p=0; p<SViewFrustum::VF_PLANE_COUNT; ++p)
+		{
+			if (!(planeMask & (1 << p)))
+				continue;
+
+			const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(_mm_set1_ps(NX[p]), cx),
+					_mm_mul_ps(_mm_set1_ps(NY[p]), cy)),
+					_mm_mul_ps(_mm_set1_ps(NZ[p]), cz)),
+					_mm_set1_ps(D[p]));
+			const __m128 radius = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(_mm_set1_ps(AbsNX[p]), ex),
+					_mm_mul_ps(_mm_set1_ps(AbsNY[p]), ey)),
+					_mm_mul_ps(_mm_set1_ps(AbsNZ[p]), ez));
+
+			const __m128 rejected = _mm_andnot_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(dist, radius), zero));
+			if (hints)
+			{
+				const int rejectedMask = _mm_movemask_ps(rejected);
+				for (u32 l=0; l<4; ++l)
+				{
+					if (rejectedMask & (1 << l))
+						hints[i+l] = (u8)p;
+				}
+			}
+
+			outside = _mm_or_ps(outside, rejected);
+			intersects = _mm_or_ps(intersects, _mm_cmpgt_ps(_mm_add_ps(dist, radius), zero));
+
+			// all four are out
+			if (_mm_movemask_ps(outside) == 0xf)
+				break;
+		}
+
+		const int outsideMask = _mm_movemask_ps(outside);
+		const int intersectsMask = _mm_movemask_ps(intersects);
+		for (u32 l=0; l<4; ++l)
+		{
+			if (outsideMask & (1 << l))
+				results[i+l] = ECR_OUTSIDE;
+			else if (intersectsMask & (1 << l))
+				results[i+l] = ECR_INTERSECTS;
+			else
+				results[i+l] = ECR_INSIDE;
+		}
+	}
+#endif
+
+	classifyBoxesScalar(boxes+i, count-i, planeMask, results+i, hints ? hints+i : 0);
+}
+
+
+void CFrustumCuller::classifyBoxesScalar(const core::aabbox3df* boxes, u32 count, u32 planeMask,
+		u8* results, u8* hints) const
+{
+	for (u32 i=0; i<count; ++i)
+	{
+		u32 mask = planeMask;
+		u8 hint = hints ? hints[i] : 0;
+		results[i] = (u8)classifyBox(boxes[i], mask, hint);
+		if (hints)
+			hints[i] = hint;
+	}
+}
+
+
+//! Checks if an oriented box is completely outside of the frustum
+bool CFrustumCuller::isBoxCulled(const core::aabbox3df& box, const core::matrix4& transform, u8& hint) const
+{
+	const core::vector3df localCenter = box.getCenter();
+	const core::vector3df extent = box.MaxEdge - localCenter;
+
+	core::vector3df center;
+	transform.transformVect(center, localCenter);
+
+	// the box axes in world space, scaled by the half extent
+	const f32* m = transform.pointer();
+	const core::vector3df axisX(m[0]*extent.X, m[1]*extent.X, m[2]*extent.X);
+	const core::vector3df axisY(m[4]*extent.Y, m[5]*extent.Y, m[6]*extent.Y);
+	const core::vector3df axisZ(m[8]*extent.Z, m[9]*extent.Z, m[10]*extent.Z);
+
+	if (hint >= SViewFrustum::VF_PLANE_COUNT)
+		hint = 0;
+
+	for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+	{
+		u32 p = hint + i;
+		if (p >= SViewFrustum::VF_PLANE_COUNT)
+			p -= SViewFrustum::VF_PLANE_COUNT;
+
+		const f32 dist = NX[p]*center.X + NY[p]*center.Y + NZ[p]*center.Z + D[p];
+		const f32 radius =
+			core::abs_(NX[p]*axisX.X + NY[p]*axisX.Y + NZ[p]*axisX.Z) +
+			core::abs_(NX[p]*axisY.X + NY[p]*axisY.Y + NZ[p]*axisY.Z) +
+			core::abs_(NX[p]*axisZ.X + NY[p]*axisZ.Y + NZ[p]*axisZ.Z);
+
+		// same tolerance as plane3d::classifyPointRelation
+		if (dist - radius > core::ROUNDING_ERROR_f32)
+		{
+			hint = (u8)p;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//! Checks if a sphere is completely outside of the frustum
+bool CFrustumCuller::isSphereCulled(const core::vector3df& center, f32 radius, u8& hint) const
+{
+	if (hint >= SViewFrustum::VF_PLANE_COUNT)
+		hint = 0;
+
+	for (u32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+	{
+		u32 p = hint + i;
+		if (p >= SViewFrustum::VF_PLANE_COUNT)
+			p -= SViewFrustum::VF_PLANE_COUNT;
+
+		if (NX[p]*center.X + NY[p]*center.Y + NZ[p]*center.Z + D[p] > radius)
+		{
+			hint = (u8)p;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,106 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FRUSTUM_CULLER_H_INCLUDED__
+#define __C_FRUSTUM_CULLER_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "SViewFrustum.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Tests boxes against the planes of a view frustum.
+	/** Boxes are tested in world space with their center and half
+	extent against each plane, which is the same as testing the corner
+	closest to the plane (p-vertex) and the one furthest away (n-vertex).
+	Tests can be limited to a mask of planes, for example the planes a
+	parent box intersects, and start with a hint, which is the plane
+	which rejected the box the last time. With _IRR_COMPILE_WITH_SSE2_
+	classifyBoxes() tests four boxes at once. */
+	class CFrustumCuller
+	{
+	public:
+
+		//! Relation of a box to the frustum
+		enum E_CULL_RESULT
+		{
+			ECR_OUTSIDE = 0,
+			ECR_INTERSECTS,
+			ECR_INSIDE
+		};
+
+		//! Mask with all frustum planes set
+		static const u32 ALL_PLANES = (1 << SViewFrustum::VF_PLANE_COUNT) - 1;
+
+		//! constructor
+		CFrustumCuller() {}
+
+		//! constructor
+		CFrustumCuller(const SViewFrustum& frustum) { setFrustum(frustum); }
+
+		//! Sets the frustum to test against
+		void setFrustum(const SViewFrustum& frustum);
+
+		//! Classifies a world space axis aligned box
+		/** \param box The box.
+		\param planeMask Planes to test. On return the planes the box
+		intersects, which is 0 for boxes inside of the frustum.
+		\param hint Plane to test first. Set to the rejecting plane
+		when the box is outside.
+		\return Relation of the box to the frustum. */
+		E_CULL_RESULT classifyBox(const core::aabbox3df& box, u32& planeMask, u8& hint) const;
+
+		//! Classifies many world space axis aligned boxes
+		/** \param boxes Array of boxes.
+		\param count Amount of boxes.
+		\param planeMask Planes to test.
+		\param results Receives an E_CULL_RESULT for each box.
+		\param hints If not 0, receives the rejecting plane for each
+		box outside of the frustum. Entries of other boxes are kept. */
+		void classifyBoxes(const core::aabbox3df* boxes, u32 count, u32 planeMask,
+				u8* results, u8* hints=0) const;
+
+		//! Checks if an oriented box is completely outside of the frustum
+		/** This is exact for the box in local space transformed by the
+		matrix, but needs neither an inverse matrix nor a transformed
+		frustum.
+		\param box Box in local space.
+		\param transform Transformation from local to world space.
+		\param hint Plane to test first. Set to the rejecting plane
+		when the box is outside.
+		\return True if the box can't be seen. */
+		bool isBoxCulled(const core::aabbox3df& box, const core::matrix4& transform, u8& hint) const;
+
+		//! Checks if a sphere is completely outside of the frustum
+		/** \param center Center of the sphere in world space.
+		\param radius Radius of the sphere.
+		\param hint Plane to test first. Set to the rejecting plane
+		when the sphere is outside.
+		\return True if the sphere can't be seen. */
+		bool isSphereCulled(const core::vector3df& center, f32 radius, u8& hint) const;
+
+	private:
+
+		void classifyBoxesScalar(const core::aabbox3df* boxes, u32 count, u32 planeMask,
+				u8* results, u8* hints) const;
+
+		//! plane normals and distances as structure of arrays
+		f32 NX[SViewFrustum::VF_PLANE_COUNT];
+		f32 NY[SViewFrustum::VF_PLANE_COUNT];
+		f32 NZ[SViewFrustum::VF_PLANE_COUNT];
+		f32 D[SViewFrustum::VF_PLANE_COUNT];
+		//! absolute values of the normals for the box extents
+		f32 AbsNX[SViewFrustum::VF_PLANE_COUNT];
+		f32 AbsNY[SViewFrustum::VF_PLANE_COUNT];
+		f32 AbsNZ[SViewFrustum::VF_PLANE_COUNT];
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
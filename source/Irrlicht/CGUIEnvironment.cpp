@@ -27,6 +27,7 @@
 #include "CGUIEditBox.h"
 #include "CGUISpinBox.h"
 #include "CGUIInOutFader.h"
+#include "CGUIProfiler.h"
 #include "CGUIMessageBox.h"
 #include "CGUIModalScreen.h"
 #include "CGUITabControl.h"
@@ -42,6 +43,8 @@
 
 #include "BuiltInFont.h"
 #include "os.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 namespace irr
 {
@@ -191,6 +194,8 @@ void CGUIEnvironment::loadBuiltInFont()
 //! draws all gui elements
 void CGUIEnvironment::drawAll()
 {
+	IRR_PROFILE(CProfileScope p1(EPID_GUI_DRAW_ALL);)
+
 	if (Driver)
 	{
 		core::dimension2d<s32> dim(Driver->getScreenSize());
@@ -1368,6 +1373,15 @@ IGUIInOutFader* CGUIEnvironment::addInOutFader(const core::rect<s32>* rectangle,
 }
 
 
+//! Adds an element displaying the statistics of the engine's profiler.
+IGUIProfiler* CGUIEnvironment::addProfilerDisplay(const core::rect<s32>& rectangle, IGUIElement* parent, s32 id)
+{
+	IGUIProfiler* p = new CGUIProfiler(this, parent ? parent : this, id, rectangle);
+	p->drop();
+	return p;
+}
+
+
 //! Adds a combo box to the environment.
 IGUIComboBox* CGUIEnvironment::addComboBox(const core::rect<s32>& rectangle,
 	IGUIElement* parent, s32 id)
@@ -198,6 +198,9 @@ public:
 	//! Adds an element for fading in or out.
 	virtual IGUIInOutFader* addInOutFader(const core::rect<s32>* rectangle=0, IGUIElement* parent=0, s32 id=-1);
 
+	//! Adds an element displaying the statistics of the engine's profiler.
+	virtual IGUIProfiler* addProfilerDisplay(const core::rect<s32>& rectangle, IGUIElement* parent=0, s32 id=-1);
+
 	//! Returns the root gui element.
 	virtual IGUIElement* getRootGUIElement();
 
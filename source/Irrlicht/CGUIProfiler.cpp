@@ -0,0 +1,221 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CGUIProfiler.h"
+#ifdef _IRR_COMPILE_WITH_GUI_
+
+#include "IGUIEnvironment.h"
+#include "IGUISkin.h"
+#include "IGUIFont.h"
+#include "IVideoDriver.h"
+#include "IProfiler.h"
+#include "os.h"
+
+namespace irr
+{
+namespace gui
+{
+
+namespace
+{
+	//! scope, average, minimum, maximum and last time
+	const u32 COLUMNS = 5;
+}
+
+
+//! constructor
+CGUIProfiler::CGUIProfiler(IGUIEnvironment* environment, IGUIElement* parent, s32 id, core::rect<s32> rectangle)
+: IGUIProfiler(environment, parent, id, rectangle), UpdateInterval(1000),
+	LastUpdateTime(0), Frozen(false), DrawBackground(true)
+{
+	#ifdef _DEBUG
+	setDebugName("CGUIProfiler");
+	#endif
+
+	setNotClipped(false);
+}
+
+
+//! draws the element and its children
+void CGUIProfiler::draw()
+{
+	if (!IsVisible)
+		return;
+
+	const u32 now = os::Timer::getRealTime();
+	if (!Frozen && (Cells.empty() || now - LastUpdateTime >= UpdateInterval))
+	{
+		updateRows();
+		LastUpdateTime = now;
+	}
+
+	IGUISkin* skin = Environment->getSkin();
+	IGUIFont* font = skin ? skin->getFont() : 0;
+	if (!font)
+		return;
+
+	if (DrawBackground)
+		skin->draw2DRectangle(this, skin->getColor(EGDC_TOOLTIP_BACKGROUND), AbsoluteRect, &AbsoluteClippingRect);
+
+	// the first column is aligned left, the numbers right
+	u32 widths[COLUMNS] = { 0 };
+	u32 i;
+	for (i=0; i<Cells.size(); ++i)
+		widths[i % COLUMNS] = core::max_(widths[i % COLUMNS], font->getDimension(Cells[i].c_str()).Width);
+
+	const s32 spacing = 8;
+	const s32 lineHeight = (s32)font->getDimension(L"A").Height;
+	const video::SColor color = skin->getColor(EGDC_TOOLTIP);
+
+	s32 y = AbsoluteRect.UpperLeftCorner.Y + 2;
+	for (i=0; i<Cells.size(); i+=COLUMNS)
+	{
+		if (y > AbsoluteClippingRect.LowerRightCorner.Y)
+			break;
+
+		s32 x = AbsoluteRect.UpperLeftCorner.X + 4;
+		for (u32 c=0; c<COLUMNS; ++c)
+		{
+			const core::stringw& text = Cells[i+c];
+			s32 left = x;
+			if (c)
+				left += (s32)(widths[c] - font->getDimension(text.c_str()).Width);
+
+			font->draw(text, core::rect<s32>(left, y, left + (s32)widths[c], y + lineHeight),
+				color, false, false, &AbsoluteClippingRect);
+			x += (s32)widths[c] + spacing;
+		}
+		y += lineHeight;
+	}
+
+	IGUIElement::draw();
+}
+
+
+//! copies the values of the profiler into the displayed rows
+void CGUIProfiler::updateRows()
+{
+	const IProfiler& profiler = getProfiler();
+
+	Cells.set_used(0);
+	Cells.push_back(L"scope (microseconds)");
+	Cells.push_back(L"avg");
+	Cells.push_back(L"min");
+	Cells.push_back(L"max");
+	Cells.push_back(L"last");
+
+	// scopes without parent, each followed by its children
+	for (u32 i=0; i<profiler.getProfileDataCount(); ++i)
+	{
+		const SProfileData& data = profiler.getProfileDataByIndex(i);
+		if (data.ParentId == data.Id || !profiler.getProfileData(data.ParentId))
+			addRows(profiler, i);
+	}
+}
+
+
+//! adds the row of a scope and the rows of its children
+void CGUIProfiler::addRows(const IProfiler& profiler, u32 index)
+{
+	const SProfileData& data = profiler.getProfileDataByIndex(index);
+	if (data.FrameCount)
+	{
+		// children are indented, the group is shown where it changes
+		core::stringw name;
+		for (u32 d=0; d<data.Depth; ++d)
+			name += L"  ";
+
+		const SProfileData* parent = data.ParentId != data.Id ? profiler.getProfileData(data.ParentId) : 0;
+		if (!parent || parent->GroupName != data.GroupName)
+		{
+			name += data.GroupName;
+			name += L": ";
+		}
+		name += data.Name;
+
+		Cells.push_back(name);
+		Cells.push_back(core::stringw(data.getAverageFrameTime()));
+		Cells.push_back(core::stringw(data.MinFrameTime));
+		Cells.push_back(core::stringw(data.MaxFrameTime));
+		Cells.push_back(core::stringw(data.LastFrameTime));
+	}
+
+	for (u32 i=0; i<profiler.getProfileDataCount(); ++i)
+	{
+		const SProfileData& child = profiler.getProfileDataByIndex(i);
+		if (child.ParentId == data.Id && child.Id != data.Id)
+			addRows(profiler, i);
+	}
+}
+
+
+//! Sets how often the displayed values are updated
+void CGUIProfiler::setUpdateInterval(u32 ms)
+{
+	UpdateInterval = ms;
+}
+
+
+//! Gets the time between two updates in milliseconds
+u32 CGUIProfiler::getUpdateInterval() const
+{
+	return UpdateInterval;
+}
+
+
+//! Stops or continues updating the displayed values
+void CGUIProfiler::setFrozen(bool freeze)
+{
+	Frozen = freeze;
+}
+
+
+//! Checks if the displayed values are frozen
+bool CGUIProfiler::isFrozen() const
+{
+	return Frozen;
+}
+
+
+//! Sets whether to draw a background behind the values
+void CGUIProfiler::setDrawBackground(bool draw)
+{
+	DrawBackground = draw;
+}
+
+
+//! Checks if a background is drawn
+bool CGUIProfiler::isDrawBackgroundEnabled() const
+{
+	return DrawBackground;
+}
+
+
+//! Writes attributes of the element.
+void CGUIProfiler::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const
+{
+	IGUIProfiler::serializeAttributes(out,options);
+
+	out->addInt		("UpdateInterval",	UpdateInterval);
+	out->addBool	("Frozen",			Frozen);
+	out->addBool	("DrawBackground",	DrawBackground);
+}
+
+
+//! Reads attributes of the element
+void CGUIProfiler::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options=0)
+{
+	IGUIProfiler::deserializeAttributes(in,options);
+
+	UpdateInterval = in->getAttributeAsInt("UpdateInterval");
+	Frozen = in->getAttributeAsBool("Frozen");
+	DrawBackground = in->getAttributeAsBool("DrawBackground");
+}
+
+
+} // end namespace gui
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_GUI_
+
@@ -0,0 +1,79 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_GUI_PROFILER_H_INCLUDED__
+#define __C_GUI_PROFILER_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#ifdef _IRR_COMPILE_WITH_GUI_
+
+#include "IGUIProfiler.h"
+#include "irrArray.h"
+
+namespace irr
+{
+	class IProfiler;
+
+namespace gui
+{
+
+	class CGUIProfiler : public IGUIProfiler
+	{
+	public:
+
+		//! constructor
+		CGUIProfiler(IGUIEnvironment* environment, IGUIElement* parent,
+			s32 id, core::rect<s32> rectangle);
+
+		//! draws the element and its children
+		virtual void draw();
+
+		//! Sets how often the displayed values are updated
+		virtual void setUpdateInterval(u32 ms);
+
+		//! Gets the time between two updates in milliseconds
+		virtual u32 getUpdateInterval() const;
+
+		//! Stops or continues updating the displayed values
+		virtual void setFrozen(bool freeze);
+
+		//! Checks if the displayed values are frozen
+		virtual bool isFrozen() const;
+
+		//! Sets whether to draw a background behind the values
+		virtual void setDrawBackground(bool draw);
+
+		//! Checks if a background is drawn
+		virtual bool isDrawBackgroundEnabled() const;
+
+		//! Writes attributes of the element.
+		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const;
+
+		//! Reads attributes of the element
+		virtual void deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options);
+
+	private:
+
+		//! copies the values of the profiler into the displayed rows
+		void updateRows();
+
+		//! adds the row of a scope and the rows of its children
+		void addRows(const IProfiler& profiler, u32 index);
+
+		//! one text per column and row, the first row is the header
+		core::array<core::stringw> Cells;
+
+		u32 UpdateInterval;
+		u32 LastUpdateTime;
+		bool Frozen;
+		bool DrawBackground;
+	};
+
+} // end namespace gui
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_GUI_
+
+#endif // __C_GUI_PROFILER_H_INCLUDED__
+
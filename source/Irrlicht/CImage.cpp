@@ -6,6 +6,10 @@
 #include "irrString.h"
 #include "CColorConverter.h"
 #include "CBlit.h"
+#include <math.h>
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
 
 namespace irr
 {
@@ -386,6 +390,283 @@ void CImage::copyToScalingBoxFilter(IImage* target, s32 bias, bool blend)
 }
 
 
+// linear intensity of the 256 sRGB values, scaled to 16 bit
+static u16 SRGBToLinear[256];
+
+//! builds the gamma table on first use
+static void initGammaTable()
+{
+	static bool done = false;
+	if (done)
+		return;
+	for (u32 i = 0; i != 256; ++i)
+	{
+		const f64 c = i / 255.0;
+		const f64 l = c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+		SRGBToLinear[i] = (u16) core::round32((f32) (l * 65535.0));
+	}
+	done = true;
+}
+
+//! sRGB value whose linear intensity is nearest to l
+static inline u32 linearToSRGB(u32 l)
+{
+	u32 low = 0;
+	u32 high = 255;
+	while (low < high)
+	{
+		const u32 mid = (low + high + 1) >> 1;
+		if ((u32) SRGBToLinear[mid - 1] + SRGBToLinear[mid] <= 2 * l)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+	return low;
+}
+
+//! average of 4 A8R8G8B8 colors
+static inline u32 averageA8R8G8B8(u32 a, u32 b, u32 c, u32 d, bool gammaCorrect)
+{
+	u32 r = (((a >> 24) + (b >> 24) + (c >> 24) + (d >> 24) + 2) >> 2) << 24;
+	for (u32 shift = 0; shift != 24; shift += 8)
+	{
+		const u32 a0 = (a >> shift) & 0xFF;
+		const u32 b0 = (b >> shift) & 0xFF;
+		const u32 c0 = (c >> shift) & 0xFF;
+		const u32 d0 = (d >> shift) & 0xFF;
+		if (gammaCorrect)
+			r |= linearToSRGB((SRGBToLinear[a0] + SRGBToLinear[b0] + SRGBToLinear[c0] + SRGBToLinear[d0] + 2) >> 2) << shift;
+		else
+			r |= ((a0 + b0 + c0 + d0 + 2) >> 2) << shift;
+	}
+	return r;
+}
+
+//! average of 4 16 bit colors, rounding each field given by the masks
+static inline u16 average16(u32 a, u32 b, u32 c, u32 d, const u32* masks, u32 count)
+{
+	u32 r = 0;
+	for (u32 i = 0; i != count; ++i)
+	{
+		const u32 m = masks[i];
+		const u32 lsb = m & ~(m - 1);
+		r |= (((a & m) + (b & m) + (c & m) + (d & m) + 2 * lsb) >> 2) & m;
+	}
+	return (u16) r;
+}
+
+//! converts a half float to float
+static inline f32 halfToFloat(u16 h)
+{
+	const u32 sign = (u32) (h & 0x8000) << 16;
+	const u32 exponent = (h >> 10) & 0x1F;
+	u32 mantissa = h & 0x3FF;
+	u32 bits;
+
+	if (exponent == 0x1F) // inf, nan
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	else if (exponent)
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	else if (mantissa) // denormal
+	{
+		u32 e = 113;
+		while (!(mantissa & 0x400))
+		{
+			mantissa <<= 1;
+			--e;
+		}
+		bits = sign | (e << 23) | ((mantissa & 0x3FF) << 13);
+	}
+	else
+		bits = sign;
+
+	return core::FR(bits);
+}
+
+//! converts a float to half float, rounding to nearest
+static inline u16 floatToHalf(f32 f)
+{
+	const u32 bits = core::IR(f);
+	const u32 sign = (bits >> 16) & 0x8000;
+	const s32 exponent = (s32) ((bits >> 23) & 0xFF) - 112;
+	const u32 mantissa = bits & 0x7FFFFF;
+
+	if (exponent >= 0x1F) // inf, nan or too large
+		return (u16) (sign | 0x7C00 | ((exponent == 0xFF - 112 && mantissa) ? 0x200 : 0));
+	if (exponent <= 0) // denormal or zero
+	{
+		if (exponent < -10)
+			return (u16) sign;
+		const u32 m = mantissa | 0x800000;
+		const u32 shift = 14 - exponent;
+		return (u16) (sign | ((m >> shift) + ((m >> (shift - 1)) & 1)));
+	}
+	return (u16) (sign | (((exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1)));
+}
+
+//! writes one row of a mip map level, from the two rows r0 and r1 of the previous level
+static void downsampleRow(const u8* r0, const u8* r1, u8* dst, u32 srcWidth, u32 dstWidth,
+	ECOLOR_FORMAT format, bool gammaCorrect)
+{
+	u32 x = 0;
+
+	switch (format)
+	{
+	case ECF_A8R8G8B8:
+	{
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		// 4 pixels from 8x2 pixels of the previous level
+		if (!gammaCorrect)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i two = _mm_set1_epi16(2);
+			for (; 2 * (x + 4) <= srcWidth; x += 4)
+			{
+				const __m128i a0 = _mm_loadu_si128((const __m128i*) (r0 + x * 8));
+				const __m128i a1 = _mm_loadu_si128((const __m128i*) (r0 + x * 8 + 16));
+				const __m128i b0 = _mm_loadu_si128((const __m128i*) (r1 + x * 8));
+				const __m128i b1 = _mm_loadu_si128((const __m128i*) (r1 + x * 8 + 16));
+
+				// vertical sums, two pixels of 16 bit channels per register
+				const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+				const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+				const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+				const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+				// horizontal sums of the pixel pairs
+				const __m128i p0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+				const __m128i p1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+
+				_mm_storeu_si128((__m128i*) (dst + x * 4), _mm_packus_epi16(
+					_mm_srli_epi16(_mm_add_epi16(p0, two), 2),
+					_mm_srli_epi16(_mm_add_epi16(p1, two), 2)));
+			}
+		}
+#endif
+		const u32* a = (const u32*) r0;
+		const u32* b = (const u32*) r1;
+		u32* d = (u32*) dst;
+		for (; x != dstWidth; ++x)
+		{
+			const u32 x0 = 2 * x;
+			const u32 x1 = core::min_(x0 + 1, srcWidth - 1);
+			d[x] = averageA8R8G8B8(a[x0], a[x1], b[x0], b[x1], gammaCorrect);
+		}
+	} break;
+
+	case ECF_R8G8B8:
+		for (; x != dstWidth; ++x)
+		{
+			const u32 x0 = 2 * x * 3;
+			const u32 x1 = core::min_(2 * x + 1, srcWidth - 1) * 3;
+			const u32 c = averageA8R8G8B8(
+				r0[x0] << 16 | r0[x0 + 1] << 8 | r0[x0 + 2],
+				r0[x1] << 16 | r0[x1 + 1] << 8 | r0[x1 + 2],
+				r1[x0] << 16 | r1[x0 + 1] << 8 | r1[x0 + 2],
+				r1[x1] << 16 | r1[x1 + 1] << 8 | r1[x1 + 2], gammaCorrect);
+			dst[x * 3] = (u8) (c >> 16);
+			dst[x * 3 + 1] = (u8) (c >> 8);
+			dst[x * 3 + 2] = (u8) c;
+		}
+		break;
+
+	case ECF_A1R5G5B5:
+	case ECF_R5G6B5:
+	{
+		static const u32 masksA1R5G5B5[] = { 0x8000, 0x7C00, 0x03E0, 0x001F };
+		static const u32 masksR5G6B5[] = { 0xF800, 0x07E0, 0x001F };
+		const bool alpha = format == ECF_A1R5G5B5;
+		const u16* a = (const u16*) r0;
+		const u16* b = (const u16*) r1;
+		u16* d = (u16*) dst;
+		for (; x != dstWidth; ++x)
+		{
+			const u32 x0 = 2 * x;
+			const u32 x1 = core::min_(x0 + 1, srcWidth - 1);
+			if (!gammaCorrect)
+				d[x] = alpha ? average16(a[x0], a[x1], b[x0], b[x1], masksA1R5G5B5, 4) :
+					average16(a[x0], a[x1], b[x0], b[x1], masksR5G6B5, 3);
+			else if (alpha)
+				d[x] = A8R8G8B8toA1R5G5B5(averageA8R8G8B8(A1R5G5B5toA8R8G8B8(a[x0]), A1R5G5B5toA8R8G8B8(a[x1]),
+					A1R5G5B5toA8R8G8B8(b[x0]), A1R5G5B5toA8R8G8B8(b[x1]), true));
+			else
+				d[x] = A8R8G8B8toR5G6B5(averageA8R8G8B8(R5G6B5toA8R8G8B8(a[x0]), R5G6B5toA8R8G8B8(a[x1]),
+					R5G6B5toA8R8G8B8(b[x0]), R5G6B5toA8R8G8B8(b[x1]), true));
+		}
+	} break;
+
+	case ECF_R16F:
+	case ECF_G16R16F:
+	case ECF_A16B16G16R16F:
+	{
+		const u32 channels = IImage::getBitsPerPixelFromFormat(format) / 16;
+		const u16* a = (const u16*) r0;
+		const u16* b = (const u16*) r1;
+		u16* d = (u16*) dst;
+		for (; x != dstWidth; ++x)
+		{
+			const u32 x0 = 2 * x * channels;
+			const u32 x1 = core::min_(2 * x + 1, srcWidth - 1) * channels;
+			for (u32 c = 0; c != channels; ++c)
+				d[x * channels + c] = floatToHalf(0.25f * (halfToFloat(a[x0 + c]) + halfToFloat(a[x1 + c]) +
+					halfToFloat(b[x0 + c]) + halfToFloat(b[x1 + c])));
+		}
+	} break;
+
+	case ECF_R32F:
+	case ECF_G32R32F:
+	case ECF_A32B32G32R32F:
+	{
+		const u32 channels = IImage::getBitsPerPixelFromFormat(format) / 32;
+		const f32* a = (const f32*) r0;
+		const f32* b = (const f32*) r1;
+		f32* d = (f32*) dst;
+		for (; x != dstWidth; ++x)
+		{
+			const u32 x0 = 2 * x * channels;
+			const u32 x1 = core::min_(2 * x + 1, srcWidth - 1) * channels;
+			for (u32 c = 0; c != channels; ++c)
+				d[x * channels + c] = 0.25f * (a[x0 + c] + a[x1 + c] + b[x0 + c] + b[x1 + c]);
+		}
+	} break;
+
+	default:
+		break;
+	}
+}
+
+
+//! writes the mip map levels of the image into a buffer
+void CImage::copyToMipMaps(void* target, bool gammaCorrect)
+{
+	if (gammaCorrect)
+		initGammaTable();
+
+	// each level is built from the previous one, which is still in the cache
+	const u8* src = Data;
+	u8* dst = (u8*) target;
+	core::dimension2d<u32> size = Size;
+
+	while (size.Width > 1 || size.Height > 1)
+	{
+		const core::dimension2d<u32> next(core::max_(1u, size.Width >> 1), core::max_(1u, size.Height >> 1));
+		const u32 srcPitch = size.Width * BytesPerPixel;
+		const u32 dstPitch = next.Width * BytesPerPixel;
+
+		for (u32 y = 0; y != next.Height; ++y)
+		{
+			const u8* r0 = src + 2 * y * srcPitch;
+			const u8* r1 = src + core::min_(2 * y + 1, size.Height - 1) * srcPitch;
+			downsampleRow(r0, r1, dst + y * dstPitch, size.Width, next.Width, Format, gammaCorrect);
+		}
+
+		src = dst;
+		dst += next.Height * dstPitch;
+		size = next;
+	}
+}
+
+
 //! fills the surface with given color
 void CImage::fill(const SColor &color)
 {
@@ -100,6 +100,9 @@ public:
 	//! copies this surface into another, scaling it to fit, appyling a box filter
 	virtual void copyToScalingBoxFilter(IImage* target, s32 bias = 0, bool blend = false);
 
+	//! writes the mip map levels of the image into a buffer
+	virtual void copyToMipMaps(void* target, bool gammaCorrect = false);
+
 	//! fills the surface with given color
 	virtual void fill(const SColor &color);
 
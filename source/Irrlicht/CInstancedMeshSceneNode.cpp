@@ -0,0 +1,736 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInstancedMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "IMeshCache.h"
+#include "IAnimatedMesh.h"
+#include "IMaterialRenderer.h"
+#include "IFileSystem.h"
+#include "CFrustumCuller.h"
+#include "ITexture.h"
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+
+//! constructor
+CInstancedMeshSceneNode::CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IInstancedMeshSceneNode(parent, mgr, id, position, rotation, scale), Box(0,0,0,0,0,0), Mesh(0),
+	ImpostorTexture(0), ImpostorDistance(0.f), ImpostorViews(8), ImpostorViewSize(128),
+	ImpostorColumns(1), ImpostorRows(1), ImpostorTextureShared(false), ImpostorViewsDirty(false), ColoredInstances(0), BoxDirty(false),
+	WorldBoxesDirty(true), ReadOnlyMaterials(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CInstancedMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CInstancedMeshSceneNode::~CInstancedMeshSceneNode()
+{
+	releaseImpostorTexture();
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! frame
+void CInstancedMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible)
+	{
+		VisibleTransforms.set_used(0);
+		VisibleColors.set_used(0);
+		ImpostorVertices.set_used(0);
+
+		if (Mesh && Transforms.size())
+		{
+			updateBoxes();
+			cullInstances();
+		}
+
+		// the quads are alpha tested and drawn with the solid nodes
+		if (ImpostorVertices.size())
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+		if (VisibleTransforms.size())
+		{
+			// register for the passes of the materials like a mesh scene node
+			video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+			bool solid = false;
+			bool transparent = false;
+
+			for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+			{
+				const IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+				if (!mb)
+					continue;
+
+				const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+				video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+
+				if (rnd && rnd->isTransparent())
+					transparent = true;
+				else
+					solid = true;
+			}
+
+			if (solid)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+			if (transparent)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+		}
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+}
+
+
+//! renders the node.
+void CInstancedMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!Mesh || !driver)
+		return;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	if (!isTransparentPass && ImpostorVertices.size())
+		drawImpostors();
+
+	if (VisibleTransforms.empty())
+		return;
+
+	// colors are only collected if any instance is not white
+	const video::SColor* colors = VisibleColors.empty() ? 0 : VisibleColors.const_pointer();
+
+	for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+		if (!mb)
+			continue;
+
+		const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+
+		video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+		const bool transparent = (rnd && rnd->isTransparent());
+
+		// only render transparent buffer if this is the transparent render pass
+		// and solid only in solid pass
+		if (transparent == isTransparentPass)
+		{
+			driver->setMaterial(material);
+			driver->drawMeshBufferInstanced(mb, VisibleTransforms.const_pointer(),
+				colors, VisibleTransforms.size());
+		}
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible & scene::EDS_BBOX)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		driver->setMaterial(m);
+		driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+		driver->draw3DBox(Box, video::SColor(255,255,255,255));
+	}
+}
+
+
+//! recalculates the bounding boxes after instances or the node moved
+void CInstancedMeshSceneNode::updateBoxes()
+{
+	const core::aabbox3df& meshBox = Mesh->getBoundingBox();
+
+	if (BoxDirty)
+	{
+		// shrink the box after instances were moved or removed
+		for (u32 i=0; i<Transforms.size(); ++i)
+		{
+			core::aabbox3df box(meshBox);
+			Transforms[i].transformBoxEx(box);
+
+			if (i)
+				Box.addInternalBox(box);
+			else
+				Box = box;
+		}
+
+		BoxDirty = false;
+	}
+
+	if (WorldBoxesDirty || BoxesTransform != AbsoluteTransformation)
+	{
+		WorldBoxes.set_used(Transforms.size());
+
+		for (u32 i=0; i<Transforms.size(); ++i)
+		{
+			WorldBoxes[i] = meshBox;
+			(AbsoluteTransformation * Transforms[i]).transformBoxEx(WorldBoxes[i]);
+		}
+
+		BoxesTransform = AbsoluteTransformation;
+		WorldBoxesDirty = false;
+	}
+}
+
+
+//! collects the instances inside of the view frustum
+void CInstancedMeshSceneNode::cullInstances()
+{
+	const u32 count = Transforms.size();
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+
+	if (camera && AutomaticCullingState != EAC_OFF)
+	{
+		CFrustumCuller culler(*camera->getViewFrustum());
+		CullResults.set_used(count);
+		culler.classifyBoxes(WorldBoxes.const_pointer(), count,
+			CFrustumCuller::ALL_PLANES, CullResults.pointer());
+	}
+	else
+	{
+		CullResults.set_used(count);
+		for (u32 i=0; i<count; ++i)
+			CullResults[i] = CFrustumCuller::ECR_INSIDE;
+	}
+
+	const bool impostors = ImpostorTexture && camera;
+	const core::vector3df cameraPosition = camera ? camera->getAbsolutePosition() : core::vector3df();
+	const f32 impostorDistanceSQ = ImpostorDistance * ImpostorDistance;
+
+	for (u32 i=0; i<count; ++i)
+	{
+		if (CullResults[i] == CFrustumCuller::ECR_OUTSIDE)
+			continue;
+
+		if (impostors && WorldBoxes[i].getCenter().getDistanceFromSQ(cameraPosition) > impostorDistanceSQ)
+		{
+			addImpostor(i, cameraPosition);
+			continue;
+		}
+
+		VisibleTransforms.push_back(AbsoluteTransformation * Transforms[i]);
+		if (ColoredInstances)
+			VisibleColors.push_back(Colors[i]);
+	}
+}
+
+//! renders the views of the mesh or finds them in the texture cache
+void CInstancedMeshSceneNode::updateImpostorTexture()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	if (!driver->queryFeature(video::EVDF_RENDER_TO_TARGET))
+	{
+		os::Printer::log("Impostors need render targets, drawing all instances as meshes.", ELL_WARNING);
+		ImpostorDistance = 0.f;
+		return;
+	}
+
+	// the views are placed in a grid on a power of two texture
+	ImpostorColumns = (u32)ceilf(sqrtf((f32)ImpostorViews));
+	ImpostorRows = (ImpostorViews + ImpostorColumns - 1) / ImpostorColumns;
+	core::dimension2du size(1, 1);
+	while (size.Width < ImpostorColumns * ImpostorViewSize)
+		size.Width <<= 1;
+	while (size.Height < ImpostorRows * ImpostorViewSize)
+		size.Height <<= 1;
+
+	// only the read only materials of a mesh in the mesh cache are the
+	// same for all nodes, copied materials may have been changed
+	const io::path& meshName = SceneManager->getMeshCache()->getMeshName(Mesh).getPath();
+	ImpostorTextureShared = ReadOnlyMaterials && meshName.size();
+
+	io::path name(ImpostorTextureShared ? "impostor:" : "impostor-copy:");
+	name += meshName;
+	name += "/";
+	name += ImpostorViews;
+	name += "x";
+	name += ImpostorViewSize;
+
+	video::ITexture* texture = ImpostorTextureShared ? driver->findTexture(name) : 0;
+	if (!texture)
+	{
+		texture = driver->addRenderTargetTexture(size, name, video::ECF_A8R8G8B8);
+		if (!texture)
+		{
+			ImpostorDistance = 0.f;
+			return;
+		}
+
+		// the transformations may have been set by the user
+		const core::matrix4 view = driver->getTransform(video::ETS_VIEW);
+		const core::matrix4 projection = driver->getTransform(video::ETS_PROJECTION);
+		const core::rect<s32> viewPort = driver->getViewPort();
+
+		driver->setRenderTarget(texture, true, true, video::SColor(0,0,0,0));
+
+		// the mesh is seen from outside of its bounding sphere
+		const core::aabbox3df& box = Mesh->getBoundingBox();
+		const core::vector3df center = box.getCenter();
+		const f32 radius = core::max_(box.getExtent().getLength() * 0.5f, core::ROUNDING_ERROR_f32);
+
+		core::matrix4 m;
+		m.buildProjectionMatrixOrthoLH(2.f*radius, 2.f*radius, radius, 3.f*radius);
+		driver->setTransform(video::ETS_PROJECTION, m);
+
+		for (u32 v=0; v<ImpostorViews; ++v)
+		{
+			const f32 angle = v * core::PI * 2.f / ImpostorViews;
+			const core::vector3df eye = center + core::vector3df(sinf(angle), 0.f, -cosf(angle)) * (2.f*radius);
+			m.buildCameraLookAtMatrixLH(eye, center, core::vector3df(0,1,0));
+			driver->setTransform(video::ETS_VIEW, m);
+			driver->setTransform(video::ETS_WORLD, core::IdentityMatrix);
+
+			const s32 x = (v % ImpostorColumns) * ImpostorViewSize;
+			const s32 y = (v / ImpostorColumns) * ImpostorViewSize;
+			driver->setViewPort(core::rect<s32>(x, y, x + ImpostorViewSize, y + ImpostorViewSize));
+
+			for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+			{
+				const IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+				if (!mb)
+					continue;
+
+				// the quads are lit in the scene
+				video::SMaterial material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+				material.Lighting = false;
+				material.FogEnable = false;
+				driver->setMaterial(material);
+				driver->drawMeshBuffer(mb);
+			}
+		}
+
+		// the software drivers share the z buffer with the frame, which
+		// is why this is not done while the scene is drawn
+		driver->setRenderTarget(0, false, true);
+		driver->setViewPort(viewPort);
+		driver->setTransform(video::ETS_PROJECTION, projection);
+		driver->setTransform(video::ETS_VIEW, view);
+	}
+
+	texture->grab();
+	ImpostorTexture = texture;
+
+	ImpostorMaterial = video::SMaterial();
+	ImpostorMaterial.MaterialType = video::EMT_TRANSPARENT_ALPHA_CHANNEL_REF;
+	ImpostorMaterial.setTexture(0, ImpostorTexture);
+	ImpostorMaterial.TextureLayer[0].TextureWrapU = video::ETC_CLAMP_TO_EDGE;
+	ImpostorMaterial.TextureLayer[0].TextureWrapV = video::ETC_CLAMP_TO_EDGE;
+	ImpostorMaterial.BackfaceCulling = false;
+	ImpostorMaterial.Lighting = getMaterialCount() && getMaterial(0).Lighting;
+}
+
+
+//! drops the views, removes them from the driver if no other node uses them
+void CInstancedMeshSceneNode::releaseImpostorTexture()
+{
+	if (!ImpostorTexture)
+		return;
+
+	if (!ImpostorTextureShared)
+		SceneManager->getVideoDriver()->removeTexture(ImpostorTexture);
+
+	ImpostorTexture->drop();
+	ImpostorTexture = 0;
+}
+
+
+//! releases the views and lets the scene manager render them in the next frame
+void CInstancedMeshSceneNode::invalidateImpostorViews()
+{
+	releaseImpostorTexture();
+
+	// drawAll() renders them before anything of the frame is drawn
+	ImpostorViewsDirty = ImpostorDistance > 0.f && Mesh;
+	if (ImpostorViewsDirty)
+		SceneManager->addImpostorUpdate(this);
+}
+
+
+//! Renders the views of the mesh for the impostors
+void CInstancedMeshSceneNode::updateImpostorViews()
+{
+	if (!ImpostorViewsDirty)
+		return;
+
+	ImpostorViewsDirty = false;
+	if (ImpostorDistance > 0.f && Mesh)
+		updateImpostorTexture();
+}
+
+
+//! adds the quad of an instance far away
+void CInstancedMeshSceneNode::addImpostor(u32 index, const core::vector3df& cameraPosition)
+{
+	const core::matrix4 transform = AbsoluteTransformation * Transforms[index];
+	const core::aabbox3df& box = Mesh->getBoundingBox();
+	core::vector3df center = box.getCenter();
+	transform.transformVect(center);
+
+	// direction to the camera around the vertical axis
+	core::vector3df toCamera = cameraPosition - center;
+	toCamera.Y = 0.f;
+	if (toCamera.getLengthSQ() <= core::ROUNDING_ERROR_f32)
+		toCamera.set(0.f, 0.f, -1.f);
+	toCamera.normalize();
+
+	// the view closest to the direction in the space of the mesh,
+	// rotated back with the transposed matrix
+	const f32* m = transform.pointer();
+	const f32 localX = m[0]*toCamera.X + m[1]*toCamera.Y + m[2]*toCamera.Z;
+	const f32 localZ = m[8]*toCamera.X + m[9]*toCamera.Y + m[10]*toCamera.Z;
+	f32 angle = atan2f(localX, -localZ);
+	if (angle < 0.f)
+		angle += core::PI * 2.f;
+	const u32 view = (u32)core::round32(angle * ImpostorViews / (core::PI * 2.f)) % ImpostorViews;
+
+	const core::dimension2du& size = ImpostorTexture->getOriginalSize();
+	const f32 texelU = 0.5f / size.Width;
+	const f32 texelV = 0.5f / size.Height;
+	const f32 u0 = (f32)((view % ImpostorColumns) * ImpostorViewSize) / size.Width + texelU;
+	const f32 v0 = (f32)((view / ImpostorColumns) * ImpostorViewSize) / size.Height + texelV;
+	const f32 u1 = u0 + (f32)ImpostorViewSize / size.Width - 2.f*texelU;
+	const f32 v1 = v0 + (f32)ImpostorViewSize / size.Height - 2.f*texelV;
+
+	const core::vector3df scale = transform.getScale();
+	const f32 radius = box.getExtent().getLength() * 0.5f;
+	const core::vector3df right = toCamera.crossProduct(core::vector3df(0.f, 1.f, 0.f)) * (radius * scale.X);
+	const core::vector3df up(0.f, radius * scale.Y, 0.f);
+	const video::SColor color = ColoredInstances ? Colors[index] : video::SColor(0xffffffff);
+
+	ImpostorVertices.push_back(video::S3DVertex(center - right + up, toCamera, color, core::vector2df(u0, v0)));
+	ImpostorVertices.push_back(video::S3DVertex(center + right + up, toCamera, color, core::vector2df(u1, v0)));
+	ImpostorVertices.push_back(video::S3DVertex(center + right - up, toCamera, color, core::vector2df(u1, v1)));
+	ImpostorVertices.push_back(video::S3DVertex(center - right - up, toCamera, color, core::vector2df(u0, v1)));
+}
+
+
+//! draws the quads of the instances far away
+void CInstancedMeshSceneNode::drawImpostors()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	// 16 bit indices reach 16384 quads, which share the indices
+	const u32 maxQuads = 16384;
+	const u32 quadCount = ImpostorVertices.size() / 4;
+	const u32 indexedQuads = core::min_(quadCount, maxQuads);
+	for (u32 q=ImpostorIndices.size()/6; q<indexedQuads; ++q)
+	{
+		ImpostorIndices.push_back(q*4);
+		ImpostorIndices.push_back(q*4+1);
+		ImpostorIndices.push_back(q*4+2);
+		ImpostorIndices.push_back(q*4);
+		ImpostorIndices.push_back(q*4+2);
+		ImpostorIndices.push_back(q*4+3);
+	}
+
+	driver->setTransform(video::ETS_WORLD, core::IdentityMatrix);
+	driver->setMaterial(ImpostorMaterial);
+
+	for (u32 first=0; first<quadCount; first+=maxQuads)
+	{
+		const u32 count = core::min_(quadCount - first, maxQuads);
+		driver->drawVertexPrimitiveList(&ImpostorVertices[first*4], count*4,
+			ImpostorIndices.const_pointer(), count*2, video::EVT_STANDARD,
+			scene::EPT_TRIANGLES, video::EIT_16BIT);
+	}
+}
+
+
+//! returns the axis aligned bounding box of all instances
+const core::aabbox3d<f32>& CInstancedMeshSceneNode::getBoundingBox() const
+{
+	return Box;
+}
+
+
+//! Adds an instance of the mesh
+u32 CInstancedMeshSceneNode::addInstance(const core::matrix4& transform, video::SColor color)
+{
+	// grow the box right away, so the node isn't culled before the next update
+	core::aabbox3df box(Mesh ? Mesh->getBoundingBox() : core::aabbox3df(0,0,0,0,0,0));
+	transform.transformBoxEx(box);
+
+	if (Transforms.empty())
+		Box = box;
+	else
+		Box.addInternalBox(box);
+
+	Transforms.push_back(transform);
+	Colors.push_back(color);
+	if (color.color != 0xffffffff)
+		++ColoredInstances;
+
+	WorldBoxesDirty = true;
+	return Transforms.size()-1;
+}
+
+
+//! Removes an instance
+void CInstancedMeshSceneNode::removeInstance(u32 index)
+{
+	if (index >= Transforms.size())
+		return;
+
+	if (Colors[index].color != 0xffffffff)
+		--ColoredInstances;
+
+	// move the last instance into the gap
+	const u32 last = Transforms.size()-1;
+	Transforms[index] = Transforms[last];
+	Colors[index] = Colors[last];
+	Transforms.set_used(last);
+	Colors.set_used(last);
+
+	BoxDirty = true;
+	WorldBoxesDirty = true;
+}
+
+
+//! Removes all instances
+void CInstancedMeshSceneNode::removeAllInstances()
+{
+	Transforms.set_used(0);
+	Colors.set_used(0);
+	VisibleTransforms.set_used(0);
+	VisibleColors.set_used(0);
+	ColoredInstances = 0;
+	Box.reset(0,0,0);
+	BoxDirty = false;
+	WorldBoxesDirty = true;
+}
+
+
+//! Reserves memory for instances
+void CInstancedMeshSceneNode::reserveInstances(u32 count)
+{
+	if (count <= Transforms.allocated_size())
+		return;
+
+	Transforms.reallocate(count);
+	Colors.reallocate(count);
+	WorldBoxes.reallocate(count);
+	CullResults.reallocate(count);
+	VisibleTransforms.reallocate(count);
+	VisibleColors.reallocate(count);
+}
+
+
+//! Sets the transformation of an instance relative to the node
+void CInstancedMeshSceneNode::setInstanceTransform(u32 index, const core::matrix4& transform)
+{
+	if (index >= Transforms.size())
+		return;
+
+	Transforms[index] = transform;
+
+	if (Mesh)
+	{
+		core::aabbox3df box(Mesh->getBoundingBox());
+		transform.transformBoxEx(box);
+		Box.addInternalBox(box);
+	}
+
+	BoxDirty = true;
+	WorldBoxesDirty = true;
+}
+
+
+//! Sets the color of an instance
+void CInstancedMeshSceneNode::setInstanceColor(u32 index, video::SColor color)
+{
+	if (index >= Colors.size())
+		return;
+
+	if (Colors[index].color != 0xffffffff)
+		--ColoredInstances;
+	if (color.color != 0xffffffff)
+		++ColoredInstances;
+
+	Colors[index] = color;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CInstancedMeshSceneNode::getMaterial(u32 i)
+{
+	if (Mesh && ReadOnlyMaterials && i<Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CInstancedMeshSceneNode::getMaterialCount() const
+{
+	if (Mesh && ReadOnlyMaterials)
+		return Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets a new mesh
+void CInstancedMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+	{
+		mesh->grab();
+		if (Mesh)
+			Mesh->drop();
+
+		Mesh = mesh;
+		copyMaterials();
+
+		// the views are rendered again for the new mesh
+		invalidateImpostorViews();
+
+		BoxDirty = true;
+		WorldBoxesDirty = true;
+	}
+}
+
+
+//! Draws instances far away from the camera as textured quads
+void CInstancedMeshSceneNode::setImpostors(f32 distance, u32 viewCount, u32 viewSize)
+{
+	ImpostorDistance = core::max_(distance, 0.f);
+	ImpostorViews = core::max_(viewCount, 1u);
+	ImpostorViewSize = core::max_(viewSize, 1u);
+
+	invalidateImpostorViews();
+}
+
+
+void CInstancedMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (Mesh)
+	{
+		video::SMaterial mat;
+
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+//! Writes attributes of the scene node.
+void CInstancedMeshSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
+{
+	IInstancedMeshSceneNode::serializeAttributes(out, options);
+
+	if (options && (options->Flags&io::EARWF_USE_RELATIVE_PATHS) && options->Filename)
+	{
+		const io::path path = SceneManager->getFileSystem()->getRelativeFilename(
+				SceneManager->getFileSystem()->getAbsolutePath(SceneManager->getMeshCache()->getMeshName(Mesh).getPath()),
+				options->Filename);
+		out->addString("Mesh", path.c_str());
+	}
+	else
+		out->addString("Mesh", SceneManager->getMeshCache()->getMeshName(Mesh).getPath().c_str());
+	out->addBool("ReadOnlyMaterials", ReadOnlyMaterials);
+}
+
+
+//! Reads attributes of the scene node.
+void CInstancedMeshSceneNode::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options)
+{
+	io::path oldMeshStr = SceneManager->getMeshCache()->getMeshName(Mesh);
+	io::path newMeshStr = in->getAttributeAsString("Mesh");
+	ReadOnlyMaterials = in->getAttributeAsBool("ReadOnlyMaterials");
+
+	if (newMeshStr != "" && oldMeshStr != newMeshStr)
+	{
+		IAnimatedMesh* newAnimatedMesh = SceneManager->getMesh(newMeshStr.c_str());
+
+		if (newAnimatedMesh && newAnimatedMesh->getMesh(0))
+			setMesh(newAnimatedMesh->getMesh(0));
+	}
+
+	IInstancedMeshSceneNode::deserializeAttributes(in, options);
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CInstancedMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	if (ReadOnlyMaterials == readonly)
+		return;
+
+	ReadOnlyMaterials = readonly;
+
+	// the views use the other materials
+	if (ImpostorTexture || ImpostorViewsDirty)
+		invalidateImpostorViews();
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CInstancedMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CInstancedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CInstancedMeshSceneNode* nb = new CInstancedMeshSceneNode(Mesh, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+	nb->Materials = Materials;
+	nb->Transforms = Transforms;
+	nb->Colors = Colors;
+	nb->ColoredInstances = ColoredInstances;
+	nb->Box = Box;
+	nb->BoxDirty = BoxDirty;
+	nb->setImpostors(ImpostorDistance, ImpostorViews, ImpostorViewSize);
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,188 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IInstancedMeshSceneNode.h"
+#include "IMesh.h"
+#include "S3DVertex.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	class CInstancedMeshSceneNode : public IInstancedMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CInstancedMeshSceneNode();
+
+		//! frame
+		virtual void OnRegisterSceneNode();
+
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
+		//! renders the node.
+		virtual void render();
+
+		//! returns the axis aligned bounding box of all instances
+		virtual const core::aabbox3d<f32>& getBoundingBox() const;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i);
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const;
+
+		//! Writes attributes of the scene node.
+		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const;
+
+		//! Reads attributes of the scene node.
+		virtual void deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options=0);
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const { return ESNT_INSTANCED_MESH; }
+
+		//! Sets a new mesh
+		virtual void setMesh(IMesh* mesh);
+
+		//! Returns the current mesh
+		virtual IMesh* getMesh(void) { return Mesh; }
+
+		//! Adds an instance of the mesh
+		virtual u32 addInstance(const core::matrix4& transform, video::SColor color);
+
+		//! Removes an instance
+		virtual void removeInstance(u32 index);
+
+		//! Removes all instances
+		virtual void removeAllInstances();
+
+		//! Reserves memory for instances
+		virtual void reserveInstances(u32 count);
+
+		//! Get amount of instances
+		virtual u32 getInstanceCount() const { return Transforms.size(); }
+
+		//! Get amount of instances which were visible in the last frame
+		virtual u32 getVisibleInstanceCount() const { return VisibleTransforms.size() + ImpostorVertices.size()/4; }
+
+		//! Sets the transformation of an instance relative to the node
+		virtual void setInstanceTransform(u32 index, const core::matrix4& transform);
+
+		//! Get the transformation of an instance relative to the node
+		virtual const core::matrix4& getInstanceTransform(u32 index) const { return Transforms[index]; }
+
+		//! Sets the color of an instance
+		virtual void setInstanceColor(u32 index, video::SColor color);
+
+		//! Get the color of an instance
+		virtual video::SColor getInstanceColor(u32 index) const { return Colors[index]; }
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		virtual void setReadOnlyMaterials(bool readonly);
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		virtual bool isReadOnlyMaterials() const;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0);
+
+		//! Draws instances far away from the camera as textured quads
+		virtual void setImpostors(f32 distance, u32 viewCount=8, u32 viewSize=128);
+
+		//! Renders the views of the mesh for the impostors
+		virtual void updateImpostorViews();
+
+		//! Get the distance beyond which instances are drawn as quads
+		virtual f32 getImpostorDistance() const { return ImpostorDistance; }
+
+		//! Get amount of instances which were drawn as quads in the last frame
+		virtual u32 getVisibleImpostorCount() const { return ImpostorVertices.size()/4; }
+
+		//! Get the texture with the views of the mesh
+		virtual video::ITexture* getImpostorTexture() const { return ImpostorTexture; }
+
+	private:
+
+		void copyMaterials();
+
+		//! recalculates the bounding boxes after instances or the node moved
+		void updateBoxes();
+
+		//! collects the instances inside of the view frustum
+		void cullInstances();
+
+		//! renders the views of the mesh or finds them in the texture cache
+		void updateImpostorTexture();
+
+		//! drops the views, removes them from the driver if no other node uses them
+		void releaseImpostorTexture();
+
+		//! releases the views and lets the scene manager render them in the next frame
+		void invalidateImpostorViews();
+
+		//! adds the quad of an instance far away
+		void addImpostor(u32 index, const core::vector3df& cameraPosition);
+
+		//! draws the quads of the instances far away
+		void drawImpostors();
+
+		//! transformations of the instances relative to the node
+		core::array<core::matrix4> Transforms;
+		core::array<video::SColor> Colors;
+
+		//! world space boxes of the instances, valid for BoxesTransform
+		core::array<core::aabbox3df> WorldBoxes;
+		core::array<u8> CullResults;
+		core::matrix4 BoxesTransform;
+
+		//! absolute transformations and colors of the visible instances
+		core::array<core::matrix4> VisibleTransforms;
+		core::array<video::SColor> VisibleColors;
+
+		core::array<video::SMaterial> Materials;
+		core::aabbox3d<f32> Box;
+		video::SMaterial ReadOnlyMaterial;
+
+		IMesh* Mesh;
+
+		//! views of the mesh and the quads of the instances far away
+		video::ITexture* ImpostorTexture;
+		video::SMaterial ImpostorMaterial;
+		core::array<video::S3DVertex> ImpostorVertices;
+		core::array<u16> ImpostorIndices;
+		f32 ImpostorDistance;
+		u32 ImpostorViews;
+		u32 ImpostorViewSize;
+		u32 ImpostorColumns;
+		u32 ImpostorRows;
+		//! true if the views are in the texture cache for other nodes
+		bool ImpostorTextureShared;
+		//! true until the views of the current settings are rendered
+		bool ImpostorViewsDirty;
+
+		//! amount of instances which are not white
+		u32 ColoredInstances;
+
+		bool BoxDirty;
+		bool WorldBoxesDirty;
+		bool ReadOnlyMaterials;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -13,6 +13,7 @@
 #include "CLogger.h"
 #include "irrString.h"
 #include "IRandomizer.h"
+#include "IProfiler.h"
 
 namespace irr
 {
@@ -141,6 +142,13 @@ ITimer* CIrrDeviceStub::getTimer()
 }
 
 
+//! Returns a pointer to the profiler of the engine.
+IProfiler* CIrrDeviceStub::getProfiler()
+{
+	return &irr::getProfiler();
+}
+
+
 //! Returns the version of the engine.
 const char* CIrrDeviceStub::getVersion() const
 {
@@ -79,6 +79,9 @@ namespace irr
 		//! Returns a pointer to the ITimer object. With it the current Time can be received.
 		virtual ITimer* getTimer();
 
+		//! Returns a pointer to the profiler of the engine.
+		virtual IProfiler* getProfiler();
+
 		//! Returns the version of the engine.
 		virtual const char* getVersion() const;
 
@@ -0,0 +1,447 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CLODMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "IMeshCache.h"
+#include "IAnimatedMesh.h"
+#include "IMaterialRenderer.h"
+#include "IFileSystem.h"
+#include "CShadowVolumeSceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+
+//! constructor
+CLODMeshSceneNode::CLODMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: ILODMeshSceneNode(parent, mgr, id, position, rotation, scale), Shadow(0),
+	Hysteresis(0.1f), CurrentLevel(0), PassCount(0), ReadOnlyMaterials(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CLODMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CLODMeshSceneNode::~CLODMeshSceneNode()
+{
+	if (Shadow)
+		Shadow->drop();
+	for (u32 i=0; i<Levels.size(); ++i)
+		Levels[i].Mesh->drop();
+}
+
+
+//! frame
+void CLODMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible)
+	{
+		PassCount = 0;
+
+		if (Levels.empty())
+		{
+			ISceneNode::OnRegisterSceneNode();
+			return;
+		}
+
+		updateLevel();
+		IMesh* mesh = Levels[CurrentLevel].Mesh;
+
+		// without debug data and shadow, the buffers are sorted into the
+		// render queue of the scene manager one by one
+		if (!DebugDataVisible && !Shadow &&
+			(ReadOnlyMaterials || Materials.size() >= mesh->getMeshBufferCount()))
+		{
+			SceneManager->registerMeshForRendering(this, mesh,
+				ReadOnlyMaterials ? 0 : Materials.const_pointer());
+			ISceneNode::OnRegisterSceneNode();
+			return;
+		}
+
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+		bool solid = false;
+		bool transparent = false;
+
+		for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+		{
+			const IMeshBuffer* mb = mesh->getMeshBuffer(i);
+			if (!mb)
+				continue;
+
+			const video::SMaterial& material = (ReadOnlyMaterials || i >= Materials.size()) ?
+				mb->getMaterial() : Materials[i];
+			video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+
+			if (rnd && rnd->isTransparent())
+				transparent = true;
+			else
+				solid = true;
+		}
+
+		if (solid)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+		if (transparent)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+}
+
+
+//! renders the node.
+void CLODMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (Levels.empty() || !driver)
+		return;
+
+	const IMesh* mesh = Levels[CurrentLevel].Mesh;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	++PassCount;
+
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+	if (Shadow && PassCount==1)
+		Shadow->updateShadowVolumes();
+
+	u32 i;
+	for (i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(i);
+		if (!mb)
+			continue;
+
+		const video::SMaterial& material = (ReadOnlyMaterials || i >= Materials.size()) ?
+			mb->getMaterial() : Materials[i];
+
+		video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+		const bool transparent = (rnd && rnd->isTransparent());
+
+		// only render transparent buffer if this is the transparent render pass
+		// and solid only in solid pass
+		if (transparent == isTransparentPass)
+		{
+			driver->setMaterial(material);
+			driver->drawMeshBuffer(mb);
+		}
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+			driver->draw3DBox(Box, video::SColor(255,255,255,255));
+
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			for (i=0; i<mesh->getMeshBufferCount(); ++i)
+				driver->draw3DBox(mesh->getMeshBuffer(i)->getBoundingBox(),
+					video::SColor(255,190,128,128));
+		}
+
+		if (DebugDataVisible & scene::EDS_MESH_WIRE_OVERLAY)
+		{
+			m.Wireframe = true;
+			driver->setMaterial(m);
+
+			for (i=0; i<mesh->getMeshBufferCount(); ++i)
+				driver->drawMeshBuffer(mesh->getMeshBuffer(i));
+		}
+	}
+}
+
+
+//! height of the bounding sphere on the screen, relative to the screen height
+f32 CLODMeshSceneNode::getProjectedSize() const
+{
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+		return FLT_MAX;
+
+	core::aabbox3df box(Box);
+	AbsoluteTransformation.transformBoxEx(box);
+	const f32 radius = box.getExtent().getLength() * 0.5f;
+
+	// the projection scales y by 1/tan(fovy/2) or by 2/height
+	const f32 scale = camera->getProjectionMatrix()[5];
+	if (camera->isOrthogonal())
+		return radius * scale;
+
+	const f32 distance = camera->getAbsolutePosition().getDistanceFrom(box.getCenter());
+	if (distance <= radius)
+		return FLT_MAX;
+
+	return radius * scale / distance;
+}
+
+
+//! chooses the level for the projected size
+void CLODMeshSceneNode::updateLevel()
+{
+	const f32 size = getProjectedSize();
+
+	u32 level = core::min_(CurrentLevel, Levels.size()-1);
+	while (level+1 < Levels.size() && size < Levels[level+1].ScreenSize * (1.f - Hysteresis))
+		++level;
+	while (level > 0 && size > Levels[level].ScreenSize * (1.f + Hysteresis))
+		--level;
+
+	CurrentLevel = level;
+}
+
+
+//! Removes a child from this scene node.
+bool CLODMeshSceneNode::removeChild(ISceneNode* child)
+{
+	if (child && Shadow == child)
+	{
+		Shadow->drop();
+		Shadow = 0;
+	}
+
+	return ISceneNode::removeChild(child);
+}
+
+
+//! returns the axis aligned bounding box of this node
+const core::aabbox3d<f32>& CLODMeshSceneNode::getBoundingBox() const
+{
+	return Box;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CLODMeshSceneNode::getMaterial(u32 i)
+{
+	if (Levels.size() && ReadOnlyMaterials && i<Levels[0].Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Levels[0].Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CLODMeshSceneNode::getMaterialCount() const
+{
+	if (Levels.size() && ReadOnlyMaterials)
+		return Levels[0].Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets the mesh of level 0 and removes the other levels
+void CLODMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+	{
+		mesh->grab();
+		removeLevels();
+		if (Levels.size())
+			Levels[0].Mesh->drop();
+		else
+			Levels.set_used(1);
+
+		Levels[0].Mesh = mesh;
+		Levels[0].ScreenSize = FLT_MAX;
+		Box = mesh->getBoundingBox();
+		copyMaterials();
+	}
+}
+
+
+//! Adds a less detailed level
+void CLODMeshSceneNode::addLevel(IMesh* mesh, f32 screenSize)
+{
+	if (!mesh || Levels.empty())
+		return;
+
+	mesh->grab();
+
+	SLevel level;
+	level.Mesh = mesh;
+	level.ScreenSize = screenSize;
+	Levels.push_back(level);
+}
+
+
+//! Removes all levels except level 0
+void CLODMeshSceneNode::removeLevels()
+{
+	for (u32 i=1; i<Levels.size(); ++i)
+		Levels[i].Mesh->drop();
+
+	if (Levels.size())
+		Levels.set_used(1);
+	CurrentLevel = 0;
+}
+
+
+//! Sets the screen size below which a level is used
+void CLODMeshSceneNode::setLevelScreenSize(u32 level, f32 screenSize)
+{
+	if (level && level < Levels.size())
+		Levels[level].ScreenSize = screenSize;
+}
+
+
+//! Get the screen size below which a level is used
+f32 CLODMeshSceneNode::getLevelScreenSize(u32 level) const
+{
+	return level < Levels.size() ? Levels[level].ScreenSize : 0.f;
+}
+
+
+//! Creates shadow volume scene node as child of this node
+//! and returns a pointer to it.
+IShadowVolumeSceneNode* CLODMeshSceneNode::addShadowVolumeSceneNode(
+		const IMesh* shadowMesh, s32 id, bool zfailmethod, f32 infinity)
+{
+	if (!SceneManager->getVideoDriver()->queryFeature(video::EVDF_STENCIL_BUFFER))
+		return 0;
+
+	// if null is given, use the least detailed level, the shadow
+	// volume has to be built from all triangles each time it changes
+	if (!shadowMesh && Levels.size())
+		shadowMesh = Levels.getLast().Mesh;
+
+	if (Shadow)
+		Shadow->drop();
+
+	Shadow = new CShadowVolumeSceneNode(shadowMesh, this, SceneManager, id,  zfailmethod, infinity);
+	return Shadow;
+}
+
+
+void CLODMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (Levels.size())
+	{
+		video::SMaterial mat;
+
+		for (u32 i=0; i<Levels[0].Mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = Levels[0].Mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+//! Writes attributes of the scene node.
+void CLODMeshSceneNode::serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options) const
+{
+	ILODMeshSceneNode::serializeAttributes(out, options);
+
+	IMesh* mesh = Levels.size() ? Levels[0].Mesh : 0;
+	if (options && (options->Flags&io::EARWF_USE_RELATIVE_PATHS) && options->Filename)
+	{
+		const io::path path = SceneManager->getFileSystem()->getRelativeFilename(
+				SceneManager->getFileSystem()->getAbsolutePath(SceneManager->getMeshCache()->getMeshName(mesh).getPath()),
+				options->Filename);
+		out->addString("Mesh", path.c_str());
+	}
+	else
+		out->addString("Mesh", SceneManager->getMeshCache()->getMeshName(mesh).getPath().c_str());
+	out->addBool("ReadOnlyMaterials", ReadOnlyMaterials);
+	out->addFloat("Hysteresis", Hysteresis);
+}
+
+
+//! Reads attributes of the scene node.
+void CLODMeshSceneNode::deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options)
+{
+	io::path oldMeshStr = SceneManager->getMeshCache()->getMeshName(getMesh());
+	io::path newMeshStr = in->getAttributeAsString("Mesh");
+	ReadOnlyMaterials = in->getAttributeAsBool("ReadOnlyMaterials");
+	Hysteresis = in->getAttributeAsFloat("Hysteresis");
+
+	if (newMeshStr != "" && oldMeshStr != newMeshStr)
+	{
+		IAnimatedMesh* newAnimatedMesh = SceneManager->getMesh(newMeshStr.c_str());
+
+		if (newAnimatedMesh && newAnimatedMesh->getMesh(0))
+			setMesh(newAnimatedMesh->getMesh(0));
+	}
+
+	ILODMeshSceneNode::deserializeAttributes(in, options);
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CLODMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	ReadOnlyMaterials = readonly;
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CLODMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CLODMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CLODMeshSceneNode* nb = new CLODMeshSceneNode(getMesh(), newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	for (u32 i=1; i<Levels.size(); ++i)
+		nb->addLevel(Levels[i].Mesh, Levels[i].ScreenSize);
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+	nb->Materials = Materials;
+	nb->Hysteresis = Hysteresis;
+	nb->Shadow = Shadow;
+	if ( nb->Shadow )
+		nb->Shadow->grab();
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
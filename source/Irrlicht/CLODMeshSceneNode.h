@@ -0,0 +1,140 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_LOD_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_LOD_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "ILODMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	class CLODMeshSceneNode : public ILODMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CLODMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CLODMeshSceneNode();
+
+		//! frame
+		virtual void OnRegisterSceneNode();
+
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
+		//! renders the node.
+		virtual void render();
+
+		//! returns the axis aligned bounding box of this node
+		virtual const core::aabbox3d<f32>& getBoundingBox() const;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i);
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const;
+
+		//! Writes attributes of the scene node.
+		virtual void serializeAttributes(io::IAttributes* out, io::SAttributeReadWriteOptions* options=0) const;
+
+		//! Reads attributes of the scene node.
+		virtual void deserializeAttributes(io::IAttributes* in, io::SAttributeReadWriteOptions* options=0);
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const { return ESNT_LOD_MESH; }
+
+		//! Sets the mesh of level 0 and removes the other levels
+		virtual void setMesh(IMesh* mesh);
+
+		//! Returns the mesh of level 0
+		virtual IMesh* getMesh(void) { return Levels.size() ? Levels[0].Mesh : 0; }
+
+		//! Adds a less detailed level
+		virtual void addLevel(IMesh* mesh, f32 screenSize);
+
+		//! Removes all levels except level 0
+		virtual void removeLevels();
+
+		//! Get the amount of levels, including level 0
+		virtual u32 getLevelCount() const { return Levels.size(); }
+
+		//! Get the mesh of a level
+		virtual IMesh* getLevelMesh(u32 level) { return level < Levels.size() ? Levels[level].Mesh : 0; }
+
+		//! Sets the screen size below which a level is used
+		virtual void setLevelScreenSize(u32 level, f32 screenSize);
+
+		//! Get the screen size below which a level is used
+		virtual f32 getLevelScreenSize(u32 level) const;
+
+		//! Sets how far the limit of a level must be passed to change it
+		virtual void setHysteresis(f32 hysteresis) { Hysteresis = hysteresis; }
+
+		//! Get how far the limit of a level must be passed to change it
+		virtual f32 getHysteresis() const { return Hysteresis; }
+
+		//! Get the level which was chosen in the last frame
+		virtual u32 getCurrentLevel() const { return CurrentLevel; }
+
+		//! Creates shadow volume scene node as child of this node
+		//! and returns a pointer to it.
+		virtual IShadowVolumeSceneNode* addShadowVolumeSceneNode(const IMesh* shadowMesh,
+			s32 id, bool zfailmethod=true, f32 infinity=10000.0f);
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		virtual void setReadOnlyMaterials(bool readonly);
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		virtual bool isReadOnlyMaterials() const;
+
+		//! Creates a clone of this scene node and its children.
+		virtual ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0);
+
+		//! Removes a child from this scene node.
+		virtual bool removeChild(ISceneNode* child);
+
+	private:
+
+		//! mesh of a level and the screen size below which it is used
+		struct SLevel
+		{
+			IMesh* Mesh;
+			f32 ScreenSize;
+		};
+
+		void copyMaterials();
+
+		//! height of the bounding sphere on the screen, relative to the screen height
+		f32 getProjectedSize() const;
+
+		//! chooses the level for the projected size
+		void updateLevel();
+
+		core::array<SLevel> Levels;
+		core::array<video::SMaterial> Materials;
+		core::aabbox3d<f32> Box;
+		video::SMaterial ReadOnlyMaterial;
+
+		IShadowVolumeSceneNode* Shadow;
+
+		f32 Hysteresis;
+		u32 CurrentLevel;
+		s32 PassCount;
+		bool ReadOnlyMaterials;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
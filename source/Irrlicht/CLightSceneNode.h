@@ -27,6 +27,9 @@ public:
 	//! pre render event
 	virtual void OnRegisterSceneNode();
 
+	//! Returns if OnAnimate() of this node may run on a worker thread.
+	virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
 	//! render
 	virtual void render();
 
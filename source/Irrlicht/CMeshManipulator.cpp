@@ -5,6 +5,7 @@
 #include "CMeshManipulator.h"
 #include "SMesh.h"
 #include "CMeshBuffer.h"
+#include "CDynamicMeshBuffer.h"
 #include "SAnimatedMesh.h"
 #include "os.h"
 #include "irrMap.h"
@@ -1815,6 +1816,924 @@ IMesh* CMeshManipulator::createForsythOptimizedMesh(const IMesh *mesh) const
 	return newmesh;
 }
 
+
+namespace
+{
+	//! a mesh buffer of the merged meshes and the group it is merged into
+	struct SBatchEntry
+	{
+		const IMeshBuffer* Buffer;
+		u32 Group;
+		u32 Mesh;
+		u32 Index;
+
+		bool operator<(const SBatchEntry& other) const
+		{
+			if (Group != other.Group)
+				return Group < other.Group;
+			if (Mesh != other.Mesh)
+				return Mesh < other.Mesh;
+			return Index < other.Index;
+		}
+	};
+
+	template <class T>
+	inline void transformBatchVertex(T& v, const core::matrix4& m, const core::matrix4& normalMatrix)
+	{
+		m.transformVect(v.Pos);
+		normalMatrix.rotateVect(v.Normal);
+		v.Normal.normalize();
+	}
+
+	inline void transformBatchVertex(video::S3DVertexTangents& v, const core::matrix4& m, const core::matrix4& normalMatrix)
+	{
+		m.transformVect(v.Pos);
+		normalMatrix.rotateVect(v.Normal);
+		v.Normal.normalize();
+		m.rotateVect(v.Tangent);
+		v.Tangent.normalize();
+		m.rotateVect(v.Binormal);
+		v.Binormal.normalize();
+	}
+
+	template <class T>
+	void appendBatchVertices(IVertexBuffer& dst, const T* v, u32 count,
+		const core::matrix4& m, const core::matrix4& normalMatrix)
+	{
+		for (u32 i=0; i<count; ++i)
+		{
+			T vertex(v[i]);
+			transformBatchVertex(vertex, m, normalMatrix);
+			dst.push_back(vertex);
+		}
+	}
+
+	//! appends the transformed vertices and the indices of a mesh buffer
+	void appendBatchBuffer(CDynamicMeshBuffer* dst, const IMeshBuffer* src, const core::matrix4& m)
+	{
+		IVertexBuffer& vertices = dst->getVertexBuffer();
+		IIndexBuffer& indices = dst->getIndexBuffer();
+		const u32 base = vertices.size();
+		const u32 vcount = src->getVertexCount();
+		const u32 icount = src->getIndexCount();
+
+		// normals are transformed with the inverse transposed matrix to
+		// stay perpendicular under non uniform scaling
+		core::matrix4 normalMatrix;
+		if (m.getInverse(normalMatrix))
+			normalMatrix = normalMatrix.getTransposed();
+		else
+			normalMatrix = m;
+
+		vertices.reallocate(base + vcount);
+		switch (src->getVertexType())
+		{
+		case video::EVT_STANDARD:
+			appendBatchVertices(vertices, (const video::S3DVertex*)src->getVertices(), vcount, m, normalMatrix);
+			break;
+		case video::EVT_2TCOORDS:
+			appendBatchVertices(vertices, (const video::S3DVertex2TCoords*)src->getVertices(), vcount, m, normalMatrix);
+			break;
+		case video::EVT_TANGENTS:
+			appendBatchVertices(vertices, (const video::S3DVertexTangents*)src->getVertices(), vcount, m, normalMatrix);
+			break;
+		}
+
+		indices.reallocate(indices.size() + icount);
+		if (src->getIndexType() == video::EIT_16BIT)
+		{
+			const u16* idx = src->getIndices();
+			for (u32 i=0; i<icount; ++i)
+				indices.push_back(base + idx[i]);
+		}
+		else
+		{
+			const u32* idx = (const u32*)src->getIndices();
+			for (u32 i=0; i<icount; ++i)
+				indices.push_back(base + idx[i]);
+		}
+	}
+
+	void finishBatchBuffer(SMesh* mesh, CDynamicMeshBuffer* buffer)
+	{
+		buffer->recalculateBoundingBox();
+		buffer->setHardwareMappingHint(EHM_STATIC);
+		mesh->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+}
+
+
+//! Merges the mesh buffers of several meshes which have equal materials
+IMesh* CMeshManipulator::createBatchedMesh(const IMesh* const* meshes, const core::matrix4* transforms,
+		const video::SMaterial* const* materials, u32 count, bool allow32BitIndices) const
+{
+	SMesh* result = new SMesh();
+	if (!meshes || !transforms)
+		return result;
+
+	// sort all buffers into groups with equal material and vertex type
+	core::array<const video::SMaterial*> groupMaterials;
+	core::array<video::E_VERTEX_TYPE> groupTypes;
+	core::array<SBatchEntry> entries;
+
+	u32 m;
+	for (m=0; m<count; ++m)
+	{
+		if (!meshes[m])
+			continue;
+
+		const u32 bcount = meshes[m]->getMeshBufferCount();
+		for (u32 b=0; b<bcount; ++b)
+		{
+			const IMeshBuffer* mb = meshes[m]->getMeshBuffer(b);
+			if (!mb || !mb->getVertexCount() || !mb->getIndexCount())
+				continue;
+
+			const video::SMaterial* material = (materials && materials[m]) ?
+				&materials[m][b] : &mb->getMaterial();
+
+			u32 g;
+			for (g=0; g<groupMaterials.size(); ++g)
+			{
+				if (groupTypes[g] == mb->getVertexType() && *groupMaterials[g] == *material)
+					break;
+			}
+			if (g == groupMaterials.size())
+			{
+				groupMaterials.push_back(material);
+				groupTypes.push_back(mb->getVertexType());
+			}
+
+			SBatchEntry entry;
+			entry.Buffer = mb;
+			entry.Group = g;
+			entry.Mesh = m;
+			entry.Index = b;
+			entries.push_back(entry);
+		}
+	}
+	entries.sort();
+
+	// merge the buffers of each group, splitting at the 16 bit index limit
+	CDynamicMeshBuffer* buffer = 0;
+	u32 groupVertices = 0;
+	for (u32 i=0; i<entries.size(); ++i)
+	{
+		const SBatchEntry& entry = entries[i];
+		const u32 vcount = entry.Buffer->getVertexCount();
+
+		if (!i || entry.Group != entries[i-1].Group)
+		{
+			groupVertices = 0;
+			for (u32 j=i; j<entries.size() && entries[j].Group == entry.Group; ++j)
+				groupVertices += entries[j].Buffer->getVertexCount();
+
+			if (buffer)
+			{
+				finishBatchBuffer(result, buffer);
+				buffer = 0;
+			}
+		}
+		else if (buffer && buffer->getIndexType() == video::EIT_16BIT &&
+			buffer->getVertexCount() + vcount > 65536)
+		{
+			finishBatchBuffer(result, buffer);
+			buffer = 0;
+		}
+
+		if (!buffer)
+		{
+			// a single buffer which needs 32 bit indices keeps them
+			const bool use32Bit = (allow32BitIndices && groupVertices > 65536) || vcount > 65536;
+			buffer = new CDynamicMeshBuffer(groupTypes[entry.Group],
+				use32Bit ? video::EIT_32BIT : video::EIT_16BIT);
+			buffer->Material = *groupMaterials[entry.Group];
+			buffer->getVertexBuffer().reallocate(use32Bit ? groupVertices : core::min_(groupVertices, 65536u));
+		}
+
+		appendBatchBuffer(buffer, entry.Buffer, transforms[entry.Mesh]);
+		groupVertices -= vcount;
+	}
+	if (buffer)
+		finishBatchBuffer(result, buffer);
+
+	result->recalculateBoundingBox();
+	return result;
+}
+
+
+namespace
+{
+	//! symmetric 4x4 matrix summing the squared distances to planes
+	struct SQuadric
+	{
+		f64 A00, A01, A02, A03, A11, A12, A13, A22, A23, A33;
+
+		void setPlane(f64 a, f64 b, f64 c, f64 d, f64 weight)
+		{
+			A00 = weight*a*a; A01 = weight*a*b; A02 = weight*a*c; A03 = weight*a*d;
+			A11 = weight*b*b; A12 = weight*b*c; A13 = weight*b*d;
+			A22 = weight*c*c; A23 = weight*c*d;
+			A33 = weight*d*d;
+		}
+
+		void add(const SQuadric& q)
+		{
+			A00 += q.A00; A01 += q.A01; A02 += q.A02; A03 += q.A03;
+			A11 += q.A11; A12 += q.A12; A13 += q.A13;
+			A22 += q.A22; A23 += q.A23;
+			A33 += q.A33;
+		}
+
+		//! weighted sum of the squared distances of a point to the planes
+		f64 getError(const core::vector3df& p) const
+		{
+			const f64 x = p.X, y = p.Y, z = p.Z;
+			return x*(A00*x + 2.0*(A01*y + A02*z + A03)) +
+				y*(A11*y + 2.0*(A12*z + A13)) +
+				z*(A22*z + 2.0*A23) + A33;
+		}
+	};
+
+	//! collapse of the position From into the position To
+	struct SEdgeCollapse
+	{
+		f64 Cost;
+		u32 From;
+		u32 To;
+		//! versions of the positions when the cost was calculated
+		u32 FromVersion;
+		u32 ToVersion;
+	};
+
+	//! vertex sorted by its data or by its position to find equal ones
+	struct SSimplifyVertex
+	{
+		const u8* Data;
+		u32 Size;
+		u32 Index;
+
+		bool operator<(const SSimplifyVertex& other) const
+		{
+			const s32 cmp = memcmp(Data, other.Data, Size);
+			return cmp < 0 || (cmp == 0 && Index < other.Index);
+		}
+	};
+
+	//! edge between two positions, sorted to find open edges and seams
+	struct SSimplifyEdge
+	{
+		//! positions, A < B
+		u32 A, B;
+		//! vertices of the triangle at A and B
+		u32 VertexA, VertexB;
+		u32 Triangle;
+
+		bool operator<(const SSimplifyEdge& other) const
+		{
+			if (A != other.A)
+				return A < other.A;
+			if (B != other.B)
+				return B < other.B;
+			return Triangle < other.Triangle;
+		}
+	};
+
+	//! Removes triangles of a mesh buffer by collapsing edges
+	/** Uses the quadric error metric of Garland and Heckbert, but
+	only collapses a vertex into one of its neighbors, so the vertex
+	attributes never have to be interpolated. Vertices with equal
+	positions and different attributes, like at UV seams, form one
+	position which is collapsed as a whole. Each of its vertices is
+	replaced by the vertex of the target position it shares a triangle
+	with, so the seam stays intact. */
+	class CQuadricSimplifier
+	{
+	public:
+
+		CQuadricSimplifier(const IMeshBuffer* mb)
+			: Buffer(mb), TriangleCount(0), Stamp(0)
+		{
+			const u32 vcount = mb->getVertexCount();
+			const u32 icount = mb->getIndexCount() / 3 * 3;
+
+			Vertex.set_used(vcount);
+			Position.set_used(vcount);
+			Quadrics.set_used(vcount);
+			Versions.set_used(vcount);
+			Locked.set_used(vcount);
+			Removed.set_used(vcount);
+			Stamps.set_used(vcount);
+			MapStamps.set_used(vcount);
+			MapTo.set_used(vcount);
+			PositionTriangles.reallocate(vcount);
+
+			u32 i;
+			for (i=0; i<vcount; ++i)
+			{
+				Quadrics[i].setPlane(0, 0, 0, 0, 0);
+				Versions[i] = 0;
+				Locked[i] = false;
+				Removed[i] = false;
+				Stamps[i] = 0;
+				MapStamps[i] = 0;
+				PositionTriangles.push_back(core::array<u32>());
+			}
+
+			weldVertices();
+
+			Indices.set_used(icount);
+			if (mb->getIndexType() == video::EIT_16BIT)
+			{
+				const u16* idx = mb->getIndices();
+				for (i=0; i<icount; ++i)
+					Indices[i] = idx[i] < vcount ? Vertex[idx[i]] : vcount;
+			}
+			else
+			{
+				const u32* idx = (const u32*)mb->getIndices();
+				for (i=0; i<icount; ++i)
+					Indices[i] = idx[i] < vcount ? Vertex[idx[i]] : vcount;
+			}
+
+			// degenerated triangles are dropped right away
+			TriangleRemoved.set_used(icount / 3);
+			for (i=0; i<icount; i+=3)
+			{
+				const u32* t = &Indices[i];
+				bool removed = t[0] == vcount || t[1] == vcount || t[2] == vcount;
+				if (!removed)
+				{
+					const u32 a = Position[t[0]], b = Position[t[1]], c = Position[t[2]];
+					removed = a == b || b == c || c == a;
+				}
+				TriangleRemoved[i/3] = removed;
+				if (removed)
+					continue;
+
+				++TriangleCount;
+				for (u32 k=0; k<3; ++k)
+					PositionTriangles[Position[t[k]]].push_back(i/3);
+
+				// plane quadrics weighted with the area of the triangle
+				core::vector3d<f64> n;
+				const f64 length = getTriangleNormal(i/3, n);
+				if (length <= 0.0)
+					continue;
+
+				const core::vector3df& p0 = mb->getPosition(t[0]);
+				SQuadric q;
+				q.setPlane(n.X, n.Y, n.Z, -(n.X*p0.X + n.Y*p0.Y + n.Z*p0.Z), length * 0.5);
+				for (u32 k=0; k<3; ++k)
+					Quadrics[Position[t[k]]].add(q);
+			}
+
+			classifyEdges();
+
+			for (i=0; i<icount; i+=3)
+			{
+				if (TriangleRemoved[i/3])
+					continue;
+
+				for (u32 k=0; k<3; ++k)
+				{
+					const u32 a = Position[Indices[i+k]];
+					const u32 b = Position[Indices[i+(k+1)%3]];
+					pushCollapse(a, b);
+					pushCollapse(b, a);
+				}
+			}
+		}
+
+		u32 getTriangleCount() const
+		{
+			return TriangleCount;
+		}
+
+		//! collapses edges until at most targetCount triangles are left
+		void simplify(u32 targetCount)
+		{
+			while (TriangleCount > targetCount && Heap.size())
+			{
+				const SEdgeCollapse c = popCollapse();
+				if (Removed[c.From] || Removed[c.To] ||
+					Versions[c.From] != c.FromVersion || Versions[c.To] != c.ToVersion)
+					continue;
+
+				if (canCollapse(c.From, c.To))
+					collapse(c.From, c.To);
+			}
+		}
+
+		//! creates a mesh buffer with the remaining triangles
+		/** Only the used vertices are copied, in their old order. */
+		IMeshBuffer* createMeshBuffer() const
+		{
+			const u32 vcount = Vertex.size();
+			core::array<u32> remap;
+			remap.set_used(vcount);
+			u32 i;
+			for (i=0; i<vcount; ++i)
+				remap[i] = 0xffffffff;
+
+			u32 used = 0;
+			for (i=0; i<Indices.size(); ++i)
+			{
+				if (!TriangleRemoved[i/3])
+					remap[Indices[i]] = 0;
+			}
+			for (i=0; i<vcount; ++i)
+			{
+				if (remap[i] != 0xffffffff)
+					remap[i] = used++;
+			}
+
+			CDynamicMeshBuffer* buffer = new CDynamicMeshBuffer(Buffer->getVertexType(),
+				used > 65536 ? video::EIT_32BIT : video::EIT_16BIT);
+			buffer->Material = Buffer->getMaterial();
+
+			IVertexBuffer& vertices = buffer->getVertexBuffer();
+			const u32 stride = vertices.stride();
+			vertices.set_used(used);
+			u8* dst = (u8*)vertices.pointer();
+			const u8* src = (const u8*)Buffer->getVertices();
+			for (i=0; i<vcount; ++i)
+			{
+				if (remap[i] != 0xffffffff)
+					memcpy(dst + remap[i]*stride, src + i*stride, stride);
+			}
+
+			IIndexBuffer& indices = buffer->getIndexBuffer();
+			indices.reallocate(TriangleCount * 3);
+			for (i=0; i<Indices.size(); ++i)
+			{
+				if (!TriangleRemoved[i/3])
+					indices.push_back(remap[Indices[i]]);
+			}
+
+			buffer->recalculateBoundingBox();
+			buffer->setHardwareMappingHint(Buffer->getHardwareMappingHint_Vertex(), EBT_VERTEX);
+			buffer->setHardwareMappingHint(Buffer->getHardwareMappingHint_Index(), EBT_INDEX);
+			return buffer;
+		}
+
+	private:
+
+		//! finds the first of equal vertices and of vertices with equal positions
+		void weldVertices()
+		{
+			const u32 vcount = Vertex.size();
+			const u8* data = (const u8*)Buffer->getVertices();
+			const u32 stride = getVertexPitchFromType(Buffer->getVertexType());
+
+			core::array<SSimplifyVertex> sorted;
+			sorted.set_used(vcount);
+			u32 i;
+			for (i=0; i<vcount; ++i)
+			{
+				sorted[i].Data = data + i*stride;
+				sorted[i].Size = stride;
+				sorted[i].Index = i;
+			}
+			sorted.set_sorted(false);
+			sorted.sort();
+
+			for (i=0; i<vcount; ++i)
+			{
+				const bool equal = i && !memcmp(sorted[i].Data, sorted[i-1].Data, stride);
+				Vertex[sorted[i].Index] = equal ? Vertex[sorted[i-1].Index] : sorted[i].Index;
+			}
+
+			// the position is the first member of all vertex types
+			for (i=0; i<vcount; ++i)
+				sorted[i].Size = sizeof(core::vector3df);
+			sorted.set_sorted(false);
+			sorted.sort();
+
+			for (i=0; i<vcount; ++i)
+			{
+				const bool equal = i && !memcmp(sorted[i].Data, sorted[i-1].Data, sizeof(core::vector3df));
+				Position[sorted[i].Index] = equal ? Position[sorted[i-1].Index] : sorted[i].Index;
+			}
+		}
+
+		//! normal of a triangle, returns twice its area
+		f64 getTriangleNormal(u32 triangle, core::vector3d<f64>& normal) const
+		{
+			const u32* t = &Indices[triangle*3];
+			const core::vector3df& p0 = Buffer->getPosition(t[0]);
+			const core::vector3df& p1 = Buffer->getPosition(t[1]);
+			const core::vector3df& p2 = Buffer->getPosition(t[2]);
+			const core::vector3d<f64> e1(p1.X - p0.X, p1.Y - p0.Y, p1.Z - p0.Z);
+			const core::vector3d<f64> e2(p2.X - p0.X, p2.Y - p0.Y, p2.Z - p0.Z);
+			normal = e1.crossProduct(e2);
+			const f64 length = normal.getLength();
+			if (length > 0.0)
+				normal /= length;
+			return length;
+		}
+
+		//! locks positions on open edges and keeps seams in place
+		void classifyEdges()
+		{
+			core::array<SSimplifyEdge> edges;
+			edges.reallocate(TriangleCount * 3);
+
+			u32 i;
+			for (i=0; i<Indices.size(); i+=3)
+			{
+				if (TriangleRemoved[i/3])
+					continue;
+
+				for (u32 k=0; k<3; ++k)
+				{
+					const u32 a = Indices[i+k];
+					const u32 b = Indices[i+(k+1)%3];
+					const bool swap = Position[b] < Position[a];
+					SSimplifyEdge e;
+					e.A = Position[swap ? b : a];
+					e.B = Position[swap ? a : b];
+					e.VertexA = swap ? b : a;
+					e.VertexB = swap ? a : b;
+					e.Triangle = i/3;
+					edges.push_back(e);
+				}
+			}
+			edges.sort();
+
+			core::array<u32> seamEdges;
+			seamEdges.set_used(Vertex.size());
+			for (i=0; i<seamEdges.size(); ++i)
+				seamEdges[i] = 0;
+
+			for (i=0; i<edges.size(); )
+			{
+				u32 j = i+1;
+				while (j<edges.size() && edges[j].A == edges[i].A && edges[j].B == edges[i].B)
+					++j;
+
+				if (j-i != 2)
+				{
+					Locked[edges[i].A] = true;
+					Locked[edges[i].B] = true;
+				}
+				else if (edges[i].VertexA != edges[i+1].VertexA || edges[i].VertexB != edges[i+1].VertexB)
+				{
+					++seamEdges[edges[i].A];
+					++seamEdges[edges[i].B];
+					addSeamQuadric(edges[i]);
+					addSeamQuadric(edges[i+1]);
+				}
+				i = j;
+			}
+
+			// seams may only be shortened, so the end of a seam and
+			// the point where seams meet stay
+			for (i=0; i<seamEdges.size(); ++i)
+			{
+				if (seamEdges[i] && seamEdges[i] != 2)
+					Locked[i] = true;
+			}
+		}
+
+		//! adds a plane through a seam edge, perpendicular to its triangle
+		void addSeamQuadric(const SSimplifyEdge& edge)
+		{
+			core::vector3d<f64> n;
+			if (getTriangleNormal(edge.Triangle, n) <= 0.0)
+				return;
+
+			const core::vector3df& pa = Buffer->getPosition(edge.VertexA);
+			const core::vector3df& pb = Buffer->getPosition(edge.VertexB);
+			const core::vector3d<f64> e(pb.X - pa.X, pb.Y - pa.Y, pb.Z - pa.Z);
+			core::vector3d<f64> plane = e.crossProduct(n);
+			const f64 length = plane.getLength();
+			if (length <= 0.0)
+				return;
+			plane /= length;
+
+			// weighted like a triangle so the seam is kept as well as the surface
+			SQuadric q;
+			q.setPlane(plane.X, plane.Y, plane.Z,
+				-(plane.X*pa.X + plane.Y*pa.Y + plane.Z*pa.Z), e.getLengthSQ());
+			Quadrics[edge.A].add(q);
+			Quadrics[edge.B].add(q);
+		}
+
+		//! adds a collapse to the heap, ordered by the smallest cost
+		void pushCollapse(u32 from, u32 to)
+		{
+			if (Locked[from])
+				return;
+
+			SQuadric q = Quadrics[from];
+			q.add(Quadrics[to]);
+
+			SEdgeCollapse c;
+			c.Cost = q.getError(Buffer->getPosition(to));
+			c.From = from;
+			c.To = to;
+			c.FromVersion = Versions[from];
+			c.ToVersion = Versions[to];
+
+			u32 i = Heap.size();
+			Heap.push_back(c);
+			while (i)
+			{
+				const u32 parent = (i-1) / 2;
+				if (Heap[parent].Cost <= c.Cost)
+					break;
+				Heap[i] = Heap[parent];
+				i = parent;
+			}
+			Heap[i] = c;
+		}
+
+		//! removes the cheapest collapse from the heap
+		SEdgeCollapse popCollapse()
+		{
+			const SEdgeCollapse top = Heap[0];
+			const SEdgeCollapse last = Heap.getLast();
+			Heap.erase(Heap.size()-1);
+
+			const u32 size = Heap.size();
+			if (size)
+			{
+				u32 i = 0;
+				for (;;)
+				{
+					u32 child = 2*i + 1;
+					if (child >= size)
+						break;
+					if (child+1 < size && Heap[child+1].Cost < Heap[child].Cost)
+						++child;
+					if (last.Cost <= Heap[child].Cost)
+						break;
+					Heap[i] = Heap[child];
+					i = child;
+				}
+				Heap[i] = last;
+			}
+			return top;
+		}
+
+		//! index of the corner of a triangle at a position, or 3
+		u32 findCorner(const u32* t, u32 position) const
+		{
+			for (u32 k=0; k<3; ++k)
+			{
+				if (Position[t[k]] == position)
+					return k;
+			}
+			return 3;
+		}
+
+		//! marks the positions next to a position with a new stamp
+		u32 markNeighbors(u32 p)
+		{
+			++Stamp;
+			const core::array<u32>& tris = PositionTriangles[p];
+			for (u32 i=0; i<tris.size(); ++i)
+			{
+				if (TriangleRemoved[tris[i]])
+					continue;
+				const u32* t = &Indices[tris[i]*3];
+				for (u32 k=0; k<3; ++k)
+				{
+					if (Position[t[k]] != p)
+						Stamps[Position[t[k]]] = Stamp;
+				}
+			}
+			return Stamp;
+		}
+
+		//! checks if a collapse keeps seams, the surface manifold and doesn't flip triangles
+		/** Finds the vertex of to which replaces each vertex of from. */
+		bool canCollapse(u32 from, u32 to)
+		{
+			const core::array<u32>& tris = PositionTriangles[from];
+			u32 i;
+
+			// each vertex of from must share triangles on the edge with
+			// exactly one vertex of to
+			++Stamp;
+			const u32 mapStamp = Stamp;
+			u32 shared = 0;
+			for (i=0; i<tris.size(); ++i)
+			{
+				if (TriangleRemoved[tris[i]])
+					continue;
+				const u32* t = &Indices[tris[i]*3];
+				const u32 k = findCorner(t, to);
+				if (k == 3)
+					continue;
+
+				++shared;
+				const u32 v = t[findCorner(t, from)];
+				if (MapStamps[v] == mapStamp && MapTo[v] != t[k])
+					return false;
+				MapStamps[v] = mapStamp;
+				MapTo[v] = t[k];
+			}
+			if (!shared)
+				return false;
+
+			for (i=0; i<tris.size(); ++i)
+			{
+				if (TriangleRemoved[tris[i]])
+					continue;
+				const u32* t = &Indices[tris[i]*3];
+				if (MapStamps[t[findCorner(t, from)]] != mapStamp)
+					return false;
+			}
+
+			// the positions next to both must be exactly the ones of
+			// the triangles on the edge
+			const u32 fromStamp = markNeighbors(from);
+			u32 common = 0;
+			const core::array<u32>& toTris = PositionTriangles[to];
+			++Stamp;
+			for (i=0; i<toTris.size(); ++i)
+			{
+				if (TriangleRemoved[toTris[i]])
+					continue;
+				const u32* t = &Indices[toTris[i]*3];
+				for (u32 k=0; k<3; ++k)
+				{
+					const u32 p = Position[t[k]];
+					if (p != to && Stamps[p] == fromStamp)
+					{
+						Stamps[p] = Stamp;
+						++common;
+					}
+				}
+			}
+			if (common != shared)
+				return false;
+
+			// the triangles which remain must not turn around
+			for (i=0; i<tris.size(); ++i)
+			{
+				if (TriangleRemoved[tris[i]])
+					continue;
+				const u32* t = &Indices[tris[i]*3];
+				if (findCorner(t, to) != 3)
+					continue;
+
+				core::vector3df p[3];
+				for (u32 k=0; k<3; ++k)
+					p[k] = Buffer->getPosition(t[k]);
+				const core::vector3df before = (p[1] - p[0]).crossProduct(p[2] - p[0]);
+				p[findCorner(t, from)] = Buffer->getPosition(to);
+				const core::vector3df after = (p[1] - p[0]).crossProduct(p[2] - p[0]);
+
+				if (after.dotProduct(before) <= 0.f)
+					return false;
+			}
+			return true;
+		}
+
+		//! moves the triangles of from to to and removes the ones between them
+		/** Uses the vertices found by canCollapse(). */
+		void collapse(u32 from, u32 to)
+		{
+			core::array<u32>& tris = PositionTriangles[from];
+			core::array<u32>& toTris = PositionTriangles[to];
+			u32 i;
+			for (i=0; i<tris.size(); ++i)
+			{
+				const u32 tri = tris[i];
+				if (TriangleRemoved[tri])
+					continue;
+
+				u32* t = &Indices[tri*3];
+				if (findCorner(t, to) != 3)
+				{
+					TriangleRemoved[tri] = true;
+					--TriangleCount;
+					continue;
+				}
+
+				const u32 k = findCorner(t, from);
+				t[k] = MapTo[t[k]];
+				toTris.push_back(tri);
+			}
+			tris.clear();
+			Removed[from] = true;
+			++Versions[from];
+
+			Quadrics[to].add(Quadrics[from]);
+			++Versions[to];
+
+			// forget removed triangles and update the costs around to
+			u32 kept = 0;
+			for (i=0; i<toTris.size(); ++i)
+			{
+				if (!TriangleRemoved[toTris[i]])
+					toTris[kept++] = toTris[i];
+			}
+			toTris.set_used(kept);
+
+			const u32 stamp = markNeighbors(to);
+			for (i=0; i<toTris.size(); ++i)
+			{
+				const u32* t = &Indices[toTris[i]*3];
+				for (u32 k=0; k<3; ++k)
+				{
+					const u32 n = Position[t[k]];
+					if (Stamps[n] != stamp)
+						continue;
+					// visit each neighbor once
+					Stamps[n] = 0;
+					pushCollapse(to, n);
+					pushCollapse(n, to);
+				}
+			}
+		}
+
+		const IMeshBuffer* Buffer;
+
+		//! first vertex with equal data, used instead of each vertex
+		core::array<u32> Vertex;
+		//! first vertex with an equal position, identifies the positions
+		core::array<u32> Position;
+
+		//! per position
+		core::array<SQuadric> Quadrics;
+		core::array<u32> Versions;
+		core::array<bool> Locked;
+		core::array<bool> Removed;
+		core::array<u32> Stamps;
+		core::array<core::array<u32> > PositionTriangles;
+
+		//! per vertex, the vertex which replaces it in a collapse
+		core::array<u32> MapStamps;
+		core::array<u32> MapTo;
+
+		core::array<u32> Indices;
+		core::array<bool> TriangleRemoved;
+		u32 TriangleCount;
+
+		core::array<SEdgeCollapse> Heap;
+		u32 Stamp;
+	};
+}
+
+
+//! Creates a copy of a mesh with less triangles
+IMesh* CMeshManipulator::createSimplifiedMesh(const IMesh* mesh, f32 triangleRatio) const
+{
+	core::array<IMesh*> levels;
+	createLODMeshes(mesh, levels, 1, triangleRatio);
+	return levels.size() ? levels[0] : 0;
+}
+
+
+//! Creates several simplified copies of a mesh as levels of detail
+void CMeshManipulator::createLODMeshes(const IMesh* mesh, core::array<IMesh*>& levels,
+		u32 levelCount, f32 triangleRatio) const
+{
+	if (!mesh || !levelCount)
+		return;
+
+	triangleRatio = core::clamp(triangleRatio, 0.f, 1.f);
+
+	core::array<SMesh*> meshes;
+	u32 l;
+	for (l=0; l<levelCount; ++l)
+		meshes.push_back(new SMesh());
+
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		if (!mb)
+			continue;
+
+		CQuadricSimplifier simplifier(mb);
+
+		// each level continues with the triangles of the previous one
+		f32 ratio = 1.f;
+		const u32 triangles = simplifier.getTriangleCount();
+		for (l=0; l<levelCount; ++l)
+		{
+			ratio *= triangleRatio;
+			simplifier.simplify((u32)(triangles * ratio));
+
+			IMeshBuffer* buffer = simplifier.createMeshBuffer();
+			meshes[l]->addMeshBuffer(buffer);
+			buffer->drop();
+		}
+	}
+
+	for (l=0; l<levelCount; ++l)
+	{
+		meshes[l]->recalculateBoundingBox();
+		levels.push_back(meshes[l]);
+	}
+}
+
+
 } // end namespace scene
 } // end namespace irr
 
@@ -86,6 +86,17 @@ public:
 
 	//! create a mesh optimized for the vertex cache
 	virtual IMesh* createForsythOptimizedMesh(const scene::IMesh *mesh) const;
+
+	//! Merges the mesh buffers of several meshes which have equal materials
+	virtual IMesh* createBatchedMesh(const IMesh* const* meshes, const core::matrix4* transforms,
+		const video::SMaterial* const* materials, u32 count, bool allow32BitIndices=false) const;
+
+	//! Creates a copy of a mesh with less triangles
+	virtual IMesh* createSimplifiedMesh(const IMesh* mesh, f32 triangleRatio) const;
+
+	//! Creates several simplified copies of a mesh as levels of detail
+	virtual void createLODMeshes(const IMesh* mesh, core::array<IMesh*>& levels,
+		u32 levelCount, f32 triangleRatio=0.5f) const;
 };
 
 } // end namespace scene
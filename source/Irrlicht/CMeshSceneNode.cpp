@@ -58,6 +58,19 @@ void CMeshSceneNode::OnRegisterSceneNode()
 		video::IVideoDriver* driver = SceneManager->getVideoDriver();
 
 		PassCount = 0;
+
+		// without debug data and shadow, the buffers are sorted into the
+		// render queue of the scene manager one by one
+		if (Mesh && !DebugDataVisible && !Shadow &&
+			(ReadOnlyMaterials || Materials.size() >= Mesh->getMeshBufferCount()))
+		{
+			Box = Mesh->getBoundingBox();
+			SceneManager->registerMeshForRendering(this, Mesh,
+				ReadOnlyMaterials ? 0 : Materials.const_pointer());
+			ISceneNode::OnRegisterSceneNode();
+			return;
+		}
+
 		int transparentCount = 0;
 		int solidCount = 0;
 
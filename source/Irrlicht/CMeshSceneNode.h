@@ -29,6 +29,9 @@ namespace scene
 		//! frame
 		virtual void OnRegisterSceneNode();
 
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
 		//! renders the node.
 		virtual void render();
 
@@ -15,6 +15,8 @@
 #include "CMeshManipulator.h"
 #include "CColorConverter.h"
 #include "IAttributeExchangingObject.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 
 namespace irr
@@ -83,7 +85,7 @@ IImageWriter* createImageWriterPPM();
 //! constructor
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
 : FileSystem(io), MeshManipulator(0), ViewPort(0,0,0,0), ScreenSize(screenSize),
-	PrimitivesDrawn(0), MinVertexCountForVBO(500), TextureCreationFlags(0),
+	PrimitivesDrawn(0), MaterialChanges(0), MaterialChangesLastFrame(0), MinVertexCountForVBO(500), TextureCreationFlags(0),
 	OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
 {
 	#ifdef _DEBUG
@@ -303,6 +305,8 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 {
 	core::clearFPUException();
 	PrimitivesDrawn = 0;
+	MaterialChanges = 0;
+	IRR_PROFILE(getProfiler().nextFrame();)
 	return true;
 }
 
@@ -311,8 +315,10 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 bool CNullDriver::endScene()
 {
 	FPSCounter.registerFrame(os::Timer::getRealTime(), PrimitivesDrawn);
+	MaterialChangesLastFrame = MaterialChanges;
 	updateAllHardwareBuffers();
-	updateAllOcclusionQueries();
+	// don't wait for the GPU, results arrive in one of the next frames
+	updateAllOcclusionQueries(false);
 	return true;
 }
 
@@ -500,6 +506,8 @@ ITexture* CNullDriver::getTexture(io::IReadFile* file)
 //! opens the file and loads it into the surface
 video::ITexture* CNullDriver::loadTextureFromFile(io::IReadFile* file, const io::path& hashName )
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_LOAD_TEXTURE);)
+
 	ITexture* texture = 0;
 	IImage* image = createImageFromFile(file);
 
@@ -891,6 +899,13 @@ u32 CNullDriver::getPrimitiveCountDrawn( u32 param ) const
 }
 
 
+//! Returns how often the material was changed in the last frame.
+u32 CNullDriver::getMaterialChangeCount() const
+{
+	return MaterialChangesLastFrame;
+}
+
+
 
 //! Sets the dynamic ambient light color. The default color is
 //! (0,0,0,0) which means it is dark.
@@ -1520,6 +1535,53 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
+//! Draws a mesh buffer several times with different transformations
+void CNullDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+		const core::matrix4* transforms, const SColor* colors, u32 instanceCount)
+{
+	if (!mb || !transforms)
+		return;
+
+	const u32 vertexCount = mb->getVertexCount();
+	const u32 pitch = getVertexPitchFromType(mb->getVertexType());
+	bool copied = false;
+	SColor copiedColor;
+
+	for (u32 i=0; i<instanceCount; ++i)
+	{
+		setTransform(ETS_WORLD, transforms[i]);
+
+		if (!colors || colors[i].color == 0xffffffff)
+		{
+			drawMeshBuffer(mb);
+			continue;
+		}
+
+		// draw a copy of the vertices with the color of the instance,
+		// which is only rewritten when the color changes
+		if (!copied || copiedColor != colors[i])
+		{
+			if (!copied)
+			{
+				InstanceVertices.set_used(vertexCount*pitch);
+				memcpy(InstanceVertices.pointer(), mb->getVertices(), vertexCount*pitch);
+				copied = true;
+			}
+
+			// all vertex types start with the members of S3DVertex
+			u8* v = InstanceVertices.pointer();
+			for (u32 j=0; j<vertexCount; ++j, v+=pitch)
+				reinterpret_cast<S3DVertex*>(v)->Color = colors[i];
+
+			copiedColor = colors[i];
+		}
+
+		drawVertexPrimitiveList(InstanceVertices.const_pointer(), vertexCount, mb->getIndices(),
+			mb->getIndexCount()/3, mb->getVertexType(), scene::EPT_TRIANGLES, mb->getIndexType());
+	}
+}
+
+
 //! Draws the normals of a mesh buffer
 void CNullDriver::drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length, SColor color)
 {
@@ -1630,7 +1692,7 @@ void CNullDriver::addOcclusionQuery(scene::ISceneNode* node, const scene::IMesh*
 	}
 
 	//search for query
-	s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 	{
 		if (OcclusionQueries[index].Mesh != mesh)
@@ -1643,6 +1705,7 @@ void CNullDriver::addOcclusionQuery(scene::ISceneNode* node, const scene::IMesh*
 	else
 	{
 		OcclusionQueries.push_back(SOccQuery(node, mesh));
+		OcclusionQueries.sort();
 		node->setAutomaticCulling(node->getAutomaticCulling() | scene::EAC_OCC_QUERY);
 	}
 }
@@ -1652,7 +1715,7 @@ void CNullDriver::addOcclusionQuery(scene::ISceneNode* node, const scene::IMesh*
 void CNullDriver::removeOcclusionQuery(scene::ISceneNode* node)
 {
 	//search for query
-	s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 	{
 		node->setAutomaticCulling(node->getAutomaticCulling() & ~scene::EAC_OCC_QUERY);
@@ -1678,7 +1741,7 @@ void CNullDriver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
 {
 	if(!node)
 		return;
-	s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index==-1)
 		return;
 	OcclusionQueries[index].Run=0;
@@ -1730,7 +1793,8 @@ void CNullDriver::updateAllOcclusionQueries(bool block)
 	{
 		if (OcclusionQueries[i].Run==u32(~0))
 			continue;
-		updateOcclusionQuery(OcclusionQueries[i].Node, block);
+		if (OcclusionQueries[i].Pending)
+			updateOcclusionQuery(OcclusionQueries[i].Node, block);
 		++OcclusionQueries[i].Run;
 		if (OcclusionQueries[i].Run>1000)
 			removeOcclusionQuery(OcclusionQueries[i].Node);
@@ -1748,6 +1812,14 @@ u32 CNullDriver::getOcclusionQueryResult(scene::ISceneNode* node) const
 }
 
 
+//! Check if an occlusion query still waits for its result.
+bool CNullDriver::isOcclusionQueryPending(scene::ISceneNode* node) const
+{
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
+	return (index != -1) && OcclusionQueries[index].Pending;
+}
+
+
 //! Only used by the internal engine. Used to notify the driver that
 //! the window was resized.
 void CNullDriver::OnResize(const core::dimension2d<u32>& size)
@@ -250,6 +250,9 @@ namespace video
 		//! very useful method for statistics.
 		virtual u32 getPrimitiveCountDrawn( u32 param = 0 ) const;
 
+		//! Returns how often the material was changed in the last frame.
+		virtual u32 getMaterialChangeCount() const;
+
 		//! deletes all dynamic lights there are
 		virtual void deleteAllDynamicLights();
 
@@ -372,6 +375,10 @@ namespace video
 		//! Draws a mesh buffer
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb);
 
+		//! Draws a mesh buffer several times with different transformations
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+				const core::matrix4* transforms, const SColor* colors, u32 instanceCount);
+
 		//! Draws the normals of a mesh buffer
 		virtual void drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length=10.f, SColor color=0xffffffff);
 
@@ -466,6 +473,9 @@ namespace video
 		actual value of pixels. */
 		virtual u32 getOcclusionQueryResult(scene::ISceneNode* node) const;
 
+		//! Check if an occlusion query still waits for its result.
+		virtual bool isOcclusionQueryPending(scene::ISceneNode* node) const;
+
 		//! Only used by the engine internally.
 		/** Used to notify the driver that the window was resized. */
 		virtual void OnResize(const core::dimension2d<u32>& size);
@@ -754,7 +764,7 @@ namespace video
 
 		struct SOccQuery
 		{
-			SOccQuery(scene::ISceneNode* node, const scene::IMesh* mesh=0) : Node(node), Mesh(mesh), PID(0), Result(~0), Run(~0)
+			SOccQuery(scene::ISceneNode* node, const scene::IMesh* mesh=0) : Node(node), Mesh(mesh), PID(0), Result(~0), Run(~0), Pending(false)
 			{
 				if (Node)
 					Node->grab();
@@ -762,7 +772,7 @@ namespace video
 					Mesh->grab();
 			}
 
-			SOccQuery(const SOccQuery& other) : Node(other.Node), Mesh(other.Mesh), PID(other.PID), Result(other.Result), Run(other.Run)
+			SOccQuery(const SOccQuery& other) : Node(other.Node), Mesh(other.Mesh), PID(other.PID), Result(other.Result), Run(other.Run), Pending(other.Pending)
 			{
 				if (Node)
 					Node->grab();
@@ -780,15 +790,20 @@ namespace video
 
 			SOccQuery& operator=(const SOccQuery& other)
 			{
+				if (other.Node)
+					other.Node->grab();
+				if (other.Mesh)
+					other.Mesh->grab();
+				if (Node)
+					Node->drop();
+				if (Mesh)
+					Mesh->drop();
 				Node=other.Node;
 				Mesh=other.Mesh;
 				PID=other.PID;
 				Result=other.Result;
 				Run=other.Run;
-				if (Node)
-					Node->grab();
-				if (Mesh)
-					Mesh->grab();
+				Pending=other.Pending;
 				return *this;
 			}
 
@@ -797,6 +812,12 @@ namespace video
 				return other.Node==Node;
 			}
 
+			//! queries are sorted by node for binary searches
+			bool operator<(const SOccQuery& other) const
+			{
+				return Node<other.Node;
+			}
+
 			scene::ISceneNode* Node;
 			const scene::IMesh* Mesh;
 			union
@@ -806,6 +827,8 @@ namespace video
 			};
 			u32 Result;
 			u32 Run;
+			//! true from running the query on the GPU until its result was retrieved
+			bool Pending;
 		};
 		core::array<SOccQuery> OcclusionQueries;
 
@@ -829,6 +852,11 @@ namespace video
 		CFPSCounter FPSCounter;
 
 		u32 PrimitivesDrawn;
+		//! material changes of the current and the last frame
+		u32 MaterialChanges;
+		u32 MaterialChangesLastFrame;
+		//! vertices of an instance with replaced colors
+		core::array<u8> InstanceVertices;
 		u32 MinVertexCountForVBO;
 
 		u32 TextureCreationFlags;
@@ -0,0 +1,356 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "COcclusionCuller.h"
+#include "IMeshBuffer.h"
+#include "S3DVertex.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+COcclusionCuller::COcclusionCuller(const core::dimension2du& size)
+: Pitch(0), DrawnTriangles(0)
+{
+	setSize(size);
+}
+
+
+//! Sets the resolution of the depth buffer
+void COcclusionCuller::setSize(const core::dimension2du& size)
+{
+	Size.Width = core::max_(size.Width, 1u);
+	Size.Height = core::max_(size.Height, 1u);
+	Pitch = (Size.Width + 3) & ~3u;
+	Depth.set_used(Pitch * Size.Height);
+	DrawnTriangles = 0;
+}
+
+
+//! Clears the depth buffer for a new frame
+void COcclusionCuller::begin(const core::matrix4& viewProjection)
+{
+	ViewProjection = viewProjection;
+	DrawnTriangles = 0;
+
+	f32* depth = Depth.pointer();
+	const u32 count = Depth.size();
+	u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128 far4 = _mm_set1_ps(FLT_MAX);
+	for (; i+4 <= count; i+=4)
+		_mm_storeu_ps(depth + i, far4);
+#endif
+
+	for (; i<count; ++i)
+		depth[i] = FLT_MAX;
+}
+
+
+//! Rasterizes the triangles of a mesh into the depth buffer
+void COcclusionCuller::drawOccluder(const IMesh* mesh, const core::matrix4& transform)
+{
+	if (!mesh)
+		return;
+
+	const core::matrix4 m(ViewProjection * transform);
+	const f32* M = m.pointer();
+
+	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		const u32 vertexCount = mb->getVertexCount();
+		const u32 indexCount = mb->getIndexCount();
+		if (!vertexCount || indexCount < 3)
+			continue;
+
+		// all vertex types start with the position
+		const u8* vertices = (const u8*)mb->getVertices();
+		const u32 vertexPitch = video::getVertexPitchFromType(mb->getVertexType());
+
+		ClipVertices.set_used(vertexCount);
+		for (u32 v=0; v<vertexCount; ++v)
+		{
+			const core::vector3df& p = *(const core::vector3df*)(vertices + v*vertexPitch);
+			SClipVertex& c = ClipVertices[v];
+			c.X = p.X*M[0] + p.Y*M[4] + p.Z*M[8] + M[12];
+			c.Y = p.X*M[1] + p.Y*M[5] + p.Z*M[9] + M[13];
+			c.Z = p.X*M[2] + p.Y*M[6] + p.Z*M[10] + M[14];
+			c.W = p.X*M[3] + p.Y*M[7] + p.Z*M[11] + M[15];
+		}
+
+		const u16* indices16 = mb->getIndices();
+		const u32* indices32 = (const u32*)indices16;
+		const bool is32Bit = (mb->getIndexType() == video::EIT_32BIT);
+
+		for (u32 i=0; i+2<indexCount; i+=3)
+		{
+			const u32 i0 = is32Bit ? indices32[i] : indices16[i];
+			const u32 i1 = is32Bit ? indices32[i+1] : indices16[i+1];
+			const u32 i2 = is32Bit ? indices32[i+2] : indices16[i+2];
+			if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+				continue;
+
+			const SClipVertex& a = ClipVertices[i0];
+			const SClipVertex& b = ClipVertices[i1];
+			const SClipVertex& c = ClipVertices[i2];
+
+			// completely outside of one side of the frustum
+			if ((a.X > a.W && b.X > b.W && c.X > c.W) ||
+				(a.X < -a.W && b.X < -b.W && c.X < -c.W) ||
+				(a.Y > a.W && b.Y > b.W && c.Y > c.W) ||
+				(a.Y < -a.W && b.Y < -b.W && c.Y < -c.W) ||
+				(a.Z > a.W && b.Z > b.W && c.Z > c.W) ||
+				(a.Z < 0.f && b.Z < 0.f && c.Z < 0.f))
+				continue;
+
+			clipAndDrawTriangle(a, b, c);
+		}
+	}
+}
+
+
+//! clips a triangle at the near plane and draws the rest
+void COcclusionCuller::clipAndDrawTriangle(const SClipVertex& a, const SClipVertex& b, const SClipVertex& c)
+{
+	const SClipVertex* in[3] = { &a, &b, &c };
+	SClipVertex out[4];
+	u32 count = 0;
+
+	// near plane at z=0, which works for the depth ranges of all drivers
+	for (u32 i=0; i<3; ++i)
+	{
+		const SClipVertex& p = *in[i];
+		const SClipVertex& q = *in[i == 2 ? 0 : i+1];
+		const bool pInside = p.Z >= 0.f;
+		const bool qInside = q.Z >= 0.f;
+
+		if (pInside)
+			out[count++] = p;
+
+		if (pInside != qInside)
+		{
+			const f32 t = p.Z / (p.Z - q.Z);
+			SClipVertex& v = out[count++];
+			v.X = p.X + (q.X - p.X) * t;
+			v.Y = p.Y + (q.Y - p.Y) * t;
+			v.Z = 0.f;
+			v.W = p.W + (q.W - p.W) * t;
+		}
+	}
+
+	if (count < 3)
+		return;
+
+	SScreenVertex screen[4];
+	for (u32 i=0; i<count; ++i)
+	{
+		if (out[i].W <= core::ROUNDING_ERROR_f32)
+			return;
+		project(out[i], screen[i]);
+	}
+
+	drawTriangle(screen[0], screen[1], screen[2]);
+	if (count == 4)
+		drawTriangle(screen[0], screen[2], screen[3]);
+}
+
+
+//! projects a clip space vertex to the screen
+void COcclusionCuller::project(const SClipVertex& v, SScreenVertex& out) const
+{
+	const f32 invW = core::reciprocal(v.W);
+	out.X = (v.X * invW * 0.5f + 0.5f) * (f32)Size.Width;
+	out.Y = (0.5f - v.Y * invW * 0.5f) * (f32)Size.Height;
+	out.Z = v.Z * invW;
+}
+
+
+//! rasterizes a triangle in screen space
+void COcclusionCuller::drawTriangle(const SScreenVertex& a, const SScreenVertex& v1, const SScreenVertex& v2)
+{
+	f32 area = (v1.X - a.X) * (v2.Y - a.Y) - (v1.Y - a.Y) * (v2.X - a.X);
+	if (core::iszero(area))
+		return;
+
+	// occluders are drawn from both sides
+	const bool swap = area < 0.f;
+	const SScreenVertex& b = swap ? v2 : v1;
+	const SScreenVertex& c = swap ? v1 : v2;
+	if (swap)
+		area = -area;
+
+	// pixels whose center is inside of the bounding rectangle
+	const f32 maxX = (f32)(Size.Width - 1);
+	const f32 maxY = (f32)(Size.Height - 1);
+	const s32 x0 = (s32)core::clamp(ceilf(core::min_(a.X, b.X, c.X) - 0.5f), 0.f, maxX);
+	const s32 x1 = (s32)core::clamp(floorf(core::max_(a.X, b.X, c.X) - 0.5f), -1.f, maxX);
+	const s32 y0 = (s32)core::clamp(ceilf(core::min_(a.Y, b.Y, c.Y) - 0.5f), 0.f, maxY);
+	const s32 y1 = (s32)core::clamp(floorf(core::max_(a.Y, b.Y, c.Y) - 0.5f), -1.f, maxY);
+	if (x0 > x1 || y0 > y1)
+		return;
+
+	++DrawnTriangles;
+
+	// edge functions, positive inside of the triangle
+	const f32 e0dx = a.Y - b.Y, e0dy = b.X - a.X;
+	const f32 e1dx = b.Y - c.Y, e1dy = c.X - b.X;
+	const f32 e2dx = c.Y - a.Y, e2dy = a.X - c.X;
+
+	// depth is linear in screen space
+	const f32 invArea = core::reciprocal(area);
+	const f32 zdx = ((b.Z - a.Z) * (c.Y - a.Y) - (c.Z - a.Z) * (b.Y - a.Y)) * invArea;
+	const f32 zdy = ((c.Z - a.Z) * (b.X - a.X) - (b.Z - a.Z) * (c.X - a.X)) * invArea;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	// four pixels starting at a multiple of four, rows are padded
+	const s32 start = x0 & ~3;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 lanes = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+	const __m128 e0step = _mm_set1_ps(e0dx * 4.f);
+	const __m128 e1step = _mm_set1_ps(e1dx * 4.f);
+	const __m128 e2step = _mm_set1_ps(e2dx * 4.f);
+	const __m128 zstep = _mm_set1_ps(zdx * 4.f);
+#else
+	const s32 start = x0;
+#endif
+
+	for (s32 y=y0; y<=y1; ++y)
+	{
+		const f32 px = (f32)start + 0.5f;
+		const f32 py = (f32)y + 0.5f;
+
+		f32 e0 = e0dx * (px - a.X) + e0dy * (py - a.Y);
+		f32 e1 = e1dx * (px - b.X) + e1dy * (py - b.Y);
+		f32 e2 = e2dx * (px - c.X) + e2dy * (py - c.Y);
+		f32 z = a.Z + zdx * (px - a.X) + zdy * (py - a.Y);
+
+		f32* row = Depth.pointer() + y * Pitch;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		__m128 e0v = _mm_add_ps(_mm_set1_ps(e0), _mm_mul_ps(_mm_set1_ps(e0dx), lanes));
+		__m128 e1v = _mm_add_ps(_mm_set1_ps(e1), _mm_mul_ps(_mm_set1_ps(e1dx), lanes));
+		__m128 e2v = _mm_add_ps(_mm_set1_ps(e2), _mm_mul_ps(_mm_set1_ps(e2dx), lanes));
+		__m128 zv = _mm_add_ps(_mm_set1_ps(z), _mm_mul_ps(_mm_set1_ps(zdx), lanes));
+
+		for (s32 x=start; x<=x1; x+=4)
+		{
+			const __m128 inside = _mm_and_ps(_mm_and_ps(
+					_mm_cmpge_ps(e0v, zero),
+					_mm_cmpge_ps(e1v, zero)),
+					_mm_cmpge_ps(e2v, zero));
+
+			if (_mm_movemask_ps(inside))
+			{
+				const __m128 old = _mm_loadu_ps(row + x);
+				const __m128 nearest = _mm_min_ps(old, zv);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+			}
+
+			e0v = _mm_add_ps(e0v, e0step);
+			e1v = _mm_add_ps(e1v, e1step);
+			e2v = _mm_add_ps(e2v, e2step);
+			zv = _mm_add_ps(zv, zstep);
+		}
+#else
+		for (s32 x=start; x<=x1; ++x)
+		{
+			if (e0 >= 0.f && e1 >= 0.f && e2 >= 0.f && z < row[x])
+				row[x] = z;
+
+			e0 += e0dx;
+			e1 += e1dx;
+			e2 += e2dx;
+			z += zdx;
+		}
+#endif
+	}
+}
+
+
+//! Checks if a box is completely hidden by the occluders
+bool COcclusionCuller::isBoxOccluded(const core::aabbox3df& box, const core::matrix4& transform) const
+{
+	if (!DrawnTriangles)
+		return false;
+
+	const core::matrix4 m(ViewProjection * transform);
+	const f32* M = m.pointer();
+
+	core::vector3df edges[8];
+	box.getEdges(edges);
+
+	f32 minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+	f32 maxX = -FLT_MAX, maxY = -FLT_MAX;
+
+	for (u32 i=0; i<8; ++i)
+	{
+		const core::vector3df& p = edges[i];
+		SClipVertex c;
+		c.X = p.X*M[0] + p.Y*M[4] + p.Z*M[8] + M[12];
+		c.Y = p.X*M[1] + p.Y*M[5] + p.Z*M[9] + M[13];
+		c.Z = p.X*M[2] + p.Y*M[6] + p.Z*M[10] + M[14];
+		c.W = p.X*M[3] + p.Y*M[7] + p.Z*M[11] + M[15];
+
+		// boxes crossing the near plane can't be tested
+		if (c.Z < 0.f || c.W <= core::ROUNDING_ERROR_f32)
+			return false;
+
+		SScreenVertex s;
+		project(c, s);
+		minX = core::min_(minX, s.X);
+		maxX = core::max_(maxX, s.X);
+		minY = core::min_(minY, s.Y);
+		maxY = core::max_(maxY, s.Y);
+		minZ = core::min_(minZ, s.Z);
+	}
+
+	// left to the frustum tests
+	if (maxX < 0.f || maxY < 0.f || minX >= (f32)Size.Width || minY >= (f32)Size.Height)
+		return false;
+
+	// all pixels touched by the rectangle
+	const s32 x0 = (s32)core::max_(floorf(minX), 0.f);
+	const s32 x1 = (s32)core::min_(floorf(maxX), (f32)(Size.Width - 1));
+	const s32 y0 = (s32)core::max_(floorf(minY), 0.f);
+	const s32 y1 = (s32)core::min_(floorf(maxY), (f32)(Size.Height - 1));
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128 minZ4 = _mm_set1_ps(minZ);
+#endif
+
+	for (s32 y=y0; y<=y1; ++y)
+	{
+		const f32* row = Depth.const_pointer() + y * Pitch;
+		s32 x = x0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		for (; x+4 <= x1+1; x+=4)
+		{
+			if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), minZ4)))
+				return false;
+		}
+#endif
+
+		for (; x<=x1; ++x)
+		{
+			if (row[x] >= minZ)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,102 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_OCCLUSION_CULLER_H_INCLUDED__
+#define __C_OCCLUSION_CULLER_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IMesh.h"
+#include "matrix4.h"
+#include "dimension2d.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Tests boxes against a small depth buffer of occluders on the cpu.
+	/** Occluder meshes are rasterized like in the Burning's Video
+	rasterizer, but only their depth z/w is written, without textures,
+	colors and perspective correction. Triangles are clipped at the near
+	plane and drawn from both sides. A box is occluded if its nearest
+	corner is behind the depth of every pixel covered by its projection.
+	With _IRR_COMPILE_WITH_SSE2_ four pixels are rasterized and tested
+	at once. */
+	class COcclusionCuller
+	{
+	public:
+
+		//! constructor
+		COcclusionCuller(const core::dimension2du& size);
+
+		//! Sets the resolution of the depth buffer
+		void setSize(const core::dimension2du& size);
+
+		//! Gets the resolution of the depth buffer
+		const core::dimension2du& getSize() const { return Size; }
+
+		//! Clears the depth buffer for a new frame
+		/** \param viewProjection Projection matrix multiplied with the
+		view matrix of the camera. */
+		void begin(const core::matrix4& viewProjection);
+
+		//! Rasterizes the triangles of a mesh into the depth buffer
+		/** \param mesh Triangle mesh.
+		\param transform Transformation from mesh to world space. */
+		void drawOccluder(const IMesh* mesh, const core::matrix4& transform);
+
+		//! Checks if a box is completely hidden by the occluders
+		/** \param box Box in local space.
+		\param transform Transformation from local to world space.
+		\return True if the box can't be seen. Boxes crossing the near
+		plane or outside of the screen are never occluded. */
+		bool isBoxOccluded(const core::aabbox3df& box, const core::matrix4& transform) const;
+
+		//! Checks if anything was drawn since begin()
+		bool hasOccluders() const { return DrawnTriangles != 0; }
+
+		//! Amount of triangles drawn since begin()
+		u32 getDrawnTriangleCount() const { return DrawnTriangles; }
+
+	private:
+
+		//! vertex in clip space
+		struct SClipVertex
+		{
+			f32 X, Y, Z, W;
+		};
+
+		//! vertex in screen space with depth z/w
+		struct SScreenVertex
+		{
+			f32 X, Y, Z;
+		};
+
+		//! clips a triangle at the near plane and draws the rest
+		void clipAndDrawTriangle(const SClipVertex& a, const SClipVertex& b, const SClipVertex& c);
+
+		//! projects a clip space vertex to the screen
+		void project(const SClipVertex& v, SScreenVertex& out) const;
+
+		//! rasterizes a triangle in screen space
+		void drawTriangle(const SScreenVertex& a, const SScreenVertex& b, const SScreenVertex& c);
+
+		//! depth z/w per pixel, rows padded to a multiple of four
+		core::array<f32> Depth;
+
+		//! vertices of the current mesh buffer in clip space
+		core::array<SClipVertex> ClipVertices;
+
+		core::matrix4 ViewProjection;
+		core::dimension2du Size;
+		u32 Pitch;
+		u32 DrawnTriangles;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif // __C_OCCLUSION_CULLER_H_INCLUDED__
+
@@ -26,6 +26,9 @@ namespace scene
 
 		virtual void OnRegisterSceneNode();
 
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
 		//! renders the node.
 		virtual void render();
 
@@ -16,6 +16,8 @@
 #include "COpenGLNormalMapRenderer.h"
 #include "COpenGLParallaxMapRenderer.h"
 #include "os.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 #ifdef _IRR_COMPILE_WITH_OSX_DEVICE_
 #include "MacOSX/CIrrDeviceMacOSX.h"
@@ -47,7 +49,7 @@ COpenGLDriver::COpenGLDriver(const irr::SIrrlichtCreationParameters& params,
 : CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(),
 	CurrentRenderMode(ERM_NONE), ResetRenderStates(true), Transformation3DChanged(true),
 	AntiAlias(params.AntiAlias), RenderTargetTexture(0),
-	CurrentRendertargetSize(0,0), ColorFormat(ECF_R8G8B8),
+	CurrentRendertargetSize(0,0), ColorFormat(ECF_R8G8B8), InstanceBufferID(0), InstanceCount(1), InstanceWorldLocation(-1), InstanceColorLocation(-1),
 	CurrentTarget(ERT_FRAME_BUFFER), Params(params),
 	HDc(0), Window(static_cast<HWND>(params.WindowId)), Win32Device(device),
 	DeviceType(EIDT_WIN32)
@@ -484,7 +486,7 @@ COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params,
 : CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(),
 	CurrentRenderMode(ERM_NONE), ResetRenderStates(true), Transformation3DChanged(true),
 	AntiAlias(params.AntiAlias), RenderTargetTexture(0),
-	CurrentRendertargetSize(0,0), ColorFormat(ECF_R8G8B8),
+	CurrentRendertargetSize(0,0), ColorFormat(ECF_R8G8B8), InstanceBufferID(0), InstanceCount(1), InstanceWorldLocation(-1), InstanceColorLocation(-1),
 	CurrentTarget(ERT_FRAME_BUFFER), Params(params),
 	OSXDevice(device), DeviceType(EIDT_OSX)
 {
@@ -511,7 +513,7 @@ COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params,
 : CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(),
 	CurrentRenderMode(ERM_NONE), ResetRenderStates(true),
 	Transformation3DChanged(true), AntiAlias(params.AntiAlias),
-	RenderTargetTexture(0), CurrentRendertargetSize(0,0), ColorFormat(ECF_R8G8B8),
+	RenderTargetTexture(0), CurrentRendertargetSize(0,0), ColorFormat(ECF_R8G8B8), InstanceBufferID(0), InstanceCount(1), InstanceWorldLocation(-1), InstanceColorLocation(-1),
 	CurrentTarget(ERT_FRAME_BUFFER), Params(params),
 	X11Device(device), DeviceType(EIDT_X11)
 {
@@ -603,7 +605,7 @@ COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params, io::IFil
 	: CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(),
 	CurrentRenderMode(ERM_NONE), ResetRenderStates(true),
 	Transformation3DChanged(true), AntiAlias(params.AntiAlias),
-	RenderTargetTexture(0), CurrentRendertargetSize(0,0), ColorFormat(ECF_R8G8B8),
+	RenderTargetTexture(0), CurrentRendertargetSize(0,0), ColorFormat(ECF_R8G8B8), InstanceBufferID(0), InstanceCount(1), InstanceWorldLocation(-1), InstanceColorLocation(-1),
 	CurrentTarget(ERT_FRAME_BUFFER), Params(params),
 	SDLDevice(device), DeviceType(EIDT_SDL)
 {
@@ -639,6 +641,8 @@ COpenGLDriver::~COpenGLDriver()
 	deleteAllTextures();
 	removeAllOcclusionQueries();
 	removeAllHardwareBuffers();
+	if (InstanceBufferID)
+		extGlDeleteBuffers(1, &InstanceBufferID);
 
 #ifdef _IRR_COMPILE_WITH_WINDOWS_DEVICE_
 	if (DeviceType == EIDT_WIN32)
@@ -833,6 +837,8 @@ void COpenGLDriver::createMaterialRenderers()
 //! presents the rendered scene on the screen, returns false if failed
 bool COpenGLDriver::endScene()
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_END_SCENE);)
+
 	CNullDriver::endScene();
 
 	glFlush();
@@ -913,6 +919,8 @@ void COpenGLDriver::clearBuffers(bool backBuffer, bool zBuffer, bool stencilBuff
 bool COpenGLDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 		const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_BEGIN_SCENE);)
+
 	CNullDriver::beginScene(backBuffer, zBuffer, color, videoData, sourceRect);
 
 	switch (DeviceType)
@@ -1337,7 +1345,7 @@ void COpenGLDriver::addOcclusionQuery(scene::ISceneNode* node,
 		return;
 
 	CNullDriver::addOcclusionQuery(node, mesh);
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if ((index != -1) && (OcclusionQueries[index].UID == 0))
 		extGlGenQueries(1, reinterpret_cast<GLuint*>(&OcclusionQueries[index].UID));
 }
@@ -1346,7 +1354,7 @@ void COpenGLDriver::addOcclusionQuery(scene::ISceneNode* node,
 //! Remove occlusion query.
 void COpenGLDriver::removeOcclusionQuery(scene::ISceneNode* node)
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 	{
 		if (OcclusionQueries[index].UID != 0)
@@ -1364,7 +1372,7 @@ void COpenGLDriver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
 	if (!node)
 		return;
 
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 	{
 		if (OcclusionQueries[index].UID)
@@ -1377,12 +1385,15 @@ void COpenGLDriver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
 				OcclusionQueries[index].UID);
 		CNullDriver::runOcclusionQuery(node,visible);
 		if (OcclusionQueries[index].UID)
+		{
 			extGlEndQuery(
 #ifdef GL_ARB_occlusion_query
 				GL_SAMPLES_PASSED_ARB);
 #else
 				0);
 #endif
+			OcclusionQueries[index].Pending = true;
+		}
 		testGLError();
 	}
 }
@@ -1393,11 +1404,11 @@ void COpenGLDriver::runOcclusionQuery(scene::ISceneNode* node, bool visible)
 Update might not occur in this case, though */
 void COpenGLDriver::updateOcclusionQuery(scene::ISceneNode* node, bool block)
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 	{
-		// not yet started
-		if (OcclusionQueries[index].Run==u32(~0))
+		// not yet started or result already retrieved
+		if (OcclusionQueries[index].Run==u32(~0) || !OcclusionQueries[index].Pending)
 			return;
 		GLint available = block?GL_TRUE:GL_FALSE;
 		if (!block)
@@ -1424,6 +1435,7 @@ void COpenGLDriver::updateOcclusionQuery(scene::ISceneNode* node, bool block)
 						&available);
 			if (queryFeature(EVDF_OCCLUSION_QUERY))
 				OcclusionQueries[index].Result = available;
+			OcclusionQueries[index].Pending = false;
 		}
 		testGLError();
 	}
@@ -1436,7 +1448,7 @@ The value is a safe approximation, i.e. can be larger than the
 actual value of pixels. */
 u32 COpenGLDriver::getOcclusionQueryResult(scene::ISceneNode* node) const
 {
-	const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+	const s32 index = OcclusionQueries.binary_search(SOccQuery(node));
 	if (index != -1)
 		return OcclusionQueries[index].Result;
 	else
@@ -1451,6 +1463,86 @@ static inline u8* buffer_offset(const long offset)
 }
 
 
+//! Draws a mesh buffer several times with different transformations
+void COpenGLDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+		const core::matrix4* transforms, const SColor* colors, u32 instanceCount)
+{
+	if (!mb || !transforms || !instanceCount)
+		return;
+
+#if defined(GL_ARB_vertex_buffer_object) && defined(GL_VERSION_2_0)
+	if (instanceCount > 1 && Version >= 200 &&
+		FeatureAvailable[IRR_ARB_vertex_buffer_object] && FeatureAvailable[IRR_ARB_instanced_arrays] &&
+		(FeatureAvailable[IRR_ARB_draw_instanced] || FeatureAvailable[IRR_EXT_draw_instanced]))
+	{
+		// binds the shader of the material
+		setTransform(ETS_WORLD, core::IdentityMatrix);
+		setRenderStates3DMode();
+
+		// looked up by the shader when it was linked
+		const GLint worldLocation = InstanceWorldLocation;
+
+		if (worldLocation >= 0)
+		{
+			const GLint colorLocation = colors ? InstanceColorLocation : -1;
+
+			// matrices and colors of all instances in one stream buffer
+			const u32 matrixSize = instanceCount*sizeof(core::matrix4);
+			if (!InstanceBufferID)
+				extGlGenBuffers(1, &InstanceBufferID);
+			extGlBindBuffer(GL_ARRAY_BUFFER, InstanceBufferID);
+			extGlBufferData(GL_ARRAY_BUFFER, matrixSize + (colorLocation >= 0 ? instanceCount*4 : 0), 0, GL_STREAM_DRAW);
+			extGlBufferSubData(GL_ARRAY_BUFFER, 0, matrixSize, transforms);
+
+			// a mat4 attribute uses four locations, one per column
+			for (u32 c=0; c<4; ++c)
+			{
+				extGlEnableVertexAttribArray(worldLocation+c);
+				extGlVertexAttribPointer(worldLocation+c, 4, GL_FLOAT, GL_FALSE, sizeof(core::matrix4), buffer_offset(c*4*sizeof(f32)));
+				extGlVertexAttribDivisor(worldLocation+c, 1);
+			}
+
+			if (colorLocation >= 0)
+			{
+				ColorBuffer.set_used(instanceCount*4);
+				for (u32 i=0; i<instanceCount; ++i)
+					colors[i].toOpenGLColor(&ColorBuffer[i*4]);
+				extGlBufferSubData(GL_ARRAY_BUFFER, matrixSize, instanceCount*4, ColorBuffer.const_pointer());
+
+				extGlEnableVertexAttribArray(colorLocation);
+				extGlVertexAttribPointer(colorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, buffer_offset(matrixSize));
+				extGlVertexAttribDivisor(colorLocation, 1);
+			}
+
+			// the attribute pointers keep the buffer, vertices may come from client memory
+			extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+
+			InstanceCount = instanceCount;
+			drawMeshBuffer(mb);
+			InstanceCount = 1;
+
+			// drawVertexPrimitiveList counted one instance only
+			PrimitivesDrawn += (mb->getIndexCount()/3)*(instanceCount-1);
+
+			for (u32 c=0; c<4; ++c)
+			{
+				extGlVertexAttribDivisor(worldLocation+c, 0);
+				extGlDisableVertexAttribArray(worldLocation+c);
+			}
+			if (colorLocation >= 0)
+			{
+				extGlVertexAttribDivisor(colorLocation, 0);
+				extGlDisableVertexAttribArray(colorLocation);
+			}
+			return;
+		}
+	}
+#endif
+
+	CNullDriver::drawMeshBufferInstanced(mb, transforms, colors, instanceCount);
+}
+
+
 //! draws a vertex primitive list
 void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
 		const void* indexList, u32 primitiveCount,
@@ -1756,7 +1848,10 @@ void COpenGLDriver::renderArray(const void* indexList, u32 primitiveCount,
 			glDrawElements(GL_TRIANGLE_FAN, primitiveCount+2, indexSize, indexList);
 			break;
 		case scene::EPT_TRIANGLES:
-			glDrawElements(GL_TRIANGLES, primitiveCount*3, indexSize, indexList);
+			if (InstanceCount > 1)
+				extGlDrawElementsInstanced(GL_TRIANGLES, primitiveCount*3, indexSize, indexList, InstanceCount);
+			else
+				glDrawElements(GL_TRIANGLES, primitiveCount*3, indexSize, indexList);
 			break;
 		case scene::EPT_QUAD_STRIP:
 			glDrawElements(GL_QUAD_STRIP, primitiveCount*2+2, indexSize, indexList);
@@ -2604,6 +2699,8 @@ void COpenGLDriver::setRenderStates3DMode()
 
 	if (ResetRenderStates || LastMaterial != Material)
 	{
+		++MaterialChanges;
+
 		// unset old material
 
 		if (LastMaterial.MaterialType != Material.MaterialType &&
@@ -104,6 +104,10 @@ namespace video
 		//! Draw hardware buffer
 		virtual void drawHardwareBuffer(SHWBufferLink *HWBuffer);
 
+		//! Draws a mesh buffer several times with different transformations
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+				const core::matrix4* transforms, const SColor* colors, u32 instanceCount);
+
 		//! Create occlusion query.
 		/** Use node for identification and mesh for occlusion test. */
 		virtual void addOcclusionQuery(scene::ISceneNode* node,
@@ -305,6 +309,13 @@ namespace video
 		//! Returns whether setting was a success or not.
 		bool setActiveTexture(u32 stage, const video::ITexture* texture);
 
+		//! sets the instance attributes of the current shader, -1 if it has none
+		void setInstanceAttributeLocations(GLint world, GLint color)
+		{
+			InstanceWorldLocation = world;
+			InstanceColorLocation = color;
+		}
+
 		//! disables all textures beginning with the optional fromStage parameter. Otherwise all texture stages are disabled.
 		//! Returns whether disabling was successful or not.
 		bool disableTextures(u32 fromStage=0);
@@ -561,6 +572,14 @@ namespace video
 		//! Color buffer format
 		ECOLOR_FORMAT ColorFormat;
 
+		//! buffer for the transformations and colors of instances
+		GLuint InstanceBufferID;
+		//! amount of instances renderArray draws
+		u32 InstanceCount;
+		//! locations of inInstanceWorld and inInstanceColor in the current shader
+		GLint InstanceWorldLocation;
+		GLint InstanceColorLocation;
+
 		//! Render target type for render operations
 		E_RENDER_TARGET CurrentTarget;
 
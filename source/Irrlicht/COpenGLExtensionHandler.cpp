@@ -78,7 +78,11 @@ COpenGLExtensionHandler::COpenGLExtensionHandler() :
 	pGlIsOcclusionQueryNV(0), pGlBeginOcclusionQueryNV(0),
 	pGlEndOcclusionQueryNV(0), pGlGetOcclusionQueryivNV(0),
 	pGlGetOcclusionQueryuivNV(0),
-	pGlBlendEquationEXT(0), pGlBlendEquation(0)
+	pGlBlendEquationEXT(0), pGlBlendEquation(0),
+	pGlGetAttribLocation(0), pGlVertexAttribPointerARB(0),
+	pGlEnableVertexAttribArrayARB(0), pGlDisableVertexAttribArrayARB(0),
+	pGlVertexAttribDivisorARB(0),
+	pGlDrawElementsInstancedARB(0), pGlDrawElementsInstancedEXT(0)
 #if defined(GLX_SGI_swap_control)
 	,pGlxSwapIntervalSGI(0)
 #endif
@@ -547,6 +551,15 @@ void COpenGLExtensionHandler::initExtensions(bool stencilBuffer)
 	pGlBlendEquationEXT = (PFNGLBLENDEQUATIONEXTPROC) IRR_OGL_LOAD_EXTENSION("glBlendEquationEXT");
 	pGlBlendEquation = (PFNGLBLENDEQUATIONPROC) IRR_OGL_LOAD_EXTENSION("glBlendEquation");
 
+	// generic vertex attributes and instancing
+	pGlGetAttribLocation = (PFNGLGETATTRIBLOCATIONPROC) IRR_OGL_LOAD_EXTENSION("glGetAttribLocation");
+	pGlVertexAttribPointerARB = (PFNGLVERTEXATTRIBPOINTERARBPROC) IRR_OGL_LOAD_EXTENSION("glVertexAttribPointerARB");
+	pGlEnableVertexAttribArrayARB = (PFNGLENABLEVERTEXATTRIBARRAYARBPROC) IRR_OGL_LOAD_EXTENSION("glEnableVertexAttribArrayARB");
+	pGlDisableVertexAttribArrayARB = (PFNGLDISABLEVERTEXATTRIBARRAYARBPROC) IRR_OGL_LOAD_EXTENSION("glDisableVertexAttribArrayARB");
+	pGlVertexAttribDivisorARB = (PFNGLVERTEXATTRIBDIVISORARBPROC) IRR_OGL_LOAD_EXTENSION("glVertexAttribDivisorARB");
+	pGlDrawElementsInstancedARB = (PFNGLDRAWELEMENTSINSTANCEDARBPROC) IRR_OGL_LOAD_EXTENSION("glDrawElementsInstancedARB");
+	pGlDrawElementsInstancedEXT = (PFNGLDRAWELEMENTSINSTANCEDEXTPROC) IRR_OGL_LOAD_EXTENSION("glDrawElementsInstancedEXT");
+
 	// get vsync extension
 	#if defined(WGL_EXT_swap_control) && !defined(_IRR_COMPILE_WITH_SDL_DEVICE_) && !defined(_IRR_COMPILE_WITH_SDL2_DEVICE_)
 		pWglSwapIntervalEXT = (PFNWGLSWAPINTERVALEXTPROC) IRR_OGL_LOAD_EXTENSION("wglSwapIntervalEXT");
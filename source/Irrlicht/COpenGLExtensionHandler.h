@@ -1110,6 +1110,14 @@ class COpenGLExtensionHandler
 	// blend operations
 	void extGlBlendEquation(GLenum mode);
 
+	// generic vertex attributes and instancing
+	GLint extGlGetAttribLocation(GLuint program, const char *name);
+	void extGlVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer);
+	void extGlEnableVertexAttribArray(GLuint index);
+	void extGlDisableVertexAttribArray(GLuint index);
+	void extGlVertexAttribDivisor(GLuint index, GLuint divisor);
+	void extGlDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount);
+
 	// the global feature array
 	bool FeatureAvailable[IRR_OpenGL_Feature_Count];
 
@@ -1239,6 +1247,13 @@ class COpenGLExtensionHandler
 		PFNGLGETOCCLUSIONQUERYUIVNVPROC pGlGetOcclusionQueryuivNV;
 		PFNGLBLENDEQUATIONEXTPROC pGlBlendEquationEXT;
 		PFNGLBLENDEQUATIONPROC pGlBlendEquation;
+		PFNGLGETATTRIBLOCATIONPROC pGlGetAttribLocation;
+		PFNGLVERTEXATTRIBPOINTERARBPROC pGlVertexAttribPointerARB;
+		PFNGLENABLEVERTEXATTRIBARRAYARBPROC pGlEnableVertexAttribArrayARB;
+		PFNGLDISABLEVERTEXATTRIBARRAYARBPROC pGlDisableVertexAttribArrayARB;
+		PFNGLVERTEXATTRIBDIVISORARBPROC pGlVertexAttribDivisorARB;
+		PFNGLDRAWELEMENTSINSTANCEDARBPROC pGlDrawElementsInstancedARB;
+		PFNGLDRAWELEMENTSINSTANCEDEXTPROC pGlDrawElementsInstancedEXT;
 		#if defined(WGL_EXT_swap_control)
 		PFNWGLSWAPINTERVALEXTPROC pWglSwapIntervalEXT;
 		#endif
@@ -2581,6 +2596,83 @@ inline void COpenGLExtensionHandler::extGlBlendEquation(GLenum mode)
 #endif
 }
 
+inline GLint COpenGLExtensionHandler::extGlGetAttribLocation(GLuint program, const char *name)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlGetAttribLocation)
+		return pGlGetAttribLocation(program, name);
+#elif defined(GL_VERSION_2_0)
+	return glGetAttribLocation(program, name);
+#else
+	os::Printer::log("glGetAttribLocation not supported", ELL_ERROR);
+#endif
+	return -1;
+}
+
+inline void COpenGLExtensionHandler::extGlVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlVertexAttribPointerARB)
+		pGlVertexAttribPointerARB(index, size, type, normalized, stride, pointer);
+#elif defined(GL_ARB_vertex_program)
+	glVertexAttribPointerARB(index, size, type, normalized, stride, pointer);
+#else
+	os::Printer::log("glVertexAttribPointer not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlEnableVertexAttribArray(GLuint index)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlEnableVertexAttribArrayARB)
+		pGlEnableVertexAttribArrayARB(index);
+#elif defined(GL_ARB_vertex_program)
+	glEnableVertexAttribArrayARB(index);
+#else
+	os::Printer::log("glEnableVertexAttribArray not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDisableVertexAttribArray(GLuint index)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlDisableVertexAttribArrayARB)
+		pGlDisableVertexAttribArrayARB(index);
+#elif defined(GL_ARB_vertex_program)
+	glDisableVertexAttribArrayARB(index);
+#else
+	os::Printer::log("glDisableVertexAttribArray not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlVertexAttribDivisorARB)
+		pGlVertexAttribDivisorARB(index, divisor);
+#elif defined(GL_ARB_instanced_arrays)
+	glVertexAttribDivisorARB(index, divisor);
+#else
+	os::Printer::log("glVertexAttribDivisor not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::extGlDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei primcount)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (FeatureAvailable[IRR_ARB_draw_instanced] && pGlDrawElementsInstancedARB)
+		pGlDrawElementsInstancedARB(mode, count, type, indices, primcount);
+	else if (FeatureAvailable[IRR_EXT_draw_instanced] && pGlDrawElementsInstancedEXT)
+		pGlDrawElementsInstancedEXT(mode, count, type, indices, primcount);
+#elif defined(GL_ARB_draw_instanced)
+	glDrawElementsInstancedARB(mode, count, type, indices, primcount);
+#elif defined(GL_EXT_draw_instanced)
+	glDrawElementsInstancedEXT(mode, count, type, indices, primcount);
+#else
+	os::Printer::log("glDrawElementsInstanced not supported", ELL_ERROR);
+#endif
+}
+
 
 }
 }
@@ -44,7 +44,8 @@ COpenGLSLMaterialRenderer::COpenGLSLMaterialRenderer(video::COpenGLDriver* drive
 		video::IMaterialRenderer* baseMaterial,
 		s32 userData)
 	: Driver(driver), CallBack(callback), BaseMaterial(baseMaterial),
-		Program(0), Program2(0), UserData(userData)
+		Program(0), Program2(0), InstanceWorldLocation(-1), InstanceColorLocation(-1),
+		UserData(userData)
 {
 	#ifdef _DEBUG
 	setDebugName("COpenGLSLMaterialRenderer");
@@ -73,7 +74,8 @@ COpenGLSLMaterialRenderer::COpenGLSLMaterialRenderer(COpenGLDriver* driver,
 					IShaderConstantSetCallBack* callback,
 					IMaterialRenderer* baseMaterial, s32 userData)
 : Driver(driver), CallBack(callback), BaseMaterial(baseMaterial),
-		Program(0), Program2(0), UserData(userData)
+		Program(0), Program2(0), InstanceWorldLocation(-1), InstanceColorLocation(-1),
+		UserData(userData)
 {
 	if (BaseMaterial)
 		BaseMaterial->grab();
@@ -201,6 +203,8 @@ void COpenGLSLMaterialRenderer::OnSetMaterial(const video::SMaterial& material,
 
 		if (BaseMaterial)
 			BaseMaterial->OnSetMaterial(material, material, true, this);
+
+		Driver->setInstanceAttributeLocations(InstanceWorldLocation, InstanceColorLocation);
 	}
 
 	//let callback know used material
@@ -220,6 +224,8 @@ void COpenGLSLMaterialRenderer::OnUnsetMaterial()
 	if (Program2)
 		Driver->extGlUseProgram(0);
 
+	Driver->setInstanceAttributeLocations(-1, -1);
+
 	if (BaseMaterial)
 		BaseMaterial->OnUnsetMaterial();
 }
@@ -351,6 +357,10 @@ bool COpenGLSLMaterialRenderer::linkProgram()
 			return false;
 		}
 
+		// attributes for drawMeshBufferInstanced
+		InstanceWorldLocation = Driver->extGlGetAttribLocation(Program2, "inInstanceWorld");
+		InstanceColorLocation = Driver->extGlGetAttribLocation(Program2, "inInstanceColor");
+
 		// get uniforms information
 
 		GLint num = 0;
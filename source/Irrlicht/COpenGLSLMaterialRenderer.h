@@ -129,6 +129,8 @@ protected:
 	GLhandleARB Program;
 	GLuint Program2;
 	core::array<SUniformInfo> UniformInfo;
+	GLint InstanceWorldLocation;
+	GLint InstanceColorLocation;
 	s32 UserData;
 };
 
@@ -23,7 +23,7 @@ namespace video
 COpenGLTexture::COpenGLTexture(IImage* origImage, const io::path& name, void* mipmapData, COpenGLDriver* driver)
 	: ITexture(name), ColorFormat(ECF_A8R8G8B8), Driver(driver), Image(0), MipImage(0),
 	TextureName(0), InternalFormat(GL_RGBA), PixelFormat(GL_BGRA_EXT),
-	PixelType(GL_UNSIGNED_BYTE), MipLevelStored(0), MipmapLegacyMode(true),
+	PixelType(GL_UNSIGNED_BYTE), MipLevelStored(0),
 	IsRenderTarget(false), AutomaticMipmapUpdate(false),
 	ReadOnlyLock(false), KeepImage(true)
 {
@@ -61,7 +61,7 @@ COpenGLTexture::COpenGLTexture(const io::path& name, COpenGLDriver* driver)
 	: ITexture(name), ColorFormat(ECF_A8R8G8B8), Driver(driver), Image(0), MipImage(0),
 	TextureName(0), InternalFormat(GL_RGBA), PixelFormat(GL_BGRA_EXT),
 	PixelType(GL_UNSIGNED_BYTE), MipLevelStored(0), HasMipMaps(true),
-	MipmapLegacyMode(true), IsRenderTarget(false), AutomaticMipmapUpdate(false),
+	IsRenderTarget(false), AutomaticMipmapUpdate(false),
 	ReadOnlyLock(false), KeepImage(true)
 {
 	#ifdef _DEBUG
@@ -324,36 +324,11 @@ void COpenGLTexture::uploadTexture(bool newTexture, void* mipmapData, u32 level)
 	if (!level && newTexture)
 	{
 #ifndef DISABLE_MIPMAPPING
-#ifdef GL_SGIS_generate_mipmap
-		// auto generate if possible and no mipmap data is given
-		if (HasMipMaps && !mipmapData && Driver->queryFeature(EVDF_MIP_MAP_AUTO_UPDATE))
-		{
-			if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_SPEED))
-				glHint(GL_GENERATE_MIPMAP_HINT_SGIS, GL_FASTEST);
-			else if (Driver->getTextureCreationFlag(ETCF_OPTIMIZED_FOR_QUALITY))
-				glHint(GL_GENERATE_MIPMAP_HINT_SGIS, GL_NICEST);
-			else
-				glHint(GL_GENERATE_MIPMAP_HINT_SGIS, GL_DONT_CARE);
-
-			AutomaticMipmapUpdate=true;
-
-			if (!Driver->queryFeature(EVDF_FRAMEBUFFER_OBJECT))
-			{
-				glTexParameteri( GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE );
-				MipmapLegacyMode=true;
-			}
-			else
-				MipmapLegacyMode=false;
-		}
-		else
-#endif
-		{
-			// Either generate manually due to missing capability
-			// or use predefined mipmap data
-			AutomaticMipmapUpdate=false;
-			regenerateMipMapLevels(mipmapData);
-		}
-		if (HasMipMaps) // might have changed in regenerateMipMapLevels
+		// the first levels are built the same way as in the other drivers
+		// and follow changes of level 0 until a mip map level is locked
+		uploadMipMapLevels(mipmapData);
+		AutomaticMipmapUpdate = HasMipMaps && !mipmapData;
+		if (HasMipMaps)
 		{
 			// enable bilinear mipmap filter
 			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST );
@@ -381,11 +356,8 @@ void COpenGLTexture::uploadTexture(bool newTexture, void* mipmapData, u32 level)
 			image->getDimension().Height, PixelFormat, PixelType, source);
 	image->unlock();
 
-	if (!MipmapLegacyMode && AutomaticMipmapUpdate)
-	{
-		glEnable(GL_TEXTURE_2D);
-		Driver->extGlGenerateMipmap(GL_TEXTURE_2D);
-	}
+	if (!level && !newTexture && AutomaticMipmapUpdate)
+		updateMipMapLevels();
 
 	if (Driver->testGLError())
 		os::Printer::log("Could not glTexImage2D", ELL_ERROR);
@@ -401,13 +373,7 @@ void* COpenGLTexture::lock(E_TEXTURE_LOCK_MODE mode, u32 mipmapLevel)
 	MipLevelStored = mipmapLevel;
 	if (!ReadOnlyLock && mipmapLevel)
 	{
-#ifdef GL_SGIS_generate_mipmap
-		if (Driver->queryFeature(EVDF_MIP_MAP_AUTO_UPDATE))
-		{
-			// do not automatically generate and update mipmaps
-			glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_FALSE);
-		}
-#endif
+		// do not overwrite the changed level with level 0
 		AutomaticMipmapUpdate=false;
 	}
 
@@ -585,12 +551,35 @@ bool COpenGLTexture::hasMipMaps() const
 //! modifying the texture
 void COpenGLTexture::regenerateMipMapLevels(void* mipmapData)
 {
-	if (AutomaticMipmapUpdate || !HasMipMaps || !Image)
+	// levels which follow level 0 are already up to date
+	if (AutomaticMipmapUpdate && !mipmapData)
+		return;
+
+	Driver->setActiveTexture(0, this);
+	if (mipmapData)
+		uploadMipMapLevels(mipmapData);
+	else
+		updateMipMapLevels();
+}
+
+
+//! uploads the mip map levels, built from Image if no data is given
+void COpenGLTexture::uploadMipMapLevels(void* mipmapData)
+{
+	if (!HasMipMaps || !Image)
 		return;
 	if ((Image->getDimension().Width==1) && (Image->getDimension().Height==1))
 		return;
 
-	// Manually create mipmaps or use prepared version
+	// build all levels in one pass if no prepared version is given
+	u8* chain = 0;
+	if (!mipmapData)
+	{
+		chain = new u8[IImage::getMipMapsDataSize(Image->getColorFormat(), Image->getDimension())];
+		Image->copyToMipMaps(chain);
+		mipmapData = chain;
+	}
+
 	u32 width=Image->getDimension().Width;
 	u32 height=Image->getDimension().Height;
 	u32 i=0;
@@ -602,24 +591,31 @@ void COpenGLTexture::regenerateMipMapLevels(void* mipmapData)
 		if (height>1)
 			height>>=1;
 		++i;
-		if (!target)
-			target = new u8[width*height*Image->getBytesPerPixel()];
-		// create scaled version if no mipdata available
-		if (!mipmapData)
-			Image->copyToScaling(target, width, height, Image->getColorFormat());
 		glTexImage2D(GL_TEXTURE_2D, i, InternalFormat, width, height,
 				0, PixelFormat, PixelType, target);
-		// get next prepared mipmap data if available
-		if (mipmapData)
-		{
-			mipmapData = static_cast<u8*>(mipmapData)+width*height*Image->getBytesPerPixel();
-			target = static_cast<u8*>(mipmapData);
-		}
+		target += width*height*Image->getBytesPerPixel();
 	}
 	while (width!=1 || height!=1);
-	// cleanup
-	if (!mipmapData)
-		delete [] target;
+
+	delete [] chain;
+}
+
+
+//! rebuilds the mip map levels after level 0 of an existing texture changed
+void COpenGLTexture::updateMipMapLevels()
+{
+	if (!HasMipMaps)
+		return;
+
+	// textures updated each frame would build the whole chain on the cpu
+	// on each unlock, so the hardware builds it if it can
+	if (Driver->queryFeature(EVDF_FRAMEBUFFER_OBJECT))
+	{
+		glEnable(GL_TEXTURE_2D);
+		Driver->extGlGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+		uploadMipMapLevels();
 }
 
 
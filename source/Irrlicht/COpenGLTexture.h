@@ -124,6 +124,12 @@ protected:
 	\param mipLevel If set to non-zero, only that specific miplevel is updated, using the MipImage member. */
 	void uploadTexture(bool newTexture=false, void* mipmapData=0, u32 mipLevel=0);
 
+	//! uploads the mip map levels, built from Image with IImage::copyToMipMaps() if no data is given
+	void uploadMipMapLevels(void* mipmapData=0);
+
+	//! rebuilds the mip map levels after level 0 of an existing texture changed
+	void updateMipMapLevels();
+
 	core::dimension2d<u32> ImageSize;
 	core::dimension2d<u32> TextureSize;
 	ECOLOR_FORMAT ColorFormat;
@@ -138,7 +144,6 @@ protected:
 
 	u8 MipLevelStored;
 	bool HasMipMaps;
-	bool MipmapLegacyMode;
 	bool IsRenderTarget;
 	bool AutomaticMipmapUpdate;
 	bool ReadOnlyLock;
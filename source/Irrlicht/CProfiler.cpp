@@ -0,0 +1,321 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CProfiler.h"
+#include "EProfileIDs.h"
+#include "IWriteFile.h"
+#include "os.h"
+
+namespace irr
+{
+
+//! Get the profiler which is shared by the whole engine
+IRRLICHT_API IProfiler& IRRCALLCONV getProfiler()
+{
+	static CProfiler profiler;
+	return profiler;
+}
+
+
+namespace
+{
+	//! appends a left aligned text and fills the column with spaces
+	void appendColumn(core::stringw& result, const core::stringw& text, u32 width)
+	{
+		result += text;
+		for (u32 i=text.size(); i<width; ++i)
+			result += L' ';
+		if (text.size() >= width)
+			result += L' ';
+	}
+
+	//! appends a right aligned text
+	void appendRightColumn(core::stringw& result, const core::stringw& text, u32 width)
+	{
+		for (u32 i=text.size(); i<width; ++i)
+			result += L' ';
+		result += text;
+	}
+
+	//! appends a right aligned number
+	void appendNumber(core::stringw& result, u32 value, u32 width)
+	{
+		appendRightColumn(result, core::stringw(value), width);
+	}
+}
+
+
+//! constructor, adds the scopes of the engine
+CProfiler::CProfiler()
+: FrameCount(0), Enabled(true)
+{
+	#ifdef _DEBUG
+	setDebugName("CProfiler");
+	#endif
+
+	add(EPID_SM_DRAW_ALL, L"drawAll", L"scene");
+	add(EPID_SM_ANIMATE, L"animate", L"scene");
+	add(EPID_SM_REGISTER, L"register", L"scene");
+	add(EPID_SM_RENDER_CAMERAS, L"render cameras", L"scene");
+	add(EPID_SM_RENDER_LIGHTS, L"render lights", L"scene");
+	add(EPID_SM_RENDER_SKYBOXES, L"render skyboxes", L"scene");
+	add(EPID_SM_RENDER_SOLID, L"render solid", L"scene");
+	add(EPID_SM_RENDER_SHADOWS, L"render shadows", L"scene");
+	add(EPID_SM_RENDER_TRANSPARENT, L"render transparent", L"scene");
+	add(EPID_SM_RENDER_EFFECT, L"render effects", L"scene");
+	add(EPID_SM_LOAD_MESH, L"load mesh", L"scene");
+	add(EPID_SM_COLLISION, L"collision", L"scene");
+	add(EPID_SM_OCCLUSION, L"draw occluders", L"scene");
+	add(EPID_VIDEO_BEGIN_SCENE, L"beginScene", L"video");
+	add(EPID_VIDEO_END_SCENE, L"endScene", L"video");
+	add(EPID_VIDEO_LOAD_TEXTURE, L"load texture", L"video");
+	add(EPID_GUI_DRAW_ALL, L"drawAll", L"gui");
+}
+
+
+//! Adds a scope to measure
+void CProfiler::add(s32 id, const core::stringw& name, const core::stringw& groupName)
+{
+	const s32 index = findScope(id);
+	if (index >= 0)
+	{
+		Scopes[index].Data.Name = name;
+		Scopes[index].Data.GroupName = groupName;
+		return;
+	}
+
+	SScope scope;
+	scope.Data.Id = id;
+	scope.Data.ParentId = id;
+	scope.Data.Name = name;
+	scope.Data.GroupName = groupName;
+
+	// keep the scopes sorted by id
+	u32 i = 0;
+	while (i < Scopes.size() && Scopes[i].Data.Id < id)
+		++i;
+	Scopes.insert(scope, i);
+}
+
+
+//! Removes a scope
+void CProfiler::remove(s32 id)
+{
+	const s32 index = findScope(id);
+	if (index < 0)
+		return;
+
+	Scopes.erase(index);
+
+	const s32 running = RunningScopes.linear_reverse_search(id);
+	if (running >= 0)
+		RunningScopes.erase(running);
+}
+
+
+//! Starts the time measurement of a scope
+void CProfiler::start(s32 id)
+{
+	if (!Enabled)
+		return;
+
+	const s32 index = findScope(id);
+	if (index < 0)
+		return;
+
+	SScope& scope = Scopes[index];
+	if (scope.Nesting++)
+		return;
+
+	// the scope belongs to the one which was started last
+	if (!scope.HasParent)
+	{
+		const s32 parent = RunningScopes.empty() ? -1 : findScope(RunningScopes.getLast());
+		scope.Data.ParentId = parent >= 0 ? Scopes[parent].Data.Id : id;
+		scope.Data.Depth = parent >= 0 ? Scopes[parent].Data.Depth + 1 : 0;
+		scope.HasParent = true;
+	}
+
+	RunningScopes.push_back(id);
+	scope.StartTime = os::Timer::getRealTimeMicroseconds();
+}
+
+
+//! Stops the time measurement of a scope
+void CProfiler::stop(s32 id)
+{
+	const s32 index = findScope(id);
+	if (index < 0)
+		return;
+
+	// also stops scopes started before the profiler was disabled
+	SScope& scope = Scopes[index];
+	if (!scope.Nesting || --scope.Nesting)
+		return;
+
+	// scopes may be stopped in another order than they were started
+	const s32 running = RunningScopes.linear_reverse_search(id);
+	if (running >= 0)
+		RunningScopes.erase(running);
+
+	scope.FrameTime += (u32)(os::Timer::getRealTimeMicroseconds() - scope.StartTime);
+	++scope.Data.CallCount;
+	scope.Called = true;
+}
+
+
+//! Finishes the current frame
+void CProfiler::nextFrame()
+{
+	++FrameCount;
+
+	for (u32 i=0; i<Scopes.size(); ++i)
+	{
+		SScope& scope = Scopes[i];
+		if (!scope.Called)
+			continue;
+
+		SProfileData& data = scope.Data;
+		if (!data.FrameCount || scope.FrameTime < data.MinFrameTime)
+			data.MinFrameTime = scope.FrameTime;
+		if (scope.FrameTime > data.MaxFrameTime)
+			data.MaxFrameTime = scope.FrameTime;
+		data.LastFrameTime = scope.FrameTime;
+		data.TimeSum += scope.FrameTime;
+		++data.FrameCount;
+
+		scope.FrameTime = 0;
+		scope.Called = false;
+	}
+}
+
+
+//! Get the data of a scope by id
+const SProfileData* CProfiler::getProfileData(s32 id) const
+{
+	const s32 index = findScope(id);
+	return index >= 0 ? &Scopes[index].Data : 0;
+}
+
+
+//! Resets the statistics of all scopes
+void CProfiler::resetAll()
+{
+	FrameCount = 0;
+
+	for (u32 i=0; i<Scopes.size(); ++i)
+	{
+		SProfileData& data = Scopes[i].Data;
+		data.CallCount = 0;
+		data.FrameCount = 0;
+		data.TimeSum = 0;
+		data.MinFrameTime = 0;
+		data.MaxFrameTime = 0;
+		data.LastFrameTime = 0;
+		data.ParentId = data.Id;
+		data.Depth = 0;
+		Scopes[i].FrameTime = 0;
+		Scopes[i].Called = false;
+		Scopes[i].HasParent = false;
+	}
+}
+
+
+//! Writes the statistics of all scopes as table into a string
+void CProfiler::printAll(core::stringw& result, bool suppressUncalled) const
+{
+	result += L"frames: ";
+	result += core::stringw(FrameCount);
+	result += L", times per frame in microseconds\n";
+
+	appendColumn(result, L"group", 8);
+	appendColumn(result, L"scope", 28);
+	appendRightColumn(result, L"calls", 8);
+	appendRightColumn(result, L"frames", 8);
+	appendRightColumn(result, L"avg", 8);
+	appendRightColumn(result, L"min", 8);
+	appendRightColumn(result, L"max", 8);
+	appendRightColumn(result, L"last", 8);
+	result += L'\n';
+
+	// scopes without parent, each followed by its children
+	for (u32 i=0; i<Scopes.size(); ++i)
+	{
+		const SProfileData& data = Scopes[i].Data;
+		if (data.ParentId == data.Id || findScope(data.ParentId) < 0)
+			printScope(result, i, suppressUncalled);
+	}
+}
+
+
+//! Writes the statistics of all scopes as table into a file
+bool CProfiler::writeToFile(io::IWriteFile* file, bool suppressUncalled) const
+{
+	if (!file)
+		return false;
+
+	core::stringw table;
+	printAll(table, suppressUncalled);
+
+	const core::stringc text(table);
+	return file->write(text.c_str(), text.size()) == (s32)text.size();
+}
+
+
+//! adds the row of a scope and the rows of its children to the table
+void CProfiler::printScope(core::stringw& result, u32 index, bool suppressUncalled) const
+{
+	const SProfileData& data = Scopes[index].Data;
+	if (!suppressUncalled || data.CallCount)
+	{
+		core::stringw name;
+		for (u32 d=0; d<data.Depth; ++d)
+			name += L"  ";
+		name += data.Name;
+
+		appendColumn(result, data.GroupName, 8);
+		appendColumn(result, name, 28);
+		appendNumber(result, data.CallCount, 8);
+		appendNumber(result, data.FrameCount, 8);
+		appendNumber(result, data.getAverageFrameTime(), 8);
+		appendNumber(result, data.MinFrameTime, 8);
+		appendNumber(result, data.MaxFrameTime, 8);
+		appendNumber(result, data.LastFrameTime, 8);
+		result += L'\n';
+	}
+
+	for (u32 i=0; i<Scopes.size(); ++i)
+	{
+		const SProfileData& child = Scopes[i].Data;
+		if (child.ParentId == data.Id && child.Id != data.Id)
+			printScope(result, i, suppressUncalled);
+	}
+}
+
+
+//! returns the index of the scope with this id, -1 if there is none
+s32 CProfiler::findScope(s32 id) const
+{
+	s32 left = 0;
+	s32 right = (s32)Scopes.size() - 1;
+
+	while (left <= right)
+	{
+		const s32 middle = (left + right) / 2;
+		const s32 middleId = Scopes[middle].Data.Id;
+
+		if (middleId == id)
+			return middle;
+		if (middleId < id)
+			left = middle + 1;
+		else
+			right = middle - 1;
+	}
+
+	return -1;
+}
+
+
+} // end namespace irr
+
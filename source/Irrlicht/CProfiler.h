@@ -0,0 +1,95 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_PROFILER_H_INCLUDED__
+#define __C_PROFILER_H_INCLUDED__
+
+#include "IProfiler.h"
+#include "irrArray.h"
+
+namespace irr
+{
+
+	class CProfiler : public IProfiler
+	{
+	public:
+
+		//! constructor, adds the scopes of the engine
+		CProfiler();
+
+		//! Adds a scope to measure
+		virtual void add(s32 id, const core::stringw& name, const core::stringw& groupName);
+
+		//! Removes a scope
+		virtual void remove(s32 id);
+
+		//! Starts the time measurement of a scope
+		virtual void start(s32 id);
+
+		//! Stops the time measurement of a scope
+		virtual void stop(s32 id);
+
+		//! Finishes the current frame
+		virtual void nextFrame();
+
+		//! Enables or disables measuring
+		virtual void setEnabled(bool enable) { Enabled = enable; }
+
+		//! Check if measuring is enabled
+		virtual bool isEnabled() const { return Enabled; }
+
+		//! Get the amount of scopes
+		virtual u32 getProfileDataCount() const { return Scopes.size(); }
+
+		//! Get the data of a scope by index
+		virtual const SProfileData& getProfileDataByIndex(u32 index) const { return Scopes[index].Data; }
+
+		//! Get the data of a scope by id
+		virtual const SProfileData* getProfileData(s32 id) const;
+
+		//! Resets the statistics of all scopes
+		virtual void resetAll();
+
+		//! Writes the statistics of all scopes as table into a string
+		virtual void printAll(core::stringw& result, bool suppressUncalled=true) const;
+
+		//! Writes the statistics of all scopes as table into a file
+		virtual bool writeToFile(io::IWriteFile* file, bool suppressUncalled=true) const;
+
+	private:
+
+		//! statistics of a scope and the measurement of the current frame
+		struct SScope
+		{
+			SScope() : StartTime(0), FrameTime(0), Nesting(0), Called(false), HasParent(false) {}
+
+			SProfileData Data;
+			u64 StartTime;
+			u32 FrameTime;
+			u32 Nesting;
+			bool Called;
+			//! false until the scope is started the first time after a reset
+			bool HasParent;
+		};
+
+		//! returns the index of the scope with this id, -1 if there is none
+		s32 findScope(s32 id) const;
+
+		//! adds the row of a scope and the rows of its children to the table
+		void printScope(core::stringw& result, u32 index, bool suppressUncalled) const;
+
+		//! scopes sorted by id
+		core::array<SScope> Scopes;
+
+		//! ids of the running scopes, the last one was started last
+		core::array<s32> RunningScopes;
+
+		u32 FrameCount;
+		bool Enabled;
+	};
+
+} // end namespace irr
+
+#endif
+
@@ -13,6 +13,7 @@
 #include "ILightSceneNode.h"
 #include "IQ3Shader.h"
 #include "IFileList.h"
+#include "SViewFrustum.h"
 
 //#define TJUNCTION_SOLVER_ROUND
 //#define TJUNCTION_SOLVER_0125
@@ -24,13 +25,44 @@ namespace scene
 
 	using namespace quake3;
 
+namespace
+{
+	//! mesh buffer of the potentially visible mesh
+	/** Uses the vertices of a buffer of the geometry mesh, only the indices are its own. */
+	class CQ3VisibleMeshBuffer : public SMeshBufferLightMap
+	{
+	public:
+		CQ3VisibleMeshBuffer(SMeshBufferLightMap* source) : Source(source)
+		{
+			Source->grab();
+			Vertices.set_pointer(Source->Vertices.pointer(), Source->Vertices.size(), false, false);
+			Indices = Source->Indices;
+			Material = Source->Material;
+			BoundingBox = Source->BoundingBox;
+
+			// the indices change whenever the viewer moves
+			setHardwareMappingHint(EHM_STATIC, EBT_VERTEX);
+			setHardwareMappingHint(EHM_STREAM, EBT_INDEX);
+		}
+
+		virtual ~CQ3VisibleMeshBuffer()
+		{
+			Source->drop();
+		}
+
+	private:
+		SMeshBufferLightMap* Source;
+	};
+}
+
 //! constructor
 CQ3LevelMesh::CQ3LevelMesh(io::IFileSystem* fs, scene::ISceneManager* smgr,
 				const Q3LevelLoadParameter &loadParam)
 	: LoadParam(loadParam), Textures(0), NumTextures(0), LightMaps(0), NumLightMaps(0),
 	Vertices(0), NumVertices(0), Faces(0), NumFaces(0), Models(0), NumModels(0),
 	Planes(0), NumPlanes(0), Nodes(0), NumNodes(0), Leafs(0), NumLeafs(0),
-	LeafFaces(0), NumLeafFaces(0), MeshVerts(0), NumMeshVerts(0),
+	LeafFaces(0), NumLeafFaces(0), VisitStamp(0), VisibleCluster(-2), VisibleMesh(0),
+	MeshVerts(0), NumMeshVerts(0),
 	Brushes(0), NumBrushes(0), BrushEntities(0), FileSystem(fs),
 	SceneManager(smgr), FramesPerSecond(25.f)
 {
@@ -43,6 +75,10 @@ CQ3LevelMesh::CQ3LevelMesh(io::IFileSystem* fs, scene::ISceneManager* smgr,
 		Mesh[i] = 0;
 	}
 
+	VisData.numOfClusters = 0;
+	VisData.bytesPerCluster = 0;
+	VisData.pBitsets = 0;
+
 	Driver = smgr ? smgr->getVideoDriver() : 0;
 	if (Driver)
 		Driver->grab();
@@ -60,6 +96,15 @@ CQ3LevelMesh::~CQ3LevelMesh()
 {
 	cleanLoader ();
 
+	delete [] Planes;
+	delete [] Nodes;
+	delete [] Leafs;
+	delete [] LeafFaces;
+	delete [] VisData.pBitsets;
+
+	if ( VisibleMesh )
+		VisibleMesh->drop();
+
 	if (Driver)
 		Driver->drop();
 
@@ -162,6 +207,7 @@ bool CQ3LevelMesh::loadFile(io::IReadFile* file)
 
 	cleanMeshes();
 	calcBoundingBoxes();
+	constructVisibleMesh();
 	cleanLoader();
 
 	return true;
@@ -176,10 +222,6 @@ void CQ3LevelMesh::cleanLoader ()
 	delete [] Vertices; Vertices = 0;
 	delete [] Faces; Faces = 0;
 	delete [] Models; Models = 0;
-	delete [] Planes; Planes = 0;
-	delete [] Nodes; Nodes = 0;
-	delete [] Leafs; Leafs = 0;
-	delete [] LeafFaces; LeafFaces = 0;
 	delete [] MeshVerts; MeshVerts = 0;
 	delete [] Brushes; Brushes = 0;
 
@@ -314,7 +356,22 @@ void CQ3LevelMesh::loadFaces(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadPlanes(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	NumPlanes = l->length / sizeof(tBSPPlane);
+	if ( !NumPlanes )
+		return;
+	Planes = new tBSPPlane[NumPlanes];
+
+	file->seek( l->offset );
+	file->read(Planes, NumPlanes * sizeof(tBSPPlane));
+
+	if ( LoadParam.swapHeader )
+	for ( s32 i = 0; i < NumPlanes; i++)
+	{
+		Planes[i].vNormal[0] = os::Byteswap::byteswap(Planes[i].vNormal[0]);
+		Planes[i].vNormal[1] = os::Byteswap::byteswap(Planes[i].vNormal[1]);
+		Planes[i].vNormal[2] = os::Byteswap::byteswap(Planes[i].vNormal[2]);
+		Planes[i].d = os::Byteswap::byteswap(Planes[i].d);
+	}
 }
 
 
@@ -322,7 +379,26 @@ void CQ3LevelMesh::loadPlanes(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadNodes(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	NumNodes = l->length / sizeof(tBSPNode);
+	if ( !NumNodes )
+		return;
+	Nodes = new tBSPNode[NumNodes];
+
+	file->seek( l->offset );
+	file->read(Nodes, NumNodes * sizeof(tBSPNode));
+
+	if ( LoadParam.swapHeader )
+	for ( s32 i = 0; i < NumNodes; i++)
+	{
+		Nodes[i].plane = os::Byteswap::byteswap(Nodes[i].plane);
+		Nodes[i].front = os::Byteswap::byteswap(Nodes[i].front);
+		Nodes[i].back = os::Byteswap::byteswap(Nodes[i].back);
+		for ( s32 j = 0; j < 3; j++)
+		{
+			Nodes[i].mins[j] = os::Byteswap::byteswap(Nodes[i].mins[j]);
+			Nodes[i].maxs[j] = os::Byteswap::byteswap(Nodes[i].maxs[j]);
+		}
+	}
 }
 
 
@@ -330,7 +406,29 @@ void CQ3LevelMesh::loadNodes(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadLeafs(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	NumLeafs = l->length / sizeof(tBSPLeaf);
+	if ( !NumLeafs )
+		return;
+	Leafs = new tBSPLeaf[NumLeafs];
+
+	file->seek( l->offset );
+	file->read(Leafs, NumLeafs * sizeof(tBSPLeaf));
+
+	if ( LoadParam.swapHeader )
+	for ( s32 i = 0; i < NumLeafs; i++)
+	{
+		Leafs[i].cluster = os::Byteswap::byteswap(Leafs[i].cluster);
+		Leafs[i].area = os::Byteswap::byteswap(Leafs[i].area);
+		for ( s32 j = 0; j < 3; j++)
+		{
+			Leafs[i].mins[j] = os::Byteswap::byteswap(Leafs[i].mins[j]);
+			Leafs[i].maxs[j] = os::Byteswap::byteswap(Leafs[i].maxs[j]);
+		}
+		Leafs[i].leafface = os::Byteswap::byteswap(Leafs[i].leafface);
+		Leafs[i].numOfLeafFaces = os::Byteswap::byteswap(Leafs[i].numOfLeafFaces);
+		Leafs[i].leafBrush = os::Byteswap::byteswap(Leafs[i].leafBrush);
+		Leafs[i].numOfLeafBrushes = os::Byteswap::byteswap(Leafs[i].numOfLeafBrushes);
+	}
 }
 
 
@@ -338,7 +436,19 @@ void CQ3LevelMesh::loadLeafs(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadLeafFaces(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	NumLeafFaces = l->length / sizeof(s32);
+	if ( !NumLeafFaces )
+		return;
+	LeafFaces = new s32[NumLeafFaces];
+
+	file->seek( l->offset );
+	file->read(LeafFaces, NumLeafFaces * sizeof(s32));
+
+	if ( LoadParam.swapHeader )
+	for ( s32 i = 0; i < NumLeafFaces; i++)
+	{
+		LeafFaces[i] = os::Byteswap::byteswap(LeafFaces[i]);
+	}
 }
 
 
@@ -346,7 +456,32 @@ void CQ3LevelMesh::loadLeafFaces(tBSPLump* l, io::IReadFile* file)
 */
 void CQ3LevelMesh::loadVisData(tBSPLump* l, io::IReadFile* file)
 {
-	// ignore
+	if ( l->length < (s32) (2 * sizeof(s32)) )
+		return;
+
+	s32 header[2];
+	file->seek( l->offset );
+	file->read(header, sizeof(header));
+
+	if ( LoadParam.swapHeader )
+	{
+		header[0] = os::Byteswap::byteswap(header[0]);
+		header[1] = os::Byteswap::byteswap(header[1]);
+	}
+
+	// the bitsets have to fit into the lump
+	if ( header[0] <= 0 || header[1] <= 0 ||
+		header[1] < (header[0] + 7) / 8 ||
+		(l->length - (s32) sizeof(header)) / header[1] < header[0] )
+	{
+		os::Printer::log("Ignoring invalid visibility data of .bsp file.", ELL_WARNING);
+		return;
+	}
+
+	VisData.numOfClusters = header[0];
+	VisData.bytesPerCluster = header[1];
+	VisData.pBitsets = new c8[header[0] * header[1]];
+	file->read(VisData.pBitsets, header[0] * header[1]);
 }
 
 
@@ -965,6 +1100,8 @@ scene::SMesh** CQ3LevelMesh::buildMesh(s32 num)
 			}
 
 
+			const u32 firstIndex = buffer->getIndexCount();
+
 			switch(Faces[i].type)
 			{
 				case 4: // billboards
@@ -1018,6 +1155,14 @@ scene::SMesh** CQ3LevelMesh::buildMesh(s32 num)
 					break;
 
 			} // end switch
+
+			// remember where the faces of the level went for the visible mesh
+			if ( 0 == num && item[g].index == E_Q3_MESH_GEOMETRY )
+			{
+				FaceIndices[i].Buffer = buffer;
+				FaceIndices[i].FirstIndex = firstIndex;
+				FaceIndices[i].IndexCount = buffer->getIndexCount() - firstIndex;
+			}
 		}
 	}
 
@@ -1054,6 +1199,18 @@ void CQ3LevelMesh::constructMesh()
 
 	s32 i, j;
 
+	SFaceIndices noFace;
+	noFace.Buffer = 0;
+	noFace.VisibleBuffer = -1;
+	noFace.FirstIndex = 0;
+	noFace.IndexCount = 0;
+	FaceIndices.set_used(0);
+	FaceIndices.reallocate(NumFaces);
+	for (i = 0; i < NumFaces; i++)
+	{
+		FaceIndices.push_back(noFace);
+	}
+
 	// First the main level
 	SMesh **tmp = buildMesh(0);
 
@@ -1491,6 +1648,185 @@ IMesh* CQ3LevelMesh::getBrushEntityMesh(quake3::IEntity &ent) const
 }
 
 
+/*!
+	creates the potentially visible mesh from the cleaned geometry mesh
+*/
+void CQ3LevelMesh::constructVisibleMesh()
+{
+	VisibleMesh = new SMesh();
+
+	const SMesh* geometry = Mesh[E_Q3_MESH_GEOMETRY];
+	u32 i;
+	for ( i = 0; i != geometry->MeshBuffers.size(); ++i )
+	{
+		CQ3VisibleMeshBuffer* buffer = new CQ3VisibleMeshBuffer(
+				(SMeshBufferLightMap*) geometry->MeshBuffers[i]);
+		VisibleMesh->addMeshBuffer(buffer);
+		buffer->drop();
+	}
+	VisibleMesh->BoundingBox = geometry->BoundingBox;
+
+	// faces of buffers removed by cleanMeshes are not drawn at all
+	for ( i = 0; i != FaceIndices.size(); ++i )
+	{
+		SFaceIndices& face = FaceIndices[i];
+		face.VisibleBuffer = face.Buffer ? geometry->MeshBuffers.linear_search(face.Buffer) : -1;
+		face.Buffer = 0;
+	}
+
+	FaceVisitedStamp.set_used(FaceIndices.size());
+	for ( i = 0; i != FaceVisitedStamp.size(); ++i )
+		FaceVisitedStamp[i] = 0;
+}
+
+
+//! Get the visibility cluster of a position
+s32 CQ3LevelMesh::getClusterFromPosition(const core::vector3df& position) const
+{
+	if ( !Nodes || !Leafs || !Planes )
+		return -1;
+
+	// walk down the bsp tree, leafs are stored as -(leaf+1)
+	s32 index = 0;
+	while ( index >= 0 )
+	{
+		if ( index >= NumNodes || Nodes[index].plane < 0 || Nodes[index].plane >= NumPlanes )
+			return -1;
+
+		const tBSPNode& node = Nodes[index];
+		const tBSPPlane& plane = Planes[node.plane];
+
+		// y and z are swapped in quake3 files
+		const f32 distance = plane.vNormal[0] * position.X +
+				plane.vNormal[1] * position.Z +
+				plane.vNormal[2] * position.Y - plane.d;
+
+		index = distance >= 0.f ? node.front : node.back;
+	}
+
+	const s32 leaf = -(index + 1);
+	if ( leaf >= NumLeafs )
+		return -1;
+
+	return Leafs[leaf].cluster;
+}
+
+
+//! Checks if a cluster is in the potentially visible set of another one
+bool CQ3LevelMesh::isClusterVisible(s32 fromCluster, s32 testCluster) const
+{
+	if ( !VisData.pBitsets || fromCluster < 0 || fromCluster >= VisData.numOfClusters )
+		return true;
+
+	if ( testCluster < 0 || testCluster >= VisData.numOfClusters )
+		return false;
+
+	const u8 bits = (u8) VisData.pBitsets[fromCluster * VisData.bytesPerCluster + (testCluster >> 3)];
+	return 0 != (bits & (1 << (testCluster & 7)));
+}
+
+
+//! Restricts the potentially visible mesh to what can be seen from a position
+u32 CQ3LevelMesh::updatePotentiallyVisibleSet(const core::vector3df& position,
+		const SViewFrustum* frustum)
+{
+	if ( !VisibleMesh )
+		return 0;
+
+	u32 i;
+	u32 triangles = 0;
+	const s32 cluster = getClusterFromPosition(position);
+
+	// without a frustum the set only changes with the cluster
+	if ( !frustum && cluster == VisibleCluster )
+	{
+		for ( i = 0; i != VisibleMesh->MeshBuffers.size(); ++i )
+			triangles += VisibleMesh->MeshBuffers[i]->getIndexCount() / 3;
+		return triangles;
+	}
+	VisibleCluster = frustum ? -2 : cluster;
+
+	for ( i = 0; i != VisibleMesh->MeshBuffers.size(); ++i )
+		((SMeshBufferLightMap*) VisibleMesh->MeshBuffers[i])->Indices.set_used(0);
+
+	// faces may be part of several leafs
+	++VisitStamp;
+	if ( 0 == VisitStamp )
+	{
+		for ( i = 0; i != FaceVisitedStamp.size(); ++i )
+			FaceVisitedStamp[i] = 0;
+		VisitStamp = 1;
+	}
+
+	const SMesh* geometry = Mesh[E_Q3_MESH_GEOMETRY];
+
+	for ( s32 l = 0; l < NumLeafs; ++l )
+	{
+		const tBSPLeaf& leaf = Leafs[l];
+
+		// leafs without cluster are inside solid geometry
+		if ( leaf.cluster < 0 || !isClusterVisible(cluster, leaf.cluster) )
+			continue;
+
+		if ( frustum )
+		{
+			const core::aabbox3df box(
+				(f32) leaf.mins[0], (f32) leaf.mins[2], (f32) leaf.mins[1],
+				(f32) leaf.maxs[0], (f32) leaf.maxs[2], (f32) leaf.maxs[1]);
+
+			bool outside = false;
+			for ( u32 p = 0; p != SViewFrustum::VF_PLANE_COUNT; ++p )
+			{
+				if ( box.classifyPlaneRelation(frustum->planes[p]) == core::ISREL3D_FRONT )
+				{
+					outside = true;
+					break;
+				}
+			}
+			if ( outside )
+				continue;
+		}
+
+		if ( leaf.leafface < 0 || leaf.numOfLeafFaces < 0 ||
+			leaf.leafface + leaf.numOfLeafFaces > NumLeafFaces )
+			continue;
+
+		for ( s32 f = 0; f < leaf.numOfLeafFaces; ++f )
+		{
+			const s32 faceIndex = LeafFaces[leaf.leafface + f];
+			if ( faceIndex < 0 || faceIndex >= (s32) FaceIndices.size() ||
+				FaceVisitedStamp[faceIndex] == VisitStamp )
+				continue;
+			FaceVisitedStamp[faceIndex] = VisitStamp;
+
+			const SFaceIndices& face = FaceIndices[faceIndex];
+			if ( face.VisibleBuffer < 0 || 0 == face.IndexCount )
+				continue;
+
+			const u16* source = ((const SMeshBufferLightMap*) geometry->MeshBuffers[face.VisibleBuffer])->Indices.const_pointer();
+			core::array<u16>& indices = ((SMeshBufferLightMap*) VisibleMesh->MeshBuffers[face.VisibleBuffer])->Indices;
+			for ( u32 k = 0; k != face.IndexCount; ++k )
+				indices.push_back(source[face.FirstIndex + k]);
+		}
+	}
+
+	for ( i = 0; i != VisibleMesh->MeshBuffers.size(); ++i )
+	{
+		VisibleMesh->MeshBuffers[i]->setDirty(EBT_INDEX);
+		triangles += VisibleMesh->MeshBuffers[i]->getIndexCount() / 3;
+	}
+
+	return triangles;
+}
+
+
+//! Get the level geometry restricted to the potentially visible set
+IMesh* CQ3LevelMesh::getPotentiallyVisibleMesh() const
+{
+	return VisibleMesh;
+}
+
+
 /*!
 */
 const IShader * CQ3LevelMesh::getShader(u32 index) const
@@ -89,6 +89,19 @@ namespace scene
 		//! returns the requested brush entity
 		virtual IMesh* getBrushEntityMesh(quake3::IEntity &ent) const;
 
+		//! Get the visibility cluster of a position
+		virtual s32 getClusterFromPosition(const core::vector3df& position) const;
+
+		//! Checks if a cluster is in the potentially visible set of another one
+		virtual bool isClusterVisible(s32 fromCluster, s32 testCluster) const;
+
+		//! Restricts the potentially visible mesh to what can be seen from a position
+		virtual u32 updatePotentiallyVisibleSet(const core::vector3df& position,
+				const SViewFrustum* frustum=0);
+
+		//! Get the level geometry restricted to the potentially visible set
+		virtual IMesh* getPotentiallyVisibleMesh() const;
+
 		//Link to held meshes? ...
 
 
@@ -133,6 +146,7 @@ namespace scene
 
 
 		void constructMesh();
+		void constructVisibleMesh();
 		void solveTJunction();
 		void loadTextures();
 		scene::SMesh** buildMesh(s32 num);
@@ -267,6 +281,15 @@ namespace scene
 			c8 *pBitsets;      // Array of bytes holding the cluster vis.
 		};
 
+		// indices of a face of the level geometry
+		struct SFaceIndices
+		{
+			SMeshBufferLightMap* Buffer;	// buffer of the geometry mesh while loading
+			s32 VisibleBuffer;				// buffer of the visible mesh, -1 if none
+			u32 FirstIndex;
+			u32 IndexCount;
+		};
+
 		struct tBSPBrush
 		{
 			s32 brushSide;           // The starting brush side for the brush
@@ -407,6 +430,16 @@ namespace scene
 		s32 *LeafFaces;
 		s32 NumLeafFaces;
 
+		tBSPVisData VisData;
+
+		// Planes, Nodes, Leafs, LeafFaces and VisData are kept after loading
+		// to find the potentially visible set
+		core::array<SFaceIndices> FaceIndices;
+		core::array<u32> FaceVisitedStamp;
+		u32 VisitStamp;
+		s32 VisibleCluster;
+		SMesh* VisibleMesh;
+
 		s32 *MeshVerts;           // The vertex offsets for a mesh
 		s32 NumMeshVerts;
 
@@ -34,6 +34,7 @@ public:
 	virtual void OnRegisterSceneNode();
 	virtual void render();
 	virtual void OnAnimate(u32 timeMs);
+	virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
 	virtual const core::aabbox3d<f32>& getBoundingBox() const;
 
 	virtual u32 getMaterialCount() const;
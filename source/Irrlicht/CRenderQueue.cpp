@@ -0,0 +1,166 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CRenderQueue.h"
+#include <string.h>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! hash of all texture pointers of a material, equal for equal texture sets
+	u32 getTextureHash(const video::SMaterial& material)
+	{
+		u32 hash = 0;
+		for (u32 i=0; i<video::MATERIAL_MAX_TEXTURES; ++i)
+		{
+			const size_t texture = (size_t)material.getTexture(i);
+			hash = hash * 2654435761u + (u32)(texture >> 4) + (u32)((u64)texture >> 32);
+		}
+		return hash ^ (hash >> 16);
+	}
+
+	//! positive floats keep their order when compared as integers
+	u32 getDepthBits(f32 distanceSQ)
+	{
+		if (!(distanceSQ > 0.f))
+			return 0;
+		return IR(distanceSQ);
+	}
+}
+
+
+//! Creates a key from the pass, material and squared distance to the camera
+u64 CRenderQueue::makeKey(E_QUEUE_PASS pass, const video::SMaterial& material, f32 distanceSQ)
+{
+	const u64 materialType = (u64)(material.MaterialType & 0xfff);
+	const u64 textures = (u64)getTextureHash(material);
+	const u64 depth = (u64)getDepthBits(distanceSQ);
+
+	// pass:2 | material type:12 | textures:26 | depth front to back:24
+	if (pass == EQP_SOLID)
+		return ((u64)pass << 62) | (materialType << 50) | ((textures & 0x3ffffff) << 24) | (depth >> 8);
+
+	// pass:2 | depth back to front:30 | material type:12 | textures:20
+	return ((u64)pass << 62) | ((~(depth >> 2) & 0x3fffffff) << 32) | (materialType << 20) | (textures & 0xfffff);
+}
+
+
+//! Creates a key for a node without material from the pass and squared distance to the camera
+u64 CRenderQueue::makeKey(E_QUEUE_PASS pass, f32 distanceSQ)
+{
+	const u64 depth = (u64)getDepthBits(distanceSQ);
+
+	if (pass == EQP_SOLID)
+		return ((u64)pass << 62) | (depth >> 8);
+
+	return ((u64)pass << 62) | ((~(depth >> 2) & 0x3fffffff) << 32);
+}
+
+
+//! Adds a node which renders itself
+void CRenderQueue::push(u64 key, ISceneNode* node)
+{
+	push(key, node, 0, 0);
+}
+
+
+//! Adds a mesh buffer of a node
+void CRenderQueue::push(u64 key, ISceneNode* node, IMeshBuffer* buffer, const video::SMaterial* material)
+{
+	SKey k;
+	k.Key = key;
+	k.Index = Entries.size();
+	Keys.push_back(k);
+
+	SEntry e;
+	e.Node = node;
+	e.Buffer = buffer;
+	e.Material = material;
+	Entries.push_back(e);
+
+	const E_QUEUE_PASS pass = getPass(key);
+	if (node != LastNode[pass])
+	{
+		++NodeCount[pass];
+		LastNode[pass] = node;
+	}
+}
+
+
+//! Sorts all entries by their key
+void CRenderQueue::sort()
+{
+	const u32 count = Keys.size();
+	if (count < 2)
+		return;
+
+	SortBuffer.set_used(count);
+
+	// count all eight bytes of the keys in one go
+	u32 histogram[8][256];
+	memset(histogram, 0, sizeof(histogram));
+
+	u32 i;
+	for (i=0; i<count; ++i)
+	{
+		const u64 key = Keys[i].Key;
+		for (u32 b=0; b<8; ++b)
+			++histogram[b][(key >> (b*8)) & 0xff];
+	}
+
+	// stable sort by each byte, starting with the least significant
+	SKey* src = Keys.pointer();
+	SKey* dst = SortBuffer.pointer();
+
+	for (u32 b=0; b<8; ++b)
+	{
+		const u32 shift = b*8;
+		u32* h = histogram[b];
+
+		// all keys have the same value in this byte
+		if (h[(src[0].Key >> shift) & 0xff] == count)
+			continue;
+
+		u32 offset = 0;
+		for (i=0; i<256; ++i)
+		{
+			const u32 c = h[i];
+			h[i] = offset;
+			offset += c;
+		}
+
+		for (i=0; i<count; ++i)
+			dst[h[(src[i].Key >> shift) & 0xff]++] = src[i];
+
+		SKey* tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	if (src != Keys.pointer())
+		Keys.swap(SortBuffer);
+}
+
+
+//! Removes all entries, keeping the memory
+void CRenderQueue::clear()
+{
+	Keys.set_used(0);
+	Entries.set_used(0);
+
+	for (u32 i=0; i<EQP_COUNT; ++i)
+	{
+		NodeCount[i] = 0;
+		LastNode[i] = 0;
+	}
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
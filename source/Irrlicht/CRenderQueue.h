@@ -0,0 +1,107 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_RENDER_QUEUE_H_INCLUDED__
+#define __C_RENDER_QUEUE_H_INCLUDED__
+
+#include "irrArray.h"
+#include "SMaterial.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ISceneNode;
+	class IMeshBuffer;
+
+	//! Collects everything registered for rendering in one frame and sorts it by a 64 bit key.
+	/** The key contains the render pass in the highest bits. Solid
+	entries are then ordered by material type (which includes shaders),
+	textures and distance front to back, so the video driver changes its
+	states as rarely as possible. Transparent entries are ordered back to
+	front first and by material only for equal distances. Sorting is a
+	radix sort, which is linear in the amount of entries. */
+	class CRenderQueue
+	{
+	public:
+
+		//! Passes in the order they are rendered
+		enum E_QUEUE_PASS
+		{
+			EQP_SOLID = 0,
+			EQP_TRANSPARENT,
+			EQP_TRANSPARENT_EFFECT,
+
+			EQP_COUNT
+		};
+
+		//! An entry of the queue
+		struct SEntry
+		{
+			//! The node, whose absolute transformation is used for a buffer
+			ISceneNode* Node;
+			//! Buffer to draw, 0 if render() of the node has to be called
+			IMeshBuffer* Buffer;
+			//! Material of the buffer, 0 for nodes
+			const video::SMaterial* Material;
+		};
+
+		//! constructor
+		CRenderQueue() { clear(); }
+
+		//! Creates a key from the pass, material and squared distance to the camera
+		static u64 makeKey(E_QUEUE_PASS pass, const video::SMaterial& material, f32 distanceSQ);
+
+		//! Creates a key for a node without material from the pass and squared distance to the camera
+		static u64 makeKey(E_QUEUE_PASS pass, f32 distanceSQ);
+
+		//! Returns the pass a key belongs to
+		static E_QUEUE_PASS getPass(u64 key) { return (E_QUEUE_PASS)(key >> 62); }
+
+		//! Adds a node which renders itself
+		void push(u64 key, ISceneNode* node);
+
+		//! Adds a mesh buffer of a node
+		void push(u64 key, ISceneNode* node, IMeshBuffer* buffer, const video::SMaterial* material);
+
+		//! Sorts all entries by their key
+		void sort();
+
+		//! Returns amount of entries
+		u32 size() const { return Keys.size(); }
+
+		//! Returns the key of an entry in sorted order
+		u64 getKey(u32 index) const { return Keys[index].Key; }
+
+		//! Returns an entry in sorted order
+		const SEntry& operator[](u32 index) const { return Entries[Keys[index].Index]; }
+
+		//! Returns amount of nodes with entries in a pass
+		/** Buffers of a node pushed one after another count once. */
+		u32 getNodeCount(E_QUEUE_PASS pass) const { return NodeCount[pass]; }
+
+		//! Removes all entries, keeping the memory
+		void clear();
+
+	private:
+
+		struct SKey
+		{
+			u64 Key;
+			u32 Index;
+		};
+
+		core::array<SEntry> Entries;
+		core::array<SKey> Keys;
+		core::array<SKey> SortBuffer;
+
+		u32 NodeCount[EQP_COUNT];
+		const ISceneNode* LastNode[EQP_COUNT];
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
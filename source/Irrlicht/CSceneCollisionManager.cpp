@@ -10,6 +10,8 @@
 
 #include "os.h"
 #include "irrMath.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 namespace irr
 {
@@ -57,6 +59,8 @@ ISceneNode* CSceneCollisionManager::getSceneNodeFromRayBB(
 		const core::line3d<f32>& ray,
 		s32 idBitMask, bool noDebugObjects, scene::ISceneNode* root)
 {
+	IRR_PROFILE(CProfileScope p1(EPID_SM_COLLISION);)
+
 	ISceneNode* best = 0;
 	f32 dist = FLT_MAX;
 
@@ -229,6 +233,8 @@ ISceneNode* CSceneCollisionManager::getSceneNodeAndCollisionPointFromRay(
 						ISceneNode * collisionRootNode,
 						bool noDebugObjects)
 {
+	IRR_PROFILE(CProfileScope p1(EPID_SM_COLLISION);)
+
 	ISceneNode* bestNode = 0;
 	f32 bestDistanceSquared = FLT_MAX;
 
@@ -351,6 +357,8 @@ bool CSceneCollisionManager::getCollisionPoint(const core::line3d<f32>& ray,
 		core::triangle3df& outTriangle,
 		ISceneNode*& outNode)
 {
+	IRR_PROFILE(CProfileScope p1(EPID_SM_COLLISION);)
+
 	if (!selector)
 	{
 		_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
@@ -430,6 +438,8 @@ core::vector3df CSceneCollisionManager::getCollisionResultPosition(
 		f32 slidingSpeed,
 		const core::vector3df& gravity)
 {
+	IRR_PROFILE(CProfileScope p1(EPID_SM_COLLISION);)
+
 	return collideEllipsoidWithWorld(selector, position,
 		radius, direction, slidingSpeed, gravity, triout, hitPosition, outFalling, outNode);
 }
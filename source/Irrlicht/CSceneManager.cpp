@@ -8,6 +8,7 @@
 #include "IFileSystem.h"
 #include "SAnimatedMesh.h"
 #include "CMeshCache.h"
+#include "CClusteredLightManager.h"
 #include "IXMLWriter.h"
 #include "ISceneUserDataSerializer.h"
 #include "IGUIEnvironment.h"
@@ -17,6 +18,8 @@
 #include "ISceneLoader.h"
 
 #include "os.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 // We need this include for the case of skinned mesh support without
 // any such loader
@@ -140,6 +143,8 @@
 #include "CLightSceneNode.h"
 #include "CBillboardSceneNode.h"
 #include "CMeshSceneNode.h"
+#include "CInstancedMeshSceneNode.h"
+#include "CLODMeshSceneNode.h"
 #include "CSkyBoxSceneNode.h"
 #include "CSkyDomeSceneNode.h"
 #include "CParticleSystemSceneNode.h"
@@ -183,7 +188,12 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 		gui::ICursorControl* cursorControl, IMeshCache* cache,
 		gui::IGUIEnvironment* gui)
 : ISceneNode(0, 0), Driver(driver), FileSystem(fs), GUIEnvironment(gui),
-	CursorControl(cursorControl), CollisionManager(0),
+	CursorControl(cursorControl), CollisionManager(0), AnimationThreads(0),
+	FrustumCulling(false), SpatialIndex(0), SpatialIndexCulling(false), SpatialNodesTested(0),
+	SpatialNodesAccepted(0), SpatialNodesSkipped(0), OcclusionCuller(0),
+	OcclusionBufferSize(256,128), OcclusionCulling(false), OccludedNodes(0),
+	OcclusionQueryInterval(8), OcclusionQueryLatency(3), OcclusionQueryFrame(0),
+	AutomaticOcclusionQueries(false), OcclusionQueryCulling(false),
 	ActiveCamera(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0),
 	MeshCache(cache), CurrentRendertime(ESNRP_NONE), LightManager(0),
 	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
@@ -315,6 +325,7 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 CSceneManager::~CSceneManager()
 {
 	clearDeletionList();
+	clearImpostorUpdates();
 
 	//! force to remove hardwareTextures from the driver
 	//! because Scenes may hold internally data bounded to sceneNodes
@@ -360,6 +371,17 @@ CSceneManager::~CSceneManager()
 	if (LightManager)
 		LightManager->drop();
 
+	if (AnimationThreads)
+		AnimationThreads->drop();
+
+	delete SpatialIndex;
+
+	removeAllOccluders();
+	delete OcclusionCuller;
+	removeOcclusionProxies();
+
+	clearStaticBatches();
+
 	// remove all nodes and animators before dropping the driver
 	// as render targets may be destroyed twice
 
@@ -378,6 +400,8 @@ IAnimatedMesh* CSceneManager::getMesh(const io::path& filename)
 	if (msh)
 		return msh;
 
+	IRR_PROFILE(CProfileScope p1(EPID_SM_LOAD_MESH);)
+
 	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
 	if (!file)
 	{
@@ -425,6 +449,8 @@ IAnimatedMesh* CSceneManager::getMesh(io::IReadFile* file)
 	if (msh)
 		return msh;
 
+	IRR_PROFILE(CProfileScope p1(EPID_SM_LOAD_MESH);)
+
 	// iterate the list in reverse order so user-added loaders can override the built-in ones
 	s32 count = MeshLoaderList.size();
 	for (s32 i=count-1; i>=0; --i)
@@ -610,6 +636,225 @@ IMeshSceneNode* CSceneManager::addMeshSceneNode(IMesh* mesh, ISceneNode* parent,
 }
 
 
+//! Adds a scene node for rendering many instances of a static mesh.
+IInstancedMeshSceneNode* CSceneManager::addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale)
+{
+	if (!parent)
+		parent = this;
+
+	IInstancedMeshSceneNode* node = new CInstancedMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
+//! Adds a scene node which draws less detailed versions of a static mesh when it gets small.
+ILODMeshSceneNode* CSceneManager::addLODMeshSceneNode(IMesh* mesh, u32 levelCount,
+	f32 triangleRatio, ISceneNode* parent, s32 id, const core::vector3df& position,
+	const core::vector3df& rotation, const core::vector3df& scale)
+{
+	if (!mesh)
+		return 0;
+
+	if (!parent)
+		parent = this;
+
+	ILODMeshSceneNode* node = new CLODMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	core::array<IMesh*> levels;
+	getMeshManipulator()->createLODMeshes(mesh, levels, levelCount, triangleRatio);
+
+	// the projected area of a triangle shrinks with the square of the size
+	const f32 sizeFactor = sqrtf(core::clamp(triangleRatio, 0.f, 1.f));
+	f32 screenSize = 0.5f;
+	for (u32 i=0; i<levels.size(); ++i)
+	{
+		node->addLevel(levels[i], screenSize);
+		levels[i]->drop();
+		screenSize *= sizeFactor;
+	}
+
+	return node;
+}
+
+
+namespace
+{
+	//! a node to batch and the grid cell it belongs to
+	struct SBatchCellEntry
+	{
+		u64 Cell;
+		u32 Node;
+
+		bool operator<(const SBatchCellEntry& other) const
+		{
+			return Cell < other.Cell || (Cell == other.Cell && Node < other.Node);
+		}
+	};
+}
+
+
+//! Merges static mesh scene nodes into a few batched nodes.
+ISceneNode* CSceneManager::batchStaticMeshes(const core::array<ISceneNode*>& nodes,
+	f32 cellSize, bool allow32BitIndices)
+{
+	if (!Driver)
+		return 0;
+
+	// find the nodes which can be batched and their cells
+	core::array<IMeshSceneNode*> batched;
+	core::array<SBatchCellEntry> cells;
+	u32 i;
+	for (i=0; i<nodes.size(); ++i)
+	{
+		ISceneNode* node = nodes[i];
+		if (!node || node->getType() != ESNT_MESH || !node->getParent() ||
+			!node->isVisible() || !node->getChildren().empty())
+			continue;
+
+		IMeshSceneNode* meshNode = static_cast<IMeshSceneNode*>(node);
+		if (!meshNode->getMesh())
+			continue;
+
+		bool transparent = false;
+		for (u32 m=0; m<node->getMaterialCount() && !transparent; ++m)
+		{
+			video::IMaterialRenderer* rnd = Driver->getMaterialRenderer(node->getMaterial(m).MaterialType);
+			transparent = rnd && rnd->isTransparent();
+		}
+		if (transparent)
+			continue;
+
+		// the same node may be passed twice
+		if (batched.linear_search(meshNode) != -1)
+			continue;
+
+		node->updateAbsolutePosition();
+
+		SBatchCellEntry entry;
+		entry.Cell = 0;
+		entry.Node = batched.size();
+		if (cellSize > 0.f)
+		{
+			const core::vector3df center = node->getTransformedBoundingBox().getCenter() / cellSize;
+			entry.Cell = ((u64)(core::floor32(center.X) & 0x1fffff) << 42) |
+				((u64)(core::floor32(center.Y) & 0x1fffff) << 21) |
+				(u64)(core::floor32(center.Z) & 0x1fffff);
+		}
+		cells.push_back(entry);
+		batched.push_back(meshNode);
+	}
+
+	if (batched.empty())
+		return 0;
+
+	cells.sort();
+
+	ISceneNode* batch = addEmptySceneNode(this);
+	IMeshManipulator* manipulator = Driver->getMeshManipulator();
+
+	core::array<const IMesh*> meshes;
+	core::array<core::matrix4> transforms;
+	core::array<const video::SMaterial*> materials;
+	for (i=0; i<cells.size(); )
+	{
+		meshes.set_used(0);
+		transforms.set_used(0);
+		materials.set_used(0);
+
+		const u64 cell = cells[i].Cell;
+		for (; i<cells.size() && cells[i].Cell == cell; ++i)
+		{
+			IMeshSceneNode* node = batched[cells[i].Node];
+			meshes.push_back(node->getMesh());
+			transforms.push_back(node->getAbsoluteTransformation());
+			materials.push_back(node->isReadOnlyMaterials() ? 0 : &node->getMaterial(0));
+		}
+
+		IMesh* mesh = manipulator->createBatchedMesh(meshes.const_pointer(),
+			transforms.const_pointer(), materials.const_pointer(), meshes.size(), allow32BitIndices);
+		if (mesh->getMeshBufferCount())
+			addMeshSceneNode(mesh, batch)->setReadOnlyMaterials(true);
+		mesh->drop();
+	}
+
+	// keep the original nodes for unbatching
+	SStaticBatch record;
+	record.Batch = batch;
+	batch->grab();
+	for (i=0; i<batched.size(); ++i)
+	{
+		ISceneNode* node = batched[i];
+		ISceneNode* parent = node->getParent();
+
+		// the root must not be grabbed, it would never be deleted
+		if (parent == this)
+			parent = 0;
+		else
+			parent->grab();
+
+		node->grab();
+		node->remove();
+
+		record.Nodes.push_back(node);
+		record.Parents.push_back(parent);
+	}
+	StaticBatches.push_back(record);
+
+	return batch;
+}
+
+
+//! Restores the nodes of a batch created with batchStaticMeshes().
+bool CSceneManager::unbatchStaticMeshes(ISceneNode* batch)
+{
+	for (u32 i=0; i<StaticBatches.size(); ++i)
+	{
+		SStaticBatch& record = StaticBatches[i];
+		if (record.Batch != batch)
+			continue;
+
+		for (u32 n=0; n<record.Nodes.size(); ++n)
+		{
+			ISceneNode* parent = record.Parents[n];
+			(parent ? parent : this)->addChild(record.Nodes[n]);
+			record.Nodes[n]->drop();
+			if (parent)
+				parent->drop();
+		}
+
+		batch->remove();
+		batch->drop();
+		StaticBatches.erase(i);
+		return true;
+	}
+
+	return false;
+}
+
+
+//! drops the original nodes of all static batches
+void CSceneManager::clearStaticBatches()
+{
+	for (u32 i=0; i<StaticBatches.size(); ++i)
+	{
+		SStaticBatch& record = StaticBatches[i];
+		for (u32 n=0; n<record.Nodes.size(); ++n)
+		{
+			record.Nodes[n]->drop();
+			if (record.Parents[n])
+				record.Parents[n]->drop();
+		}
+		record.Batch->drop();
+	}
+	StaticBatches.clear();
+}
+
+
 //! Adds a scene node for rendering a animated water surface mesh.
 ISceneNode* CSceneManager::addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 waveLength,
 	ISceneNode* parent, s32 id, const core::vector3df& position,
@@ -1165,60 +1410,141 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 	}
 	bool result = false;
 
-	// has occlusion query information
-	if (node->getAutomaticCulling() & scene::EAC_OCC_QUERY)
+	// the region of the spatial index the node is in was already tested
+	CSceneNodeOctree::E_NODE_VISIBILITY visibility = CSceneNodeOctree::ENV_UNKNOWN;
+	if (SpatialIndexCulling)
 	{
-		result = (Driver->getOcclusionQueryResult(const_cast<ISceneNode*>(node))==0);
+		visibility = SpatialIndex->getVisibility(node, node->SpatialIndexHandle);
+		if (visibility == CSceneNodeOctree::ENV_CULLED)
+		{
+			++SpatialNodesSkipped;
+			_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
+			return true;
+		}
+
+		if (visibility == CSceneNodeOctree::ENV_INSIDE)
+			++SpatialNodesAccepted;
+		else
+			++SpatialNodesTested;
 	}
 
-	// can be seen by a bounding box ?
-	if (!result && (node->getAutomaticCulling() & scene::EAC_BOX))
+	// nodes completely inside of the frustum need no further frustum tests
+	if (visibility == CSceneNodeOctree::ENV_INSIDE)
 	{
-		core::aabbox3d<f32> tbox = node->getBoundingBox();
-		node->getAbsoluteTransformation().transformBoxEx(tbox);
-		result = !(tbox.intersectsWithBox(cam->getViewFrustum()->getBoundingBox() ));
+		_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
+		return isOccluded(node);
+	}
+
+	u8 hint = 0;
+	u8& planeHint = (visibility == CSceneNodeOctree::ENV_PARTIAL) ?
+		SpatialIndex->getPlaneHint(node->SpatialIndexHandle) : hint;
+
+	// the planes are only set up here when called outside of drawAll()
+	CFrustumCuller ownCuller;
+	const CFrustumCuller* culler = &FrustumCuller;
+	if (!FrustumCulling && (node->getAutomaticCulling() & (scene::EAC_FRUSTUM_SPHERE | scene::EAC_FRUSTUM_BOX)))
+	{
+		ownCuller.setFrustum(*cam->getViewFrustum());
+		culler = &ownCuller;
 	}
 
-	// can be seen by a bounding sphere
+	// can be seen by a bounding sphere ? This is the cheapest test, so it is done first
 	if (!result && (node->getAutomaticCulling() & scene::EAC_FRUSTUM_SPHERE))
-	{ // requires bbox diameter
+	{
+		core::vector3df center;
+		f32 radius;
+		node->getTransformedBoundingSphere(center, radius);
+		result = culler->isSphereCulled(center, radius, planeHint);
+	}
+
+	// can be seen by a bounding box ?
+	if (!result && (node->getAutomaticCulling() & scene::EAC_BOX))
+	{
+		core::aabbox3d<f32> tbox;
+		if (visibility == CSceneNodeOctree::ENV_PARTIAL)
+			tbox = SpatialIndex->getBox(node->SpatialIndexHandle);
+		else
+		{
+			tbox = node->getBoundingBox();
+			node->getAbsoluteTransformation().transformBoxEx(tbox);
+		}
+		result = !(tbox.intersectsWithBox(cam->getViewFrustum()->getBoundingBox() ));
 	}
 
 	// can be seen by cam pyramid planes ?
 	if (!result && (node->getAutomaticCulling() & scene::EAC_FRUSTUM_BOX))
 	{
-		SViewFrustum frust = *cam->getViewFrustum();
+		// the box is tested in world space, so neither the matrix
+		// has to be inverted nor the frustum transformed
+		result = culler->isBoxCulled(node->getBoundingBox(), node->getAbsoluteTransformation(), planeHint);
+	}
+
+	// hidden behind other objects ? Done last, as automatic occlusion
+	// queries are only run for nodes in the frustum
+	if (!result)
+		result = isOccluded(node);
+
+	_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
+	return result;
+}
 
-		//transform the frustum to the node's current absolute transformation
-		core::matrix4 invTrans(node->getAbsoluteTransformation(), core::matrix4::EM4CONST_INVERSE);
-		//invTrans.makeInverse();
-		frust.transform(invTrans);
 
-		core::vector3df edges[8];
-		node->getBoundingBox().getEdges(edges);
+//! checks if a node is hidden by occlusion queries or the occluders of this frame
+bool CSceneManager::isOccluded(const ISceneNode* node) const
+{
+	const u32 culling = node->getAutomaticCulling();
 
-		for (s32 i=0; i<scene::SViewFrustum::VF_PLANE_COUNT; ++i)
-		{
-			bool boxInFrustum=false;
-			for (u32 j=0; j<8; ++j)
-			{
-				if (frust.planes[i].classifyPointRelation(edges[j]) != core::ISREL3D_FRONT)
-				{
-					boxInFrustum=true;
-					break;
-				}
-			}
+	// has occlusion query information
+	if ((culling & scene::EAC_OCC_QUERY) && isOccludedByQuery(node))
+		return true;
 
-			if (!boxInFrustum)
-			{
-				result = true;
-				break;
-			}
-		}
-	}
+	// the software occlusion test is the most expensive one
+	if (!(culling & scene::EAC_OCC_SOFTWARE) || !OcclusionCulling)
+		return false;
 
-	_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
-	return result;
+	if (!OcclusionCuller->isBoxOccluded(node->getBoundingBox(), node->getAbsoluteTransformation()))
+		return false;
+
+	++OccludedNodes;
+	return true;
+}
+
+
+//! checks the occlusion query result of a node
+bool CSceneManager::isOccludedByQuery(const ISceneNode* node) const
+{
+	ISceneNode* queryNode = const_cast<ISceneNode*>(node);
+	if (!OcclusionQueryCulling)
+		return (Driver->getOcclusionQueryResult(queryNode)==0);
+
+	// the query is run after the solid objects were drawn
+	OcclusionQueryNodes.push_back(queryNode);
+
+	const s32 index = OcclusionProxies.binary_search(SOcclusionProxy(queryNode));
+	if (index == -1)
+		return false;
+
+	// results of nodes outside of the frustum in the last frame are outdated
+	if (OcclusionProxies[index].UsedFrame + 1 != OcclusionQueryFrame)
+		return false;
+
+	// the box of the query can't be seen from inside
+	if (isCameraInsideNode(node))
+		return false;
+
+	return (Driver->getOcclusionQueryResult(queryNode)==0);
+}
+
+
+//! checks if the camera is inside of the bounding box of a node
+bool CSceneManager::isCameraInsideNode(const ISceneNode* node) const
+{
+	// the near plane must not cut the box either
+	const f32 margin = ActiveCamera->getNearValue() * 2.f;
+	core::aabbox3df box = node->getTransformedBoundingBox();
+	box.MinEdge -= core::vector3df(margin);
+	box.MaxEdge += core::vector3df(margin);
+	return box.isPointInside(camWorldPos);
 }
 
 
@@ -1265,21 +1591,21 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	case ESNRP_SOLID:
 		if (!isCulled(node))
 		{
-			SolidNodeList.push_back(node);
+			RenderQueue.push(getRenderQueueKey(CRenderQueue::EQP_SOLID, node), node);
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT:
 		if (!isCulled(node))
 		{
-			TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			RenderQueue.push(getRenderQueueKey(CRenderQueue::EQP_TRANSPARENT, node), node);
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT_EFFECT:
 		if (!isCulled(node))
 		{
-			TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			RenderQueue.push(getRenderQueueKey(CRenderQueue::EQP_TRANSPARENT_EFFECT, node), node);
 			taken = 1;
 		}
 		break;
@@ -1296,8 +1622,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 				if (rnd && rnd->isTransparent())
 				{
 					// register as transparent node
-					TransparentNodeEntry e(node, camWorldPos);
-					TransparentNodeList.push_back(e);
+					RenderQueue.push(getRenderQueueKey(CRenderQueue::EQP_TRANSPARENT, node), node);
 					taken = 1;
 					break;
 				}
@@ -1306,7 +1631,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 			// not transparent, register as solid
 			if (!taken)
 			{
-				SolidNodeList.push_back(node);
+				RenderQueue.push(getRenderQueueKey(CRenderQueue::EQP_SOLID, node), node);
 				taken = 1;
 			}
 		}
@@ -1338,6 +1663,102 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 }
 
 
+//! Registers the mesh buffers of a node for rendering.
+u32 CSceneManager::registerMeshForRendering(ISceneNode* node, IMesh* mesh, const video::SMaterial* materials)
+{
+	u32 taken = 0;
+
+	if (!isCulled(node))
+	{
+		const f32 distanceSQ = node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camWorldPos);
+
+		for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = mesh->getMeshBuffer(i);
+			if (!mb)
+				continue;
+
+			const video::SMaterial& material = materials ? materials[i] : mb->getMaterial();
+			video::IMaterialRenderer* rnd = Driver->getMaterialRenderer(material.MaterialType);
+			const CRenderQueue::E_QUEUE_PASS pass = (rnd && rnd->isTransparent()) ?
+				CRenderQueue::EQP_TRANSPARENT : CRenderQueue::EQP_SOLID;
+
+			RenderQueue.push(CRenderQueue::makeKey(pass, material, distanceSQ), node, mb, &material);
+			++taken;
+		}
+	}
+
+#ifdef _IRR_SCENEMANAGER_DEBUG
+	s32 index = Parameters.findAttribute ( "calls" );
+	Parameters.setAttribute ( index, Parameters.getAttributeAsInt ( index ) + 1 );
+
+	if (!taken)
+	{
+		index = Parameters.findAttribute ( "culled" );
+		Parameters.setAttribute ( index, Parameters.getAttributeAsInt ( index ) + 1 );
+	}
+#endif
+
+	return taken;
+}
+
+
+//! returns the key of a node which renders itself in the render queue
+u64 CSceneManager::getRenderQueueKey(CRenderQueue::E_QUEUE_PASS pass, ISceneNode* node) const
+{
+	const f32 distanceSQ = node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camWorldPos);
+
+	if (node->getMaterialCount())
+		return CRenderQueue::makeKey(pass, node->getMaterial(0), distanceSQ);
+
+	return CRenderQueue::makeKey(pass, distanceSQ);
+}
+
+
+//! renders all entries of a pass from the sorted render queue
+void CSceneManager::renderQueuePass(u32& index, CRenderQueue::E_QUEUE_PASS pass)
+{
+	const ISceneNode* transformNode = 0;
+	ISceneNode* lightNode = 0;
+
+	for (; index<RenderQueue.size() && CRenderQueue::getPass(RenderQueue.getKey(index)) == pass; ++index)
+	{
+		const CRenderQueue::SEntry& e = RenderQueue[index];
+
+		// the light manager sees each run of buffers of a node once
+		if (LightManager && e.Node != lightNode)
+		{
+			if (lightNode)
+				LightManager->OnNodePostRender(lightNode);
+			LightManager->OnNodePreRender(e.Node);
+			lightNode = e.Node;
+			transformNode = 0;
+		}
+
+		if (e.Buffer)
+		{
+			// buffers of one node often follow each other
+			if (e.Node != transformNode)
+			{
+				Driver->setTransform(video::ETS_WORLD, e.Node->getAbsoluteTransformation());
+				transformNode = e.Node;
+			}
+
+			Driver->setMaterial(*e.Material);
+			Driver->drawMeshBuffer(e.Buffer);
+		}
+		else
+		{
+			e.Node->render();
+			transformNode = 0;
+		}
+	}
+
+	if (lightNode)
+		LightManager->OnNodePostRender(lightNode);
+}
+
+
 //! This method is called just before the rendering process of the whole scene.
 //! draws all scene nodes
 void CSceneManager::drawAll()
@@ -1345,6 +1766,8 @@ void CSceneManager::drawAll()
 	if (!Driver)
 		return;
 
+	IRR_PROFILE(CProfileScope p1(EPID_SM_DRAW_ALL);)
+
 #ifdef _IRR_SCENEMANAGER_DEBUG
 	// reset attributes
 	Parameters.setAttribute ( "culled", 0 );
@@ -1352,10 +1775,20 @@ void CSceneManager::drawAll()
 	Parameters.setAttribute ( "drawn_solid", 0 );
 	Parameters.setAttribute ( "drawn_transparent", 0 );
 	Parameters.setAttribute ( "drawn_transparent_effect", 0 );
+	Parameters.setAttribute ( "spatial_cells_tested", 0 );
+	Parameters.setAttribute ( "spatial_nodes_tested", 0 );
+	Parameters.setAttribute ( "spatial_nodes_accepted", 0 );
+	Parameters.setAttribute ( "spatial_nodes_skipped", 0 );
+	Parameters.setAttribute ( "occlusion_queries_run", 0 );
 #endif
 
 	u32 i; // new ISO for scoping problem in some compilers
 
+	// the render targets are switched before anything of the frame is
+	// drawn, the software drivers share the depth buffer with the frame
+	if (!ImpostorUpdates.empty())
+		updateImpostors();
+
 	// reset all transforms
 	Driver->setMaterial(video::SMaterial());
 	Driver->setTransform ( video::ETS_PROJECTION, core::IdentityMatrix );
@@ -1368,7 +1801,12 @@ void CSceneManager::drawAll()
 	Driver->setAllowZWriteOnTransparent(Parameters.getAttributeAsBool( ALLOW_ZWRITE_ON_TRANSPARENT) );
 
 	// do animations and other stuff.
-	OnAnimate(os::Timer::getTime());
+	IRR_PROFILE(getProfiler().start(EPID_SM_ANIMATE);)
+	if (AnimationThreads)
+		animateParallel(os::Timer::getTime());
+	else
+		OnAnimate(os::Timer::getTime());
+	IRR_PROFILE(getProfiler().stop(EPID_SM_ANIMATE);)
 
 	/*!
 		First Scene Node for prerendering should be the active camera
@@ -1379,16 +1817,77 @@ void CSceneManager::drawAll()
 	{
 		ActiveCamera->render();
 		camWorldPos = ActiveCamera->getAbsolutePosition();
+
+		// all nodes of this frame are tested against the same planes
+		FrustumCuller.setFrustum(*ActiveCamera->getViewFrustum());
+		FrustumCulling = true;
+	}
+
+	// fill the depth buffer for software occlusion culling
+	if (OcclusionCuller && ActiveCamera && !Occluders.empty())
+	{
+		IRR_PROFILE(CProfileScope p1(EPID_SM_OCCLUSION);)
+		drawOccluders();
+	}
+
+	IRR_PROFILE(getProfiler().start(EPID_SM_REGISTER);)
+
+	// sort the nodes into the spatial index and test its regions
+	if (SpatialIndex && ActiveCamera)
+	{
+		SpatialIndex->beginUpdate();
+		updateSpatialIndex(this);
+		SpatialIndex->endUpdate();
+		SpatialIndex->cull(*ActiveCamera->getViewFrustum());
+
+		SpatialNodesTested = 0;
+		SpatialNodesAccepted = 0;
+		SpatialNodesSkipped = 0;
+		SpatialIndexCulling = true;
+	}
+
+	// collect the nodes for automatic occlusion queries while culling
+	if (AutomaticOcclusionQueries && ActiveCamera && Driver->queryFeature(video::EVDF_OCCLUSION_QUERY))
+	{
+		++OcclusionQueryFrame;
+		updateOcclusionQueries();
+		OcclusionQueryCulling = true;
 	}
 
 	// let all nodes register themselves
 	OnRegisterSceneNode();
 
+	OcclusionQueryCulling = false;
+	FrustumCulling = false;
+
+	if (SpatialIndexCulling)
+	{
+		SpatialIndexCulling = false;
+#ifdef _IRR_SCENEMANAGER_DEBUG
+		Parameters.setAttribute ( "spatial_cells_tested", (s32) SpatialIndex->getCellsTested() );
+		Parameters.setAttribute ( "spatial_nodes_tested", (s32) SpatialNodesTested );
+		Parameters.setAttribute ( "spatial_nodes_accepted", (s32) SpatialNodesAccepted );
+		Parameters.setAttribute ( "spatial_nodes_skipped", (s32) SpatialNodesSkipped );
+#endif
+	}
+
+	if (OcclusionCulling)
+	{
+		OcclusionCulling = false;
+#ifdef _IRR_SCENEMANAGER_DEBUG
+		Parameters.setAttribute ( "occluder_triangles", (s32) OcclusionCuller->getDrawnTriangleCount() );
+		Parameters.setAttribute ( "occluded_nodes", (s32) OccludedNodes );
+#endif
+	}
+
+	IRR_PROFILE(getProfiler().stop(EPID_SM_REGISTER);)
+
 	if (LightManager)
 		LightManager->OnPreRender(LightList);
 
 	//render camera scenes
 	{
+		IRR_PROFILE(CProfileScope psc(EPID_SM_RENDER_CAMERAS);)
 		CurrentRendertime = ESNRP_CAMERA;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
@@ -1406,6 +1905,7 @@ void CSceneManager::drawAll()
 
 	//render lights scenes
 	{
+		IRR_PROFILE(CProfileScope psl(EPID_SM_RENDER_LIGHTS);)
 		CurrentRendertime = ESNRP_LIGHT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
@@ -1450,6 +1950,7 @@ void CSceneManager::drawAll()
 
 	// render skyboxes
 	{
+		IRR_PROFILE(CProfileScope psb(EPID_SM_RENDER_SKYBOXES);)
 		CurrentRendertime = ESNRP_SKY_BOX;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
@@ -1477,41 +1978,36 @@ void CSceneManager::drawAll()
 	}
 
 
+	// sort by pass, material and distance from camera
+	RenderQueue.sort();
+	u32 queueIndex = 0;
+
 	// render default objects
 	{
+		IRR_PROFILE(CProfileScope psd(EPID_SM_RENDER_SOLID);)
 		CurrentRendertime = ESNRP_SOLID;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
-		SolidNodeList.sort(); // sort by textures
-
 		if (LightManager)
-		{
 			LightManager->OnRenderPassPreRender(CurrentRendertime);
-			for (i=0; i<SolidNodeList.size(); ++i)
-			{
-				ISceneNode* node = SolidNodeList[i].Node;
-				LightManager->OnNodePreRender(node);
-				node->render();
-				LightManager->OnNodePostRender(node);
-			}
-		}
-		else
-		{
-			for (i=0; i<SolidNodeList.size(); ++i)
-				SolidNodeList[i].Node->render();
-		}
+
+		renderQueuePass(queueIndex, CRenderQueue::EQP_SOLID);
 
 #ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters.setAttribute("drawn_solid", (s32) SolidNodeList.size() );
+		Parameters.setAttribute("drawn_solid", (s32) RenderQueue.getNodeCount(CRenderQueue::EQP_SOLID) );
 #endif
-		SolidNodeList.set_used(0);
 
 		if (LightManager)
 			LightManager->OnRenderPassPostRender(CurrentRendertime);
 	}
 
+	// test the boxes of the nodes against the depth of the solid objects
+	if (!OcclusionQueryNodes.empty())
+		runOcclusionQueries();
+
 	// render shadows
 	{
+		IRR_PROFILE(CProfileScope pss(EPID_SM_RENDER_SHADOWS);)
 		CurrentRendertime = ESNRP_SHADOW;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
@@ -1544,32 +2040,18 @@ void CSceneManager::drawAll()
 
 	// render transparent objects.
 	{
+		IRR_PROFILE(CProfileScope pst(EPID_SM_RENDER_TRANSPARENT);)
 		CurrentRendertime = ESNRP_TRANSPARENT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
-		TransparentNodeList.sort(); // sort by distance from camera
 		if (LightManager)
-		{
 			LightManager->OnRenderPassPreRender(CurrentRendertime);
 
-			for (i=0; i<TransparentNodeList.size(); ++i)
-			{
-				ISceneNode* node = TransparentNodeList[i].Node;
-				LightManager->OnNodePreRender(node);
-				node->render();
-				LightManager->OnNodePostRender(node);
-			}
-		}
-		else
-		{
-			for (i=0; i<TransparentNodeList.size(); ++i)
-				TransparentNodeList[i].Node->render();
-		}
+		renderQueuePass(queueIndex, CRenderQueue::EQP_TRANSPARENT);
 
 #ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters.setAttribute ( "drawn_transparent", (s32) TransparentNodeList.size() );
+		Parameters.setAttribute ( "drawn_transparent", (s32) RenderQueue.getNodeCount(CRenderQueue::EQP_TRANSPARENT) );
 #endif
-		TransparentNodeList.set_used(0);
 
 		if (LightManager)
 			LightManager->OnRenderPassPostRender(CurrentRendertime);
@@ -1577,34 +2059,22 @@ void CSceneManager::drawAll()
 
 	// render transparent effect objects.
 	{
+		IRR_PROFILE(CProfileScope pse(EPID_SM_RENDER_EFFECT);)
 		CurrentRendertime = ESNRP_TRANSPARENT_EFFECT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRendertime) != 0);
 
-		TransparentEffectNodeList.sort(); // sort by distance from camera
-
 		if (LightManager)
-		{
 			LightManager->OnRenderPassPreRender(CurrentRendertime);
 
-			for (i=0; i<TransparentEffectNodeList.size(); ++i)
-			{
-				ISceneNode* node = TransparentEffectNodeList[i].Node;
-				LightManager->OnNodePreRender(node);
-				node->render();
-				LightManager->OnNodePostRender(node);
-			}
-		}
-		else
-		{
-			for (i=0; i<TransparentEffectNodeList.size(); ++i)
-				TransparentEffectNodeList[i].Node->render();
-		}
+		renderQueuePass(queueIndex, CRenderQueue::EQP_TRANSPARENT_EFFECT);
+
 #ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters.setAttribute ( "drawn_transparent_effect", (s32) TransparentEffectNodeList.size() );
+		Parameters.setAttribute ( "drawn_transparent_effect", (s32) RenderQueue.getNodeCount(CRenderQueue::EQP_TRANSPARENT_EFFECT) );
 #endif
-		TransparentEffectNodeList.set_used(0);
 	}
 
+	RenderQueue.clear();
+
 	if (LightManager)
 		LightManager->OnPostRender();
 
@@ -1614,6 +2084,411 @@ void CSceneManager::drawAll()
 	CurrentRendertime = ESNRP_NONE;
 }
 
+//! Sets the number of threads used to animate the scene in drawAll().
+void CSceneManager::setAnimationThreadCount(u32 threadCount)
+{
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	if (threadCount == 0)
+		threadCount = CThreadPool::getProcessorCount();
+
+	if (threadCount == getAnimationThreadCount())
+		return;
+
+	if (AnimationThreads)
+		AnimationThreads->drop();
+	AnimationThreads = 0;
+
+	if (threadCount > 1)
+		AnimationThreads = new CThreadPool(threadCount);
+#endif
+}
+
+
+//! Get the number of threads used to animate the scene.
+u32 CSceneManager::getAnimationThreadCount() const
+{
+	return AnimationThreads ? AnimationThreads->getThreadCount() : 1;
+}
+
+
+//! animates the scene graph, spreading subtrees over the animation threads
+void CSceneManager::animateParallel(u32 timeMs)
+{
+	if (!IsVisible)
+		return;
+
+	// the root node itself is animated like in ISceneNode::OnAnimate
+	ISceneNodeAnimatorList::Iterator ait = Animators.begin();
+	while (ait != Animators.end())
+	{
+		ISceneNodeAnimator* anim = *ait;
+		++ait;
+		anim->animateNode(this, timeMs);
+	}
+
+	if (TransformationDirty)
+		updateAbsolutePosition();
+
+	ParallelAnimationNodes.set_used(0);
+	SerialAnimationNodes.set_used(0);
+
+	ISceneNodeList::Iterator it = Children.begin();
+	for (; it != Children.end(); ++it)
+	{
+		if (isSubtreeAnimationThreadSafe(*it))
+			ParallelAnimationNodes.push_back(*it);
+		else
+			SerialAnimationNodes.push_back(*it);
+	}
+
+	// all jobs are finished when run returns, this is the barrier
+	// before the nodes are registered for rendering
+	SAnimationJob job(ParallelAnimationNodes);
+	job.TimeMs = timeMs;
+	AnimationThreads->run(&job, ParallelAnimationNodes.size());
+
+	// Those might be removed from the scene while being animated
+	// (e.g. by a delete animator), so keep them alive
+	u32 i;
+	for (i=0; i<SerialAnimationNodes.size(); ++i)
+		SerialAnimationNodes[i]->grab();
+
+	for (i=0; i<SerialAnimationNodes.size(); ++i)
+	{
+		SerialAnimationNodes[i]->OnAnimate(timeMs);
+		SerialAnimationNodes[i]->drop();
+	}
+
+	SerialAnimationNodes.set_used(0);
+	ParallelAnimationNodes.set_used(0);
+}
+
+
+//! Enables or disables the spatial index used for culling.
+void CSceneManager::setSpatialIndex(bool enable, const core::aabbox3df& worldBox, u32 maxDepth)
+{
+	delete SpatialIndex;
+	SpatialIndex = 0;
+
+	if (enable)
+		SpatialIndex = new CSceneNodeOctree(worldBox, maxDepth);
+}
+
+
+//! Checks if the spatial index is used for culling.
+bool CSceneManager::isSpatialIndexEnabled() const
+{
+	return SpatialIndex != 0;
+}
+
+
+//! Adds an occluder for software occlusion culling.
+void CSceneManager::addOccluder(ISceneNode* node, IMesh* mesh)
+{
+	if (!node)
+		return;
+
+	if (!mesh)
+	{
+		switch (node->getType())
+		{
+		case ESNT_MESH:
+		case ESNT_OCTREE:
+		case ESNT_CUBE:
+		case ESNT_SPHERE:
+			mesh = static_cast<IMeshSceneNode*>(node)->getMesh();
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (!mesh)
+	{
+		os::Printer::log("Could not add occluder, no mesh.", ELL_WARNING);
+		return;
+	}
+
+	if (!OcclusionCuller)
+		OcclusionCuller = new COcclusionCuller(OcclusionBufferSize);
+
+	SOccluder occluder;
+	occluder.Node = node;
+	occluder.Mesh = mesh;
+	node->grab();
+	mesh->grab();
+	Occluders.push_back(occluder);
+}
+
+
+//! Removes all occluders of a node.
+bool CSceneManager::removeOccluder(ISceneNode* node)
+{
+	bool found = false;
+	for (u32 i=0; i<Occluders.size();)
+	{
+		if (Occluders[i].Node == node)
+		{
+			Occluders[i].Node->drop();
+			Occluders[i].Mesh->drop();
+			Occluders.erase(i);
+			found = true;
+		}
+		else
+			++i;
+	}
+
+	return found;
+}
+
+
+//! Removes all occluders.
+void CSceneManager::removeAllOccluders()
+{
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		Occluders[i].Node->drop();
+		Occluders[i].Mesh->drop();
+	}
+
+	Occluders.clear();
+}
+
+
+//! Sets the resolution of the depth buffer for software occlusion culling.
+void CSceneManager::setOcclusionBufferSize(const core::dimension2du& size)
+{
+	OcclusionBufferSize = size;
+	if (OcclusionCuller)
+		OcclusionCuller->setSize(size);
+}
+
+
+//! Gets the resolution of the depth buffer for software occlusion culling.
+const core::dimension2du& CSceneManager::getOcclusionBufferSize() const
+{
+	return OcclusionBufferSize;
+}
+
+
+//! Enables automatic hardware occlusion queries.
+void CSceneManager::setAutomaticOcclusionQueries(bool enable, u32 visibleTestInterval, u32 maxLatency)
+{
+	if (!enable)
+		removeOcclusionProxies();
+
+	AutomaticOcclusionQueries = enable;
+	OcclusionQueryInterval = core::max_(visibleTestInterval, 1u);
+	OcclusionQueryLatency = maxLatency;
+}
+
+
+//! Checks if drawAll() manages the occlusion queries.
+bool CSceneManager::isAutomaticOcclusionQueryEnabled() const
+{
+	return AutomaticOcclusionQueries;
+}
+
+
+//! waits for results which are too late and removes unused proxies
+void CSceneManager::updateOcclusionQueries()
+{
+	for (u32 i=0; i<OcclusionProxies.size();)
+	{
+		SOcclusionProxy& proxy = OcclusionProxies[i];
+
+		// outside of the frustum or removed from the scene for a while,
+		// this is well below the 1000 frames after which the driver
+		// removes queries which were not run
+		if (OcclusionQueryFrame - proxy.UsedFrame > 250)
+		{
+			// removing the query clears the culling flag of the node
+			const u32 culling = proxy.Node->getAutomaticCulling();
+			Driver->removeOcclusionQuery(proxy.Node);
+			proxy.Node->setAutomaticCulling(culling);
+
+			proxy.Node->drop();
+			proxy.Mesh->drop();
+			OcclusionProxies.erase(i);
+			continue;
+		}
+
+		if (OcclusionQueryFrame - proxy.RunFrame >= OcclusionQueryLatency &&
+			Driver->isOcclusionQueryPending(proxy.Node))
+			Driver->updateOcclusionQuery(proxy.Node, true);
+
+		++i;
+	}
+}
+
+
+//! runs the queries of the nodes in the view frustum
+void CSceneManager::runOcclusionQueries()
+{
+	// nodes may have been tested more than once
+	OcclusionQueryNodes.sort();
+
+	Driver->getOverrideMaterial().Enabled = false;
+
+	const u32 proxyCount = OcclusionProxies.size();
+	u32 queriesRun = 0;
+
+	for (u32 i=0; i<OcclusionQueryNodes.size(); ++i)
+	{
+		ISceneNode* node = OcclusionQueryNodes[i];
+		if (i && node == OcclusionQueryNodes[i-1])
+			continue;
+
+		// new proxies are sorted in after the loop
+		s32 index = proxyCount ?
+			OcclusionProxies.binary_search(SOcclusionProxy(node), 0, proxyCount-1) : -1;
+		const bool isNew = (index == -1);
+		if (isNew)
+		{
+			SOcclusionProxy proxy(node);
+			proxy.Mesh = GeometryCreator->createCubeMesh(core::vector3df(1.f));
+			// invalid, so the mesh is fitted to the box of the node
+			proxy.Box = core::aabbox3df(1.f,1.f,1.f,-1.f,-1.f,-1.f);
+			proxy.Phase = OcclusionProxies.size();
+			node->grab();
+			Driver->addOcclusionQuery(node, proxy.Mesh);
+
+			index = OcclusionProxies.size();
+			OcclusionProxies.push_back(proxy);
+		}
+
+		SOcclusionProxy& proxy = OcclusionProxies[index];
+
+		// only tested again when the camera left the box
+		if (isCameraInsideNode(node))
+			continue;
+
+		const bool wasInFrustum = !isNew && (proxy.UsedFrame + 1 == OcclusionQueryFrame);
+		proxy.UsedFrame = OcclusionQueryFrame;
+
+		if (Driver->isOcclusionQueryPending(node))
+			continue;
+
+		// visible nodes are likely to stay visible
+		if (wasInFrustum && Driver->getOcclusionQueryResult(node) != 0 &&
+			(OcclusionQueryFrame + proxy.Phase) % OcclusionQueryInterval != 0)
+			continue;
+
+		const core::aabbox3df& box = node->getBoundingBox();
+		if (box != proxy.Box)
+		{
+			// the corners of the mesh keep their side of the box center
+			IMeshBuffer* mb = proxy.Mesh->getMeshBuffer(0);
+			video::S3DVertex* vertices = (video::S3DVertex*)mb->getVertices();
+			const core::vector3df center = proxy.Box.getCenter();
+			for (u32 v=0; v<mb->getVertexCount(); ++v)
+			{
+				core::vector3df& pos = vertices[v].Pos;
+				pos.X = (pos.X > center.X) ? box.MaxEdge.X : box.MinEdge.X;
+				pos.Y = (pos.Y > center.Y) ? box.MaxEdge.Y : box.MinEdge.Y;
+				pos.Z = (pos.Z > center.Z) ? box.MaxEdge.Z : box.MinEdge.Z;
+			}
+			mb->setBoundingBox(box);
+			mb->setDirty(EBT_VERTEX);
+			proxy.Mesh->setBoundingBox(box);
+			proxy.Box = box;
+		}
+
+		Driver->runOcclusionQuery(node, false);
+		proxy.RunFrame = OcclusionQueryFrame;
+		++queriesRun;
+	}
+
+	OcclusionQueryNodes.set_used(0);
+	OcclusionProxies.sort();
+
+#ifdef _IRR_SCENEMANAGER_DEBUG
+	Parameters.setAttribute ( "occlusion_queries_run", (s32) queriesRun );
+#endif
+}
+
+
+//! removes all proxies and their queries
+void CSceneManager::removeOcclusionProxies()
+{
+	for (u32 i=0; i<OcclusionProxies.size(); ++i)
+	{
+		ISceneNode* node = OcclusionProxies[i].Node;
+		if (Driver)
+		{
+			const u32 culling = node->getAutomaticCulling();
+			Driver->removeOcclusionQuery(node);
+			node->setAutomaticCulling(culling);
+		}
+
+		node->drop();
+		OcclusionProxies[i].Mesh->drop();
+	}
+
+	OcclusionProxies.clear();
+	OcclusionQueryNodes.clear();
+}
+
+
+//! rasterizes the occluders for the active camera
+void CSceneManager::drawOccluders()
+{
+	OcclusionCuller->begin(ActiveCamera->getProjectionMatrix() * ActiveCamera->getViewMatrix());
+
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		// nodes removed from the scene are only kept alive by the occluder
+		const ISceneNode* node = Occluders[i].Node;
+		if (!node->getParent() || !node->isTrulyVisible())
+			continue;
+
+		OcclusionCuller->drawOccluder(Occluders[i].Mesh, node->getAbsoluteTransformation());
+	}
+
+	OccludedNodes = 0;
+	OcclusionCulling = OcclusionCuller->hasOccluders();
+}
+
+
+//! puts the visible children of a node into the spatial index
+void CSceneManager::updateSpatialIndex(ISceneNode* node)
+{
+	ISceneNodeList::ConstIterator it = node->getChildren().begin();
+	for (; it != node->getChildren().end(); ++it)
+	{
+		ISceneNode* child = *it;
+		if (!child->isVisible())
+			continue;
+
+		if (child->getAutomaticCulling() & (EAC_BOX | EAC_FRUSTUM_BOX | EAC_FRUSTUM_SPHERE))
+		{
+			SpatialIndex->update(child, child->SpatialIndexHandle, child->SpatialIndexMoved);
+			child->SpatialIndexMoved = false;
+		}
+
+		updateSpatialIndex(child);
+	}
+}
+
+
+//! returns if a whole subtree can be animated on a worker thread
+bool CSceneManager::isSubtreeAnimationThreadSafe(const ISceneNode* node)
+{
+	if (!node->isAnimationThreadSafe())
+		return false;
+
+	const ISceneNodeList& list = node->getChildren();
+	ISceneNodeList::ConstIterator it = list.begin();
+	for (; it != list.end(); ++it)
+	{
+		if (!isSubtreeAnimationThreadSafe(*it))
+			return false;
+	}
+
+	return true;
+}
+
+
 void CSceneManager::setLightManager(ILightManager* lightManager)
 {
 	if (lightManager)
@@ -1625,6 +2500,14 @@ void CSceneManager::setLightManager(ILightManager* lightManager)
 }
 
 
+//! Creates a light manager for scenes with many dynamic lights
+ILightManager* CSceneManager::createClusteredLightManager(u32 maxLightsPerNode,
+		const core::vector3di& clusterCount)
+{
+	return new CClusteredLightManager(this, maxLightsPerNode, clusterCount);
+}
+
+
 //! Sets the color of stencil buffers shadows drawn by the scene manager.
 void CSceneManager::setShadowColor(video::SColor color)
 {
@@ -1864,6 +2747,37 @@ void CSceneManager::addToDeletionQueue(ISceneNode* node)
 }
 
 
+//! Renders the impostor views of a node in the next drawAll().
+void CSceneManager::addImpostorUpdate(IInstancedMeshSceneNode* node)
+{
+	if (!node || ImpostorUpdates.linear_search(node) != -1)
+		return;
+
+	node->grab();
+	ImpostorUpdates.push_back(node);
+}
+
+
+//! renders the impostor views of the nodes added since the last frame
+void CSceneManager::updateImpostors()
+{
+	for (u32 i=0; i<ImpostorUpdates.size(); ++i)
+		ImpostorUpdates[i]->updateImpostorViews();
+
+	clearImpostorUpdates();
+}
+
+
+//! drops the nodes without rendering their impostor views
+void CSceneManager::clearImpostorUpdates()
+{
+	for (u32 i=0; i<ImpostorUpdates.size(); ++i)
+		ImpostorUpdates[i]->drop();
+
+	ImpostorUpdates.clear();
+}
+
+
 //! clears the deletion list
 void CSceneManager::clearDeletionList()
 {
@@ -1880,6 +2794,22 @@ void CSceneManager::clearDeletionList()
 }
 
 
+namespace
+{
+	//! FNV-1a hash of a node name for the name index
+	u32 hashNodeName(const c8* name)
+	{
+		u32 hash = 2166136261u;
+		for (; *name; ++name)
+		{
+			hash ^= (u8)*name;
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+}
+
+
 //! Returns the first scene node with the specified name.
 ISceneNode* CSceneManager::getSceneNodeFromName(const char* name, ISceneNode* start)
 {
@@ -1889,6 +2819,11 @@ ISceneNode* CSceneManager::getSceneNodeFromName(const char* name, ISceneNode* st
 	if (!strcmp(start->getName(),name))
 		return start;
 
+	updateNodeIndex();
+	if (isInNodeIndex(start))
+		return findInNodeIndex(NodeNameIndex, hashNodeName(name), start, name);
+
+	// start is not part of this scene, search its children
 	ISceneNode* node = 0;
 
 	const ISceneNodeList& list = start->getChildren();
@@ -1913,6 +2848,11 @@ ISceneNode* CSceneManager::getSceneNodeFromId(s32 id, ISceneNode* start)
 	if (start->getID() == id)
 		return start;
 
+	updateNodeIndex();
+	if (isInNodeIndex(start))
+		return findInNodeIndex(NodeIdIndex, (u32)id, start);
+
+	// start is not part of this scene, search its children
 	ISceneNode* node = 0;
 
 	const ISceneNodeList& list = start->getChildren();
@@ -1937,6 +2877,11 @@ ISceneNode* CSceneManager::getSceneNodeFromType(scene::ESCENE_NODE_TYPE type, IS
 	if (start->getType() == type || ESNT_ANY == type)
 		return start;
 
+	updateNodeIndex();
+	if (isInNodeIndex(start))
+		return findInNodeIndex(NodeTypeIndex, (u32)type, start);
+
+	// start is not part of this scene, search its children
 	ISceneNode* node = 0;
 
 	const ISceneNodeList& list = start->getChildren();
@@ -1961,6 +2906,24 @@ void CSceneManager::getSceneNodesFromType(ESCENE_NODE_TYPE type, core::array<sce
 	if (start->getType() == type || ESNT_ANY == type)
 		outNodes.push_back(start);
 
+	updateNodeIndex();
+	if (isInNodeIndex(start))
+	{
+		// the subtree of start are the positions after it up to its end
+		if (ESNT_ANY == type)
+		{
+			for (u32 i=start->NodeIndexBegin+1; i<start->NodeIndexEnd; ++i)
+				outNodes.push_back(NodeIndexOrder[i]);
+			return;
+		}
+
+		u32 i = lowerBoundInNodeIndex(NodeTypeIndex, (u32)type, start->NodeIndexBegin+1);
+		for (; i<NodeTypeIndex.size() && NodeTypeIndex[i].Key == (u32)type &&
+			NodeTypeIndex[i].Position < start->NodeIndexEnd; ++i)
+			outNodes.push_back(NodeTypeIndex[i].Node);
+		return;
+	}
+
 	const ISceneNodeList& list = start->getChildren();
 	ISceneNodeList::ConstIterator it = list.begin();
 
@@ -1971,6 +2934,154 @@ void CSceneManager::getSceneNodesFromType(ESCENE_NODE_TYPE type, core::array<sce
 }
 
 
+//! rebuilds the node index if nodes were added, removed or renamed
+void CSceneManager::updateNodeIndex()
+{
+	if (!NodeIndexDirty)
+		return;
+
+	// the order of the nodes is kept, only some keys changed
+	if (!(NodeIndexDirty & ENIC_STRUCTURE))
+	{
+		if (NodeIndexDirty & ENIC_IDS)
+			updateNodeIndexKeys(NodeIdIndex, false);
+		if (NodeIndexDirty & ENIC_NAMES)
+			updateNodeIndexKeys(NodeNameIndex, true);
+
+		NodeIndexDirty = 0;
+		return;
+	}
+
+	NodeIndexOrder.set_used(0);
+	NodeIdIndex.set_used(0);
+	NodeNameIndex.set_used(0);
+	NodeTypeIndex.set_used(0);
+
+	addToNodeIndex(this);
+
+	NodeIdIndex.sort();
+	NodeNameIndex.sort();
+	NodeTypeIndex.sort();
+
+	NodeIndexDirty = 0;
+}
+
+
+//! moves the entries of nodes with a new id or name to their sorted position
+void CSceneManager::updateNodeIndexKeys(core::array<SNodeIndexEntry>& index, bool names)
+{
+	core::array<SNodeIndexEntry> changed;
+
+	u32 kept = 0;
+	for (u32 i=0; i<index.size(); ++i)
+	{
+		SNodeIndexEntry entry = index[i];
+		const u32 key = names ? hashNodeName(entry.Node->getName()) : (u32)entry.Node->getID();
+		if (key != entry.Key)
+		{
+			entry.Key = key;
+			changed.push_back(entry);
+		}
+		else
+			index[kept++] = entry;
+	}
+
+	if (changed.empty())
+		return;
+
+	// the remaining entries are still sorted
+	index.set_used(kept);
+
+	// many changes are cheaper to sort at once
+	if (changed.size() > 16)
+	{
+		for (u32 i=0; i<changed.size(); ++i)
+			index.push_back(changed[i]);
+		index.sort();
+		return;
+	}
+
+	for (u32 i=0; i<changed.size(); ++i)
+		index.insert(changed[i], lowerBoundInNodeIndex(index, changed[i].Key, changed[i].Position));
+}
+
+
+//! adds a node and its children to the node index in preorder
+void CSceneManager::addToNodeIndex(ISceneNode* node)
+{
+	SNodeIndexEntry entry;
+	entry.Position = NodeIndexOrder.size();
+	entry.Node = node;
+
+	node->NodeIndexBegin = entry.Position;
+	NodeIndexOrder.push_back(node);
+
+	entry.Key = (u32)node->getID();
+	NodeIdIndex.push_back(entry);
+	entry.Key = hashNodeName(node->getName());
+	NodeNameIndex.push_back(entry);
+	entry.Key = (u32)node->getType();
+	NodeTypeIndex.push_back(entry);
+
+	const ISceneNodeList& list = node->getChildren();
+	ISceneNodeList::ConstIterator it = list.begin();
+	for (; it!=list.end(); ++it)
+		addToNodeIndex(*it);
+
+	node->NodeIndexEnd = NodeIndexOrder.size();
+}
+
+
+//! returns if a node is part of the current node index
+bool CSceneManager::isInNodeIndex(const ISceneNode* node) const
+{
+	// positions of nodes which left the scene point to other nodes
+	return node->NodeIndexBegin < NodeIndexOrder.size() &&
+		NodeIndexOrder[node->NodeIndexBegin] == node;
+}
+
+
+//! returns the first entry with this key at or after the position
+u32 CSceneManager::lowerBoundInNodeIndex(const core::array<SNodeIndexEntry>& index,
+	u32 key, u32 position)
+{
+	SNodeIndexEntry search;
+	search.Key = key;
+	search.Position = position;
+
+	u32 first = 0;
+	u32 count = index.size();
+	while (count)
+	{
+		const u32 step = count / 2;
+		if (index[first + step] < search)
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+			count = step;
+	}
+	return first;
+}
+
+
+//! returns the first node below start with this key, compares the name if given
+ISceneNode* CSceneManager::findInNodeIndex(const core::array<SNodeIndexEntry>& index,
+	u32 key, const ISceneNode* start, const c8* name) const
+{
+	u32 i = lowerBoundInNodeIndex(index, key, start->NodeIndexBegin+1);
+	for (; i<index.size() && index[i].Key == key && index[i].Position < start->NodeIndexEnd; ++i)
+	{
+		// different names may have the same hash
+		if (!name || !strcmp(index[i].Node->getName(), name))
+			return index[i].Node;
+	}
+
+	return 0;
+}
+
+
 //! Posts an input event to the environment. Usually you do not have to
 //! use this method, it is used by the internal engine.
 bool CSceneManager::postEventFromUser(const SEvent& event)
@@ -1999,7 +3110,11 @@ void CSceneManager::removeAll()
 //! Clears the whole scene. All scene nodes are removed.
 void CSceneManager::clear()
 {
+	clearImpostorUpdates();
+	removeAllOccluders();
+	removeOcclusionProxies();
 	removeAll();
+	clearStaticBatches();
 }
 
 
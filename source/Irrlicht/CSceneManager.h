@@ -13,6 +13,10 @@
 #include "IMeshLoader.h"
 #include "CAttributes.h"
 #include "ILightManager.h"
+#include "CThreadPool.h"
+#include "CSceneNodeOctree.h"
+#include "COcclusionCuller.h"
+#include "CRenderQueue.h"
 
 namespace irr
 {
@@ -95,6 +99,26 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false);
 
+		//! Adds a scene node for rendering many instances of a static mesh.
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! Adds a scene node which draws less detailed versions of a static mesh when it gets small.
+		virtual ILODMeshSceneNode* addLODMeshSceneNode(IMesh* mesh, u32 levelCount=3,
+			f32 triangleRatio=0.5f, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! Merges static mesh scene nodes into a few batched nodes.
+		virtual ISceneNode* batchStaticMeshes(const core::array<ISceneNode*>& nodes,
+			f32 cellSize=0.f, bool allow32BitIndices=false);
+
+		//! Restores the nodes of a batch created with batchStaticMeshes().
+		virtual bool unbatchStaticMeshes(ISceneNode* batch);
+
 		//! Adds a scene node for rendering a animated water surface mesh.
 		virtual ISceneNode* addWaterSurfaceSceneNode(IMesh* mesh, f32 waveHeight, f32 waveSpeed, f32 wlenght, ISceneNode* parent=0, s32 id=-1,
 			const core::vector3df& position = core::vector3df(0,0,0),
@@ -110,9 +134,48 @@ namespace scene
 		//! registers a node for rendering it at a specific time.
 		virtual u32 registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass = ESNRP_AUTOMATIC);
 
+		//! Registers the mesh buffers of a node for rendering.
+		virtual u32 registerMeshForRendering(ISceneNode* node, IMesh* mesh, const video::SMaterial* materials = 0);
+
 		//! draws all scene nodes
 		virtual void drawAll();
 
+		//! Sets the number of threads used to animate the scene in drawAll().
+		virtual void setAnimationThreadCount(u32 threadCount);
+
+		//! Get the number of threads used to animate the scene.
+		virtual u32 getAnimationThreadCount() const;
+
+		//! Enables or disables the spatial index used for culling.
+		virtual void setSpatialIndex(bool enable, const core::aabbox3df& worldBox, u32 maxDepth);
+
+		//! Checks if the spatial index is used for culling.
+		virtual bool isSpatialIndexEnabled() const;
+
+		//! Adds an occluder for software occlusion culling.
+		virtual void addOccluder(ISceneNode* node, IMesh* mesh=0);
+
+		//! Removes all occluders of a node.
+		virtual bool removeOccluder(ISceneNode* node);
+
+		//! Removes all occluders.
+		virtual void removeAllOccluders();
+
+		//! Sets the resolution of the depth buffer for software occlusion culling.
+		virtual void setOcclusionBufferSize(const core::dimension2du& size);
+
+		//! Gets the resolution of the depth buffer for software occlusion culling.
+		virtual const core::dimension2du& getOcclusionBufferSize() const;
+
+		//! Enables automatic hardware occlusion queries.
+		virtual void setAutomaticOcclusionQueries(bool enable, u32 visibleTestInterval=8, u32 maxLatency=3);
+
+		//! Checks if drawAll() manages the occlusion queries.
+		virtual bool isAutomaticOcclusionQueryEnabled() const;
+
+		//! Renders the impostor views of a node in the next drawAll().
+		virtual void addImpostorUpdate(IInstancedMeshSceneNode* node);
+
 		//! Adds a scene node for rendering using a octree to the scene graph. This a good method for rendering
 		//! scenes with lots of geometry. The Octree is built on the fly from the mesh, much
 		//! faster then a bsp tree.
@@ -509,6 +572,10 @@ namespace scene
 		//! Register a custom callbacks manager which gets callbacks during scene rendering.
 		virtual void setLightManager(ILightManager* lightManager);
 
+		//! Creates a light manager for scenes with many dynamic lights
+		virtual ILightManager* createClusteredLightManager(u32 maxLightsPerNode=8,
+			const core::vector3di& clusterCount=core::vector3di(16,8,24));
+
 		//! Get current render time.
 		virtual E_SCENE_NODE_RENDER_PASS getCurrentRendertime() const { return CurrentRendertime; }
 
@@ -526,45 +593,76 @@ namespace scene
 		//! clears the deletion list
 		void clearDeletionList();
 
-		//! writes a scene node
-		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
+		//! renders the impostor views of the nodes added since the last frame
+		void updateImpostors();
 
-		struct DefaultNodeEntry
-		{
-			DefaultNodeEntry(ISceneNode* n) :
-				Node(n), TextureValue(0)
-			{
-				if (n->getMaterialCount())
-					TextureValue = (n->getMaterial(0).getTexture(0));
-			}
+		//! drops the nodes without rendering their impostor views
+		void clearImpostorUpdates();
 
-			bool operator < (const DefaultNodeEntry& other) const
-			{
-				return (TextureValue < other.TextureValue);
-			}
+		//! animates the scene graph, spreading subtrees over the animation threads
+		void animateParallel(u32 timeMs);
 
-			ISceneNode* Node;
-			private:
-			void* TextureValue;
-		};
+		//! returns if a whole subtree can be animated on a worker thread
+		static bool isSubtreeAnimationThreadSafe(const ISceneNode* node);
+
+		//! puts the visible children of a node into the spatial index
+		void updateSpatialIndex(ISceneNode* node);
+
+		//! returns the key of a node which renders itself in the render queue
+		u64 getRenderQueueKey(CRenderQueue::E_QUEUE_PASS pass, ISceneNode* node) const;
+
+		//! renders all entries of a pass from the sorted render queue
+		void renderQueuePass(u32& index, CRenderQueue::E_QUEUE_PASS pass);
+
+		//! drops the original nodes of all static batches
+		void clearStaticBatches();
+
+		//! rasterizes the occluders for the active camera
+		void drawOccluders();
+
+		//! checks if a node is hidden by occlusion queries or the occluders of this frame
+		bool isOccluded(const ISceneNode* node) const;
+
+		//! checks the occlusion query result of a node
+		bool isOccludedByQuery(const ISceneNode* node) const;
+
+		//! checks if the camera is inside of the bounding box of a node
+		bool isCameraInsideNode(const ISceneNode* node) const;
+
+		//! waits for results which are too late and removes unused proxies
+		void updateOcclusionQueries();
+
+		//! runs the queries of the nodes in the view frustum
+		void runOcclusionQueries();
 
-		//! sort on distance (center) to camera
-		struct TransparentNodeEntry
+		//! removes all proxies and their queries
+		void removeOcclusionProxies();
+
+		//! rebuilds the node index if nodes were added, removed or renamed
+		void updateNodeIndex();
+
+		//! adds a node and its children to the node index in preorder
+		void addToNodeIndex(ISceneNode* node);
+
+		//! returns if a node is part of the current node index
+		bool isInNodeIndex(const ISceneNode* node) const;
+
+		//! writes a scene node
+		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
+
+		//! animates one subtree below the root per work item
+		struct SAnimationJob : public IThreadJob
 		{
-			TransparentNodeEntry(ISceneNode* n, const core::vector3df& camera)
-				: Node(n)
-			{
-				Distance = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
-			}
+			SAnimationJob(const core::array<ISceneNode*>& nodes)
+				: Nodes(nodes), TimeMs(0) {}
 
-			bool operator < (const TransparentNodeEntry& other) const
+			virtual void execute(u32 index)
 			{
-				return Distance > other.Distance;
+				Nodes[index]->OnAnimate(TimeMs);
 			}
 
-			ISceneNode* Node;
-			private:
-				f64 Distance;
+			const core::array<ISceneNode*>& Nodes;
+			u32 TimeMs;
 		};
 
 		//! sort on distance (sphere) to camera
@@ -593,6 +691,39 @@ namespace scene
 			f64 Distance;
 		};
 
+		//! a node in the id, name or type index, sorted by key and preorder position
+		struct SNodeIndexEntry
+		{
+			u32 Key;
+			u32 Position;
+			ISceneNode* Node;
+
+			bool operator<(const SNodeIndexEntry& other) const
+			{
+				return Key < other.Key || (Key == other.Key && Position < other.Position);
+			}
+		};
+
+		//! returns the first node below start with this key, compares the name if given
+		ISceneNode* findInNodeIndex(const core::array<SNodeIndexEntry>& index,
+			u32 key, const ISceneNode* start, const c8* name=0) const;
+
+		//! returns the first entry with this key at or after the position
+		static u32 lowerBoundInNodeIndex(const core::array<SNodeIndexEntry>& index,
+			u32 key, u32 position);
+
+		//! moves the entries of nodes with a new id or name to their sorted position
+		void updateNodeIndexKeys(core::array<SNodeIndexEntry>& index, bool names);
+
+		//! nodes replaced by a batch of static meshes, all grabbed
+		struct SStaticBatch
+		{
+			ISceneNode* Batch;
+			core::array<ISceneNode*> Nodes;
+			//! old parents of the nodes, 0 for the root scene node
+			core::array<ISceneNode*> Parents;
+		};
+
 		//! video driver
 		video::IVideoDriver* Driver;
 
@@ -613,16 +744,95 @@ namespace scene
 		core::array<ISceneNode*> LightList;
 		core::array<ISceneNode*> ShadowNodeList;
 		core::array<ISceneNode*> SkyBoxList;
-		core::array<DefaultNodeEntry> SolidNodeList;
-		core::array<TransparentNodeEntry> TransparentNodeList;
-		core::array<TransparentNodeEntry> TransparentEffectNodeList;
+		//! solid, transparent and transparent effect nodes and mesh buffers
+		CRenderQueue RenderQueue;
+
+		core::array<SStaticBatch> StaticBatches;
+
+		//! all nodes of the scene in preorder, rebuilt when nodes were added or removed
+		core::array<ISceneNode*> NodeIndexOrder;
+		core::array<SNodeIndexEntry> NodeIdIndex;
+		core::array<SNodeIndexEntry> NodeNameIndex;
+		core::array<SNodeIndexEntry> NodeTypeIndex;
 
 		core::array<IMeshLoader*> MeshLoaderList;
 		core::array<ISceneLoader*> SceneLoaderList;
 		core::array<ISceneNode*> DeletionList;
+		core::array<IInstancedMeshSceneNode*> ImpostorUpdates;
 		core::array<ISceneNodeFactory*> SceneNodeFactoryList;
 		core::array<ISceneNodeAnimatorFactory*> SceneNodeAnimatorFactoryList;
 
+		//! worker threads for animating the scene, 0 if animation is single threaded
+		CThreadPool* AnimationThreads;
+		core::array<ISceneNode*> ParallelAnimationNodes;
+		core::array<ISceneNode*> SerialAnimationNodes;
+
+		//! planes of the active camera, set up once per frame in drawAll()
+		CFrustumCuller FrustumCuller;
+		//! true while nodes register themselves and FrustumCuller is valid
+		bool FrustumCulling;
+
+		//! octree of the scene nodes for culling, 0 if disabled
+		CSceneNodeOctree* SpatialIndex;
+		//! true while nodes register themselves after the index was culled
+		bool SpatialIndexCulling;
+		mutable u32 SpatialNodesTested;
+		mutable u32 SpatialNodesAccepted;
+		mutable u32 SpatialNodesSkipped;
+
+		//! mesh drawn into the depth buffer of the occlusion culler
+		struct SOccluder
+		{
+			ISceneNode* Node;
+			IMesh* Mesh;
+		};
+
+		core::array<SOccluder> Occluders;
+		//! created with the first occluder
+		COcclusionCuller* OcclusionCuller;
+		core::dimension2du OcclusionBufferSize;
+		//! true while nodes register themselves after occluders were drawn
+		bool OcclusionCulling;
+		mutable u32 OccludedNodes;
+
+		//! bounding box of a node drawn for its automatic occlusion query
+		struct SOcclusionProxy
+		{
+			SOcclusionProxy(ISceneNode* node=0) : Node(node), Mesh(0),
+				RunFrame(0), UsedFrame(0), Phase(0) {}
+
+			bool operator<(const SOcclusionProxy& other) const
+			{
+				return Node < other.Node;
+			}
+
+			bool operator==(const SOcclusionProxy& other) const
+			{
+				return Node == other.Node;
+			}
+
+			ISceneNode* Node;
+			IMesh* Mesh;
+			core::aabbox3df Box;
+			//! frame in which the query was run the last time
+			u32 RunFrame;
+			//! frame in which the node was in the view frustum the last time
+			u32 UsedFrame;
+			//! spreads the tests of visible nodes over the frames
+			u32 Phase;
+		};
+
+		//! sorted by node
+		core::array<SOcclusionProxy> OcclusionProxies;
+		//! nodes with EAC_OCC_QUERY in the view frustum this frame
+		mutable core::array<ISceneNode*> OcclusionQueryNodes;
+		u32 OcclusionQueryInterval;
+		u32 OcclusionQueryLatency;
+		u32 OcclusionQueryFrame;
+		bool AutomaticOcclusionQueries;
+		//! true while nodes register themselves with automatic queries
+		bool OcclusionQueryCulling;
+
 		//! current active camera
 		ICameraSceneNode* ActiveCamera;
 		core::vector3df camWorldPos; // Position of camera for transparent nodes.
@@ -32,6 +32,9 @@ namespace scene
 
 		//! Returns type of the scene node animator
 		virtual ESCENE_NODE_ANIMATOR_TYPE getType() const { return ESNAT_FLY_CIRCLE; }
+
+		//! Only modifies the animated node, so it can run on worker threads
+		virtual bool isThreadSafe() const { return true; }
 		
 		//! Creates a clone of this animator.
 		/** Please note that you will have to drop
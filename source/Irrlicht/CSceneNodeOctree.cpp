@@ -0,0 +1,347 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeOctree.h"
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+CSceneNodeOctree::CSceneNodeOctree(const core::aabbox3df& worldBox, u32 maxDepth)
+	: MaxDepth(maxDepth), Frame(0), CellsTested(0)
+{
+	// cells are cubes, so the world box is extended to a cube
+	const core::vector3df extent = worldBox.getExtent();
+	WorldSize = core::max_(extent.X, extent.Y, extent.Z);
+	if (WorldSize <= 0.f)
+		WorldSize = 1.f;
+
+	WorldBox.MinEdge = worldBox.MinEdge;
+	WorldBox.MaxEdge = worldBox.MinEdge + core::vector3df(WorldSize);
+
+	const f32 loose = WorldSize * 0.5f;
+	Cells.push_back(SCell(core::aabbox3df(WorldBox.MinEdge - core::vector3df(loose),
+			WorldBox.MaxEdge + core::vector3df(loose)), -1, 0));
+}
+
+
+//! Starts updating the positions of the nodes for a new frame
+void CSceneNodeOctree::beginUpdate()
+{
+	++Frame;
+}
+
+
+//! Updates or inserts a node
+void CSceneNodeOctree::update(ISceneNode* node, u32& handle, bool moved)
+{
+	const core::aabbox3df& localBox = node->getBoundingBox();
+	const bool known = handle < Entries.size() && Entries[handle].Node == node;
+
+	// nodes which did not move keep their world box and cell
+	if (known && !moved && Entries[handle].LocalBox.MinEdge == localBox.MinEdge &&
+		Entries[handle].LocalBox.MaxEdge == localBox.MaxEdge)
+	{
+		Entries[handle].UpdateFrame = Frame;
+		return;
+	}
+
+	core::aabbox3df box = localBox;
+	node->getAbsoluteTransformation().transformBoxEx(box);
+
+	if (known)
+	{
+		SEntry& e = Entries[handle];
+		e.LocalBox = localBox;
+		e.Box = box;
+		e.UpdateFrame = Frame;
+		if (!staysInCell(e.Cell, box))
+		{
+			const s32 cell = getCell(box);
+			if (e.Cell != cell)
+			{
+				removeEntry(handle);
+				insertEntry(handle, cell);
+			}
+		}
+		return;
+	}
+
+	const s32 cell = getCell(box);
+
+	if (FreeEntries.size())
+	{
+		handle = FreeEntries.getLast();
+		FreeEntries.erase(FreeEntries.size()-1);
+	}
+	else
+	{
+		handle = Entries.size();
+		Entries.push_back(SEntry());
+	}
+
+	SEntry& e = Entries[handle];
+	e.Node = node;
+	e.LocalBox = localBox;
+	e.Box = box;
+	e.UpdateFrame = Frame;
+	e.VisibleFrame = 0;
+	e.Visibility = ENV_UNKNOWN;
+	e.PlaneHint = 0;
+	insertEntry(handle, cell);
+}
+
+
+//! Removes all nodes which were not updated since beginUpdate()
+void CSceneNodeOctree::endUpdate()
+{
+	for (u32 i=0; i<Entries.size(); ++i)
+	{
+		SEntry& e = Entries[i];
+		if (e.Node && e.UpdateFrame != Frame)
+		{
+			removeEntry(i);
+			e.Node = 0;
+			FreeEntries.push_back(i);
+		}
+	}
+}
+
+
+//! Classifies all cells and the nodes in cells intersecting the frustum
+void CSceneNodeOctree::cull(const SViewFrustum& frustum)
+{
+	const CFrustumCuller culler(frustum);
+
+	CellsTested = 0;
+	cullEntries(OutsideEntries, culler, CFrustumCuller::ALL_PLANES);
+	cullCell(0, culler, CFrustumCuller::ALL_PLANES);
+}
+
+
+//! Returns the result of the last cull() for a node
+CSceneNodeOctree::E_NODE_VISIBILITY CSceneNodeOctree::getVisibility(const ISceneNode* node, u32 handle) const
+{
+	if (handle >= Entries.size())
+		return ENV_UNKNOWN;
+
+	const SEntry& e = Entries[handle];
+	if (e.Node != node || e.UpdateFrame != Frame)
+		return ENV_UNKNOWN;
+
+	// cells which were not stamped during cull() are outside
+	if (e.VisibleFrame != Frame)
+		return ENV_CULLED;
+
+	return (E_NODE_VISIBILITY)e.Visibility;
+}
+
+
+//! Finds or creates the cell a box has to be stored in, -1 if outside of the tree
+s32 CSceneNodeOctree::getCell(const core::aabbox3df& box)
+{
+	const core::vector3df center = box.getCenter();
+	const core::vector3df extent = box.getExtent();
+	const f32 halfSize = core::max_(extent.X, extent.Y, extent.Z) * 0.5f;
+
+	// the root cell can hold everything up to the size of the world
+	if (!WorldBox.isPointInside(center) || halfSize > WorldSize * 0.5f)
+		return -1;
+
+	s32 cell = 0;
+	core::vector3df cellMin = WorldBox.MinEdge;
+	f32 cellSize = WorldSize;
+
+	for (u32 depth=0; depth<MaxDepth; ++depth)
+	{
+		const f32 childSize = cellSize * 0.5f;
+
+		// the loose box of a child holds boxes up to the size of the child
+		if (halfSize > childSize * 0.5f)
+			break;
+
+		u32 child = 0;
+		core::vector3df childMin = cellMin;
+		if (center.X >= cellMin.X + childSize)
+		{
+			child |= 1;
+			childMin.X += childSize;
+		}
+		if (center.Y >= cellMin.Y + childSize)
+		{
+			child |= 2;
+			childMin.Y += childSize;
+		}
+		if (center.Z >= cellMin.Z + childSize)
+		{
+			child |= 4;
+			childMin.Z += childSize;
+		}
+
+		if (Cells[cell].Children[child] == -1)
+		{
+			const f32 loose = childSize * 0.5f;
+			const s32 created = Cells.size();
+			Cells.push_back(SCell(core::aabbox3df(childMin - core::vector3df(loose),
+					childMin + core::vector3df(childSize + loose)), cell, depth+1));
+			Cells[cell].Children[child] = created;
+		}
+
+		cell = Cells[cell].Children[child];
+		cellMin = childMin;
+		cellSize = childSize;
+	}
+
+	return cell;
+}
+
+
+//! Checks if a box can stay in its cell, which is true as long as it is in the loose box
+bool CSceneNodeOctree::staysInCell(s32 cell, const core::aabbox3df& box) const
+{
+	if (cell == -1)
+		return false;
+
+	const SCell& c = Cells[cell];
+	if (!box.isFullInside(c.LooseBox))
+		return false;
+
+	if (c.Depth == MaxDepth)
+		return true;
+
+	// the loose box is twice the size of the cell, boxes up to half the
+	// size of the cell belong into a child
+	const core::vector3df extent = box.getExtent();
+	const f32 size = core::max_(extent.X, extent.Y, extent.Z);
+	return size > (c.LooseBox.MaxEdge.X - c.LooseBox.MinEdge.X) * 0.25f;
+}
+
+
+void CSceneNodeOctree::insertEntry(u32 entry, s32 cell)
+{
+	SEntry& e = Entries[entry];
+	e.Cell = cell;
+
+	if (cell == -1)
+	{
+		e.Slot = OutsideEntries.size();
+		OutsideEntries.push_back(entry);
+		return;
+	}
+
+	e.Slot = Cells[cell].Entries.size();
+	Cells[cell].Entries.push_back(entry);
+
+	for (s32 c=cell; c!=-1; c=Cells[c].Parent)
+		++Cells[c].SubtreeEntryCount;
+}
+
+
+void CSceneNodeOctree::removeEntry(u32 entry)
+{
+	const SEntry& e = Entries[entry];
+	core::array<u32>& list = (e.Cell == -1) ? OutsideEntries : Cells[e.Cell].Entries;
+
+	// move the last entry of the list into the free slot
+	const u32 last = list.getLast();
+	list[e.Slot] = last;
+	Entries[last].Slot = e.Slot;
+	list.erase(list.size()-1);
+
+	for (s32 c=e.Cell; c!=-1; c=Cells[c].Parent)
+		--Cells[c].SubtreeEntryCount;
+}
+
+
+void CSceneNodeOctree::cullCell(s32 cell, const CFrustumCuller& culler, u32 planeMask)
+{
+	SCell& c = Cells[cell];
+	if (!c.SubtreeEntryCount)
+		return;
+
+	++CellsTested;
+
+	// children are inside of all planes their parent is inside of,
+	// so only the planes the cell intersects are passed on
+	const CFrustumCuller::E_CULL_RESULT rel = culler.classifyBox(c.LooseBox, planeMask, c.PlaneHint);
+	if (rel == CFrustumCuller::ECR_OUTSIDE)
+		return;
+	if (rel == CFrustumCuller::ECR_INSIDE)
+	{
+		markSubtree(cell, ENV_INSIDE);
+		return;
+	}
+
+	cullEntries(c.Entries, culler, planeMask);
+
+	for (u32 i=0; i<8; ++i)
+	{
+		if (c.Children[i] != -1)
+			cullCell(c.Children[i], culler, planeMask);
+	}
+}
+
+
+void CSceneNodeOctree::cullEntries(const core::array<u32>& list, const CFrustumCuller& culler, u32 planeMask)
+{
+	const u32 count = list.size();
+	if (!count)
+		return;
+
+	BatchBoxes.set_used(count);
+	BatchResults.set_used(count);
+	BatchHints.set_used(count);
+
+	u32 i;
+	for (i=0; i<count; ++i)
+	{
+		const SEntry& e = Entries[list[i]];
+		BatchBoxes[i] = e.Box;
+		BatchHints[i] = e.PlaneHint;
+	}
+
+	culler.classifyBoxes(BatchBoxes.const_pointer(), count, planeMask,
+			BatchResults.pointer(), BatchHints.pointer());
+
+	// entries which are not stamped are culled
+	for (i=0; i<count; ++i)
+	{
+		SEntry& e = Entries[list[i]];
+		e.PlaneHint = BatchHints[i];
+		if (BatchResults[i] == CFrustumCuller::ECR_OUTSIDE)
+			continue;
+
+		e.VisibleFrame = Frame;
+		e.Visibility = (BatchResults[i] == CFrustumCuller::ECR_INSIDE) ? ENV_INSIDE : ENV_PARTIAL;
+	}
+}
+
+
+void CSceneNodeOctree::markSubtree(s32 cell, u8 visibility)
+{
+	const SCell& c = Cells[cell];
+	if (!c.SubtreeEntryCount)
+		return;
+
+	for (u32 i=0; i<c.Entries.size(); ++i)
+	{
+		SEntry& e = Entries[c.Entries[i]];
+		e.VisibleFrame = Frame;
+		e.Visibility = visibility;
+	}
+
+	for (u32 i=0; i<8; ++i)
+	{
+		if (c.Children[i] != -1)
+			markSubtree(c.Children[i], visibility);
+	}
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
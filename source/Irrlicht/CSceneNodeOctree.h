@@ -0,0 +1,166 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_OCTREE_H_INCLUDED__
+#define __C_SCENE_NODE_OCTREE_H_INCLUDED__
+
+#include "irrArray.h"
+#include "aabbox3d.h"
+#include "CFrustumCuller.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ISceneNode;
+
+	//! A loose octree of scene nodes used by the scene manager for culling.
+	/** Each node is stored in the deepest cell it fits into when cells are
+	enlarged to twice their size, so a node only moves to another cell after
+	it moved by at least half the cell size. Culling classifies whole cells
+	against the view frustum. Nodes in cells completely outside are culled
+	without ever looking at them, nodes in cells completely inside are
+	accepted without further tests. Nodes in the cells between are
+	tested in batches, each only against the planes its cell intersects.
+	Nodes are not grabbed. The index keeps a handle per node (stored by the
+	scene manager in the node), and forgets all nodes which were not
+	updated between beginUpdate() and endUpdate(). It never dereferences
+	nodes it did not get during the current update. */
+	class CSceneNodeOctree
+	{
+	public:
+
+		//! Result of the frustum test for a node
+		enum E_NODE_VISIBILITY
+		{
+			//! The node is not in the index, it has to be tested by itself
+			ENV_UNKNOWN = 0,
+			//! The cell of the node is outside of the frustum
+			ENV_CULLED,
+			//! The world box of the node intersects the frustum, the node has to be tested by itself
+			ENV_PARTIAL,
+			//! The node is completely inside of the frustum
+			ENV_INSIDE
+		};
+
+		//! Handle value of nodes which are not in any index
+		static const u32 INVALID_HANDLE = 0xffffffff;
+
+		//! constructor
+		/** \param worldBox Area covered by the tree. Nodes outside are
+		kept in a list and always tested by themselves.
+		\param maxDepth Depth of the smallest cells. */
+		CSceneNodeOctree(const core::aabbox3df& worldBox, u32 maxDepth);
+
+		//! Returns the area covered by the tree
+		const core::aabbox3df& getWorldBox() const { return WorldBox; }
+
+		//! Returns depth of the smallest cells
+		u32 getMaxDepth() const { return MaxDepth; }
+
+		//! Starts updating the positions of the nodes for a new frame
+		void beginUpdate();
+
+		//! Updates or inserts a node
+		/** \param node The node, its transformed bounding box is used.
+		\param handle Handle of the node in this index. Must be
+		INVALID_HANDLE for new nodes and is updated by this method.
+		\param moved False if the absolute transformation of the node did
+		not change since its last update. The node then only gets a new
+		world box if its bounding box changed. */
+		void update(ISceneNode* node, u32& handle, bool moved = true);
+
+		//! Removes all nodes which were not updated since beginUpdate()
+		void endUpdate();
+
+		//! Classifies all cells and the nodes in cells intersecting the frustum
+		void cull(const SViewFrustum& frustum);
+
+		//! Returns the result of the last cull() for a node
+		E_NODE_VISIBILITY getVisibility(const ISceneNode* node, u32 handle) const;
+
+		//! Returns the world space bounding box the node had in the last update
+		const core::aabbox3df& getBox(u32 handle) const { return Entries[handle].Box; }
+
+		//! Returns the frustum plane which rejected the node the last time
+		/** Can be used as hint for CFrustumCuller, which starts with it. */
+		u8& getPlaneHint(u32 handle) { return Entries[handle].PlaneHint; }
+
+		//! Returns how many cells were tested against the frustum in the last cull()
+		u32 getCellsTested() const { return CellsTested; }
+
+		//! Returns the amount of nodes in the index
+		u32 getNodeCount() const { return Entries.size() - FreeEntries.size(); }
+
+	private:
+
+		struct SEntry
+		{
+			//! Only compared, never dereferenced outside of update()
+			const ISceneNode* Node;
+			core::aabbox3df LocalBox;
+			core::aabbox3df Box;
+			s32 Cell;
+			u32 Slot;
+			u32 UpdateFrame;
+			u32 VisibleFrame;
+			u8 Visibility;
+			u8 PlaneHint;
+		};
+
+		struct SCell
+		{
+			SCell(const core::aabbox3df& looseBox, s32 parent, u32 depth)
+				: LooseBox(looseBox), Parent(parent), SubtreeEntryCount(0), Depth(depth), PlaneHint(0)
+			{
+				for (u32 i=0; i<8; ++i)
+					Children[i] = -1;
+			}
+
+			core::aabbox3df LooseBox;
+			s32 Parent;
+			s32 Children[8];
+			u32 SubtreeEntryCount;
+			core::array<u32> Entries;
+			u32 Depth;
+			u8 PlaneHint;
+		};
+
+		//! Finds or creates the cell a box has to be stored in, -1 if outside of the tree
+		s32 getCell(const core::aabbox3df& box);
+
+		//! Checks if a box can stay in its cell, which is true as long as it is in the loose box
+		bool staysInCell(s32 cell, const core::aabbox3df& box) const;
+
+		void insertEntry(u32 entry, s32 cell);
+		void removeEntry(u32 entry);
+
+		void cullCell(s32 cell, const CFrustumCuller& culler, u32 planeMask);
+		void cullEntries(const core::array<u32>& list, const CFrustumCuller& culler, u32 planeMask);
+		void markSubtree(s32 cell, u8 visibility);
+
+		core::aabbox3df WorldBox;
+		f32 WorldSize;
+		u32 MaxDepth;
+
+		core::array<SCell> Cells;
+		core::array<SEntry> Entries;
+		core::array<u32> FreeEntries;
+		//! entries outside of the world box, in cell -1
+		core::array<u32> OutsideEntries;
+
+		//! temporary data for the batched tests
+		core::array<core::aabbox3df> BatchBoxes;
+		core::array<u8> BatchResults;
+		core::array<u8> BatchHints;
+
+		u32 Frame;
+		u32 CellsTested;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -11,18 +11,60 @@
 #include "SLight.h"
 #include "os.h"
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
+
 namespace irr
 {
 namespace scene
 {
 
+namespace
+{
+	//! vertex position used to find vertices at the same position
+	struct SPositionKey
+	{
+		core::vector3df Pos;
+		u32 Vertex;
+
+		bool operator<(const SPositionKey& other) const
+		{
+			if (Pos.X != other.Pos.X)
+				return Pos.X < other.Pos.X;
+			if (Pos.Y != other.Pos.Y)
+				return Pos.Y < other.Pos.Y;
+			if (Pos.Z != other.Pos.Z)
+				return Pos.Z < other.Pos.Z;
+			return Vertex < other.Vertex;
+		}
+	};
+
+	//! edge between two positions, sorted to find faces sharing it
+	struct SEdgeKey
+	{
+		u32 A, B;
+		// index of the edge, face*3+edge
+		u32 Edge;
+
+		bool operator<(const SEdgeKey& other) const
+		{
+			if (A != other.A)
+				return A < other.A;
+			if (B != other.B)
+				return B < other.B;
+			return Edge < other.Edge;
+		}
+	};
+}
+
 
 //! constructor
 CShadowVolumeSceneNode::CShadowVolumeSceneNode(const IMesh* shadowMesh, ISceneNode* parent,
 		ISceneManager* mgr, s32 id, bool zfailmethod, f32 infinity)
 : IShadowVolumeSceneNode(parent, mgr, id),
-	ShadowMesh(0), IndexCount(0), VertexCount(0), ShadowVolumesUsed(0),
-	Infinity(infinity), UseZFailMethod(zfailmethod)
+	ShadowMesh(0), IndexCount(0), VertexCount(0), UpdateCount(0),
+	CacheSize(0x100000), ExtrudedCount(0), Infinity(infinity), UseZFailMethod(zfailmethod)
 {
 	#ifdef _DEBUG
 	setDebugName("CShadowVolumeSceneNode");
@@ -42,44 +84,63 @@ CShadowVolumeSceneNode::~CShadowVolumeSceneNode()
 
 void CShadowVolumeSceneNode::createShadowVolume(const core::vector3df& light, bool isDirectional)
 {
-	SShadowVolume* svp = 0;
-	core::aabbox3d<f32>* bb = 0;
-
-	// builds the shadow volume and adds it to the shadow volume list.
+	u32 i;
 
-	if (ShadowVolumes.size() > ShadowVolumesUsed)
+	// nothing to do if the volume for this light is still valid
+	for (i=0; i<ShadowVolumes.size(); ++i)
 	{
-		// get the next unused buffer
+		SCachedShadowVolume& cached = ShadowVolumes[i];
+		if (cached.Valid && cached.LastUsed != UpdateCount &&
+			cached.Directional == isDirectional && cached.Light.equals(light))
+		{
+			cached.LastUsed = UpdateCount;
+			return;
+		}
+	}
 
-		svp = &ShadowVolumes[ShadowVolumesUsed];
-		svp->set_used(0);
+	// builds the shadow volume and adds it to the shadow volume list.
 
-		bb = &ShadowBBox[ShadowVolumesUsed];
-	}
-	else
+	// get an invalid buffer which is not used in this update
+	for (i=0; i<ShadowVolumes.size(); ++i)
 	{
-		ShadowVolumes.push_back(SShadowVolume());
-		svp = &ShadowVolumes.getLast();
-
-		ShadowBBox.push_back(core::aabbox3d<f32>());
-		bb = &ShadowBBox.getLast();
+		if (!ShadowVolumes[i].Valid && ShadowVolumes[i].LastUsed != UpdateCount)
+			break;
 	}
+	if (i == ShadowVolumes.size())
+		ShadowVolumes.push_back(SCachedShadowVolume());
+
+	SCachedShadowVolume& cached = ShadowVolumes[i];
+	cached.Light = light;
+	cached.Directional = isDirectional;
+	cached.LastUsed = UpdateCount;
+	cached.Valid = true;
+
+	SShadowVolume* svp = &cached.Volume;
+	core::aabbox3d<f32>* bb = &cached.BBox;
+	svp->set_used(0);
 	svp->reallocate(IndexCount*5);
-	++ShadowVolumesUsed;
 
 	// We use triangle lists
 	Edges.set_used(IndexCount*2);
 	u32 numEdges = 0;
 
+	// vertices are extruded once per light, not for every face
+	if (++ExtrudedCount == 0)
+	{
+		for (i=0; i<ExtrudedStamp.size(); ++i)
+			ExtrudedStamp[i] = 0;
+		ExtrudedCount = 1;
+	}
+
 	numEdges=createEdgesAndCaps(light, svp, bb);
 
 	// for all edges add the near->far quads
-	for (u32 i=0; i<numEdges; ++i)
+	for (i=0; i<numEdges; ++i)
 	{
 		const core::vector3df &v1 = Vertices[Edges[2*i+0]];
 		const core::vector3df &v2 = Vertices[Edges[2*i+1]];
-		const core::vector3df v3(v1+(v1 - light).normalize()*Infinity);
-		const core::vector3df v4(v2+(v2 - light).normalize()*Infinity);
+		const core::vector3df v3(getExtrudedVertex(Edges[2*i+0], light));
+		const core::vector3df v4(getExtrudedVertex(Edges[2*i+1], light));
 
 		// Add a quad (two triangles) to the vertex list
 #ifdef _DEBUG
@@ -97,9 +158,87 @@ void CShadowVolumeSceneNode::createShadowVolume(const core::vector3df& light, bo
 }
 
 
+//! Returns a vertex moved away from the light by Infinity
+const core::vector3df& CShadowVolumeSceneNode::getExtrudedVertex(u32 vertex, const core::vector3df& light)
+{
+	if (ExtrudedStamp[vertex] != ExtrudedCount)
+	{
+		ExtrudedStamp[vertex] = ExtrudedCount;
+		const core::vector3df& v = Vertices[vertex];
+		ExtrudedVertices[vertex] = v+(v-light).normalize()*Infinity;
+	}
+	return ExtrudedVertices[vertex];
+}
+
+
 #define IRR_USE_ADJACENCY
 #define IRR_USE_REVERSE_EXTRUDED
 
+//! Stores the normalized face normals, four faces x, y and z each
+void CShadowVolumeSceneNode::calculateFaceNormals()
+{
+	const u32 faceCount = IndexCount / 3;
+	FaceNormals.set_used(((faceCount + 3) / 4) * 12);
+
+	for (u32 i=0; i<faceCount; ++i)
+	{
+		const core::vector3df& v0 = Vertices[Indices[3*i+0]];
+		const core::vector3df& v1 = Vertices[Indices[3*i+1]];
+		const core::vector3df& v2 = Vertices[Indices[3*i+2]];
+
+#ifdef IRR_USE_REVERSE_EXTRUDED
+		const core::vector3df n = core::triangle3df(v0,v1,v2).getNormal().normalize();
+#else
+		const core::vector3df n = core::triangle3df(v2,v1,v0).getNormal().normalize();
+#endif
+
+		f32* block = &FaceNormals[(i >> 2) * 12 + (i & 3)];
+		block[0] = n.X;
+		block[4] = n.Y;
+		block[8] = n.Z;
+	}
+}
+
+
+//! Checks which faces are front facing the light
+void CShadowVolumeSceneNode::calculateFacing(const core::vector3df& light)
+{
+	// Same test as triangle3df::isFrontFacing(light)
+	const u32 faceCount = IndexCount / 3;
+	const f32* n = FaceNormals.const_pointer();
+	u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	const __m128 lx = _mm_set1_ps(light.X);
+	const __m128 ly = _mm_set1_ps(light.Y);
+	const __m128 lz = _mm_set1_ps(light.Z);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i+4 <= faceCount; i+=4, n+=12)
+	{
+		const __m128 d = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_loadu_ps(n), lx),
+			_mm_mul_ps(_mm_loadu_ps(n+4), ly)),
+			_mm_mul_ps(_mm_loadu_ps(n+8), lz));
+		const int mask = _mm_movemask_ps(_mm_cmple_ps(d, zero));
+		FaceData[i+0] = (mask & 1) != 0;
+		FaceData[i+1] = (mask & 2) != 0;
+		FaceData[i+2] = (mask & 4) != 0;
+		FaceData[i+3] = (mask & 8) != 0;
+	}
+#endif
+
+	for (; i<faceCount; ++i)
+	{
+		const f32* block = n + (i & 3);
+		const f32 d = block[0]*light.X + block[4]*light.Y + block[8]*light.Z;
+		FaceData[i] = F32_LOWER_EQUAL_0(d);
+		if ((i & 3) == 3)
+			n += 12;
+	}
+}
+
+
 u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
 					SShadowVolume* svp, core::aabbox3d<f32>* bb)
 {
@@ -112,20 +251,15 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
 		bb->reset(0,0,0);
 
 	// Check every face if it is front or back facing the light.
+	calculateFacing(light);
+
 	for (u32 i=0; i<faceCount; ++i)
 	{
-		const core::vector3df v0 = Vertices[Indices[3*i+0]];
-		const core::vector3df v1 = Vertices[Indices[3*i+1]];
-		const core::vector3df v2 = Vertices[Indices[3*i+2]];
-
-#ifdef IRR_USE_REVERSE_EXTRUDED
-		FaceData[i]=core::triangle3df(v0,v1,v2).isFrontFacing(light);
-#else
-		FaceData[i]=core::triangle3df(v2,v1,v0).isFrontFacing(light);
-#endif
-
 		if (UseZFailMethod && FaceData[i])
 		{
+			const core::vector3df& v0 = Vertices[Indices[3*i+0]];
+			const core::vector3df& v1 = Vertices[Indices[3*i+1]];
+			const core::vector3df& v2 = Vertices[Indices[3*i+2]];
 #ifdef _DEBUG
 			if (svp->size() >= svp->allocated_size()-5)
 				os::Printer::log("Allocation too small.", ELL_DEBUG);
@@ -136,9 +270,9 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
 			svp->push_back(v0);
 
 			// add back cap
-			const core::vector3df i0 = v0+(v0-light).normalize()*Infinity;
-			const core::vector3df i1 = v1+(v1-light).normalize()*Infinity;
-			const core::vector3df i2 = v2+(v2-light).normalize()*Infinity;
+			const core::vector3df& i0 = getExtrudedVertex(Indices[3*i+0], light);
+			const core::vector3df& i1 = getExtrudedVertex(Indices[3*i+1], light);
+			const core::vector3df& i2 = getExtrudedVertex(Indices[3*i+2], light);
 
 			svp->push_back(i0);
 			svp->push_back(i1);
@@ -156,13 +290,13 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
 		// check all front facing faces
 		if (FaceData[i] == true)
 		{
-			const u16 wFace0 = Indices[3*i+0];
-			const u16 wFace1 = Indices[3*i+1];
-			const u16 wFace2 = Indices[3*i+2];
+			const u32 wFace0 = Indices[3*i+0];
+			const u32 wFace1 = Indices[3*i+1];
+			const u32 wFace2 = Indices[3*i+2];
 
-			const u16 adj0 = Adjacency[3*i+0];
-			const u16 adj1 = Adjacency[3*i+1];
-			const u16 adj2 = Adjacency[3*i+2];
+			const u32 adj0 = Adjacency[3*i+0];
+			const u32 adj1 = Adjacency[3*i+1];
+			const u32 adj2 = Adjacency[3*i+2];
 
 			// add edges if face is adjacent to back-facing face
 			// or if no adjacent face was found
@@ -213,40 +347,106 @@ void CShadowVolumeSceneNode::setShadowMesh(const IMesh* mesh)
 		ShadowMesh->grab();
 		Box = ShadowMesh->getBoundingBox();
 	}
+	BufferStates.clear();
 }
 
 
-void CShadowVolumeSceneNode::updateShadowVolumes()
+//! Sets the memory the node may use to keep shadow volumes
+void CShadowVolumeSceneNode::setCacheSize(u32 bytes)
 {
-	const u32 oldIndexCount = IndexCount;
-	const u32 oldVertexCount = VertexCount;
+	CacheSize = bytes;
+	shrinkCache();
+}
 
+
+void CShadowVolumeSceneNode::updateShadowVolumes()
+{
 	const IMesh* const mesh = ShadowMesh;
 	if (!mesh)
 		return;
 
+	// volumes not used in this update are not rendered
+	++UpdateCount;
+
 	// create as much shadow volumes as there are lights but
 	// do not ignore the max light settings.
 	const u32 lightCount = SceneManager->getVideoDriver()->getDynamicLightCount();
 	if (!lightCount)
 		return;
 
+	updateMesh();
+
+	core::matrix4 mat = Parent->getAbsoluteTransformation();
+	mat.makeInverse();
+	const core::vector3df parentpos = Parent->getAbsolutePosition();
+
+	// TODO: Only correct for point lights.
+	for (u32 i=0; i<lightCount; ++i)
+	{
+		const video::SLight& dl = SceneManager->getVideoDriver()->getDynamicLight(i);
+		core::vector3df lpos = dl.Position;
+		if (dl.CastShadows &&
+			fabs((lpos - parentpos).getLengthSQ()) <= (dl.Radius*dl.Radius*4.0f))
+		{
+			mat.transformVect(lpos);
+			createShadowVolume(lpos);
+		}
+	}
+
+	shrinkCache();
+}
+
+
+//! Copies the mesh if it changed since the last update
+void CShadowVolumeSceneNode::updateMesh()
+{
+	const IMesh* const mesh = ShadowMesh;
+	const u32 bufcnt = mesh->getMeshBufferCount();
+
+	u32 i;
+	bool vertexChanged = BufferStates.size() != bufcnt;
+	bool indexChanged = vertexChanged;
+	for (i=0; i<bufcnt && !indexChanged; ++i)
+	{
+		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
+		const SBufferState& state = BufferStates[i];
+		if (state.Buffer != buf || state.ChangedIndex != buf->getChangedID_Index() ||
+			state.IndexCount != buf->getIndexCount() || state.VertexCount != buf->getVertexCount())
+			indexChanged = true;
+		else if (state.ChangedVertex != buf->getChangedID_Vertex())
+			vertexChanged = true;
+	}
+	if (!vertexChanged && !indexChanged)
+		return;
+
+	// all shadow volumes have to be built again
+	for (i=0; i<ShadowVolumes.size(); ++i)
+		ShadowVolumes[i].Valid = false;
+
+	const u32 oldIndexCount = IndexCount;
+	const u32 oldVertexCount = VertexCount;
+
 	// calculate total amount of vertices and indices
 
 	VertexCount = 0;
 	IndexCount = 0;
-	ShadowVolumesUsed = 0;
 
-	u32 i;
 	u32 totalVertices = 0;
 	u32 totalIndices = 0;
-	const u32 bufcnt = mesh->getMeshBufferCount();
+	BufferStates.set_used(bufcnt);
 
 	for (i=0; i<bufcnt; ++i)
 	{
 		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
 		totalIndices += buf->getIndexCount();
 		totalVertices += buf->getVertexCount();
+
+		SBufferState& state = BufferStates[i];
+		state.Buffer = buf;
+		state.ChangedVertex = buf->getChangedID_Vertex();
+		state.ChangedIndex = buf->getChangedID_Index();
+		state.VertexCount = buf->getVertexCount();
+		state.IndexCount = buf->getIndexCount();
 	}
 
 	// allocate memory if necessary
@@ -260,10 +460,20 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 	{
 		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
 
-		const u16* idxp = buf->getIndices();
-		const u16* idxpend = idxp + buf->getIndexCount();
-		for (; idxp!=idxpend; ++idxp)
-			Indices[IndexCount++] = *idxp + VertexCount;
+		if (buf->getIndexType() == video::EIT_32BIT)
+		{
+			const u32* idxp = (const u32*)buf->getIndices();
+			const u32* idxpend = idxp + buf->getIndexCount();
+			for (; idxp!=idxpend; ++idxp)
+				Indices[IndexCount++] = *idxp + VertexCount;
+		}
+		else
+		{
+			const u16* idxp = buf->getIndices();
+			const u16* idxpend = idxp + buf->getIndexCount();
+			for (; idxp!=idxpend; ++idxp)
+				Indices[IndexCount++] = *idxp + VertexCount;
+		}
 
 		const u32 vtxcnt = buf->getVertexCount();
 		for (u32 j=0; j<vtxcnt; ++j)
@@ -271,24 +481,45 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 	}
 
 	// recalculate adjacency if necessary
-	if (oldVertexCount != VertexCount || oldIndexCount != IndexCount)
+	if (indexChanged || oldVertexCount != VertexCount || oldIndexCount != IndexCount)
 		calculateAdjacency();
 
-	core::matrix4 mat = Parent->getAbsoluteTransformation();
-	mat.makeInverse();
-	const core::vector3df parentpos = Parent->getAbsolutePosition();
+	calculateFaceNormals();
 
-	// TODO: Only correct for point lights.
-	for (i=0; i<lightCount; ++i)
+	ExtrudedVertices.set_used(VertexCount);
+	ExtrudedStamp.set_used(VertexCount);
+	for (i=0; i<VertexCount; ++i)
+		ExtrudedStamp[i] = 0;
+	ExtrudedCount = 0;
+}
+
+
+//! Removes unused shadow volumes until the cache size is met
+void CShadowVolumeSceneNode::shrinkCache()
+{
+	u32 size = 0;
+	u32 i;
+	for (i=0; i<ShadowVolumes.size(); ++i)
+		size += ShadowVolumes[i].Volume.allocated_size() * sizeof(core::vector3df);
+
+	while (size > CacheSize)
 	{
-		const video::SLight& dl = SceneManager->getVideoDriver()->getDynamicLight(i);
-		core::vector3df lpos = dl.Position;
-		if (dl.CastShadows &&
-			fabs((lpos - parentpos).getLengthSQ()) <= (dl.Radius*dl.Radius*4.0f))
+		// invalid volumes first, then the ones unused for the longest time
+		s32 oldest = -1;
+		for (i=0; i<ShadowVolumes.size(); ++i)
 		{
-			mat.transformVect(lpos);
-			createShadowVolume(lpos);
+			const SCachedShadowVolume& cached = ShadowVolumes[i];
+			if (cached.LastUsed == UpdateCount)
+				continue;
+			if (oldest < 0 || (!cached.Valid && ShadowVolumes[oldest].Valid) ||
+				(cached.Valid == ShadowVolumes[oldest].Valid && cached.LastUsed < ShadowVolumes[oldest].LastUsed))
+				oldest = (s32)i;
 		}
+		if (oldest < 0)
+			break;
+
+		size -= ShadowVolumes[oldest].Volume.allocated_size() * sizeof(core::vector3df);
+		ShadowVolumes.erase(oldest);
 	}
 }
 
@@ -308,13 +539,16 @@ void CShadowVolumeSceneNode::render()
 {
 	video::IVideoDriver* driver = SceneManager->getVideoDriver();
 
-	if (!ShadowVolumesUsed || !driver)
+	if (!driver)
 		return;
 
 	driver->setTransform(video::ETS_WORLD, Parent->getAbsoluteTransformation());
 
-	for (u32 i=0; i<ShadowVolumesUsed; ++i)
+	for (u32 i=0; i<ShadowVolumes.size(); ++i)
 	{
+		if (ShadowVolumes[i].LastUsed != UpdateCount)
+			continue;
+
 		bool drawShadow = true;
 
 		if (UseZFailMethod && SceneManager->getActiveCamera())
@@ -327,7 +561,7 @@ void CShadowVolumeSceneNode::render()
 			frust.transform(invTrans);
 
 			core::vector3df edges[8];
-			ShadowBBox[i].getEdges(edges);
+			ShadowVolumes[i].BBox.getEdges(edges);
 
 			core::vector3df largestEdge = edges[0];
 			f32 maxDistance = core::vector3df(SceneManager->getActiveCamera()->getPosition() - edges[0]).getLength();
@@ -349,7 +583,7 @@ void CShadowVolumeSceneNode::render()
 		}
 
 		if(drawShadow)
-			driver->drawStencilShadowVolume(ShadowVolumes[i], UseZFailMethod, DebugDataVisible);
+			driver->drawStencilShadowVolume(ShadowVolumes[i].Volume, UseZFailMethod, DebugDataVisible);
 		else
 		{
 			core::array<core::vector3df> triangles;
@@ -371,46 +605,107 @@ void CShadowVolumeSceneNode::calculateAdjacency()
 {
 	Adjacency.set_used(IndexCount);
 
-	// go through all faces and fetch their three neighbours
+	// vertices at the same position get the same id
+	core::array<SPositionKey> positions;
+	positions.set_used(VertexCount);
+	u32 i;
+	for (i=0; i<VertexCount; ++i)
+	{
+		positions[i].Pos = Vertices[i];
+		positions[i].Vertex = i;
+	}
+	positions.set_sorted(false);
+	positions.sort();
+
+	// positions which are equal within the tolerance are close in x
+	core::array<u32> ids;
+	ids.set_used(VertexCount);
+	for (i=0; i<VertexCount; ++i)
+		ids[i] = 0xffffffff;
+	u32 id = 0;
+	for (i=0; i<VertexCount; ++i)
+	{
+		const SPositionKey& key = positions[i];
+		if (ids[key.Vertex] != 0xffffffff)
+			continue;
+		ids[key.Vertex] = id;
+
+		for (u32 j=i+1; j<VertexCount && positions[j].Pos.X - key.Pos.X <= core::ROUNDING_ERROR_f32; ++j)
+		{
+			if (ids[positions[j].Vertex] == 0xffffffff && positions[j].Pos.equals(key.Pos))
+				ids[positions[j].Vertex] = id;
+		}
+		++id;
+	}
+
+	// sort the edges of all faces, so shared edges are next to each other
+	core::array<SEdgeKey> edges;
+	edges.set_used(IndexCount);
 	for (u32 f=0; f<IndexCount; f+=3)
 	{
 		for (u32 edge = 0; edge<3; ++edge)
 		{
-			const core::vector3df& v1 = Vertices[Indices[f+edge]];
-			const core::vector3df& v2 = Vertices[Indices[f+((edge+1)%3)]];
+			const u32 a = ids[Indices[f+edge]];
+			const u32 b = ids[Indices[f+((edge+1)%3)]];
+
+			SEdgeKey& key = edges[f+edge];
+			key.A = core::min_(a, b);
+			key.B = core::max_(a, b);
+			key.Edge = f+edge;
+		}
+	}
+	edges.set_sorted(false);
+	edges.sort();
+
+	// degenerated edges are adjacent to any face with that position,
+	// so store the first two faces of each position
+	core::array<u32> firstFaces;
+	firstFaces.set_used(id*2);
+	for (i=0; i<id*2; ++i)
+		firstFaces[i] = 0xffffffff;
+	for (i=0; i<IndexCount; ++i)
+	{
+		u32* faces = &firstFaces[ids[Indices[i]]*2];
+		if (faces[0] == 0xffffffff)
+			faces[0] = i/3;
+		else if (faces[1] == 0xffffffff && faces[0] != i/3)
+			faces[1] = i/3;
+	}
 
-			// now we search an_O_ther _F_ace with these two
-			// vertices, which is not the current face.
-			u32 of;
+	// the first other face with the same edge is adjacent,
+	// no adjacent edges -> store face number
+	for (u32 first=0; first<IndexCount; )
+	{
+		u32 last = first+1;
+		while (last<IndexCount && edges[last].A == edges[first].A && edges[last].B == edges[first].B)
+			++last;
 
-			for (of=0; of<IndexCount; of+=3)
+		for (i=first; i<last; ++i)
+		{
+			const u32 face = edges[i].Edge/3;
+			u32 other = face;
+			if (edges[i].A == edges[i].B)
 			{
-				// only other faces
-				if (of != f)
+				const u32* faces = &firstFaces[edges[i].A*2];
+				other = (faces[0] != face) ? faces[0] : faces[1];
+				if (other == 0xffffffff)
+					other = face;
+			}
+			else
+			{
+				for (u32 j=first; j<last; ++j)
 				{
-					bool cnt1 = false;
-					bool cnt2 = false;
-
-					for (s32 e=0; e<3; ++e)
+					if (edges[j].Edge/3 != face)
 					{
-						if (v1.equals(Vertices[Indices[of+e]]))
-							cnt1=true;
-
-						if (v2.equals(Vertices[Indices[of+e]]))
-							cnt2=true;
-					}
-					// one match for each vertex, i.e. edge is the same
-					if (cnt1 && cnt2)
+						other = edges[j].Edge/3;
 						break;
+					}
 				}
 			}
-
-			// no adjacent edges -> store face number, else store adjacent face
-			if (of >= IndexCount)
-				Adjacency[f + edge] = f/3;
-			else
-				Adjacency[f + edge] = of/3;
+			Adjacency[edges[i].Edge] = other;
 		}
+
+		first = last;
 	}
 }
 
@@ -11,6 +11,7 @@ namespace irr
 {
 namespace scene
 {
+	class IMeshBuffer;
 
 	//! Scene node for rendering a shadow volume into a stencil buffer.
 	class CShadowVolumeSceneNode : public IShadowVolumeSceneNode
@@ -33,9 +34,18 @@ namespace scene
 		/** Called each render cycle from Animated Mesh SceneNode render method. */
 		virtual void updateShadowVolumes();
 
+		//! Sets the memory the node may use to keep shadow volumes
+		virtual void setCacheSize(u32 bytes);
+
+		//! Gets the memory the node may use to keep shadow volumes
+		virtual u32 getCacheSize() const { return CacheSize; }
+
 		//! pre render method
 		virtual void OnRegisterSceneNode();
 
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
 		//! renders the node.
 		virtual void render();
 
@@ -49,32 +59,87 @@ namespace scene
 
 		typedef core::array<core::vector3df> SShadowVolume;
 
+		//! shadow volume of one light, kept until the light or mesh changes
+		struct SCachedShadowVolume
+		{
+			SCachedShadowVolume() : LastUsed(0), Directional(false), Valid(false) {}
+
+			SShadowVolume Volume;
+
+			// back cap bounding box
+			core::aabbox3d<f32> BBox;
+
+			// light position in object space
+			core::vector3df Light;
+
+			// update in which the volume was used last
+			u32 LastUsed;
+
+			bool Directional;
+
+			// false after the mesh changed
+			bool Valid;
+		};
+
+		//! state of a mesh buffer when the mesh was copied
+		struct SBufferState
+		{
+			const IMeshBuffer* Buffer;
+			u32 ChangedVertex;
+			u32 ChangedIndex;
+			u32 VertexCount;
+			u32 IndexCount;
+		};
+
 		void createShadowVolume(const core::vector3df& pos, bool isDirectional=false);
 		u32 createEdgesAndCaps(const core::vector3df& light, SShadowVolume* svp, core::aabbox3d<f32>* bb);
 
 		//! Generates adjacency information based on mesh indices.
 		void calculateAdjacency();
 
+		//! Stores the normalized face normals
+		void calculateFaceNormals();
+
+		//! Checks which faces are front facing the light
+		void calculateFacing(const core::vector3df& light);
+
+		//! Returns a vertex moved away from the light by Infinity
+		const core::vector3df& getExtrudedVertex(u32 vertex, const core::vector3df& light);
+
+		//! Copies the mesh if it changed since the last update
+		void updateMesh();
+
+		//! Removes unused shadow volumes until the cache size is met
+		void shrinkCache();
+
 		core::aabbox3d<f32> Box;
 
-		// a shadow volume for every light
-		core::array<SShadowVolume> ShadowVolumes;
+		// shadow volumes of the lights used now and before
+		core::array<SCachedShadowVolume> ShadowVolumes;
 
-		// a back cap bounding box for every light
-		core::array<core::aabbox3d<f32> > ShadowBBox;
+		// state of the mesh buffers copied into Vertices and Indices
+		core::array<SBufferState> BufferStates;
 
 		core::array<core::vector3df> Vertices;
-		core::array<u16> Indices;
-		core::array<u16> Adjacency;
-		core::array<u16> Edges;
+		core::array<u32> Indices;
+		core::array<u32> Adjacency;
+		core::array<u32> Edges;
 		// tells if face is front facing
 		core::array<bool> FaceData;
+		// normals of four faces, first x, then y and z
+		core::array<f32> FaceNormals;
+		// vertices moved away from the current light
+		core::array<core::vector3df> ExtrudedVertices;
+		// ExtrudedCount if the vertex was moved for the current light
+		core::array<u32> ExtrudedStamp;
 
 		const scene::IMesh* ShadowMesh;
 
 		u32 IndexCount;
 		u32 VertexCount;
-		u32 ShadowVolumesUsed;
+		u32 UpdateCount;
+		u32 CacheSize;
+		u32 ExtrudedCount;
 
 		f32 Infinity;
 
@@ -23,6 +23,7 @@ class CSkyDomeSceneNode : public ISceneNode
 		virtual ~CSkyDomeSceneNode();
 		virtual void OnRegisterSceneNode();
 		virtual void render();
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
 		virtual const core::aabbox3d<f32>& getBoundingBox() const;
 		virtual video::SMaterial& getMaterial(u32 i);
 		virtual u32 getMaterialCount() const;
@@ -11,6 +11,8 @@
 #include "CBlit.h"
 #include "os.h"
 #include "S3DVertex.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
 
 namespace irr
 {
@@ -206,6 +208,9 @@ bool CSoftwareDriver::setActiveTexture(u32 stage, video::ITexture* texture)
 //! sets a material
 void CSoftwareDriver::setMaterial(const SMaterial& material)
 {
+	if (Material != material)
+		++MaterialChanges;
+
 	Material = material;
 	OverrideMaterial.apply(Material);
 
@@ -222,6 +227,8 @@ void CSoftwareDriver::setMaterial(const SMaterial& material)
 bool CSoftwareDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 		const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_BEGIN_SCENE);)
+
 	CNullDriver::beginScene(backBuffer, zBuffer, color, videoData, sourceRect);
 	WindowId=videoData.D3D9.HWnd;
 	SceneSourceRect = sourceRect;
@@ -239,6 +246,8 @@ bool CSoftwareDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 //! presents the rendered scene on the screen, returns false if failed
 bool CSoftwareDriver::endScene()
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_END_SCENE);)
+
 	CNullDriver::endScene();
 
 	return Presenter->present(BackBuffer, WindowId, SceneSourceRect);
@@ -13,6 +13,12 @@
 #include "S3DVertex.h"
 #include "S4DVertex.h"
 #include "CBlit.h"
+#include "IProfiler.h"
+#include "EProfileIDs.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
 
 
 #define MAT_TEXTURE(tex) ( (video::CSoftwareTexture2*) Material.org.getTexture ( tex ) )
@@ -337,7 +343,8 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 	WindowId(0), SceneSourceRect(0),
 	RenderTargetTexture(0), RenderTargetSurface(0), CurrentShader(0),
 	 DepthBuffer(0), StencilBuffer ( 0 ),
-	 CurrentOut ( 12 * 2, 128 ), Temp ( 12 * 2, 128 )
+	 CurrentOut ( 12 * 2, 128 ), Temp ( 12 * 2, 128 ),
+	 RasterThreads ( 0 ), RasterStateChanged ( true )
 {
 	#ifdef _DEBUG
 	setDebugName("CBurningVideoDriver");
@@ -366,38 +373,32 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 	DriverAttributes->setAttribute("Version", 47);
 
 	// create triangle renderers
+	createShaders ( BurningShader );
+
+	// create rasterizer threads, each with its own triangle renderers
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	const u32 threadCount = params.RasterizerThreads ? params.RasterizerThreads : CThreadPool::getProcessorCount();
+	if ( threadCount > 1 )
+	{
+		RasterThreads = new CThreadPool ( threadCount );
+
+		// set_used only grows the array to the requested size
+		RasterTriangles.reallocate ( SOFTWARE_DRIVER_2_RASTER_TRIANGLES_MAX );
 
-	irr::memset32 ( BurningShader, 0, sizeof ( BurningShader ) );
-	//BurningShader[ETR_FLAT] = createTRFlat2(DepthBuffer);
-	//BurningShader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
-	BurningShader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
-	BurningShader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
-	BurningShader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this );
-	//BurningShader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
-	BurningShader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
-
-	BurningShader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2 ( this );
-
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this );
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ( this );
-
-	BurningShader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
-	BurningShader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
-	BurningShader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
-
-	BurningShader[ETR_REFERENCE] = createTriangleRendererReference ( this );
+		RasterBands.reallocate ( threadCount );
+		for ( u32 i = 0; i != threadCount; ++i )
+		{
+			RasterBands.push_back ( SRasterBand () );
+			createShaders ( RasterBands[i].Shader );
+
+			for ( s32 s = 0; s != ETR2_COUNT; ++s )
+			{
+				if ( RasterBands[i].Shader[s] )
+					RasterBands[i].Shader[s]->setRasterBand ( i, threadCount );
+			}
+		}
+	}
+#endif
 
 
 	// add the same renderer for all solid types
@@ -461,6 +462,18 @@ CBurningVideoDriver::~CBurningVideoDriver()
 			BurningShader[i]->drop();
 	}
 
+	for (u32 i=0; i<RasterBands.size(); ++i)
+	{
+		for (s32 s=0; s<ETR2_COUNT; ++s)
+		{
+			if (RasterBands[i].Shader[s])
+				RasterBands[i].Shader[s]->drop();
+		}
+	}
+
+	if (RasterThreads)
+		RasterThreads->drop();
+
 	// delete Additional buffer
 	if (StencilBuffer)
 		StencilBuffer->drop();
@@ -476,6 +489,51 @@ CBurningVideoDriver::~CBurningVideoDriver()
 }
 
 
+/*!
+	creates the triangle renderers
+*/
+void CBurningVideoDriver::createShaders ( IBurningShader** shader )
+{
+	irr::memset32 ( shader, 0, sizeof ( IBurningShader* ) * ETR2_COUNT );
+	//shader[ETR_FLAT] = createTRFlat2(DepthBuffer);
+	//shader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
+	shader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
+	shader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
+	shader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this );
+	//shader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
+	//shader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
+	//shader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
+	shader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
+	shader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
+	shader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
+
+	shader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
+	shader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
+	shader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
+	shader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
+	shader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2 ( this );
+
+	shader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this );
+	shader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ( this );
+
+	shader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
+	shader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
+	shader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
+
+	shader[ETR_REFERENCE] = createTriangleRendererReference ( this );
+
+	shader[ETR_TEXTURE_GOURAUD_NEAREST] = createTriangleRendererTextureGouraudNearest2(this);
+	shader[ETR_TEXTURE_GOURAUD_ADD_NEAREST] = createTRTextureGouraudAddNearest2(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1_NEAREST] = createTriangleRendererTextureLightMap2_M1Nearest(this);
+	shader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2_NEAREST] = createTriangleRendererTextureLightMap2_M2Nearest(this);
+	shader[ETR_TEXTURE_LIGHTMAP_M4_NEAREST] = createTriangleRendererTextureLightMap2_M4Nearest(this);
+}
+
+
 /*!
 	selects the right triangle renderer based on the render states.
 */
@@ -570,6 +628,32 @@ void CBurningVideoDriver::setCurrentShader()
 
 	}
 
+	// use the point sampled pipelines if texture 0 is not filtered
+	const SMaterialLayer& layer0 = Material.org.TextureLayer[0];
+	if ( !layer0.BilinearFilter && !layer0.TrilinearFilter && !layer0.AnisotropicFilter )
+	{
+		switch ( shader )
+		{
+			case ETR_TEXTURE_GOURAUD:
+				shader = ETR_TEXTURE_GOURAUD_NEAREST;
+				break;
+			case ETR_TEXTURE_GOURAUD_ADD:
+				shader = ETR_TEXTURE_GOURAUD_ADD_NEAREST;
+				break;
+			case ETR_TEXTURE_GOURAUD_LIGHTMAP_M1:
+				shader = ETR_TEXTURE_GOURAUD_LIGHTMAP_M1_NEAREST;
+				break;
+			case ETR_TEXTURE_GOURAUD_LIGHTMAP_M2:
+				shader = ETR_TEXTURE_GOURAUD_LIGHTMAP_M2_NEAREST;
+				break;
+			case ETR_TEXTURE_LIGHTMAP_M4:
+				shader = ETR_TEXTURE_LIGHTMAP_M4_NEAREST;
+				break;
+			default:
+				break;
+		}
+	}
+
 	if ( !texture0 )
 	{
 		shader = ETR_GOURAUD;
@@ -583,25 +667,221 @@ void CBurningVideoDriver::setCurrentShader()
 	//shader = ETR_REFERENCE;
 
 	// switchToTriangleRenderer
+	CurrentRasterState.Material = Material;
+	CurrentRasterState.RenderTarget = RenderTargetSurface;
+	CurrentRasterState.ViewPort = ViewPort;
+	CurrentRasterState.Shader = shader;
+	RasterStateChanged = true;
+
 	CurrentShader = BurningShader[shader];
 	if ( CurrentShader )
+		setShaderState ( CurrentShader, CurrentRasterState );
+
+}
+
+
+/*!
+	sets the render states of a triangle renderer
+*/
+void CBurningVideoDriver::setShaderState ( IBurningShader* shader, const SRasterState& state )
+{
+	shader->setZCompareFunc ( state.Material.org.ZBuffer );
+	shader->setRenderTarget ( state.RenderTarget, state.ViewPort );
+	shader->setMaterial ( state.Material );
+
+	switch ( state.Shader )
 	{
-		CurrentShader->setZCompareFunc ( Material.org.ZBuffer );
-		CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort);
-		CurrentShader->setMaterial ( Material );
+		case ETR_TEXTURE_GOURAUD_ALPHA:
+		case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
+		case ETR_TEXTURE_BLEND:
+			shader->setParam ( 0, state.Material.org.MaterialTypeParam );
+			break;
+		default:
+		break;
+	}
+}
 
-		switch ( shader )
+
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+
+//! depth buffer use of the triangle renderers
+enum E_BURNING_DEPTH_ACCESS
+{
+	//! draws only pixels with w >= z
+	EBDA_TEST = 1,
+
+	//! may write the depth buffer
+	EBDA_WRITE = 2
+};
+
+static u32 getDepthAccess ( EBurningFFShader shader )
+{
+	switch ( shader )
+	{
+		case ETR_TEXTURE_GOURAUD_ADD_NO_Z:
+		case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
+		case ETR_TEXTURE_GOURAUD_VERTEX_ALPHA:
+			return EBDA_TEST;
+
+		case ETR_GOURAUD_ALPHA_NOZ:
+		case ETR_TEXTURE_GOURAUD_NOZ:
+		case ETR_STENCIL_SHADOW:
+			return 0;
+
+		// other compare functions
+		case ETR_TEXTURE_BLEND:
+		case ETR_REFERENCE:
+			return EBDA_WRITE;
+
+		default:
+			return EBDA_TEST | EBDA_WRITE;
+	}
+}
+
+#endif
+
+
+/*!
+	rasterizes the triangle in the bands of a shader, unless the depth buffer hides it
+*/
+void CBurningVideoDriver::rasterizeTriangle ( IBurningShader* shader, EBurningFFShader type,
+	const s4DVertex *a, const s4DVertex *b, const s4DVertex *c, u32 band, u32 bandCount )
+{
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+	const u32 depth = DepthBuffer ? getDepthAccess ( type ) : 0;
+
+	AbsRectangle area;
+	if ( depth )
+	{
+		area.x0 = core::floor32 ( core::min_ ( a->Pos.x, b->Pos.x, c->Pos.x ) );
+		area.y0 = core::floor32 ( core::min_ ( a->Pos.y, b->Pos.y, c->Pos.y ) );
+		area.x1 = core::ceil32 ( core::max_ ( a->Pos.x, b->Pos.x, c->Pos.x ) );
+		area.y1 = core::ceil32 ( core::max_ ( a->Pos.y, b->Pos.y, c->Pos.y ) );
+	}
+
+	// interpolated w can get a bit larger than at the vertices
+	if ( ( depth & EBDA_TEST ) &&
+		DepthBuffer->isOccluded ( area, core::max_ ( a->Pos.w, b->Pos.w, c->Pos.w ) * ( 1.f + 1.f / 1024.f ), band, bandCount ) )
+		return;
+#endif
+
+	shader->drawTriangle ( a, b, c );
+
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+	if ( depth & EBDA_WRITE )
+		DepthBuffer->invalidate ( area, band, bandCount );
+#endif
+}
+
+
+/*!
+	rasterizes the triangle, or bins it for the rasterizer threads
+*/
+void CBurningVideoDriver::drawTriangle ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c )
+{
+	// lines and stencil operations are drawn directly
+	if ( 0 == RasterThreads ||
+		CurrentRasterState.Shader == ETR_TEXTURE_GOURAUD_WIRE ||
+		CurrentRasterState.Shader == ETR_STENCIL_SHADOW )
+	{
+		flushRasterThreads ();
+		rasterizeTriangle ( CurrentShader, CurrentRasterState.Shader, a, b, c, 0, 1 );
+		return;
+	}
+
+	if ( RasterStateChanged )
+	{
+		RasterStates.push_back ( CurrentRasterState );
+		RasterStateChanged = false;
+	}
+
+	const u32 index = RasterTriangles.size();
+	RasterTriangles.set_used ( index + 1 );
+
+	SRasterTriangle &t = RasterTriangles[index];
+	t.Vertex[0] = *a;
+	t.Vertex[1] = *b;
+	t.Vertex[2] = *c;
+	t.State = RasterStates.size() - 1;
+
+	// textures and mipmap levels selected for this triangle
+	for ( u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+		CurrentShader->getTextureParam ( m, t.Texture[m], t.LodLevel[m] );
+
+	// bands touched by the scanlines, with a spare line on each side
+	const s32 top = core::s32_max ( core::floor32 ( core::min_ ( a->Pos.y, b->Pos.y, c->Pos.y ) ), 0 );
+	const s32 bottom = core::s32_max ( core::ceil32 ( core::max_ ( a->Pos.y, b->Pos.y, c->Pos.y ) ), top );
+	const u32 firstBand = (u32) top >> SOFTWARE_DRIVER_2_RASTER_BAND_HEIGHT_LOG2;
+	const u32 lastBand = (u32) bottom >> SOFTWARE_DRIVER_2_RASTER_BAND_HEIGHT_LOG2;
+
+	const u32 bandCount = RasterBands.size();
+	if ( lastBand - firstBand + 1 >= bandCount )
+	{
+		for ( u32 i = 0; i != bandCount; ++i )
+			RasterBands[i].Triangles.push_back ( index );
+	}
+	else
+	{
+		for ( u32 i = firstBand; i <= lastBand; ++i )
+			RasterBands[i % bandCount].Triangles.push_back ( index );
+	}
+
+	// limit the memory of the binned triangles
+	if ( RasterTriangles.size() >= SOFTWARE_DRIVER_2_RASTER_TRIANGLES_MAX )
+		flushRasterThreads ();
+}
+
+
+/*!
+	rasterizes all binned triangles
+*/
+void CBurningVideoDriver::flushRasterThreads ()
+{
+	if ( 0 == RasterTriangles.size() )
+		return;
+
+	RasterThreads->run ( this, RasterBands.size() );
+
+	for ( u32 i = 0; i != RasterBands.size(); ++i )
+		RasterBands[i].Triangles.set_used ( 0 );
+
+	RasterTriangles.set_used ( 0 );
+	RasterStates.set_used ( 0 );
+	RasterStateChanged = true;
+}
+
+
+/*!
+	rasterizes the triangles binned for one rasterizer thread, in the order they were drawn
+*/
+void CBurningVideoDriver::execute ( u32 index )
+{
+	SRasterBand &band = RasterBands[index];
+	IBurningShader *shader = 0;
+	u32 state = 0xFFFFFFFF;
+
+	for ( u32 i = 0; i != band.Triangles.size(); ++i )
+	{
+		const SRasterTriangle &t = RasterTriangles [ band.Triangles[i] ];
+
+		if ( t.State != state )
 		{
-			case ETR_TEXTURE_GOURAUD_ALPHA:
-			case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
-			case ETR_TEXTURE_BLEND:
-				CurrentShader->setParam ( 0, Material.org.MaterialTypeParam );
-				break;
-			default:
-			break;
+			state = t.State;
+			shader = band.Shader [ RasterStates[state].Shader ];
+			setShaderState ( shader, RasterStates[state] );
 		}
-	}
 
+		for ( u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+		{
+			CSoftwareTexture2 *texture;
+			s32 lodLevel;
+			shader->getTextureParam ( m, texture, lodLevel );
+			if ( texture != t.Texture[m] || ( texture && lodLevel != t.LodLevel[m] ) )
+				shader->setTextureParam ( m, t.Texture[m], t.LodLevel[m] );
+		}
+
+		rasterizeTriangle ( shader, RasterStates[state].Shader, t.Vertex + 0, t.Vertex + 1, t.Vertex + 2, index, RasterBands.size() );
+	}
 }
 
 
@@ -687,6 +967,10 @@ bool CBurningVideoDriver::beginScene(bool backBuffer, bool zBuffer,
 		SColor color, const SExposedVideoData& videoData,
 		core::rect<s32>* sourceRect)
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_BEGIN_SCENE);)
+
+	flushRasterThreads();
+
 	CNullDriver::beginScene(backBuffer, zBuffer, color, videoData, sourceRect);
 	WindowId = videoData.D3D9.HWnd;
 	SceneSourceRect = sourceRect;
@@ -705,6 +989,10 @@ bool CBurningVideoDriver::beginScene(bool backBuffer, bool zBuffer,
 //! presents the rendered scene on the screen, returns false if failed
 bool CBurningVideoDriver::endScene()
 {
+	IRR_PROFILE(CProfileScope p1(EPID_VIDEO_END_SCENE);)
+
+	flushRasterThreads();
+
 	CNullDriver::endScene();
 
 	return Presenter->present(BackBuffer, WindowId, SceneSourceRect);
@@ -721,6 +1009,8 @@ bool CBurningVideoDriver::setRenderTarget(video::ITexture* texture, bool clearBa
 		return false;
 	}
 
+	flushRasterThreads();
+
 	if (RenderTargetTexture)
 		RenderTargetTexture->drop();
 
@@ -786,6 +1076,10 @@ void CBurningVideoDriver::setViewPort(const core::rect<s32>& area)
 
 	Transformation [ ETS_CLIPSCALE ].buildNDCToDCMatrix ( ViewPort, 1 );
 
+	CurrentRasterState.RenderTarget = RenderTargetSurface;
+	CurrentRasterState.ViewPort = ViewPort;
+	RasterStateChanged = true;
+
 	if (CurrentShader)
 		CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort);
 }
@@ -1471,6 +1765,212 @@ clipandproject:
 	//return dest;
 }
 
+
+/*!
+	fill several cache lines, 4 at once if the vertex format and the
+	material allow it
+*/
+void CBurningVideoDriver::VertexCache_fill ( const u32 *sourceIndex, const u32 *destIndex, const u32 count )
+{
+	u32 i = 0;
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+	if ( VertexCache.batch )
+	{
+		for ( ; i < count; i += 4 )
+			VertexCache_fill4 ( sourceIndex + i, destIndex + i, core::min_ ( count - i, 4u ) );
+		return;
+	}
+#endif
+
+	for ( ; i != count; ++i )
+		VertexCache_fill ( sourceIndex[i], destIndex[i] );
+}
+
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+
+/*!
+	SSE2 version of VertexCache_fill for 4 vertices in SoA layout.
+	Same operations in the same order as the scalar code, so the results
+	are identical. Texture matrices and tangent space lights are not
+	handled, VertexCache_reset falls back to the scalar version for them.
+*/
+void CBurningVideoDriver::VertexCache_fill4 ( const u32 *sourceIndex, const u32 *destIndex, const u32 count )
+{
+	const S3DVertex *base[4];
+	s4DVertex *dest[4];
+	u32 i;
+
+	// unused lanes repeat the first vertex
+	for ( i = 0; i != 4; ++i )
+	{
+		const u32 k = i < count ? i : 0;
+		base[i] = (const S3DVertex*) ( (u8*) VertexCache.vertices + ( sourceIndex[k] * vSize[VertexCache.vType].Pitch ) );
+		dest[i] = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( destIndex[k] << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
+	}
+
+	for ( i = 0; i != count; ++i )
+	{
+		VertexCache.info[ destIndex[i] ].index = sourceIndex[i];
+		VertexCache.info[ destIndex[i] ].hit = 0;
+	}
+
+	const __m128 px = _mm_set_ps ( base[3]->Pos.X, base[2]->Pos.X, base[1]->Pos.X, base[0]->Pos.X );
+	const __m128 py = _mm_set_ps ( base[3]->Pos.Y, base[2]->Pos.Y, base[1]->Pos.Y, base[0]->Pos.Y );
+	const __m128 pz = _mm_set_ps ( base[3]->Pos.Z, base[2]->Pos.Z, base[1]->Pos.Z, base[0]->Pos.Z );
+
+	// transform Model * World * Camera * Projection * NDCSpace matrix
+	__m128 pos[4];
+	const f32 *M = Transformation [ ETS_CURRENT ].pointer();
+	for ( i = 0; i != 4; ++i )
+	{
+		pos[i] = _mm_add_ps ( _mm_add_ps ( _mm_add_ps (
+					_mm_mul_ps ( px, _mm_set1_ps ( M[i] ) ),
+					_mm_mul_ps ( py, _mm_set1_ps ( M[i+4] ) ) ),
+					_mm_mul_ps ( pz, _mm_set1_ps ( M[i+8] ) ) ),
+					_mm_set1_ps ( M[i+12] ) );
+	}
+
+	if ( VertexCache.vType != 4 )
+	{
+#if defined ( SOFTWARE_DRIVER_2_USE_VERTEX_COLOR )
+		u32 argb[4];
+		for ( i = 0; i != 4; ++i )
+			argb[i] = base[i]->Color.color;
+
+	#if defined (SOFTWARE_DRIVER_2_LIGHTING)
+		if ( Material.org.Lighting )
+		{
+			// vertex normal in light space
+			__m128 normal[3];
+			__m128 vertex[3];
+
+			normal[0] = _mm_set_ps ( base[3]->Normal.X, base[2]->Normal.X, base[1]->Normal.X, base[0]->Normal.X );
+			normal[1] = _mm_set_ps ( base[3]->Normal.Y, base[2]->Normal.Y, base[1]->Normal.Y, base[0]->Normal.Y );
+			normal[2] = _mm_set_ps ( base[3]->Normal.Z, base[2]->Normal.Z, base[1]->Normal.Z, base[0]->Normal.Z );
+			vertex[0] = px;
+			vertex[1] = py;
+			vertex[2] = pz;
+
+			if ( 0 == ( TransformationFlag[ETS_WORLD] & ETF_IDENTITY ) )
+			{
+				const f32 *W = Transformation[ETS_WORLD].pointer();
+				const __m128 nx = normal[0];
+				const __m128 ny = normal[1];
+				const __m128 nz = normal[2];
+
+				for ( i = 0; i != 3; ++i )
+				{
+					normal[i] = _mm_add_ps ( _mm_add_ps (
+								_mm_mul_ps ( nx, _mm_set1_ps ( W[i] ) ),
+								_mm_mul_ps ( ny, _mm_set1_ps ( W[i+4] ) ) ),
+								_mm_mul_ps ( nz, _mm_set1_ps ( W[i+8] ) ) );
+
+					// vertex in light space
+					vertex[i] = _mm_add_ps ( _mm_add_ps ( _mm_add_ps (
+								_mm_mul_ps ( px, _mm_set1_ps ( W[i] ) ),
+								_mm_mul_ps ( py, _mm_set1_ps ( W[i+4] ) ) ),
+								_mm_mul_ps ( pz, _mm_set1_ps ( W[i+8] ) ) ),
+								_mm_set1_ps ( W[i+12] ) );
+				}
+			}
+
+			if ( LightSpace.Flags & NORMALIZE )
+			{
+				const __m128 l = _mm_div_ps ( _mm_set1_ps ( 1.f ), _mm_sqrt_ps ( _mm_add_ps ( _mm_add_ps (
+							_mm_mul_ps ( normal[0], normal[0] ),
+							_mm_mul_ps ( normal[1], normal[1] ) ),
+							_mm_mul_ps ( normal[2], normal[2] ) ) ) );
+				normal[0] = _mm_mul_ps ( normal[0], l );
+				normal[1] = _mm_mul_ps ( normal[1], l );
+				normal[2] = _mm_mul_ps ( normal[2], l );
+			}
+
+			lightVertex4 ( dest, argb, count, normal, vertex );
+		}
+		else
+	#endif
+		{
+			for ( i = 0; i != count; ++i )
+				dest[i]->Color[0].setA8R8G8B8 ( argb[i] );
+		}
+#endif
+
+		for ( i = 0; i != count; ++i )
+		{
+			irr::memcpy32_small ( &dest[i]->Tex[0],&base[i]->TCoords,
+							vSize[VertexCache.vType].TexSize << 3 //  * ( sizeof ( f32 ) * 2 )
+						);
+		}
+	}
+
+	// test vertex
+	const __m128 sign = _mm_castsi128_ps ( _mm_set1_epi32 ( 0x80000000 ) );
+	u32 clip[6];
+	clip[0] = _mm_movemask_ps ( _mm_cmple_ps ( pos[2], pos[3] ) );
+	clip[1] = _mm_movemask_ps ( _mm_cmple_ps ( _mm_xor_ps ( pos[2], sign ), pos[3] ) );
+	clip[2] = _mm_movemask_ps ( _mm_cmple_ps ( pos[0], pos[3] ) );
+	clip[3] = _mm_movemask_ps ( _mm_cmple_ps ( _mm_xor_ps ( pos[0], sign ), pos[3] ) );
+	clip[4] = _mm_movemask_ps ( _mm_cmple_ps ( pos[1], pos[3] ) );
+	clip[5] = _mm_movemask_ps ( _mm_cmple_ps ( _mm_xor_ps ( pos[1], sign ), pos[3] ) );
+
+	// project homogenous vertex, store 1/w
+	const f32 * p = Transformation [ ETS_CLIPSCALE ].pointer();
+	const __m128 iw = _mm_div_ps ( _mm_set1_ps ( 1.f ), pos[3] );
+	const __m128 dcx = _mm_mul_ps ( iw, _mm_add_ps ( _mm_mul_ps ( pos[0], _mm_set1_ps ( p[ 0] ) ), _mm_mul_ps ( pos[3], _mm_set1_ps ( p[12] ) ) ) );
+	const __m128 dcy = _mm_mul_ps ( iw, _mm_add_ps ( _mm_mul_ps ( pos[1], _mm_set1_ps ( p[ 5] ) ), _mm_mul_ps ( pos[3], _mm_set1_ps ( p[13] ) ) ) );
+#ifndef SOFTWARE_DRIVER_2_USE_WBUFFER
+	const __m128 dcz = _mm_mul_ps ( pos[2], iw );
+#endif
+
+	// back to AoS
+	_MM_TRANSPOSE4_PS ( pos[0], pos[1], pos[2], pos[3] );
+
+	f32 out[4][4];
+	_mm_storeu_ps ( out[0], iw );
+	_mm_storeu_ps ( out[1], dcx );
+	_mm_storeu_ps ( out[2], dcy );
+#ifndef SOFTWARE_DRIVER_2_USE_WBUFFER
+	_mm_storeu_ps ( out[3], dcz );
+#endif
+
+	for ( i = 0; i != count; ++i )
+	{
+		s4DVertex *a = dest[i];
+		_mm_storeu_ps ( &a->Pos.x, pos[i] );
+
+		a[0].flag = a[1].flag = vSize[VertexCache.vType].Format;
+		a[0].flag |=	( ( clip[0] >> i ) & 1 )		| ( ( ( clip[1] >> i ) & 1 ) << 1 ) |
+					( ( ( clip[2] >> i ) & 1 ) << 2 ) | ( ( ( clip[3] >> i ) & 1 ) << 3 ) |
+					( ( ( clip[4] >> i ) & 1 ) << 4 ) | ( ( ( clip[5] >> i ) & 1 ) << 5 );
+
+		// to DC Space
+		if ( (a[0].flag & VERTEX4D_CLIPMASK ) != VERTEX4D_INSIDE )
+			continue;
+
+		a[1].flag = a->flag | VERTEX4D_PROJECTED;
+		a[1].Pos.x = out[1][i];
+		a[1].Pos.y = out[2][i];
+#ifndef SOFTWARE_DRIVER_2_USE_WBUFFER
+		a[1].Pos.z = out[3][i];
+#endif
+
+	#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		#ifdef SOFTWARE_DRIVER_2_PERSPECTIVE_CORRECT
+			a[1].Color[0] = a->Color[0] * out[0][i];
+		#else
+			a[1].Color[0] = a->Color[0];
+		#endif
+	#endif
+
+		a[1].LightTangent[0] = a[0].LightTangent[0] * out[0][i];
+		a[1].Pos.w = out[0][i];
+	}
+}
+
+#endif // _IRR_COMPILE_WITH_SSE2_
+
 //
 
 REALINLINE s4DVertex * CBurningVideoDriver::VertexCache_getVertex ( const u32 sourceIndex )
@@ -1568,6 +2068,10 @@ REALINLINE void CBurningVideoDriver::VertexCache_get(const s4DVertex ** face)
 		}
 
 		// fill new
+		u32 fillSource[VERTEXCACHE_ELEMENT];
+		u32 fillDest[VERTEXCACHE_ELEMENT];
+		u32 fillCount = 0;
+
 		for ( i = 0; i!= fillIndex; ++i )
 		{
 			if ( info[i].hit != VERTEXCACHE_MISS )
@@ -1577,13 +2081,17 @@ REALINLINE void CBurningVideoDriver::VertexCache_get(const s4DVertex ** face)
 			{
 				if ( 0 == VertexCache.info[dIndex].hit )
 				{
-					VertexCache_fill ( info[i].index, dIndex );
+					fillSource[fillCount] = info[i].index;
+					fillDest[fillCount] = dIndex;
+					fillCount += 1;
 					VertexCache.info[dIndex].hit += 1;
 					info[i].hit = dIndex;
 					break;
 				}
 			}
 		}
+
+		VertexCache_fill ( fillSource, fillDest, fillCount );
 	}
 
 	const u32 i0 = core::if_c_a_else_0 ( VertexCache.pType != scene::EPT_TRIANGLE_FAN, VertexCache.indicesRun );
@@ -1730,6 +2238,10 @@ void CBurningVideoDriver::VertexCache_reset ( const void* vertices, u32 vertexCo
 	}
 
 	irr::memset32 ( VertexCache.info, VERTEXCACHE_MISS, sizeof ( VertexCache.info ) );
+
+	// texture matrices and tangent space lights are only done by the scalar VertexCache_fill
+	VertexCache.batch = 0 == ( LightSpace.Flags & VERTEXTRANSFORM ) &&
+		( 0 == LightSpace.Light.size () || 0 == ( vSize[VertexCache.vType].Format & VERTEX4D_FORMAT_BUMP_DOT3 ) );
 }
 
 
@@ -1800,7 +2312,7 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 			}
 
 			// rasterize
-			CurrentShader->drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
+			drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
 			continue;
 		}
 
@@ -1879,7 +2391,7 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 		for ( g = 0; g <= vOut - 6; g += 2 )
 		{
 			// rasterize
-			CurrentShader->drawTriangle ( CurrentOut.data + 0 + 1,
+			drawTriangle ( CurrentOut.data + 0 + 1,
 							CurrentOut.data + g + 3,
 							CurrentOut.data + g + 5);
 		}
@@ -1984,6 +2496,9 @@ u32 CBurningVideoDriver::getMaximalDynamicLightAmount() const
 //! sets a material
 void CBurningVideoDriver::setMaterial(const SMaterial& material)
 {
+	if (Material.org != material)
+		++MaterialChanges;
+
 	Material.org = material;
 
 #ifdef SOFTWARE_DRIVER_2_TEXTURE_TRANSFORM
@@ -2184,6 +2699,168 @@ void CBurningVideoDriver::lightVertex ( s4DVertex *dest, u32 vertexargb )
 	dColor.saturate ( dest->Color[0], vertexargb );
 }
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+
+/*!
+	lightVertex for 4 vertices, normal and vertex in SoA layout.
+	lights which are out of range or facing away are masked per vertex
+*/
+void CBurningVideoDriver::lightVertex4 ( s4DVertex **dest, const u32 *vertexargb, const u32 count,
+										const __m128 *normal, const __m128 *vertex )
+{
+	sVec3 dColor;
+	u32 i;
+
+	dColor = LightSpace.Global_AmbientLight;
+	dColor.add ( Material.EmissiveColor );
+
+	if ( Lights.size () == 0 )
+	{
+		for ( i = 0; i != count; ++i )
+			dColor.saturate( dest[i]->Color[0], vertexargb[i] );
+		return;
+	}
+
+	const __m128 zero = _mm_setzero_ps ();
+	const __m128 one = _mm_set1_ps ( 1.f );
+
+	sVec3 ambient;
+	__m128 diffuse[3];
+	__m128 specular[3];
+
+	// the universe started in darkness..
+	ambient.set ( 0.f, 0.f, 0.f );
+	for ( i = 0; i != 3; ++i )
+	{
+		diffuse[i] = zero;
+		specular[i] = zero;
+	}
+
+	__m128 dot;
+	__m128 len;
+	__m128 mask;
+	__m128 attenuation;
+	__m128 vp[3];			// unit vector vertex to light
+	__m128 lightHalf[3];	// blinn-phong reflection
+
+	for ( u32 l = 0; l!= LightSpace.Light.size (); ++l )
+	{
+		const SBurningShaderLight &light = LightSpace.Light[l];
+
+		if ( !light.LightIsOn )
+			continue;
+
+		// accumulate ambient
+		ambient.add ( light.AmbientColor );
+
+		switch ( light.Type )
+		{
+			case video::ELT_SPOT:
+			case video::ELT_POINT:
+				// surface to light
+				vp[0] = _mm_sub_ps ( _mm_set1_ps ( light.pos.x ), vertex[0] );
+				vp[1] = _mm_sub_ps ( _mm_set1_ps ( light.pos.y ), vertex[1] );
+				vp[2] = _mm_sub_ps ( _mm_set1_ps ( light.pos.z ), vertex[2] );
+
+				len = _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( vp[0], vp[0] ), _mm_mul_ps ( vp[1], vp[1] ) ), _mm_mul_ps ( vp[2], vp[2] ) );
+				mask = _mm_cmpnlt_ps ( _mm_set1_ps ( light.radius ), len );
+
+				len = _mm_div_ps ( one, _mm_sqrt_ps ( len ) );
+
+				// build diffuse reflection
+
+				//angle between normal and light vector
+				vp[0] = _mm_mul_ps ( vp[0], len );
+				vp[1] = _mm_mul_ps ( vp[1], len );
+				vp[2] = _mm_mul_ps ( vp[2], len );
+				dot = _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( normal[0], vp[0] ), _mm_mul_ps ( normal[1], vp[1] ) ), _mm_mul_ps ( normal[2], vp[2] ) );
+				mask = _mm_and_ps ( mask, _mm_cmpnlt_ps ( dot, zero ) );
+				if ( 0 == _mm_movemask_ps ( mask ) )
+					continue;
+
+				attenuation = _mm_add_ps ( _mm_set1_ps ( light.constantAttenuation ),
+								_mm_sub_ps ( one, _mm_mul_ps ( len, _mm_set1_ps ( light.linearAttenuation ) ) ) );
+
+				// diffuse component
+				dot = _mm_and_ps ( mask, _mm_mul_ps ( _mm_mul_ps ( _mm_set1_ps ( 3.f ), dot ), attenuation ) );
+				diffuse[0] = _mm_add_ps ( diffuse[0], _mm_mul_ps ( _mm_set1_ps ( light.DiffuseColor.r ), dot ) );
+				diffuse[1] = _mm_add_ps ( diffuse[1], _mm_mul_ps ( _mm_set1_ps ( light.DiffuseColor.g ), dot ) );
+				diffuse[2] = _mm_add_ps ( diffuse[2], _mm_mul_ps ( _mm_set1_ps ( light.DiffuseColor.b ), dot ) );
+
+				if ( !(LightSpace.Flags & SPECULAR) )
+					continue;
+
+				// build specular
+				// surface to view
+				lightHalf[0] = _mm_sub_ps ( _mm_set1_ps ( LightSpace.campos.x ), vertex[0] );
+				lightHalf[1] = _mm_sub_ps ( _mm_set1_ps ( LightSpace.campos.y ), vertex[1] );
+				lightHalf[2] = _mm_sub_ps ( _mm_set1_ps ( LightSpace.campos.z ), vertex[2] );
+				len = _mm_div_ps ( one, _mm_sqrt_ps ( _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( lightHalf[0], lightHalf[0] ),
+							_mm_mul_ps ( lightHalf[1], lightHalf[1] ) ), _mm_mul_ps ( lightHalf[2], lightHalf[2] ) ) ) );
+				lightHalf[0] = _mm_add_ps ( _mm_mul_ps ( lightHalf[0], len ), vp[0] );
+				lightHalf[1] = _mm_add_ps ( _mm_mul_ps ( lightHalf[1], len ), vp[1] );
+				lightHalf[2] = _mm_add_ps ( _mm_mul_ps ( lightHalf[2], len ), vp[2] );
+				len = _mm_div_ps ( one, _mm_sqrt_ps ( _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( lightHalf[0], lightHalf[0] ),
+							_mm_mul_ps ( lightHalf[1], lightHalf[1] ) ), _mm_mul_ps ( lightHalf[2], lightHalf[2] ) ) ) );
+				lightHalf[0] = _mm_mul_ps ( lightHalf[0], len );
+				lightHalf[1] = _mm_mul_ps ( lightHalf[1], len );
+				lightHalf[2] = _mm_mul_ps ( lightHalf[2], len );
+
+				// specular
+				dot = _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( normal[0], lightHalf[0] ), _mm_mul_ps ( normal[1], lightHalf[1] ) ), _mm_mul_ps ( normal[2], lightHalf[2] ) );
+				mask = _mm_and_ps ( mask, _mm_cmpnlt_ps ( dot, zero ) );
+
+				dot = _mm_and_ps ( mask, _mm_mul_ps ( dot, attenuation ) );
+				specular[0] = _mm_add_ps ( specular[0], _mm_mul_ps ( _mm_set1_ps ( light.SpecularColor.r ), dot ) );
+				specular[1] = _mm_add_ps ( specular[1], _mm_mul_ps ( _mm_set1_ps ( light.SpecularColor.g ), dot ) );
+				specular[2] = _mm_add_ps ( specular[2], _mm_mul_ps ( _mm_set1_ps ( light.SpecularColor.b ), dot ) );
+				break;
+
+			case video::ELT_DIRECTIONAL:
+
+				//angle between normal and light vector
+				dot = _mm_add_ps ( _mm_add_ps ( _mm_mul_ps ( normal[0], _mm_set1_ps ( light.pos.x ) ),
+						_mm_mul_ps ( normal[1], _mm_set1_ps ( light.pos.y ) ) ),
+						_mm_mul_ps ( normal[2], _mm_set1_ps ( light.pos.z ) ) );
+				dot = _mm_and_ps ( _mm_cmpnlt_ps ( dot, zero ), dot );
+
+				// diffuse component
+				diffuse[0] = _mm_add_ps ( diffuse[0], _mm_mul_ps ( _mm_set1_ps ( light.DiffuseColor.r ), dot ) );
+				diffuse[1] = _mm_add_ps ( diffuse[1], _mm_mul_ps ( _mm_set1_ps ( light.DiffuseColor.g ), dot ) );
+				diffuse[2] = _mm_add_ps ( diffuse[2], _mm_mul_ps ( _mm_set1_ps ( light.DiffuseColor.b ), dot ) );
+				break;
+			default:
+				break;
+		}
+
+	}
+
+	// sum up lights
+	dColor.mulAdd (ambient, Material.AmbientColor );
+
+	f32 color[3][4];
+	_mm_storeu_ps ( color[0], _mm_min_ps ( _mm_add_ps ( _mm_add_ps ( _mm_set1_ps ( dColor.r ),
+			_mm_mul_ps ( diffuse[0], _mm_set1_ps ( Material.DiffuseColor.r ) ) ),
+			_mm_mul_ps ( specular[0], _mm_set1_ps ( Material.SpecularColor.r ) ) ), one ) );
+	_mm_storeu_ps ( color[1], _mm_min_ps ( _mm_add_ps ( _mm_add_ps ( _mm_set1_ps ( dColor.g ),
+			_mm_mul_ps ( diffuse[1], _mm_set1_ps ( Material.DiffuseColor.g ) ) ),
+			_mm_mul_ps ( specular[1], _mm_set1_ps ( Material.SpecularColor.g ) ) ), one ) );
+	_mm_storeu_ps ( color[2], _mm_min_ps ( _mm_add_ps ( _mm_add_ps ( _mm_set1_ps ( dColor.b ),
+			_mm_mul_ps ( diffuse[2], _mm_set1_ps ( Material.DiffuseColor.b ) ) ),
+			_mm_mul_ps ( specular[2], _mm_set1_ps ( Material.SpecularColor.b ) ) ), one ) );
+
+	for ( i = 0; i != count; ++i )
+	{
+		sVec4 &c = dest[i]->Color[0];
+		c.x = ( ( vertexargb[i] & 0xFF000000 ) >> 24 ) * ( 1.f / 255.f );
+		c.y = color[0][i];
+		c.z = color[1][i];
+		c.w = color[2][i];
+	}
+}
+
+#endif // _IRR_COMPILE_WITH_SSE2_
+
 #endif
 
 
@@ -2201,6 +2878,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 			return;
 		}
 
+		flushRasterThreads();
+
 #if 0
 		// 2d methods don't use viewPort
 		core::position2di dest = destPos;
@@ -2239,6 +2918,8 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 			return;
 		}
 
+	flushRasterThreads();
+
 	if (useAlphaChannelOfTexture)
 		StretchBlit(BLITTER_TEXTURE_ALPHA_BLEND, RenderTargetSurface, &destRect, &sourceRect,
 			    ((CSoftwareTexture2*)texture)->getImage(), (colors ? colors[0].color : 0));
@@ -2253,6 +2934,7 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 					const core::position2d<s32>& end,
 					SColor color)
 {
+	flushRasterThreads();
 	drawLine(BackBuffer, start, end, color );
 }
 
@@ -2260,6 +2942,7 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 //! Draws a pixel
 void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 {
+	flushRasterThreads();
 	BackBuffer->setPixel(x, y, color, true);
 }
 
@@ -2268,6 +2951,8 @@ void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 void CBurningVideoDriver::draw2DRectangle(SColor color, const core::rect<s32>& pos,
 									 const core::rect<s32>* clip)
 {
+	flushRasterThreads();
+
 	if (clip)
 	{
 		core::rect<s32> p(pos);
@@ -2304,6 +2989,8 @@ void CBurningVideoDriver::OnResize(const core::dimension2d<u32>& size)
 
 	if (ScreenSize != realSize)
 	{
+		flushRasterThreads();
+
 		if (ViewPort.getWidth() == (s32)ScreenSize.Width &&
 			ViewPort.getHeight() == (s32)ScreenSize.Height)
 		{
@@ -2349,6 +3036,8 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 	if (!pos.isValid())
 		return;
 
+	flushRasterThreads();
+
 	const core::dimension2d<s32> renderTargetSize ( ViewPort.getSize() );
 
 	const s32 xPlus = -(renderTargetSize.Width>>1);
@@ -2451,6 +3140,8 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 void CBurningVideoDriver::draw3DLine(const core::vector3df& start,
 	const core::vector3df& end, SColor color)
 {
+	flushRasterThreads();
+
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[0].Pos.x, start );
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[2].Pos.x, end );
 
@@ -2491,6 +3182,21 @@ void CBurningVideoDriver::draw3DLine(const core::vector3df& start,
 	{
 		// rasterize
 		line->drawLine ( CurrentOut.data + 1, CurrentOut.data + g + 3 );
+
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+		if ( DepthBuffer )
+		{
+			const s4DVertex *a = CurrentOut.data + 1;
+			const s4DVertex *b = CurrentOut.data + g + 3;
+
+			AbsRectangle area;
+			area.x0 = core::floor32 ( core::min_ ( a->Pos.x, b->Pos.x ) );
+			area.y0 = core::floor32 ( core::min_ ( a->Pos.y, b->Pos.y ) );
+			area.x1 = core::ceil32 ( core::max_ ( a->Pos.x, b->Pos.x ) );
+			area.y1 = core::ceil32 ( core::max_ ( a->Pos.y, b->Pos.y ) );
+			DepthBuffer->invalidate ( area, 0, 1 );
+		}
+#endif
 	}
 }
 
@@ -2543,7 +3249,7 @@ ITexture* CBurningVideoDriver::addRenderTargetTexture(const core::dimension2d<u3
 		const io::path& name, const ECOLOR_FORMAT format)
 {
 	IImage* img = createImage(BURNINGSHADER_COLOR_FORMAT, size);
-	ITexture* tex = new CSoftwareTexture2(img, name, CSoftwareTexture2::IS_RENDERTARGET );
+	ITexture* tex = new CSoftwareTexture2(img, name, CSoftwareTexture2::IS_RENDERTARGET, 0, this );
 	img->drop();
 	addTexture(tex);
 	tex->drop();
@@ -2554,6 +3260,8 @@ ITexture* CBurningVideoDriver::addRenderTargetTexture(const core::dimension2d<u3
 //! Clears the DepthBuffer.
 void CBurningVideoDriver::clearZBuffer()
 {
+	flushRasterThreads();
+
 	if (DepthBuffer)
 		DepthBuffer->clear();
 }
@@ -2565,6 +3273,8 @@ IImage* CBurningVideoDriver::createScreenShot(video::ECOLOR_FORMAT format, video
 	if (target != video::ERT_FRAME_BUFFER)
 		return 0;
 
+	flushRasterThreads();
+
 	if (BackBuffer)
 	{
 		IImage* tmp = createImage(BackBuffer->getColorFormat(), BackBuffer->getDimension());
@@ -2583,7 +3293,7 @@ ITexture* CBurningVideoDriver::createDeviceDependentTexture(IImage* surface, con
 	return new CSoftwareTexture2(
 		surface, name,
 		(getTextureCreationFlag(ETCF_CREATE_MIP_MAPS) ? CSoftwareTexture2::GEN_MIPMAP : 0 ) |
-		(getTextureCreationFlag(ETCF_ALLOW_NON_POWER_2) ? 0 : CSoftwareTexture2::NP2_SIZE ), mipmapData);
+		(getTextureCreationFlag(ETCF_ALLOW_NON_POWER_2) ? 0 : CSoftwareTexture2::NP2_SIZE ), mipmapData, this);
 
 }
 
@@ -2605,7 +3315,10 @@ void CBurningVideoDriver::drawStencilShadowVolume(const core::array<core::vector
 	const u32 count = triangles.size();
 	IBurningShader *shader = BurningShader [ ETR_STENCIL_SHADOW ];
 
+	flushRasterThreads();
+
 	CurrentShader = shader;
+	CurrentRasterState.Shader = ETR_STENCIL_SHADOW;
 	shader->setRenderTarget(RenderTargetSurface, ViewPort);
 
 	Material.org.MaterialType = video::EMT_SOLID;
@@ -2665,6 +3378,9 @@ void CBurningVideoDriver::drawStencilShadow(bool clearStencilBuffer, video::SCol
 {
 	if (!StencilBuffer)
 		return;
+
+	flushRasterThreads();
+
 	// draw a shadow rectangle covering the entire screen using stencil buffer
 	const u32 h = RenderTargetSurface->getDimension().Height;
 	const u32 w = RenderTargetSurface->getDimension().Width;
@@ -2696,6 +3412,23 @@ core::dimension2du CBurningVideoDriver::getMaxTextureSize() const
 }
 
 
+//! Removes a texture from the texture cache and deletes it.
+void CBurningVideoDriver::removeTexture(ITexture* texture)
+{
+	// binned triangles may still use it
+	flushRasterThreads();
+	CNullDriver::removeTexture(texture);
+}
+
+
+//! Removes all textures from the texture cache and deletes them.
+void CBurningVideoDriver::removeAllTextures()
+{
+	flushRasterThreads();
+	CNullDriver::removeAllTextures();
+}
+
+
 } // end namespace video
 } // end namespace irr
 
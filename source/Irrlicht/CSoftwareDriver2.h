@@ -12,13 +12,19 @@
 #include "os.h"
 #include "irrString.h"
 #include "SIrrCreationParameters.h"
+#include "CThreadPool.h"
+
+#ifdef _IRR_COMPILE_WITH_SSE2_
+#include <emmintrin.h>
+#endif
 
 namespace irr
 {
 namespace video
 {
-	class CBurningVideoDriver : public CNullDriver
+	class CBurningVideoDriver : public CNullDriver, public IThreadJob
 	{
+		friend class CSoftwareTexture2;
 	public:
 
 		//! constructor
@@ -166,6 +172,15 @@ namespace video
 		virtual IDepthBuffer * getDepthBuffer () { return DepthBuffer; }
 		virtual IStencilBuffer * getStencilBuffer () { return StencilBuffer; }
 
+		//! Removes a texture from the texture cache and deletes it.
+		virtual void removeTexture(ITexture* texture);
+
+		//! Removes all textures from the texture cache and deletes them.
+		virtual void removeAllTextures();
+
+		//! rasterizes the triangles binned for one rasterizer thread
+		virtual void execute(u32 index);
+
 	protected:
 
 
@@ -195,6 +210,9 @@ namespace video
 		IBurningShader* CurrentShader;
 		IBurningShader* BurningShader[ETR2_COUNT];
 
+		//! creates the triangle renderers
+		void createShaders ( IBurningShader** shader );
+
 		IDepthBuffer* DepthBuffer;
 		IStencilBuffer* StencilBuffer;
 
@@ -242,8 +260,14 @@ namespace video
 		void VertexCache_getbypass ( s4DVertex ** face );
 
 		void VertexCache_fill ( const u32 sourceIndex,const u32 destIndex );
+		void VertexCache_fill ( const u32 *sourceIndex, const u32 *destIndex, const u32 count );
 		s4DVertex * VertexCache_getVertex ( const u32 sourceIndex );
 
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		//! transform, light, clip test and project up to 4 vertices at once
+		void VertexCache_fill4 ( const u32 *sourceIndex, const u32 *destIndex, const u32 count );
+#endif
+
 
 		// culling & clipping
 		u32 clipToHyperPlane ( s4DVertex * dest, const s4DVertex * source, u32 inCount, const sVec4 &plane );
@@ -254,6 +278,10 @@ namespace video
 #ifdef SOFTWARE_DRIVER_2_LIGHTING
 
 		void lightVertex ( s4DVertex *dest, u32 vertexargb );
+#ifdef _IRR_COMPILE_WITH_SSE2_
+		void lightVertex4 ( s4DVertex **dest, const u32 *vertexargb, const u32 count,
+					const __m128 *normal, const __m128 *vertex );
+#endif
 		//! Sets the fog mode.
 		virtual void setFog(SColor color, E_FOG_TYPE fogType, f32 start,
 			f32 end, f32 density, bool pixelFog, bool rangeFog);
@@ -280,6 +308,58 @@ namespace video
 		SBurningShaderMaterial Material;
 
 		static const sVec4 NDCPlane[6];
+
+
+		/*
+			Multithreaded rasterizer
+			-> triangles are transformed and clipped on the calling thread
+			-> binned to interleaved bands of scanlines
+			-> each band is rasterized by one thread, in submission order
+		*/
+
+		// state of the triangle renderer
+		struct SRasterState
+		{
+			SBurningShaderMaterial Material;
+			video::IImage* RenderTarget;
+			core::rect<s32> ViewPort;
+			EBurningFFShader Shader;
+		};
+
+		// a triangle in device coordinates
+		struct SRasterTriangle
+		{
+			s4DVertex Vertex[3];
+			CSoftwareTexture2* Texture[BURNING_MATERIAL_MAX_TEXTURES];
+			s32 LodLevel[BURNING_MATERIAL_MAX_TEXTURES];
+			u32 State;
+		};
+
+		// triangle renderers of a thread and the triangles touching its bands
+		struct SRasterBand
+		{
+			IBurningShader* Shader[ETR2_COUNT];
+			core::array<u32> Triangles;
+		};
+
+		static void setShaderState ( IBurningShader* shader, const SRasterState& state );
+
+		//! rasterizes the triangle, or bins it for the rasterizer threads
+		void drawTriangle ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c );
+
+		//! rasterizes the triangle in the bands of a shader, unless the depth buffer hides it
+		void rasterizeTriangle ( IBurningShader* shader, EBurningFFShader type,
+			const s4DVertex *a, const s4DVertex *b, const s4DVertex *c, u32 band, u32 bandCount );
+
+		//! rasterizes all binned triangles
+		void flushRasterThreads ();
+
+		CThreadPool* RasterThreads;
+		core::array<SRasterBand> RasterBands;
+		core::array<SRasterState> RasterStates;
+		core::array<SRasterTriangle> RasterTriangles;
+		SRasterState CurrentRasterState;
+		bool RasterStateChanged;
 	};
 
 } // end namespace video
@@ -8,6 +8,7 @@
 #include "SoftwareDriver2_compile_config.h"
 #include "SoftwareDriver2_helper.h"
 #include "CSoftwareTexture2.h"
+#include "CSoftwareDriver2.h"
 #include "os.h"
 
 namespace irr
@@ -17,8 +18,9 @@ namespace video
 
 //! constructor
 CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name,
-		u32 flags, void* mipmapData)
-		: ITexture(name), MipMapLOD(0), Flags ( flags ), OriginalFormat(video::ECF_UNKNOWN)
+		u32 flags, void* mipmapData, CBurningVideoDriver* driver)
+		: ITexture(name), Driver(driver), MipMapLOD(0), Flags ( flags ), OriginalFormat(video::ECF_UNKNOWN),
+		LockReadOnly(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CSoftwareTexture2");
@@ -29,6 +31,9 @@ CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name,
 	#endif
 
 	memset32 ( MipMap, 0, sizeof ( MipMap ) );
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+	memset32 ( TiledMipMap, 0, sizeof ( TiledMipMap ) );
+#endif
 
 	if (image)
 	{
@@ -81,18 +86,46 @@ CSoftwareTexture2::~CSoftwareTexture2()
 	{
 		if ( MipMap[i] )
 			MipMap[i]->drop();
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+		if ( TiledMipMap[i] )
+			TiledMipMap[i]->drop();
+#endif
 	}
 }
 
 
+//! lock function
+void* CSoftwareTexture2::lock(E_TEXTURE_LOCK_MODE mode, u32 mipmapLevel)
+{
+	if (Flags & GEN_MIPMAP)
+		MipMapLOD=mipmapLevel;
+	LockReadOnly = mode == ETLM_READ_ONLY;
+
+	// triangles binned before must be drawn with the old texels
+	if ( !LockReadOnly && Driver )
+		Driver->flushRasterThreads ();
+
+	return MipMap[MipMapLOD]->lock();
+}
+
+
 //! Regenerates the mip map levels of the texture. Useful after locking and
 //! modifying the texture
 void CSoftwareTexture2::regenerateMipMapLevels(void* mipmapData)
 {
+	s32 i;
+
+	// the levels are replaced while binned triangles may use them
+	if ( Driver )
+		Driver->flushRasterThreads ();
+
 	if ( !hasMipMaps () )
+	{
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+		tileMipMap ( MipMapLOD );
+#endif
 		return;
-
-	s32 i;
+	}
 
 	// release
 	for ( i = 1; i < SOFTWARE_DRIVER_2_MIPMAPPING_MAX; ++i )
@@ -103,6 +136,18 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* mipmapData)
 
 	core::dimension2d<u32> newSize;
 	core::dimension2d<u32> origSize=OrigSize;
+	ECOLOR_FORMAT dataFormat = OriginalFormat;
+
+	// without given levels, the whole chain is built from level 0 in one pass
+	u8* chain = 0;
+	if ( !mipmapData )
+	{
+		origSize = MipMap[0]->getDimension();
+		dataFormat = BURNINGSHADER_COLOR_FORMAT;
+		chain = new u8 [ IImage::getMipMapsDataSize ( dataFormat, origSize ) ];
+		MipMap[0]->copyToMipMaps ( chain );
+		mipmapData = chain;
+	}
 
 	for (i=1; i < SOFTWARE_DRIVER_2_MIPMAPPING_MAX; ++i)
 	{
@@ -112,42 +157,83 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* mipmapData)
 		origSize.Width = core::s32_max(1, origSize.Width >> 1);
 		origSize.Height = core::s32_max(1, origSize.Height >> 1);
 
-		if (mipmapData)
+		if (dataFormat != BURNINGSHADER_COLOR_FORMAT)
 		{
-			if (OriginalFormat != BURNINGSHADER_COLOR_FORMAT)
+			IImage* tmpImage = new CImage(dataFormat, origSize, mipmapData, true, false);
+			MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
+			if (origSize==newSize)
+				tmpImage->copyTo(MipMap[i]);
+			else
+				tmpImage->copyToScalingBoxFilter(MipMap[i]);
+			tmpImage->drop();
+		}
+		else
+		{
+			if (origSize==newSize)
+				MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize, mipmapData, false);
+			else
 			{
-				IImage* tmpImage = new CImage(OriginalFormat, origSize, mipmapData, true, false);
 				MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
-				if (origSize==newSize)
-					tmpImage->copyTo(MipMap[i]);
-				else
-					tmpImage->copyToScalingBoxFilter(MipMap[i]);
+				IImage* tmpImage = new CImage(BURNINGSHADER_COLOR_FORMAT, origSize, mipmapData, true, false);
+				tmpImage->copyToScalingBoxFilter(MipMap[i]);
 				tmpImage->drop();
 			}
-			else
-			{
-				if (origSize==newSize)
-					MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize, mipmapData, false);
-				else
-				{
-					MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
-					IImage* tmpImage = new CImage(BURNINGSHADER_COLOR_FORMAT, origSize, mipmapData, true, false);
-					tmpImage->copyToScalingBoxFilter(MipMap[i]);
-					tmpImage->drop();
-				}
-			}
-			mipmapData = (u8*)mipmapData+origSize.getArea()*IImage::getBitsPerPixelFromFormat(OriginalFormat)/8;
 		}
-		else
-		{
-			MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
+		// the data ends with the 1x1 level, it is used for all smaller levels
+		if ( origSize.Width > 1 || origSize.Height > 1 )
+			mipmapData = (u8*)mipmapData+origSize.getArea()*IImage::getBitsPerPixelFromFormat(dataFormat)/8;
+	}
 
-			//static u32 color[] = { 0, 0xFFFF0000, 0xFF00FF00,0xFF0000FF,0xFFFFFF00,0xFFFF00FF,0xFF00FFFF,0xFF0F0F0F };
-			MipMap[i]->fill ( 0 );
-			MipMap[0]->copyToScalingBoxFilter( MipMap[i], 0, false );
+	delete [] chain;
+
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+	for ( i = 0; i < SOFTWARE_DRIVER_2_MIPMAPPING_MAX; ++i )
+		tileMipMap ( i );
+#endif
+}
+
+
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+//! copies a mipmap level into its tiled surface
+void CSoftwareTexture2::tileMipMap(u32 level)
+{
+	if ( TiledMipMap[level] )
+	{
+		TiledMipMap[level]->drop();
+		TiledMipMap[level] = 0;
+	}
+
+	// render targets are drawn linear, the masks of the samplers need a power of two
+	CImage* src = MipMap[level];
+	if ( !src || ( Flags & IS_RENDERTARGET ) )
+		return;
+
+	const core::dimension2d<u32>& dim = src->getDimension();
+	if ( ( dim.Width & ( dim.Width - 1 ) ) || ( dim.Height & ( dim.Height - 1 ) ) )
+		return;
+
+	TiledMipMap[level] = new CImage ( BURNINGSHADER_COLOR_FORMAT, dim );
+
+	// same layout as getTexel_row and getTexel_column
+	const u32 widthLog2 = s32_log2_s32 ( dim.Width );
+	const u32 tileWidthLog2 = core::s32_min ( SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2, widthLog2 );
+	const u32 tileHeightLog2 = core::s32_min ( SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2, s32_log2_s32 ( dim.Height ) );
+	const u32 tileXMask = ( 1 << tileWidthLog2 ) - 1;
+	const u32 tileYMask = ( 1 << tileHeightLog2 ) - 1;
+
+	const tVideoSample* s = (const tVideoSample*) src->lock();
+	tVideoSample* d = (tVideoSample*) TiledMipMap[level]->lock();
+
+	for ( u32 y = 0; y != dim.Height; ++y )
+	{
+		const u32 row = ( ( y & tileYMask ) << tileWidthLog2 ) | ( ( y & ~tileYMask ) << widthLog2 );
+		for ( u32 x = 0; x != dim.Width; ++x )
+		{
+			d [ row | ( x & tileXMask ) | ( ( x & ~tileXMask ) << tileHeightLog2 ) ] = *s++;
 		}
 	}
 }
+#endif
 
 
 } // end namespace video
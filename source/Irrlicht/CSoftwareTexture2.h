@@ -15,6 +15,8 @@ namespace irr
 namespace video
 {
 
+class CBurningVideoDriver;
+
 /*!
 	interface for a Video Driver dependent Texture.
 */
@@ -30,23 +32,23 @@ public:
 		NP2_SIZE	= 4,
 		HAS_ALPHA	= 8
 	};
-	CSoftwareTexture2(IImage* surface, const io::path& name, u32 flags, void* mipmapData=0);
+	CSoftwareTexture2(IImage* surface, const io::path& name, u32 flags, void* mipmapData=0,
+		CBurningVideoDriver* driver=0);
 
 	//! destructor
 	virtual ~CSoftwareTexture2();
 
 	//! lock function
-	virtual void* lock(E_TEXTURE_LOCK_MODE mode=ETLM_READ_WRITE, u32 mipmapLevel=0)
-	{
-		if (Flags & GEN_MIPMAP)
-			MipMapLOD=mipmapLevel;
-		return MipMap[MipMapLOD]->lock();
-	}
+	virtual void* lock(E_TEXTURE_LOCK_MODE mode=ETLM_READ_WRITE, u32 mipmapLevel=0);
 
 	//! unlock function
 	virtual void unlock()
 	{
 		MipMap[MipMapLOD]->unlock();
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+		if (!LockReadOnly)
+			tileMipMap(MipMapLOD);
+#endif
 	}
 
 	//! Returns original size of the texture.
@@ -81,6 +83,20 @@ public:
 		return MipMap[MipMapLOD];
 	}
 
+	//! returns the surface of a mipmap level, without changing the level of the texture
+	CImage* getMipMap(u32 mipmapLevel) const
+	{
+		return MipMap[(Flags & GEN_MIPMAP) ? mipmapLevel : MipMapLOD];
+	}
+
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+	//! returns the copy of getMipMap() stored in tiles, 0 if the level is sampled linear
+	CImage* getTiledMipMap(u32 mipmapLevel) const
+	{
+		return TiledMipMap[(Flags & GEN_MIPMAP) ? mipmapLevel : MipMapLOD];
+	}
+#endif
+
 
 	//! returns driver type of texture (=the driver, who created the texture)
 	virtual E_DRIVER_TYPE getDriverType() const
@@ -123,6 +139,16 @@ public:
 	}
 
 private:
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+	//! copies a mipmap level into its tiled surface
+	void tileMipMap(u32 level);
+
+	CImage * TiledMipMap[SOFTWARE_DRIVER_2_MIPMAPPING_MAX];
+#endif
+
+	//! rasterizer threads of the driver may still read the texture, can be 0
+	CBurningVideoDriver* Driver;
+
 	f32 OrigImageDataSizeInPixels;
 	core::dimension2d<u32> OrigSize;
 
@@ -131,6 +157,7 @@ private:
 	u32 MipMapLOD;
 	u32 Flags;
 	ECOLOR_FORMAT OriginalFormat;
+	bool LockReadOnly;
 };
 
 
@@ -0,0 +1,638 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_TR_TEMPLATE_2_H_INCLUDED__
+#define __C_TR_TEMPLATE_2_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IBurningShader.h"
+
+#ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
+
+#ifndef SOFTWARE_DRIVER_2_USE_WBUFFER
+	#error "CTRTemplate2 interpolates w for the depth buffer"
+#endif
+
+namespace irr
+{
+
+namespace video
+{
+
+//! triangle renderer built from a mask of E_BURNING_SHADER_FEATURE
+/** Each instantiation is a pipeline of its own, the feature tests are
+	resolved at compile time. Scan conversion and interpolation are the
+	same as in the hand written renderers, so a pipeline draws exactly
+	the same pixels as the renderer it replaces. */
+template <u32 Features>
+class CTRTemplate2 : public IBurningShader
+{
+public:
+
+	//! constructor
+	CTRTemplate2(CBurningVideoDriver* driver)
+	: IBurningShader(driver)
+	{
+		#ifdef _DEBUG
+		setDebugName("CTRTemplate2");
+		#endif
+	}
+
+	//! draws an indexed triangle list
+	virtual void drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c );
+
+private:
+
+	enum
+	{
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		HasColor0 = ( Features & EBSF_VERTEX_COLOR ) != 0,
+#else
+		HasColor0 = 0,
+#endif
+		HasTexture1 = ( Features & EBSF_TEXTURE_1 ) != 0,
+		HasDepth = ( Features & ( EBSF_DEPTH_TEST | EBSF_DEPTH_WRITE ) ) != 0,
+		SkipHidden = ( Features & EBSF_SKIP_HIDDEN ) && ( Features & EBSF_DEPTH_TEST ),
+
+		//! texture 0 is copied to the render target
+		Plain = ( Features & ( EBSF_VERTEX_COLOR | EBSF_TEXTURE_1 | EBSF_BILINEAR | EBSF_BILINEAR_MAG | EBSF_BLEND_ADD ) ) == 0,
+
+		//! features of the scanlines of a minified or magnified triangle
+		MinFeatures = ( Features & EBSF_BILINEAR_MAG ) ? ( Features & ~EBSF_BILINEAR ) : Features,
+		MagFeatures = ( Features & EBSF_BILINEAR_MAG ) ? ( Features | EBSF_BILINEAR ) : Features
+	};
+
+	//! texel of a stage
+	template <u32 Mask, class T>
+	inline void getSample ( T &r, T &g, T &b, u32 stage, const T &tx, const T &ty ) const
+	{
+		if ( Mask & EBSF_BILINEAR )
+			getSample_texture ( r, g, b, &IT[stage], tx, ty );
+		else
+			getTexel_fix ( r, g, b, &IT[stage], tx, ty );
+	}
+
+	//! texture 0 modulated by texture 1
+	template <class T>
+	static inline T modulate ( const T &a, const T &b )
+	{
+		if ( Features & EBSF_MODULATE_4X )
+			return clampfix_maxcolor ( imulFix_tex4 ( a, b ) );
+		if ( Features & EBSF_MODULATE_2X )
+			return clampfix_maxcolor ( imulFix_tex2 ( a, b ) );
+		return imulFix_tex1 ( a, b );
+	}
+
+	//! Mask are the features with the sampling chosen for the triangle
+	template <u32 Mask>
+	void scanline ();
+
+	sScanConvertData scan;
+	sScanLineData line;
+};
+
+
+/*!
+*/
+template <u32 Features>
+template <u32 Mask>
+void CTRTemplate2<Features>::scanline ()
+{
+	tVideoSample *dst;
+	fp24 *z = 0;
+
+	s32 xStart;
+	s32 xEnd;
+	s32 dx;
+
+	fp24 slopeW;
+	sVec4 slopeC;
+	sVec2 slopeT[BURNING_MATERIAL_MAX_TEXTURES];
+
+	// apply top-left fill-convention, left
+	xStart = core::ceil32( line.x[0] );
+	xEnd = core::ceil32( line.x[1] ) - 1;
+
+	dx = xEnd - xStart;
+
+	if ( dx < 0 )
+		return;
+
+	// slopes
+	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
+
+	slopeW = (line.w[1] - line.w[0]) * invDeltaX;
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+	if ( HasColor0 )
+		slopeC = (line.c[0][1] - line.c[0][0]) * invDeltaX;
+#endif
+	slopeT[0] = (line.t[0][1] - line.t[0][0]) * invDeltaX;
+	if ( HasTexture1 )
+		slopeT[1] = (line.t[1][1] - line.t[1][0]) * invDeltaX;
+
+#ifdef SOFTWARE_DRIVER_2_SUBTEXEL
+	const f32 subPixel = ( (f32) xStart ) - line.x[0];
+	line.w[0] += slopeW * subPixel;
+	if ( !SkipHidden )
+	{
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		if ( HasColor0 )
+			line.c[0][0] += slopeC * subPixel;
+#endif
+		line.t[0][0] += slopeT[0] * subPixel;
+		if ( HasTexture1 )
+			line.t[1][0] += slopeT[1] * subPixel;
+	}
+#else
+	const f32 subPixel = 0.f;
+#endif
+
+	dst = (tVideoSample*)RenderTarget->lock() + ( line.y * RenderTarget->getDimension().Width ) + xStart;
+
+	if ( HasDepth )
+		z = (fp24*) DepthBuffer->lock() + ( line.y * RenderTarget->getDimension().Width ) + xStart;
+
+	s32 i = 0;
+
+	if ( SkipHidden )
+	{
+		// search the first visible pixel, then set up the rest of the scanline
+		while ( line.w[0] < z[i] )
+		{
+			line.w[0] += slopeW;
+			if ( ++i > dx )
+				return;
+		}
+
+		const f32 a = (f32) i + subPixel;
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		if ( HasColor0 )
+			line.c[0][0] += slopeC * a;
+#endif
+		line.t[0][0] += slopeT[0] * a;
+		if ( HasTexture1 )
+			line.t[1][0] += slopeT[1] * a;
+	}
+
+#ifdef SOFTWARE_DRIVER_2_SIMD
+	// 4 pixels at once. interpolate in the same order as the loop below.
+	// plain copies are faster one by one
+	f32 w4[4], tx4[2][4], ty4[2][4], r4[4], g4[4], b4[4];
+
+	for ( ; !Plain && i + 3 <= dx; i += 4 )
+	{
+		for ( s32 k = 0; k != 4; ++k )
+		{
+			w4[k] = line.w[0];
+			tx4[0][k] = line.t[0][0].x;
+			ty4[0][k] = line.t[0][0].y;
+			if ( HasTexture1 )
+			{
+				tx4[1][k] = line.t[1][0].x;
+				ty4[1][k] = line.t[1][0].y;
+			}
+			if ( HasColor0 )
+			{
+				r4[k] = line.c[0][0].y;
+				g4[k] = line.c[0][0].z;
+				b4[k] = line.c[0][0].w;
+			}
+
+			line.w[0] += slopeW;
+			if ( HasColor0 )
+				line.c[0][0] += slopeC;
+			line.t[0][0] += slopeT[0];
+			if ( HasTexture1 )
+				line.t[1][0] += slopeT[1];
+		}
+
+		const __m128 w = _mm_loadu_ps ( w4 );
+		__m128i mask = _mm_set1_epi32 ( -1 );
+		if ( Features & EBSF_DEPTH_TEST )
+		{
+			mask = _mm_castps_si128 ( _mm_cmpge_ps ( w, _mm_loadu_ps ( z + i ) ) );
+			if ( 0 == _mm_movemask_epi8 ( mask ) )
+				continue;
+		}
+
+		if ( Features & EBSF_DEPTH_WRITE )
+			write_masked ( z + i, _mm_castps_si128 ( w ), mask );
+
+		const __m128 inversew = fix_inverse32 ( w );
+		const __m128i tx0 = tofix ( _mm_loadu_ps ( tx4[0] ), inversew );
+		const __m128i ty0 = tofix ( _mm_loadu_ps ( ty4[0] ), inversew );
+
+		__m128i r0, g0, b0;
+		__m128i r1, g1, b1;
+		getSample<Mask> ( r0, g0, b0, 0, tx0, ty0 );
+
+		if ( HasColor0 )
+		{
+			r0 = imulFix ( r0, tofix ( _mm_loadu_ps ( r4 ), inversew ) );
+			g0 = imulFix ( g0, tofix ( _mm_loadu_ps ( g4 ), inversew ) );
+			b0 = imulFix ( b0, tofix ( _mm_loadu_ps ( b4 ), inversew ) );
+		}
+
+		if ( HasTexture1 )
+		{
+			getSample<Mask> ( r1, g1, b1, 1, tofix ( _mm_loadu_ps ( tx4[1] ), inversew ), tofix ( _mm_loadu_ps ( ty4[1] ), inversew ) );
+			r0 = modulate ( r0, r1 );
+			g0 = modulate ( g0, g1 );
+			b0 = modulate ( b0, b1 );
+		}
+
+		if ( Features & EBSF_BLEND_ADD )
+		{
+			color_to_fix ( r1, g1, b1, _mm_loadu_si128 ( (const __m128i*) ( dst + i ) ) );
+			r0 = clampfix_maxcolor ( _mm_add_epi32 ( r1, r0 ) );
+			g0 = clampfix_maxcolor ( _mm_add_epi32 ( g1, g0 ) );
+			b0 = clampfix_maxcolor ( _mm_add_epi32 ( b1, b0 ) );
+		}
+
+		const __m128i color = fix_to_color ( r0, g0, b0 );
+
+		if ( Features & EBSF_DEPTH_TEST )
+			write_masked ( dst + i, color, mask );
+		else
+			_mm_storeu_si128 ( (__m128i*) ( dst + i ), color );
+	}
+#endif
+
+	for ( ; i <= dx; ++i )
+	{
+		if ( !( Features & EBSF_DEPTH_TEST ) || line.w[0] >= z[i] )
+		{
+			if ( Features & EBSF_DEPTH_WRITE )
+				z[i] = line.w[0];
+
+#ifdef SOFTWARE_DRIVER_2_PERSPECTIVE_CORRECT
+			const f32 inversew = fix_inverse32 ( line.w[0] );
+#else
+			const f32 inversew = FIX_POINT_F32_MUL;
+#endif
+			const tFixPoint tx0 = tofix ( line.t[0][0].x, inversew );
+			const tFixPoint ty0 = tofix ( line.t[0][0].y, inversew );
+
+			if ( Plain )
+			{
+				dst[i] = getTexel_plain ( &IT[0], tx0, ty0 );
+			}
+			else
+			{
+				tFixPoint r0, g0, b0;
+				tFixPoint r1, g1, b1;
+				getSample<Mask> ( r0, g0, b0, 0, tx0, ty0 );
+
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+				if ( HasColor0 )
+				{
+					r0 = imulFix ( r0, tofix ( line.c[0][0].y, inversew ) );
+					g0 = imulFix ( g0, tofix ( line.c[0][0].z, inversew ) );
+					b0 = imulFix ( b0, tofix ( line.c[0][0].w, inversew ) );
+				}
+#endif
+
+				if ( HasTexture1 )
+				{
+					getSample<Mask> ( r1, g1, b1, 1, tofix ( line.t[1][0].x, inversew ), tofix ( line.t[1][0].y, inversew ) );
+					r0 = modulate ( r0, r1 );
+					g0 = modulate ( g0, g1 );
+					b0 = modulate ( b0, b1 );
+				}
+
+				if ( Features & EBSF_BLEND_ADD )
+				{
+					color_to_fix ( r1, g1, b1, dst[i] );
+					r0 = clampfix_maxcolor ( r1 + r0 );
+					g0 = clampfix_maxcolor ( g1 + g0 );
+					b0 = clampfix_maxcolor ( b1 + b0 );
+				}
+
+				dst[i] = fix_to_color ( r0, g0, b0 );
+			}
+		}
+
+		line.w[0] += slopeW;
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		if ( HasColor0 )
+			line.c[0][0] += slopeC;
+#endif
+		line.t[0][0] += slopeT[0];
+		if ( HasTexture1 )
+			line.t[1][0] += slopeT[1];
+	}
+
+}
+
+template <u32 Features>
+void CTRTemplate2<Features>::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
+{
+	// sort on height, y
+	if ( F32_A_GREATER_B ( a->Pos.y , b->Pos.y ) ) swapVertexPointer(&a, &b);
+	if ( F32_A_GREATER_B ( b->Pos.y , c->Pos.y ) ) swapVertexPointer(&b, &c);
+	if ( F32_A_GREATER_B ( a->Pos.y , b->Pos.y ) ) swapVertexPointer(&a, &b);
+
+	const f32 ca = c->Pos.y - a->Pos.y;
+	const f32 ba = b->Pos.y - a->Pos.y;
+	const f32 cb = c->Pos.y - b->Pos.y;
+	// calculate delta y of the edges
+	scan.invDeltaY[0] = core::reciprocal( ca );
+	scan.invDeltaY[1] = core::reciprocal( ba );
+	scan.invDeltaY[2] = core::reciprocal( cb );
+
+	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] ) )
+		return;
+
+	// texture 0 is filtered while it is magnified
+	const bool magnified = ( Features & EBSF_BILINEAR_MAG ) && IT[0].lodLevel <= 2;
+
+	// find if the major edge is left or right aligned
+	f32 temp[4];
+
+	temp[0] = a->Pos.x - c->Pos.x;
+	temp[1] = -ca;
+	temp[2] = b->Pos.x - a->Pos.x;
+	temp[3] = ba;
+
+	scan.left = ( temp[0] * temp[3] - temp[1] * temp[2] ) > 0.f ? 0 : 1;
+	scan.right = 1 - scan.left;
+
+	// calculate slopes for the major edge
+	scan.slopeX[0] = (c->Pos.x - a->Pos.x) * scan.invDeltaY[0];
+	scan.x[0] = a->Pos.x;
+
+	scan.slopeW[0] = (c->Pos.w - a->Pos.w) * scan.invDeltaY[0];
+	scan.w[0] = a->Pos.w;
+
+	if ( HasColor0 )
+	{
+		scan.slopeC[0][0] = (c->Color[0] - a->Color[0]) * scan.invDeltaY[0];
+		scan.c[0][0] = a->Color[0];
+	}
+
+	scan.slopeT[0][0] = (c->Tex[0] - a->Tex[0]) * scan.invDeltaY[0];
+	scan.t[0][0] = a->Tex[0];
+
+	if ( HasTexture1 )
+	{
+		scan.slopeT[1][0] = (c->Tex[1] - a->Tex[1]) * scan.invDeltaY[0];
+		scan.t[1][0] = a->Tex[1];
+	}
+
+	// top left fill convention y run
+	s32 yStart;
+	s32 yEnd;
+
+#ifdef SOFTWARE_DRIVER_2_SUBTEXEL
+	f32 subPixel;
+#endif
+
+	// rasterize upper sub-triangle
+	if ( (f32) 0.0 != scan.invDeltaY[1]  )
+	{
+		// calculate slopes for top edge
+		scan.slopeX[1] = (b->Pos.x - a->Pos.x) * scan.invDeltaY[1];
+		scan.x[1] = a->Pos.x;
+
+		scan.slopeW[1] = (b->Pos.w - a->Pos.w) * scan.invDeltaY[1];
+		scan.w[1] = a->Pos.w;
+
+		if ( HasColor0 )
+		{
+			scan.slopeC[0][1] = (b->Color[0] - a->Color[0]) * scan.invDeltaY[1];
+			scan.c[0][1] = a->Color[0];
+		}
+
+		scan.slopeT[0][1] = (b->Tex[0] - a->Tex[0]) * scan.invDeltaY[1];
+		scan.t[0][1] = a->Tex[0];
+
+		if ( HasTexture1 )
+		{
+			scan.slopeT[1][1] = (b->Tex[1] - a->Tex[1]) * scan.invDeltaY[1];
+			scan.t[1][1] = a->Tex[1];
+		}
+
+		// apply top-left fill convention, top part
+		yStart = core::ceil32( a->Pos.y );
+		yEnd = core::ceil32( b->Pos.y ) - 1;
+
+#ifdef SOFTWARE_DRIVER_2_SUBTEXEL
+		subPixel = ( (f32) yStart ) - a->Pos.y;
+
+		// correct to pixel center
+		scan.x[0] += scan.slopeX[0] * subPixel;
+		scan.x[1] += scan.slopeX[1] * subPixel;
+
+		scan.w[0] += scan.slopeW[0] * subPixel;
+		scan.w[1] += scan.slopeW[1] * subPixel;
+
+		if ( HasColor0 )
+		{
+			scan.c[0][0] += scan.slopeC[0][0] * subPixel;
+			scan.c[0][1] += scan.slopeC[0][1] * subPixel;
+		}
+
+		scan.t[0][0] += scan.slopeT[0][0] * subPixel;
+		scan.t[0][1] += scan.slopeT[0][1] * subPixel;
+
+		if ( HasTexture1 )
+		{
+			scan.t[1][0] += scan.slopeT[1][0] * subPixel;
+			scan.t[1][1] += scan.slopeT[1][1] * subPixel;
+		}
+#endif
+
+		// rasterize the edge scanlines
+		for( line.y = yStart; line.y <= yEnd; ++line.y)
+		{
+			line.x[scan.left] = scan.x[0];
+			line.x[scan.right] = scan.x[1];
+
+			line.w[scan.left] = scan.w[0];
+			line.w[scan.right] = scan.w[1];
+
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+			if ( HasColor0 )
+			{
+				line.c[0][scan.left] = scan.c[0][0];
+				line.c[0][scan.right] = scan.c[0][1];
+			}
+#endif
+
+			line.t[0][scan.left] = scan.t[0][0];
+			line.t[0][scan.right] = scan.t[0][1];
+
+			if ( HasTexture1 )
+			{
+				line.t[1][scan.left] = scan.t[1][0];
+				line.t[1][scan.right] = scan.t[1][1];
+			}
+
+			// render a scanline
+			if ( ownsScanLine ( line.y ) )
+			{
+				if ( magnified )
+					scanline<MagFeatures> ();
+				else
+					scanline<MinFeatures> ();
+			}
+
+			scan.x[0] += scan.slopeX[0];
+			scan.x[1] += scan.slopeX[1];
+
+			scan.w[0] += scan.slopeW[0];
+			scan.w[1] += scan.slopeW[1];
+
+			if ( HasColor0 )
+			{
+				scan.c[0][0] += scan.slopeC[0][0];
+				scan.c[0][1] += scan.slopeC[0][1];
+			}
+
+			scan.t[0][0] += scan.slopeT[0][0];
+			scan.t[0][1] += scan.slopeT[0][1];
+
+			if ( HasTexture1 )
+			{
+				scan.t[1][0] += scan.slopeT[1][0];
+				scan.t[1][1] += scan.slopeT[1][1];
+			}
+		}
+	}
+
+	// rasterize lower sub-triangle
+	if ( (f32) 0.0 != scan.invDeltaY[2] )
+	{
+		// advance to middle point
+		if( (f32) 0.0 != scan.invDeltaY[1] )
+		{
+			temp[0] = b->Pos.y - a->Pos.y;	// dy
+
+			scan.x[0] = a->Pos.x + scan.slopeX[0] * temp[0];
+			scan.w[0] = a->Pos.w + scan.slopeW[0] * temp[0];
+			if ( HasColor0 )
+				scan.c[0][0] = a->Color[0] + scan.slopeC[0][0] * temp[0];
+			scan.t[0][0] = a->Tex[0] + scan.slopeT[0][0] * temp[0];
+			if ( HasTexture1 )
+				scan.t[1][0] = a->Tex[1] + scan.slopeT[1][0] * temp[0];
+		}
+
+		// calculate slopes for bottom edge
+		scan.slopeX[1] = (c->Pos.x - b->Pos.x) * scan.invDeltaY[2];
+		scan.x[1] = b->Pos.x;
+
+		scan.slopeW[1] = (c->Pos.w - b->Pos.w) * scan.invDeltaY[2];
+		scan.w[1] = b->Pos.w;
+
+		if ( HasColor0 )
+		{
+			scan.slopeC[0][1] = (c->Color[0] - b->Color[0]) * scan.invDeltaY[2];
+			scan.c[0][1] = b->Color[0];
+		}
+
+		scan.slopeT[0][1] = (c->Tex[0] - b->Tex[0]) * scan.invDeltaY[2];
+		scan.t[0][1] = b->Tex[0];
+
+		if ( HasTexture1 )
+		{
+			scan.slopeT[1][1] = (c->Tex[1] - b->Tex[1]) * scan.invDeltaY[2];
+			scan.t[1][1] = b->Tex[1];
+		}
+
+		// apply top-left fill convention, top part
+		yStart = core::ceil32( b->Pos.y );
+		yEnd = core::ceil32( c->Pos.y ) - 1;
+
+#ifdef SOFTWARE_DRIVER_2_SUBTEXEL
+		subPixel = ( (f32) yStart ) - b->Pos.y;
+
+		// correct to pixel center
+		scan.x[0] += scan.slopeX[0] * subPixel;
+		scan.x[1] += scan.slopeX[1] * subPixel;
+
+		scan.w[0] += scan.slopeW[0] * subPixel;
+		scan.w[1] += scan.slopeW[1] * subPixel;
+
+		if ( HasColor0 )
+		{
+			scan.c[0][0] += scan.slopeC[0][0] * subPixel;
+			scan.c[0][1] += scan.slopeC[0][1] * subPixel;
+		}
+
+		scan.t[0][0] += scan.slopeT[0][0] * subPixel;
+		scan.t[0][1] += scan.slopeT[0][1] * subPixel;
+
+		if ( HasTexture1 )
+		{
+			scan.t[1][0] += scan.slopeT[1][0] * subPixel;
+			scan.t[1][1] += scan.slopeT[1][1] * subPixel;
+		}
+#endif
+
+		// rasterize the edge scanlines
+		for( line.y = yStart; line.y <= yEnd; ++line.y)
+		{
+			line.x[scan.left] = scan.x[0];
+			line.x[scan.right] = scan.x[1];
+
+			line.w[scan.left] = scan.w[0];
+			line.w[scan.right] = scan.w[1];
+
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+			if ( HasColor0 )
+			{
+				line.c[0][scan.left] = scan.c[0][0];
+				line.c[0][scan.right] = scan.c[0][1];
+			}
+#endif
+
+			line.t[0][scan.left] = scan.t[0][0];
+			line.t[0][scan.right] = scan.t[0][1];
+
+			if ( HasTexture1 )
+			{
+				line.t[1][scan.left] = scan.t[1][0];
+				line.t[1][scan.right] = scan.t[1][1];
+			}
+
+			// render a scanline
+			if ( ownsScanLine ( line.y ) )
+			{
+				if ( magnified )
+					scanline<MagFeatures> ();
+				else
+					scanline<MinFeatures> ();
+			}
+
+			scan.x[0] += scan.slopeX[0];
+			scan.x[1] += scan.slopeX[1];
+
+			scan.w[0] += scan.slopeW[0];
+			scan.w[1] += scan.slopeW[1];
+
+			if ( HasColor0 )
+			{
+				scan.c[0][0] += scan.slopeC[0][0];
+				scan.c[0][1] += scan.slopeC[0][1];
+			}
+
+			scan.t[0][0] += scan.slopeT[0][0];
+			scan.t[0][1] += scan.slopeT[0][1];
+
+			if ( HasTexture1 )
+			{
+				scan.t[1][0] += scan.slopeT[1][0];
+				scan.t[1][1] += scan.slopeT[1][1];
+			}
+		}
+	}
+
+}
+
+} // end namespace video
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_BURNINGSVIDEO_
+
+#endif
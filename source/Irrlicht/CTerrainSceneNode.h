@@ -117,6 +117,9 @@ namespace scene
 		//! generated for that patch.
 		virtual void OnRegisterSceneNode();
 
+		//! Returns if OnAnimate() of this node may run on a worker thread.
+		virtual bool isAnimationThreadSafe() const { return areAnimatorsThreadSafe(); }
+
 		//! Render the scene node
 		virtual void render();
 
@@ -72,6 +72,9 @@ namespace scene
 		//! sets the vertex positions etc
 		virtual void OnAnimate(u32 timeMs);
 
+		//! Animating reads the active camera, which might move at the same time
+		virtual bool isAnimationThreadSafe() const { return false; }
+
 		//! registers the node into the transparent pass
 		virtual void OnRegisterSceneNode();
 
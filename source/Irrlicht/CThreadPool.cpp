@@ -0,0 +1,277 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CThreadPool.h"
+#include "os.h"
+
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	#if defined(_IRR_WINDOWS_API_)
+		#include <windows.h>
+	#else
+		#include <pthread.h>
+		#include <unistd.h>
+	#endif
+#endif
+
+namespace irr
+{
+
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+
+struct CThreadPool::SPrivate
+{
+	CRITICAL_SECTION Lock;
+	// wakes up workers, released once per worker for each run
+	HANDLE WorkSemaphore;
+	// auto reset, signaled exactly once per run by the thread finishing the last item
+	HANDLE DoneEvent;
+	core::array<HANDLE> Threads;
+
+	void lock() { EnterCriticalSection(&Lock); }
+	void unlock() { LeaveCriticalSection(&Lock); }
+
+	static DWORD WINAPI threadEntry(LPVOID pool)
+	{
+		((CThreadPool*)pool)->workerLoop();
+		return 0;
+	}
+};
+
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+
+struct CThreadPool::SPrivate
+{
+	pthread_mutex_t Lock;
+	pthread_cond_t WorkCondition;
+	pthread_cond_t DoneCondition;
+	core::array<pthread_t> Threads;
+
+	void lock() { pthread_mutex_lock(&Lock); }
+	void unlock() { pthread_mutex_unlock(&Lock); }
+
+	static void* threadEntry(void* pool)
+	{
+		((CThreadPool*)pool)->workerLoop();
+		return 0;
+	}
+};
+
+#else
+
+struct CThreadPool::SPrivate
+{
+	void lock() {}
+	void unlock() {}
+};
+
+#endif
+
+
+//! constructor
+CThreadPool::CThreadPool(u32 threadCount)
+: Private(new SPrivate), Job(0), JobCount(0), NextItem(0), FinishedItems(0),
+	Generation(0), ThreadCount(1), Quit(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CThreadPool");
+	#endif
+
+	if (threadCount == 0)
+		threadCount = getProcessorCount();
+
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+	InitializeCriticalSection(&Private->Lock);
+	Private->WorkSemaphore = CreateSemaphore(0, 0, 0x7fff, 0);
+	Private->DoneEvent = CreateEvent(0, FALSE, FALSE, 0);
+
+	for (u32 i=1; i<threadCount; ++i)
+	{
+		HANDLE thread = CreateThread(0, 0, SPrivate::threadEntry, this, 0, 0);
+		if (!thread)
+		{
+			os::Printer::log("Could not create worker thread.", ELL_WARNING);
+			break;
+		}
+		Private->Threads.push_back(thread);
+	}
+	ThreadCount = Private->Threads.size() + 1;
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+	pthread_mutex_init(&Private->Lock, 0);
+	pthread_cond_init(&Private->WorkCondition, 0);
+	pthread_cond_init(&Private->DoneCondition, 0);
+
+	for (u32 i=1; i<threadCount; ++i)
+	{
+		pthread_t thread;
+		if (pthread_create(&thread, 0, SPrivate::threadEntry, this))
+		{
+			os::Printer::log("Could not create worker thread.", ELL_WARNING);
+			break;
+		}
+		Private->Threads.push_back(thread);
+	}
+	ThreadCount = Private->Threads.size() + 1;
+#endif
+}
+
+
+//! destructor
+CThreadPool::~CThreadPool()
+{
+	Private->lock();
+	Quit = true;
+	Private->unlock();
+
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+	if (Private->Threads.size())
+	{
+		ReleaseSemaphore(Private->WorkSemaphore, Private->Threads.size(), 0);
+		WaitForMultipleObjects(Private->Threads.size(), Private->Threads.pointer(), TRUE, INFINITE);
+	}
+	for (u32 i=0; i<Private->Threads.size(); ++i)
+		CloseHandle(Private->Threads[i]);
+	CloseHandle(Private->WorkSemaphore);
+	CloseHandle(Private->DoneEvent);
+	DeleteCriticalSection(&Private->Lock);
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+	Private->lock();
+	pthread_cond_broadcast(&Private->WorkCondition);
+	Private->unlock();
+
+	for (u32 i=0; i<Private->Threads.size(); ++i)
+		pthread_join(Private->Threads[i], 0);
+	pthread_cond_destroy(&Private->DoneCondition);
+	pthread_cond_destroy(&Private->WorkCondition);
+	pthread_mutex_destroy(&Private->Lock);
+#endif
+
+	delete Private;
+}
+
+
+//! Executes job->execute(i) for all i in [0,count)
+void CThreadPool::run(IThreadJob* job, u32 count)
+{
+	if (!job || !count)
+		return;
+
+	if (ThreadCount == 1 || count == 1)
+	{
+		for (u32 i=0; i<count; ++i)
+			job->execute(i);
+		return;
+	}
+
+	Private->lock();
+	Job = job;
+	JobCount = count;
+	NextItem = 0;
+	FinishedItems = 0;
+	++Generation;
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+	Private->unlock();
+	ReleaseSemaphore(Private->WorkSemaphore, core::min_(count-1, Private->Threads.size()), 0);
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+	pthread_cond_broadcast(&Private->WorkCondition);
+	Private->unlock();
+#else
+	Private->unlock();
+#endif
+
+	// the calling thread takes part in the work
+	process();
+
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+	WaitForSingleObject(Private->DoneEvent, INFINITE);
+	Private->lock();
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+	Private->lock();
+	while (FinishedItems < JobCount)
+		pthread_cond_wait(&Private->DoneCondition, &Private->Lock);
+#else
+	Private->lock();
+#endif
+	Job = 0;
+	JobCount = 0;
+	Private->unlock();
+}
+
+
+//! Pulls work items until none are left
+void CThreadPool::process()
+{
+	for (;;)
+	{
+		Private->lock();
+		if (!Job || NextItem >= JobCount)
+		{
+			Private->unlock();
+			return;
+		}
+		IThreadJob* job = Job;
+		const u32 item = NextItem++;
+		Private->unlock();
+
+		job->execute(item);
+
+		Private->lock();
+		if (++FinishedItems == JobCount)
+		{
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+			SetEvent(Private->DoneEvent);
+#elif defined(_IRR_COMPILE_WITH_THREADS_)
+			pthread_cond_signal(&Private->DoneCondition);
+#endif
+		}
+		Private->unlock();
+	}
+}
+
+
+//! Entry of the worker threads
+void CThreadPool::workerLoop()
+{
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	u32 seenGeneration = 0;
+	for (;;)
+	{
+#if defined(_IRR_WINDOWS_API_)
+		WaitForSingleObject(Private->WorkSemaphore, INFINITE);
+		Private->lock();
+#else
+		Private->lock();
+		while (!Quit && seenGeneration == Generation)
+			pthread_cond_wait(&Private->WorkCondition, &Private->Lock);
+#endif
+		if (Quit)
+		{
+			Private->unlock();
+			return;
+		}
+		seenGeneration = Generation;
+		Private->unlock();
+
+		process();
+	}
+#endif
+}
+
+
+//! Returns the number of processors available to this process
+u32 CThreadPool::getProcessorCount()
+{
+#if defined(_IRR_COMPILE_WITH_THREADS_) && defined(_IRR_WINDOWS_API_)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return core::max_((u32)info.dwNumberOfProcessors, 1u);
+#elif defined(_IRR_COMPILE_WITH_THREADS_) && defined(_SC_NPROCESSORS_ONLN)
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (u32)count : 1;
+#else
+	return 1;
+#endif
+}
+
+} // end namespace irr
+
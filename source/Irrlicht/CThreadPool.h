@@ -0,0 +1,78 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_THREAD_POOL_H_INCLUDED__
+#define __C_THREAD_POOL_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "IReferenceCounted.h"
+#include "irrArray.h"
+
+namespace irr
+{
+
+	//! Work which can be split into independent items for a CThreadPool
+	class IThreadJob
+	{
+	public:
+		virtual ~IThreadJob() {}
+
+		//! Executes one work item.
+		/** Called concurrently from several threads, but never twice
+		with the same index during one CThreadPool::run call. */
+		virtual void execute(u32 index) = 0;
+	};
+
+	//! A small pool of worker threads which execute IThreadJobs.
+	/** The thread calling run() takes part in the work and returns only
+	after all items have been executed. Without _IRR_COMPILE_WITH_THREADS_
+	all work is done on the calling thread. */
+	class CThreadPool : public virtual IReferenceCounted
+	{
+	public:
+
+		//! constructor
+		/** \param threadCount Number of threads doing work, including
+		the thread which calls run(). 0 means one per processor. */
+		CThreadPool(u32 threadCount);
+
+		//! destructor, waits for all worker threads to quit
+		virtual ~CThreadPool();
+
+		//! Returns the number of threads doing work, including the caller of run()
+		u32 getThreadCount() const { return ThreadCount; }
+
+		//! Executes job->execute(i) for all i in [0,count)
+		/** Returns after all items have been executed. */
+		void run(IThreadJob* job, u32 count);
+
+		//! Returns the number of processors available to this process
+		static u32 getProcessorCount();
+
+	private:
+
+		//! Pulls work items until none are left
+		void process();
+
+		//! Entry of the worker threads
+		void workerLoop();
+
+		struct SPrivate;
+		friend struct SPrivate;
+
+		SPrivate* Private;
+
+		IThreadJob* Job;
+		u32 JobCount;
+		u32 NextItem;
+		u32 FinishedItems;
+		u32 Generation;
+		u32 ThreadCount;
+		bool Quit;
+	};
+
+} // end namespace irr
+
+#endif
+
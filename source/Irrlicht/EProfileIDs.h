@@ -0,0 +1,37 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __E_PROFILE_IDS_H_INCLUDED__
+#define __E_PROFILE_IDS_H_INCLUDED__
+
+namespace irr
+{
+	//! Ids of the scopes measured by the engine
+	/** Engine scopes have negative ids, applications use positive ones.
+	Their names are set in the CProfiler constructor. */
+	enum EPROFILE_ID
+	{
+		EPID_SM_DRAW_ALL = -1,
+		EPID_SM_ANIMATE = -2,
+		EPID_SM_REGISTER = -3,
+		EPID_SM_RENDER_CAMERAS = -4,
+		EPID_SM_RENDER_LIGHTS = -5,
+		EPID_SM_RENDER_SKYBOXES = -6,
+		EPID_SM_RENDER_SOLID = -7,
+		EPID_SM_RENDER_SHADOWS = -8,
+		EPID_SM_RENDER_TRANSPARENT = -9,
+		EPID_SM_RENDER_EFFECT = -10,
+		EPID_SM_LOAD_MESH = -11,
+		EPID_SM_COLLISION = -12,
+		EPID_VIDEO_BEGIN_SCENE = -13,
+		EPID_VIDEO_END_SCENE = -14,
+		EPID_VIDEO_LOAD_TEXTURE = -15,
+		EPID_GUI_DRAW_ALL = -16,
+		EPID_SM_OCCLUSION = -17
+	};
+
+} // end namespace irr
+
+#endif
+
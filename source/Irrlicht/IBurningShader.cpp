@@ -36,6 +36,8 @@ namespace video
 		Driver = driver;
 		RenderTarget = 0;
 		ColorMask = COLOR_BRIGHT_WHITE;
+		RasterBand = 0;
+		RasterBandCount = 1;
 		DepthBuffer = (CDepthBuffer*) driver->getDepthBuffer ();
 		if ( DepthBuffer )
 			DepthBuffer->grab();
@@ -50,6 +52,14 @@ namespace video
 	//! destructor
 	IBurningShader::~IBurningShader()
 	{
+		// references are held by the driver
+		if ( RasterBandCount > 1 )
+		{
+			RenderTarget = 0;
+			for ( u32 i = 0; i != BURNING_MATERIAL_MAX_TEXTURES; ++i )
+				IT[i].Texture = 0;
+		}
+
 		if (RenderTarget)
 			RenderTarget->drop();
 
@@ -69,6 +79,12 @@ namespace video
 	//! sets a render target
 	void IBurningShader::setRenderTarget(video::IImage* surface, const core::rect<s32>& viewPort)
 	{
+		if ( RasterBandCount > 1 )
+		{
+			RenderTarget = (video::CImage* ) surface;
+			return;
+		}
+
 		if (RenderTarget)
 			RenderTarget->drop();
 
@@ -89,31 +105,67 @@ namespace video
 	{
 		sInternalTexture *it = &IT[stage];
 
-		if ( it->Texture)
+		if ( it->Texture && RasterBandCount == 1 )
 			it->Texture->drop();
 
 		it->Texture = texture;
 
 		if ( it->Texture)
 		{
-			it->Texture->grab();
-
 			// select mignify and magnify ( lodLevel )
 			//SOFTWARE_DRIVER_2_MIPMAPPING_LOD_BIAS
 			it->lodLevel = lodLevel;
-			it->data = (tVideoSample*) it->Texture->lock(ETLM_READ_ONLY,
-				core::s32_clamp ( lodLevel + SOFTWARE_DRIVER_2_MIPMAPPING_LOD_BIAS, 0, SOFTWARE_DRIVER_2_MIPMAPPING_MAX - 1 ));
+			const s32 level = core::s32_clamp ( lodLevel + SOFTWARE_DRIVER_2_MIPMAPPING_LOD_BIAS, 0, SOFTWARE_DRIVER_2_MIPMAPPING_MAX - 1 );
+
+			// rasterizer threads share the texture, don't change its level
+			video::CImage* mipmap;
+			if ( RasterBandCount == 1 )
+			{
+				it->Texture->grab();
+				it->Texture->lock(ETLM_READ_ONLY, level);
+				mipmap = it->Texture->getTexture();
+			}
+			else
+			{
+				mipmap = it->Texture->getMipMap(level);
+			}
+
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+			video::CImage* tiled = it->Texture->getTiledMipMap(level);
+			if ( tiled )
+				mipmap = tiled;
+#endif
+
+			it->data = (tVideoSample*) mipmap->lock();
 
 			// prepare for optimal fixpoint
-			it->pitchlog2 = s32_log2_s32 ( it->Texture->getPitch() );
+			it->pitchlog2 = s32_log2_s32 ( mipmap->getPitch() );
 
-			const core::dimension2d<u32> &dim = it->Texture->getSize();
+			const core::dimension2d<u32> &dim = mipmap->getDimension();
 			it->textureXMask = s32_to_fixPoint ( dim.Width - 1 ) & FIX_POINT_UNSIGNED_MASK;
 			it->textureYMask = s32_to_fixPoint ( dim.Height - 1 ) & FIX_POINT_UNSIGNED_MASK;
+
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+			// a linear surface is a single tile of one row
+			const u32 widthLog2 = it->pitchlog2 - VIDEO_SAMPLE_GRANULARITY;
+			const u32 tileWidthLog2 = tiled ? core::s32_min ( SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2, widthLog2 ) : widthLog2;
+			it->tileHeightLog2 = tiled ? core::s32_min ( SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2, s32_log2_s32 ( dim.Height ) ) : 0;
+			it->tileRowLog2 = tileWidthLog2 + VIDEO_SAMPLE_GRANULARITY;
+			it->tileXMask = ( 1 << it->tileRowLog2 ) - 1;
+			it->tileYMask = ( 1 << it->tileHeightLog2 ) - 1;
+#endif
 		}
 	}
 
 
+	//! restricts the shader to the scanline bands of a rasterizer thread
+	void IBurningShader::setRasterBand ( u32 band, u32 bandCount )
+	{
+		RasterBand = band;
+		RasterBandCount = core::max_ ( bandCount, 1u );
+	}
+
+
 } // end namespace video
 } // end namespace irr
 
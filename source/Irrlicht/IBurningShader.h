@@ -116,12 +116,57 @@ namespace video
 
 		ETR_TEXTURE_BLEND,
 		ETR_REFERENCE,
+
+		// point sampled versions, used when the material disables filtering
+		ETR_TEXTURE_GOURAUD_NEAREST,
+		ETR_TEXTURE_GOURAUD_ADD_NEAREST,
+		ETR_TEXTURE_GOURAUD_LIGHTMAP_M1_NEAREST,
+		ETR_TEXTURE_GOURAUD_LIGHTMAP_M2_NEAREST,
+		ETR_TEXTURE_LIGHTMAP_M4_NEAREST,
+
 		ETR_INVALID,
 
 		ETR2_COUNT
 	};
 
 
+	//! features of the triangle renderers built by CTRTemplate2
+	enum E_BURNING_SHADER_FEATURE
+	{
+		//! draws only pixels with w >= z
+		EBSF_DEPTH_TEST = 1,
+
+		//! writes w of the drawn pixels
+		EBSF_DEPTH_WRITE = 2,
+
+		//! texture 0 is modulated by the vertex color
+		EBSF_VERTEX_COLOR = 4,
+
+		//! texture 0 is modulated by texture 1
+		EBSF_TEXTURE_1 = 8,
+
+		//! texture 1 is scaled by 2 and clamped
+		EBSF_MODULATE_2X = 16,
+
+		//! texture 1 is scaled by 4 and clamped
+		EBSF_MODULATE_4X = 32,
+
+		//! textures are filtered bilinear, else point sampled
+		EBSF_BILINEAR = 64,
+
+		//! the color is added to the render target
+		EBSF_BLEND_ADD = 128,
+
+		//! hidden pixels at the start of a scanline are skipped before
+		//! the other values are set up. needs EBSF_DEPTH_TEST
+		EBSF_SKIP_HIDDEN = 256,
+
+		//! textures are filtered bilinear while texture 0 is magnified,
+		//! else point sampled
+		EBSF_BILINEAR_MAG = 512
+	};
+
+
 	class CBurningVideoDriver;
 	class IBurningShader : public virtual IReferenceCounted
 	{
@@ -144,8 +189,28 @@ namespace video
 
 		virtual void setMaterial ( const SBurningShaderMaterial &material ) {};
 
+		//! gets the Texture and level of detail of a stage
+		void getTextureParam( u32 stage, video::CSoftwareTexture2*& texture, s32& lodLevel) const
+		{
+			texture = IT[stage].Texture;
+			lodLevel = IT[stage].lodLevel;
+		}
+
+		//! restricts the shader to the scanline bands of a rasterizer thread
+		/** Scanline y belongs to band ( y >> SOFTWARE_DRIVER_2_RASTER_BAND_HEIGHT_LOG2 ) % bandCount.
+			Shaders of rasterizer threads hold no references to render target and textures,
+			the driver keeps them until the threads are done. */
+		void setRasterBand ( u32 band, u32 bandCount );
+
 	protected:
 
+		//! true if the scanline is rasterized by this shader
+		inline bool ownsScanLine ( s32 y ) const
+		{
+			return RasterBandCount == 1 ||
+				( (u32) y >> SOFTWARE_DRIVER_2_RASTER_BAND_HEIGHT_LOG2 ) % RasterBandCount == RasterBand;
+		}
+
 		CBurningVideoDriver *Driver;
 
 		video::CImage* RenderTarget;
@@ -155,14 +220,21 @@ namespace video
 
 		sInternalTexture IT[ BURNING_MATERIAL_MAX_TEXTURES ];
 
+		u32 RasterBand;
+		u32 RasterBandCount;
+
 		static const tFixPointu dithermask[ 4 * 4];
 	};
 
 
 	IBurningShader* createTriangleRendererTextureGouraud2(CBurningVideoDriver* driver);
+	IBurningShader* createTriangleRendererTextureGouraudNearest2(CBurningVideoDriver* driver);
 	IBurningShader* createTriangleRendererTextureLightMap2_M1(CBurningVideoDriver* driver);
+	IBurningShader* createTriangleRendererTextureLightMap2_M1Nearest(CBurningVideoDriver* driver);
 	IBurningShader* createTriangleRendererTextureLightMap2_M2(CBurningVideoDriver* driver);
+	IBurningShader* createTriangleRendererTextureLightMap2_M2Nearest(CBurningVideoDriver* driver);
 	IBurningShader* createTriangleRendererTextureLightMap2_M4(CBurningVideoDriver* driver);
+	IBurningShader* createTriangleRendererTextureLightMap2_M4Nearest(CBurningVideoDriver* driver);
 	IBurningShader* createTriangleRendererGTextureLightMap2_M4(CBurningVideoDriver* driver);
 	IBurningShader* createTriangleRendererTextureLightMap2_Add(CBurningVideoDriver* driver);
 	IBurningShader* createTriangleRendererTextureDetailMap2(CBurningVideoDriver* driver);
@@ -180,6 +252,7 @@ namespace video
 	IBurningShader* createTRFlatWire2(CBurningVideoDriver* driver);
 	IBurningShader* createTRTextureGouraudNoZ2(CBurningVideoDriver* driver);
 	IBurningShader* createTRTextureGouraudAdd2(CBurningVideoDriver* driver);
+	IBurningShader* createTRTextureGouraudAddNearest2(CBurningVideoDriver* driver);
 	IBurningShader* createTRTextureGouraudAddNoZ2(CBurningVideoDriver* driver);
 
 	IBurningShader* createTRTextureGouraudAlpha(CBurningVideoDriver* driver);
@@ -38,6 +38,16 @@ namespace video
 		//! returns pitch of depthbuffer (in bytes)
 		virtual u32 getPitch() const = 0;
 
+#ifdef SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2
+		//! returns true if no pixel of the area passes the depth test ( w >= z ) for any w <= wMax
+		/** Only the scanlines of the raster band ( see IBurningShader::setRasterBand ) are tested.
+		\param area Pixels, including x1 and y1. */
+		virtual bool isOccluded ( const AbsRectangle& area, f32 wMax, u32 band, u32 bandCount ) = 0;
+
+		//! tells that pixels of the area in the raster band may have been written
+		virtual void invalidate ( const AbsRectangle& area, u32 band, u32 bandCount ) = 0;
+#endif
+
 	};
 
 
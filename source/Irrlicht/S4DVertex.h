@@ -560,6 +560,9 @@ struct SVertexCache
 	u32 pType;		//scene::E_PRIMITIVE_TYPE
 	u32 iType;		//E_INDEX_TYPE iType
 
+	// fill 4 vertices at once
+	bool batch;
+
 };
 
 
@@ -93,6 +93,36 @@
 
 #define SOFTWARE_DRIVER_2_MIPMAPPING_SCALE (8/SOFTWARE_DRIVER_2_MIPMAPPING_MAX)
 
+// rasterizer threads own interleaved bands of ( 1 << log2 ) scanlines
+#define SOFTWARE_DRIVER_2_RASTER_BAND_HEIGHT_LOG2	4
+
+// triangles binned for the rasterizer threads before they are drawn
+#define SOFTWARE_DRIVER_2_RASTER_TRIANGLES_MAX	16384
+
+// the depth buffer keeps the farthest w of tiles of ( 1 << log2 ) * ( 1 << log2 ) pixels,
+// triangles behind all tiles they touch are not rasterized. not larger than the bands
+#ifdef SOFTWARE_DRIVER_2_USE_WBUFFER
+	#define SOFTWARE_DRIVER_2_DEPTH_TILE_SIZE_LOG2	3
+#endif
+
+// textures are sampled from a copy stored in tiles of ( 1 << log2 ) * ( 1 << log2 ) texels,
+// so texels which are near on the screen are near in memory. the copy is made when
+// the texture is created or unlocked, render targets are sampled linear.
+// define NO_SOFTWARE_DRIVER_2_TEXTURE_TILES to save the memory of the copy.
+#ifndef NO_SOFTWARE_DRIVER_2_TEXTURE_TILES
+	#define SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2	2
+#endif
+
+// span functions of the common shaders handle 4 pixels at once.
+// they give the same pixels as the per pixel loops, define
+// NO_SOFTWARE_DRIVER_2_SIMD to compare against those.
+#if defined ( _IRR_COMPILE_WITH_SSE2_ ) && defined ( SOFTWARE_DRIVER_2_32BIT ) && \
+	defined ( SOFTWARE_DRIVER_2_BILINEAR ) && defined ( SOFTWARE_DRIVER_2_PERSPECTIVE_CORRECT ) && \
+	defined ( SOFTWARE_DRIVER_2_USE_WBUFFER ) && defined ( SOFTWARE_DRIVER_2_USE_VERTEX_COLOR ) && \
+	!defined ( NO_SOFTWARE_DRIVER_2_SIMD )
+	#define SOFTWARE_DRIVER_2_SIMD
+#endif
+
 #ifndef REALINLINE
 	#ifdef _MSC_VER
 		#define REALINLINE __forceinline
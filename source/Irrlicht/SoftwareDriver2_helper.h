@@ -15,6 +15,9 @@
 #include "CSoftwareTexture2.h"
 #include "SMaterial.h"
 
+#ifdef SOFTWARE_DRIVER_2_SIMD
+#include <emmintrin.h>
+#endif
 
 
 namespace irr
@@ -696,10 +699,40 @@ struct sInternalTexture
 	u32 pitchlog2;
 	void *data;
 
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+	// texels are stored in tiles. a linear surface is one tile of a row
+	u32 tileXMask;		// bytes of a tile row - 1
+	u32 tileYMask;		// rows of a tile - 1
+	u32 tileRowLog2;	// bytes of a tile row
+	u32 tileHeightLog2;	// rows of a tile
+#endif
+
 	video::CSoftwareTexture2 *Texture;
 	s32 lodLevel;
 };
 
+// byte offset of the texel row ty, texture coordinates wrap
+REALINLINE u32 getTexel_row ( const sInternalTexture * t, const tFixPointu ty )
+{
+	const u32 y = ( ty & t->textureYMask ) >> FIX_POINT_PRE;
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+	return ( ( y & t->tileYMask ) << t->tileRowLog2 ) | ( ( y & ~t->tileYMask ) << t->pitchlog2 );
+#else
+	return y << t->pitchlog2;
+#endif
+}
+
+// byte offset of the texel column tx, to be combined with getTexel_row
+REALINLINE u32 getTexel_column ( const sInternalTexture * t, const tFixPointu tx )
+{
+	const u32 x = ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+	return ( x & t->tileXMask ) | ( ( x & ~t->tileXMask ) << t->tileHeightLog2 );
+#else
+	return x;
+#endif
+}
+
 
 
 // get video sample plain
@@ -707,8 +740,7 @@ inline tVideoSample getTexel_plain ( const sInternalTexture * t, const tFixPoint
 {
 	u32 ofs;
 
-	ofs = ( ( ty & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	ofs = getTexel_row ( t, ty ) | getTexel_column ( t, tx );
 
 	// texel
 	return *((tVideoSample*)( (u8*) t->data + ofs ));
@@ -721,8 +753,7 @@ inline void getTexel_fix ( tFixPoint &r, tFixPoint &g, tFixPoint &b,
 {
 	u32 ofs;
 
-	ofs = ( ( ty & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	ofs = getTexel_row ( t, ty ) | getTexel_column ( t, tx );
 
 	// texel
 	tVideoSample t00;
@@ -741,8 +772,7 @@ REALINLINE void getTexel_fix ( tFixPoint &a,
 {
 	u32 ofs;
 
-	ofs = ( ( ty & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	ofs = getTexel_row ( t, ty ) | getTexel_column ( t, tx );
 
 	// texel
 	tVideoSample t00;
@@ -771,8 +801,7 @@ inline void getSample_texture_dither (	tFixPoint &r, tFixPoint &g, tFixPoint &b,
 	const tFixPointu _nty = (ty + dithermask [ index ] ) & t->textureYMask;
 
 	u32 ofs;
-	ofs = ( ( _nty ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ( _ntx ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	ofs = getTexel_row ( t, _nty ) | getTexel_column ( t, _ntx );
 
 	// texel
 	const tVideoSample t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
@@ -796,8 +825,7 @@ inline void getSample_texture ( tFixPoint &r, tFixPoint &g, tFixPoint &b,
 {
 	u32 ofs;
 
-	ofs = ( ( ty & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	ofs = getTexel_row ( t, ty ) | getTexel_column ( t, tx );
 
 	// texel
 	const tVideoSample t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
@@ -813,8 +841,7 @@ inline void getSample_texture ( tFixPointu &a, tFixPointu &r, tFixPointu &g, tFi
 {
 	u32 ofs;
 
-	ofs = ( ( ty & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	ofs = getTexel_row ( t, ty ) | getTexel_column ( t, tx );
 
 	// texel
 	const tVideoSample t00 = *((tVideoSample*)( (u8*) t->data + ofs ));
@@ -836,8 +863,7 @@ REALINLINE void getSample_linear ( tFixPointu &r, tFixPointu &g, tFixPointu &b,
 {
 	u32 ofs;
 
-	ofs = ( ( ty & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	ofs = getTexel_row ( t, ty ) | getTexel_column ( t, tx );
 
 	// texel
 	tVideoSample t00;
@@ -868,10 +894,10 @@ REALINLINE void getSample_texture ( tFixPoint &r, tFixPoint &g, tFixPoint &b,
 	u32 o0, o1,o2,o3;
 	tVideoSample t00;
 
-	o0 = ( ( (ty) & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	o1 = ( ( (ty+FIX_POINT_ONE) & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	o2 =   ( (tx) & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
-	o3 =   ( (tx+FIX_POINT_ONE) & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	o0 = getTexel_row ( t, ty );
+	o1 = getTexel_row ( t, ty + FIX_POINT_ONE );
+	o2 = getTexel_column ( t, tx );
+	o3 = getTexel_column ( t, tx + FIX_POINT_ONE );
 
 	t00 = *((tVideoSample*)( (u8*) t->data + (o0 | o2 ) ));
 	r00	 =	(t00 & MASK_R) >> SHIFT_R; g00  =	(t00 & MASK_G) >> SHIFT_G; b00	 =	(t00 & MASK_B);
@@ -923,8 +949,7 @@ REALINLINE void getSample_linear ( tFixPointu &a, tFixPointu &r, tFixPointu &g,
 {
 	u32 ofs;
 
-	ofs = ( ( ty & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
-	ofs |= ( tx & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	ofs = getTexel_row ( t, ty ) | getTexel_column ( t, tx );
 
 	// texel
 	tVideoSample t00;
@@ -986,6 +1011,185 @@ REALINLINE void getSample_texture ( tFixPoint &a, tFixPoint &r, tFixPoint &g, tF
 }
 
 
+#endif
+
+#ifdef SOFTWARE_DRIVER_2_SIMD
+
+/*
+	4 pixel versions of the functions above, one pixel per lane.
+	They give exactly the same results as the per pixel versions.
+*/
+
+// 1/x * FIX_POINT
+REALINLINE __m128 fix_inverse32 ( const __m128 x )
+{
+	return _mm_div_ps ( _mm_set1_ps ( FIX_POINT_F32_MUL ), x );
+}
+
+// convert f32 to Fix Point
+REALINLINE __m128i tofix ( const __m128 x, const __m128 mulby )
+{
+	return _mm_cvttps_epi32 ( _mm_mul_ps ( x, mulby ) );
+}
+
+// lower 32 bit of x * y, signed or unsigned. SSE2 has no pmulld
+REALINLINE __m128i mul32 ( const __m128i x, const __m128i y )
+{
+	const __m128i even = _mm_mul_epu32 ( x, y );
+	const __m128i odd = _mm_mul_epu32 ( _mm_srli_epi64 ( x, 32 ), _mm_srli_epi64 ( y, 32 ) );
+	return _mm_unpacklo_epi32 ( _mm_shuffle_epi32 ( even, _MM_SHUFFLE ( 0, 0, 2, 0 ) ),
+								_mm_shuffle_epi32 ( odd, _MM_SHUFFLE ( 0, 0, 2, 0 ) ) );
+}
+
+// Fix Point , Fix Point Multiply
+REALINLINE __m128i imulFix ( const __m128i x, const __m128i y )
+{
+	return _mm_srai_epi32 ( mul32 ( x, y ), FIX_POINT_PRE );
+}
+
+// Multiply x * y * 1
+REALINLINE __m128i imulFix_tex1 ( const __m128i x, const __m128i y )
+{
+	return _mm_srli_epi32 ( mul32 ( _mm_srli_epi32 ( x, 2 ), _mm_srli_epi32 ( y, 2 ) ), FIX_POINT_PRE + 4 );
+}
+
+// Multiply x * y * 2
+REALINLINE __m128i imulFix_tex2 ( const __m128i x, const __m128i y )
+{
+	return _mm_srli_epi32 ( mul32 ( _mm_srli_epi32 ( x, 2 ), _mm_srli_epi32 ( y, 2 ) ), FIX_POINT_PRE + 3 );
+}
+
+// Multiply x * y * 4
+REALINLINE __m128i imulFix_tex4 ( const __m128i x, const __m128i y )
+{
+	return _mm_srli_epi32 ( mul32 ( _mm_srli_epi32 ( x, 2 ), _mm_srli_epi32 ( y, 2 ) ), FIX_POINT_PRE + 2 );
+}
+
+// clamp FixPoint to maxcolor in FixPoint
+REALINLINE __m128i clampfix_maxcolor ( const __m128i a )
+{
+	const __m128i max = _mm_set1_epi32 ( FIXPOINT_COLOR_MAX );
+	const __m128i c = _mm_srai_epi32 ( _mm_sub_epi32 ( a, max ), 31 );
+	return _mm_or_si128 ( _mm_and_si128 ( a, c ), _mm_andnot_si128 ( c, max ) );
+}
+
+// return VideoSample from fixpoint
+REALINLINE __m128i fix_to_color ( const __m128i r, const __m128i g, const __m128i b )
+{
+	const __m128i max = _mm_set1_epi32 ( FIXPOINT_COLOR_MAX );
+	return _mm_or_si128 (
+			_mm_or_si128 ( _mm_set1_epi32 ( MASK_A ),
+							_mm_slli_epi32 ( _mm_and_si128 ( r, max ), SHIFT_R - FIX_POINT_PRE ) ),
+			_mm_or_si128 ( _mm_srli_epi32 ( _mm_and_si128 ( g, max ), FIX_POINT_PRE - SHIFT_G ),
+							_mm_srli_epi32 ( _mm_and_si128 ( b, max ), FIX_POINT_PRE - SHIFT_B ) )
+			);
+}
+
+// return fixpoint from VideoSample granularity COLOR_MAX
+REALINLINE void color_to_fix ( __m128i &r, __m128i &g, __m128i &b, const __m128i t00 )
+{
+	r = _mm_srli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_R ) ), SHIFT_R - FIX_POINT_PRE );
+	g = _mm_slli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_G ) ), FIX_POINT_PRE - SHIFT_G );
+	b = _mm_slli_epi32 ( _mm_and_si128 ( t00, _mm_set1_epi32 ( MASK_B ) ), FIX_POINT_PRE - SHIFT_B );
+}
+
+// write the lanes of value where mask is set
+REALINLINE void write_masked ( void *dst, const __m128i value, const __m128i mask )
+{
+	const __m128i old = _mm_loadu_si128 ( (const __m128i*) dst );
+	_mm_storeu_si128 ( (__m128i*) dst, _mm_or_si128 ( _mm_and_si128 ( mask, value ), _mm_andnot_si128 ( mask, old ) ) );
+}
+
+// texel offset in bytes
+REALINLINE __m128i getTexel_offset ( const sInternalTexture * t, const __m128i tx, const __m128i ty )
+{
+	const __m128i y = _mm_srli_epi32 ( _mm_and_si128 ( ty, _mm_set1_epi32 ( t->textureYMask ) ), FIX_POINT_PRE );
+	const __m128i x = _mm_srli_epi32 ( _mm_and_si128 ( tx, _mm_set1_epi32 ( t->textureXMask ) ), FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+#ifdef SOFTWARE_DRIVER_2_TEXTURE_TILE_SIZE_LOG2
+	const __m128i tileY = _mm_set1_epi32 ( t->tileYMask );
+	const __m128i tileX = _mm_set1_epi32 ( t->tileXMask );
+	return _mm_or_si128 (
+		_mm_or_si128 ( _mm_sll_epi32 ( _mm_and_si128 ( y, tileY ), _mm_cvtsi32_si128 ( t->tileRowLog2 ) ),
+						_mm_sll_epi32 ( _mm_andnot_si128 ( tileY, y ), _mm_cvtsi32_si128 ( t->pitchlog2 ) ) ),
+		_mm_or_si128 ( _mm_and_si128 ( x, tileX ),
+						_mm_sll_epi32 ( _mm_andnot_si128 ( tileX, x ), _mm_cvtsi32_si128 ( t->tileHeightLog2 ) ) )
+		);
+#else
+	return _mm_or_si128 ( _mm_sll_epi32 ( y, _mm_cvtsi32_si128 ( t->pitchlog2 ) ), x );
+#endif
+}
+
+// fetch the texels at 4 offsets
+REALINLINE __m128i getTexel_gather ( const sInternalTexture * t, const __m128i offset )
+{
+	u32 ofs[4];
+	_mm_storeu_si128 ( (__m128i*) ofs, offset );
+
+	const u8 *data = (const u8*) t->data;
+	return _mm_set_epi32 (	*((const tVideoSample*)( data + ofs[3] )),
+							*((const tVideoSample*)( data + ofs[2] )),
+							*((const tVideoSample*)( data + ofs[1] )),
+							*((const tVideoSample*)( data + ofs[0] ))
+						);
+}
+
+// get video sample to fix
+REALINLINE void getTexel_fix ( __m128i &r, __m128i &g, __m128i &b,
+						const sInternalTexture * t, const __m128i tx, const __m128i ty
+								)
+{
+	color_to_fix ( r, g, b, getTexel_gather ( t, getTexel_offset ( t, tx, ty ) ) );
+}
+
+// get Sample bilinear
+REALINLINE void getSample_texture ( __m128i &r, __m128i &g, __m128i &b,
+								const sInternalTexture * t, const __m128i tx, const __m128i ty
+								)
+{
+	const __m128i one = _mm_set1_epi32 ( FIX_POINT_ONE );
+	const __m128i tx1 = _mm_add_epi32 ( tx, one );
+	const __m128i ty1 = _mm_add_epi32 ( ty, one );
+
+	const __m128i t00 = getTexel_gather ( t, getTexel_offset ( t, tx, ty ) );
+	const __m128i t10 = getTexel_gather ( t, getTexel_offset ( t, tx1, ty ) );
+	const __m128i t01 = getTexel_gather ( t, getTexel_offset ( t, tx, ty1 ) );
+	const __m128i t11 = getTexel_gather ( t, getTexel_offset ( t, tx1, ty1 ) );
+
+	// weights and colors are below 2^15, so pmaddwd multiplies and sums
+	// pairs of them. the low half of a lane holds x0, the high half x1
+	const __m128i fract = _mm_set1_epi32 ( FIX_POINT_FRACT_MASK );
+	const __m128i txFract = _mm_and_si128 ( tx, fract );
+	const __m128i txFractInv = _mm_sub_epi32 ( one, txFract );
+	const __m128i tyFract = _mm_and_si128 ( ty, fract );
+	const __m128i tyFractInv = _mm_sub_epi32 ( one, tyFract );
+
+	const __m128i w00 = _mm_srli_epi32 ( _mm_madd_epi16 ( txFractInv, tyFractInv ), FIX_POINT_PRE );
+	const __m128i w10 = _mm_srli_epi32 ( _mm_madd_epi16 ( txFract, tyFractInv ), FIX_POINT_PRE );
+	const __m128i w01 = _mm_srli_epi32 ( _mm_madd_epi16 ( txFractInv, tyFract ), FIX_POINT_PRE );
+	const __m128i w11 = _mm_srli_epi32 ( _mm_madd_epi16 ( txFract, tyFract ), FIX_POINT_PRE );
+
+	const __m128i w0 = _mm_or_si128 ( w00, _mm_slli_epi32 ( w01, 16 ) );
+	const __m128i w1 = _mm_or_si128 ( w10, _mm_slli_epi32 ( w11, 16 ) );
+
+	const __m128i low = _mm_set1_epi32 ( 0x000000FF );
+	const __m128i high = _mm_set1_epi32 ( 0x00FF0000 );
+
+	r = _mm_add_epi32 (
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( _mm_srli_epi32 ( t00, SHIFT_R ), low ), _mm_and_si128 ( t01, high ) ), w0 ),
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( _mm_srli_epi32 ( t10, SHIFT_R ), low ), _mm_and_si128 ( t11, high ) ), w1 )
+		);
+
+	g = _mm_add_epi32 (
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( _mm_srli_epi32 ( t00, SHIFT_G ), low ), _mm_and_si128 ( _mm_slli_epi32 ( t01, 16 - SHIFT_G ), high ) ), w0 ),
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( _mm_srli_epi32 ( t10, SHIFT_G ), low ), _mm_and_si128 ( _mm_slli_epi32 ( t11, 16 - SHIFT_G ), high ) ), w1 )
+		);
+
+	b = _mm_add_epi32 (
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( t00, low ), _mm_and_si128 ( _mm_slli_epi32 ( t01, 16 ), high ) ), w0 ),
+		_mm_madd_epi16 ( _mm_or_si128 ( _mm_and_si128 ( t10, low ), _mm_and_si128 ( _mm_slli_epi32 ( t11, 16 ), high ) ), w1 )
+		);
+}
+
 #endif
 
 // some 2D Defines
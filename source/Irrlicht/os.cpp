@@ -130,6 +130,22 @@ namespace os
 		return GetTickCount();
 	}
 
+	u64 Timer::getRealTimeMicroseconds()
+	{
+		static LARGE_INTEGER frequency;
+		static const BOOL supported = QueryPerformanceFrequency(&frequency);
+
+		LARGE_INTEGER nTime;
+		if (supported && QueryPerformanceCounter(&nTime))
+		{
+			const u64 ticks = (u64)nTime.QuadPart;
+			const u64 freq = (u64)frequency.QuadPart;
+			return (ticks / freq) * 1000000 + (ticks % freq) * 1000000 / freq;
+		}
+
+		return (u64)GetTickCount() * 1000;
+	}
+
 } // end namespace os
 
 
@@ -165,6 +181,13 @@ namespace os
 		gettimeofday(&tv, 0);
 		return (u32)(tv.tv_sec * 1000) + (tv.tv_usec / 1000);
 	}
+
+	u64 Timer::getRealTimeMicroseconds()
+	{
+		timeval tv;
+		gettimeofday(&tv, 0);
+		return (u64)tv.tv_sec * 1000000 + tv.tv_usec;
+	}
 } // end namespace os
 
 #endif // end linux / windows
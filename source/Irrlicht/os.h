@@ -112,6 +112,9 @@ namespace os
 		//! returns the current real time in milliseconds
 		static u32 getRealTime();
 
+		//! returns the current real time in microseconds, for measuring short times
+		static u64 getRealTimeMicroseconds();
+
 	private:
 
 		static void initVirtualTimer();